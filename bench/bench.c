@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "history.h"
+#include "host.h"
+#include "workloads.h"
+
+// Emulation speed benchmark, built once per CPU variant so each specialised
+// interpreter can be compared against the others
+//
+//  6502_bench [--history file] [--compare file] [output]
+//
+// Each workload (workloads.h) is run once and its result checked, then
+// BENCH_WARMUP runs and BENCH_REPETITIONS timed runs of BENCH_CYCLES_PER_RUN
+// cycles. The median and p99 (slowest 1% of runs) are given in emulated MHz,
+// host ns per instruction and cycles per second.
+//
+// --history compares the run with the newest one of the same build in 'file'
+// and then adds it there, --compare only compares (see history.h). The exit
+// code is 2 when a workload got slower. 'output' is the trace file or the
+// heatmap image of the builds that make one.
+
+#define BENCH_CYCLES_PER_RUN 10000000 // 10 million emulated cycles
+#define BENCH_WARMUP         2
+#define BENCH_REPETITIONS    15
+#define BENCH_PASS_CYCLES    100000000 // limit of the checked pass
+
+#if BENCH_REPETITIONS > HISTORY_MAX_SAMPLES
+#error "BENCH_REPETITIONS does not fit in the history"
+#endif
+
+#if defined(_WIN32)
+#define BENCH_NULL_FILE "NUL"
+#else
+#define BENCH_NULL_FILE "/dev/null"
+#endif
+
+// Nearest rank percentile of sorted 'values'
+static double Percentile(const double *values, int count, int percent)
+{
+    const int rank = (percent * count + 99) / 100;
+    return values[(rank > 0) ? rank - 1 : 0];
+}
+
+// Runs the first pass of 'workload' and checks its result, then times a whole
+// pass for its cycles per instruction. The machine is left at the end of it.
+static bool Workload_Check(const Workload *workload, double *cycles_per_instruction)
+{
+    static Stop_Conditions stop;
+    memset(&stop, 0, sizeof(stop));
+    Stop_At_PC(&stop, workload->done_pc);
+    stop.max_cycles = BENCH_PASS_CYCLES;
+
+    Reset_CPU();
+    Load_Program(workload->program, workload->size);
+    cpu.program_counter = 0x0200;
+
+    if (Execute_Until(&stop).reason != STOP_PC)
+    {
+        fprintf(stderr, "%s : pass did not end\n", workload->name);
+        return false;
+    }
+    if (memcmp(&mem.data[workload->check_address], workload->check, workload->check_size) != 0)
+    {
+        fprintf(stderr, "%s : wrong result at 0x%04X\n", workload->name, (unsigned)workload->check_address);
+        return false;
+    }
+
+    // the JMP back and the next pass
+    const s32            jump = Execute(1);
+    const Execute_Result pass = Execute_Until(&stop);
+    if (pass.reason != STOP_PC)
+        return false;
+
+    *cycles_per_instruction = (double)(jump + pass.cycles_used) / (double)(pass.instructions + 1);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const char *history_path = NULL;
+    const char *compare_path = NULL;
+    const char *output       = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--history") == 0 && i + 1 < argc)
+        {
+            history_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc)
+        {
+            compare_path = argv[++i];
+        }
+        else if (output == NULL && argv[i][0] != '-')
+        {
+            output = argv[i];
+        }
+        else
+        {
+            fprintf(stderr, "usage : %s [--history file] [--compare file] [output]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    printf("6502 benchmark - variant : %s\n", H6502_VARIANT_NAME);
+
+#if H6502_TRACE
+    // the trace goes nowhere unless a file is given
+    const char *trace_path = (output != NULL) ? output : BENCH_NULL_FILE;
+    if (!Trace_Start(trace_path))
+        return 1;
+    printf("tracing to : %s\n", trace_path);
+#elif H6502_TRACE_TEXT
+    const char *trace_path = (output != NULL) ? output : BENCH_NULL_FILE;
+    if (!Trace_Text_Start(trace_path))
+        return 1;
+    printf("tracing to : %s\n", trace_path);
+#endif
+
+    static History_Run run;
+    run.time           = (int64_t)time(NULL);
+    run.cycles_per_run = BENCH_CYCLES_PER_RUN;
+    History_Build_Name(run.build, sizeof(run.build));
+
+    printf("%d warm-up and %d timed runs of %d cycles a workload\n\n", BENCH_WARMUP, BENCH_REPETITIONS, BENCH_CYCLES_PER_RUN);
+    printf("%-12s %7s %9s %9s %10s %10s %11s\n", "workload", "cyc/ins", "MHz med", "MHz p99", "ns/ins med", "ns/ins p99", "cycles/s");
+
+    const double start         = Seconds_Now();
+    double       timed_cycles  = 0.0;
+    double       timed_seconds = 0.0;
+    for (u32 w = 0; w < WORKLOAD_COUNT; w++)
+    {
+        const Workload *workload = &workloads[w];
+        double          cycles_per_instruction;
+        if (!Workload_Check(workload, &cycles_per_instruction))
+            return 1;
+
+        for (int repeat = 0; repeat < BENCH_WARMUP; repeat++)
+            Execute(BENCH_CYCLES_PER_RUN);
+
+        // ns per emulated cycle of each run
+        double ns_per_cycle[BENCH_REPETITIONS];
+        for (int repeat = 0; repeat < BENCH_REPETITIONS; repeat++)
+        {
+            const double repeat_start = Seconds_Now();
+            const s32    cycles_used  = Execute(BENCH_CYCLES_PER_RUN);
+            const double seconds      = Seconds_Now() - repeat_start;
+
+            ns_per_cycle[repeat] = seconds * 1e9 / (double)cycles_used;
+            timed_cycles += (double)cycles_used;
+            timed_seconds += seconds;
+        }
+
+        History_Workload *samples = &run.workloads[run.workload_count++];
+        snprintf(samples->name, sizeof(samples->name), "%s", workload->name);
+        samples->samples = BENCH_REPETITIONS;
+        memcpy(samples->ns_per_cycle, ns_per_cycle, sizeof(ns_per_cycle));
+
+        qsort(ns_per_cycle, BENCH_REPETITIONS, sizeof(double), History_Compare_Doubles);
+
+        const double median = Percentile(ns_per_cycle, BENCH_REPETITIONS, 50);
+        const double p99    = Percentile(ns_per_cycle, BENCH_REPETITIONS, 99);
+
+        printf("%-12s %7.2f %9.1f %9.1f %10.2f %10.2f %11.3e\n", workload->name, cycles_per_instruction, 1e3 / median, 1e3 / p99,
+               median * cycles_per_instruction, p99 * cycles_per_instruction, 1e9 / median);
+    }
+    const double elapsed = Seconds_Now() - start;
+
+    printf("\nall workloads : %.1f MHz (%.3f s, %.3f s timed)\n", timed_cycles / timed_seconds / 1e6, elapsed, timed_seconds);
+
+#if H6502_TRACE
+    if (!Trace_Stop())
+        fprintf(stderr, "Error writing trace file\n");
+    printf("trace records : %" PRIu64 "\n", trace_writer.records_written);
+#endif
+
+#if H6502_TRACE_TEXT
+    const uint64_t lines = trace_text.lines;
+    Trace_Text_Stop();
+    printf("trace lines : %" PRIu64 " (%.1f M lines/s)\n", lines, (double)lines / elapsed / 1e6);
+#endif
+
+#if H6502_HEATMAP
+    if (output != NULL)
+    {
+        FILE *image = fopen(output, "wb");
+        if (image == NULL || !Heatmap_Write_PPM(&heatmap, image))
+            return 1;
+        fclose(image);
+        printf("heatmap : %s\n", output);
+    }
+#endif
+
+#if H6502_OPCODE_STATS
+    printf("\n");
+    Opcode_Stats_Write_CSV(stdout);
+#endif
+
+    // the history file is also the baseline when no other is given
+    int                regressions = 0;
+    static History_Run baseline;
+    const char        *baseline_path = (compare_path != NULL) ? compare_path : history_path;
+    if (baseline_path != NULL)
+    {
+        if (History_Load_Latest(baseline_path, run.build, &baseline))
+            regressions = History_Print_Comparison(&baseline, &run);
+        else
+            printf("\nno earlier %s run in %s\n", run.build, baseline_path);
+    }
+    if (history_path != NULL && !History_Append(history_path, &run))
+        return 1;
+    return (regressions > 0) ? 2 : 0;
+}
@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host.h"
+#include "machine.h"
+
+// Machine fork benchmark : forks a running machine many times, then runs a
+// share of the children for a while to see what they cost once they write
+
+#define FORK_BENCH_CHILDREN 100000
+#define FORK_BENCH_RUNNERS  1000  // children that run after the fork
+#define FORK_BENCH_CYCLES   10000 // cycles each of them runs
+
+int main(void)
+{
+    // same program as bench.c
+    const u8 program[] = {
+        0x00, 0x02,       // load address : 0x0200
+        0xA2, 0x00,       // 0x0200 : LDX #$00
+        0xBD, 0x00, 0x03, // 0x0202 : LDA $0300,X
+        0x69, 0x01,       // 0x0205 : ADC #$01
+        0x9D, 0x00, 0x03, // 0x0207 : STA $0300,X
+        0xE8,             // 0x020A : INX
+        0xD0, 0xF5,       // 0x020B : BNE $0202
+        0x4C, 0x00, 0x02, // 0x020D : JMP $0200
+    };
+
+    printf("6502 fork benchmark - variant : %s\n", H6502_VARIANT_NAME);
+
+    Reset_CPU();
+    Load_Program(program, sizeof(program));
+    cpu.program_counter = 0x0200;
+    Machine *parent     = Machine_Create();
+    Execute(100000);
+
+    static Machine *children[FORK_BENCH_CHILDREN];
+    const uint64_t  pages_before = machines.pages_allocated;
+
+    double start = Seconds_Now();
+    for (int i = 0; i < FORK_BENCH_CHILDREN; i++)
+        children[i] = Machine_Fork(parent);
+    const double fork_seconds = Seconds_Now() - start;
+
+    printf("fork   : %d in %.3f s (%.0f forks/s, %.0f ns each)\n", FORK_BENCH_CHILDREN, fork_seconds,
+           FORK_BENCH_CHILDREN / fork_seconds, fork_seconds / FORK_BENCH_CHILDREN * 1e9);
+    printf("memory : %zu bytes per fork, %" PRIu64 " pages copied\n", sizeof(Machine), machines.pages_allocated - pages_before);
+
+    start = Seconds_Now();
+    for (int i = 0; i < FORK_BENCH_RUNNERS; i++)
+    {
+        Machine_Switch(children[i]);
+        Execute(FORK_BENCH_CYCLES);
+    }
+    Machine_Switch(parent);
+    const double run_seconds = Seconds_Now() - start;
+
+    const uint64_t written = machines.pages_allocated - pages_before;
+    printf("run    : %d children x %d cycles in %.3f s (%.1f us per switch and run)\n", FORK_BENCH_RUNNERS, FORK_BENCH_CYCLES,
+           run_seconds, run_seconds / FORK_BENCH_RUNNERS * 1e6);
+    printf("memory : %.1f pages written per child that ran, %.0f bytes each with its own table\n", (double)written / FORK_BENCH_RUNNERS,
+           (double)(sizeof(Machine) + sizeof(Machine_Table)) + (double)written / FORK_BENCH_RUNNERS * sizeof(Machine_Page));
+
+    start = Seconds_Now();
+    for (int i = 0; i < FORK_BENCH_CHILDREN; i++)
+        Machine_Free(children[i]);
+    printf("free   : %d in %.3f s\n", FORK_BENCH_CHILDREN, Seconds_Now() - start);
+
+    Machine_Free(parent);
+    return 0;
+}
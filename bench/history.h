@@ -0,0 +1,301 @@
+#ifndef __HISTORY_H__
+#define __HISTORY_H__
+
+// Benchmark history and regression check
+//
+// Each benchmark run is appended to a history file as one JSON object a line,
+// with the time of every timed repetition of every workload:
+//
+//  {"time": 1760000000, "build": "NMOS", "cycles_per_run": 10000000, "workloads": [
+//   {"name": "sieve", "median_mhz": 571.3, "ns_per_cycle": [1.75, 1.76, ...]}, ...]}
+//
+// Runs are compared with the newest run of the same build (variant and
+// H6502_* flags) in the file. Each workload's repetitions are compared with a
+// Mann-Whitney U test, so a slower median counts as a regression only when
+// the runs as a whole are slower (p < HISTORY_SIGNIFICANCE) and by more than
+// HISTORY_MIN_CHANGE. The reader only knows the files written here.
+
+#include <math.h>
+#include <time.h>
+
+#include "h6502.h"
+
+#define HISTORY_MAX_WORKLOADS 16
+#define HISTORY_MAX_SAMPLES   64
+#define HISTORY_MAX_LINE      (1 << 16)
+#define HISTORY_SIGNIFICANCE  0.01
+#define HISTORY_MIN_CHANGE    0.01 // 1 %
+
+typedef struct History_Workload
+{
+    char   name[32];
+    int    samples;
+    double ns_per_cycle[HISTORY_MAX_SAMPLES];
+} History_Workload;
+
+typedef struct History_Run
+{
+    int64_t          time;
+    char             build[64];
+    s32              cycles_per_run;
+    int              workload_count;
+    History_Workload workloads[HISTORY_MAX_WORKLOADS];
+} History_Run;
+
+typedef enum
+{
+    HISTORY_SAME = 0,
+    HISTORY_FASTER,
+    HISTORY_SLOWER,
+} History_Verdict;
+
+static inline int History_Compare_Doubles(const void *a, const void *b)
+{
+    const double x = *(const double *)a;
+    const double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Variant and the flags that change the speed, e.g. "NMOS+TRACE"
+static inline void History_Build_Name(char *build, size_t size)
+{
+    snprintf(build, size, "%s%s%s%s%s%s%s%s%s%s%s", H6502_VARIANT_NAME, H6502_OPCODE_STATS ? "+OPCODE_STATS" : "",
+             H6502_CALL_PROFILER ? "+CALL_PROFILER" : "", H6502_TRACE ? "+TRACE" : "", H6502_TRACE_COLUMNS ? "+TRACE_COLUMNS" : "",
+             H6502_HEATMAP ? "+HEATMAP" : "", H6502_EDGE_COVERAGE ? "+EDGE_COVERAGE" : "", H6502_TRACE_TEXT ? "+TRACE_TEXT" : "",
+             H6502_SNAPSHOT ? "+SNAPSHOT" : "", H6502_INPUT_LOG ? "+INPUT_LOG" : "", H6502_WRITE_WATCH ? "+WRITE_WATCH" : "");
+}
+
+static inline double History_Median(const History_Workload *workload)
+{
+    double sorted[HISTORY_MAX_SAMPLES];
+    memcpy(sorted, workload->ns_per_cycle, (size_t)workload->samples * sizeof(double));
+    qsort(sorted, (size_t)workload->samples, sizeof(double), History_Compare_Doubles);
+
+    const int middle = workload->samples / 2;
+    return (workload->samples % 2) ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) / 2.0;
+}
+
+static inline const History_Workload *History_Find_Workload(const History_Run *run, const char *name)
+{
+    for (int w = 0; w < run->workload_count; w++)
+    {
+        if (strcmp(run->workloads[w].name, name) == 0)
+            return &run->workloads[w];
+    }
+    return NULL;
+}
+
+// ---------------------------------------------------------------------
+// File
+
+static inline bool History_Append(const char *path, const History_Run *run)
+{
+    FILE *file = fopen(path, "a");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error opening history file : %s\n", path);
+        return false;
+    }
+
+    fprintf(file, "{\"time\": %" PRId64 ", \"build\": \"%s\", \"cycles_per_run\": %" PRIdFAST32 ", \"workloads\": [", run->time, run->build,
+            run->cycles_per_run);
+    for (int w = 0; w < run->workload_count; w++)
+    {
+        const History_Workload *workload = &run->workloads[w];
+        fprintf(file, "%s{\"name\": \"%s\", \"median_mhz\": %.3f, \"ns_per_cycle\": [", w ? ", " : "", workload->name,
+                1e3 / History_Median(workload));
+        for (int s = 0; s < workload->samples; s++)
+            fprintf(file, "%s%.6f", s ? ", " : "", workload->ns_per_cycle[s]);
+        fprintf(file, "]}");
+    }
+    fprintf(file, "]}\n");
+
+    const bool ok = ferror(file) == 0;
+    return (fclose(file) == 0) && ok;
+}
+
+// The string value of "key" in 'line' into 'value', NULL when it is not there
+static inline const char *History_Get_String(const char *line, const char *key, char *value, size_t size)
+{
+    const char *at = strstr(line, key);
+    if (at == NULL || (at = strchr(at + strlen(key), '"')) == NULL)
+        return NULL;
+
+    const char *end = strchr(++at, '"');
+    if (end == NULL || (size_t)(end - at) >= size)
+        return NULL;
+    memcpy(value, at, (size_t)(end - at));
+    value[end - at] = '\0';
+    return end + 1;
+}
+
+static inline bool History_Parse_Run(const char *line, History_Run *run)
+{
+    memset(run, 0, sizeof(*run));
+    if (History_Get_String(line, "\"build\":", run->build, sizeof(run->build)) == NULL)
+        return false;
+
+    const char *at      = strstr(line, "\"time\":");
+    run->time           = (at != NULL) ? strtoll(at + 7, NULL, 10) : 0;
+    at                  = strstr(line, "\"cycles_per_run\":");
+    run->cycles_per_run = (at != NULL) ? (s32)strtol(at + 17, NULL, 10) : 0;
+
+    at = line;
+    while (run->workload_count < HISTORY_MAX_WORKLOADS)
+    {
+        History_Workload *workload = &run->workloads[run->workload_count];
+        at                         = History_Get_String(at, "\"name\":", workload->name, sizeof(workload->name));
+        if (at == NULL || (at = strstr(at, "\"ns_per_cycle\":")) == NULL || (at = strchr(at, '[')) == NULL)
+            break;
+
+        at++;
+        while (workload->samples < HISTORY_MAX_SAMPLES)
+        {
+            char        *end;
+            const double value = strtod(at, &end);
+            if (end == at)
+                break;
+            workload->ns_per_cycle[workload->samples++] = value;
+            at                                          = end;
+            while (*at == ' ' || *at == ',')
+                at++;
+        }
+        if (workload->samples > 0)
+            run->workload_count++;
+    }
+    return run->workload_count > 0;
+}
+
+// Newest run of 'build' in the history, false when there is none
+static inline bool History_Load_Latest(const char *path, const char *build, History_Run *latest)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+        return false;
+
+    static char        line[HISTORY_MAX_LINE];
+    static History_Run run;
+    bool               found = false;
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        if (History_Parse_Run(line, &run) && strcmp(run.build, build) == 0)
+        {
+            *latest = run;
+            found   = true;
+        }
+    }
+    fclose(file);
+    return found;
+}
+
+// ---------------------------------------------------------------------
+// Comparison
+
+// Two sided p value of the Mann-Whitney U test of 'a' against 'b', normal
+// approximation with the tie correction
+static inline double History_Mann_Whitney(const double *a, int a_count, const double *b, int b_count)
+{
+    typedef struct
+    {
+        double value;
+        bool   from_a;
+    } Sample;
+
+    Sample    samples[2 * HISTORY_MAX_SAMPLES];
+    const int count = a_count + b_count;
+    for (int i = 0; i < a_count; i++)
+        samples[i] = (Sample){a[i], true};
+    for (int i = 0; i < b_count; i++)
+        samples[a_count + i] = (Sample){b[i], false};
+
+    // insertion sort, a few dozen samples
+    for (int i = 1; i < count; i++)
+    {
+        const Sample sample = samples[i];
+        int          j      = i;
+        for (; j > 0 && samples[j - 1].value > sample.value; j--)
+            samples[j] = samples[j - 1];
+        samples[j] = sample;
+    }
+
+    // rank sum of 'a', equal values share their average rank
+    double rank_sum = 0.0;
+    double ties     = 0.0;
+    for (int i = 0; i < count;)
+    {
+        int j = i;
+        while (j < count && samples[j].value == samples[i].value)
+            j++;
+
+        const double rank = (i + 1 + j) / 2.0;
+        for (int k = i; k < j; k++)
+            rank_sum += samples[k].from_a ? rank : 0.0;
+
+        const double tied = (double)(j - i);
+        ties += tied * tied * tied - tied;
+        i = j;
+    }
+
+    const double n1       = (double)a_count;
+    const double n2       = (double)b_count;
+    const double n        = n1 + n2;
+    const double u        = rank_sum - n1 * (n1 + 1.0) / 2.0;
+    const double mean     = n1 * n2 / 2.0;
+    const double variance = n1 * n2 / 12.0 * ((n + 1.0) - ties / (n * (n - 1.0)));
+    if (variance <= 0.0)
+        return 1.0;
+
+    // continuity correction
+    const double distance = fabs(u - mean) - 0.5;
+    const double z        = (distance > 0.0 ? distance : 0.0) / sqrt(variance);
+    return erfc(z / sqrt(2.0));
+}
+
+// Compares 'now' with 'baseline', 'change' is the relative change of the
+// median speed (0.05 is 5 % faster)
+static inline History_Verdict History_Compare(const History_Workload *baseline, const History_Workload *now, double *change,
+                                              double *p_value)
+{
+    *change  = History_Median(baseline) / History_Median(now) - 1.0;
+    *p_value = History_Mann_Whitney(baseline->ns_per_cycle, baseline->samples, now->ns_per_cycle, now->samples);
+
+    if (*p_value >= HISTORY_SIGNIFICANCE || fabs(*change) < HISTORY_MIN_CHANGE)
+        return HISTORY_SAME;
+    return (*change < 0.0) ? HISTORY_SLOWER : HISTORY_FASTER;
+}
+
+// Delta table of 'now' against 'baseline', returns the number of regressions
+static inline int History_Print_Comparison(const History_Run *baseline, const History_Run *now)
+{
+    static const char *const verdicts[] = {"same", "faster", "REGRESSION"};
+
+    char             when[32]      = "?";
+    const time_t     baseline_time = (time_t)baseline->time;
+    const struct tm *local         = localtime(&baseline_time);
+    if (local != NULL)
+        strftime(when, sizeof(when), "%Y-%m-%d %H:%M", local);
+
+    printf("\ncompared with the run of %s (%s)\n", when, baseline->build);
+    printf("%-12s %9s %9s %8s %8s  %s\n", "workload", "base MHz", "now MHz", "delta", "p", "verdict");
+
+    int regressions = 0;
+    for (int w = 0; w < now->workload_count; w++)
+    {
+        const History_Workload *workload = &now->workloads[w];
+        const History_Workload *before   = History_Find_Workload(baseline, workload->name);
+        if (before == NULL)
+        {
+            printf("%-12s %9s %9.1f %8s %8s  new\n", workload->name, "-", 1e3 / History_Median(workload), "-", "-");
+            continue;
+        }
+
+        double                change, p_value;
+        const History_Verdict verdict = History_Compare(before, workload, &change, &p_value);
+        regressions += (verdict == HISTORY_SLOWER);
+        printf("%-12s %9.1f %9.1f %+7.1f%% %8.4f  %s\n", workload->name, 1e3 / History_Median(before), 1e3 / History_Median(workload),
+               change * 100.0, p_value, verdicts[verdict]);
+    }
+    return regressions;
+}
+
+#endif // __HISTORY_H__
@@ -0,0 +1,336 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "h6502.h"
+#include "host.h"
+
+// Per-opcode microbenchmark, built once per CPU variant
+//
+//  6502_bench_opcodes                  JSON on stdout
+//  6502_bench_opcodes results.json     JSON to the file and a table on stdout
+//
+// Every opcode of the variant is run as a long unrolled sequence of itself,
+// OPCODE_BENCH_COUNT copies closed by a JMP back to the start, and timed with
+// every engine in execution_engines (h6502.h). Indexed modes that can cross a
+// page (ABS_X, ABS_Y, IND_Y) are run without and with the cross, branches
+// taken and not taken. The result is the median host ns per emulated
+// instruction, the closing JMP counted as one of the instructions.
+//
+// Operands point at data away from the code: zero page OPCODE_BENCH_ZP,
+// absolute OPCODE_BENCH_DATA, X and Y are OPCODE_BENCH_INDEX. JMP and JSR go
+// to the next copy, RTS and RTI return to it from a stack filled beforehand.
+// BRK is left out, it cannot run on its own.
+
+#define OPCODE_BENCH_START       0x0200
+#define OPCODE_BENCH_COUNT       1000     // copies of the instruction in a sequence
+#define OPCODE_BENCH_POINTERS    0x1000   // JMP (ind) targets, one per copy
+#define OPCODE_BENCH_DATA        0x4000
+#define OPCODE_BENCH_CROSS       0xF8     // low byte of the data when it crosses a page with the index
+#define OPCODE_BENCH_ZP          0x80
+#define OPCODE_BENCH_INDEX       0x10
+#define OPCODE_BENCH_CYCLES      200000   // emulated cycles a timed run
+#define OPCODE_BENCH_REPETITIONS 7
+
+typedef enum
+{
+    BENCH_CASE_PLAIN = 0,
+    BENCH_CASE_NO_CROSS,
+    BENCH_CASE_PAGE_CROSS,
+    BENCH_CASE_TAKEN,
+    BENCH_CASE_NOT_TAKEN,
+} Bench_Case;
+
+static const char *const bench_case_names[] = {"", "no_cross", "page_cross", "taken", "not_taken"};
+
+static int Compare_Doubles(const void *a, const void *b)
+{
+    const double x = *(const double *)a;
+    const double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void Write_Word(u16 address, u16 value)
+{
+    mem.data[address & 0xFFFF]       = (u8)(value & 0xFF);
+    mem.data[(address + 1) & 0xFFFF] = (u8)(value >> 8);
+}
+
+// Writes the sequence of 'opcode' and sets the machine up to run it from
+// OPCODE_BENCH_START, 'status' is the processor status it starts with
+static void Bench_Setup(u8 opcode, Bench_Case bench_case, uint8_t status)
+{
+    Reset_CPU();
+    cpu.program_counter = OPCODE_BENCH_START;
+    cpu.index_reg_X     = OPCODE_BENCH_INDEX;
+    cpu.index_reg_Y     = OPCODE_BENCH_INDEX;
+    cpu.PS              = status;
+
+    const u16 data = OPCODE_BENCH_DATA | ((bench_case == BENCH_CASE_PAGE_CROSS) ? OPCODE_BENCH_CROSS : 0);
+    Write_Word(OPCODE_BENCH_ZP, data);                      // (zp),Y and (zp)
+    Write_Word(OPCODE_BENCH_ZP + OPCODE_BENCH_INDEX, data); // (zp,X)
+
+    // the stack holds one return address a copy, RTS adds one to it
+    const bool returns = (opcode == INS_RTS || opcode == INS_RTI);
+    const u32  pulled  = (opcode == INS_RTS) ? 2 : 3;
+    const u32  count   = returns ? 256 / pulled : OPCODE_BENCH_COUNT;
+
+    const Address_Mode mode  = Opcode_Address_Mode(opcode);
+    const u8           bytes = Opcode_Bytes(opcode);
+    u16                at    = OPCODE_BENCH_START;
+    for (u32 i = 0; i < count; i++)
+    {
+        const u16 next = at + bytes;
+        mem.data[at]   = opcode;
+        if (opcode == INS_JMP_ABS || opcode == INS_JSR)
+        {
+            Write_Word(at + 1, next);
+        }
+        else if (mode == MODE_IND || mode == MODE_ABS_IND_X)
+        {
+            const u16 pointer = OPCODE_BENCH_POINTERS + 2 * i;
+            Write_Word(pointer, next);
+            Write_Word(at + 1, (mode == MODE_IND) ? pointer : pointer - OPCODE_BENCH_INDEX);
+        }
+        else if (returns)
+        {
+            const u16 slot = 0x0100 + pulled * i;
+            if (opcode == INS_RTS)
+            {
+                Write_Word(slot, next - 1);
+            }
+            else
+            {
+                mem.data[slot] = unused_FLAG_BIT;
+                Write_Word(slot + 1, next);
+            }
+        }
+        else if (mode == MODE_ABS || mode == MODE_ABS_X || mode == MODE_ABS_Y)
+        {
+            Write_Word(at + 1, data);
+        }
+        else if (mode == MODE_IM)
+        {
+            mem.data[at + 1] = OPCODE_BENCH_INDEX; // LDX and LDY keep the index
+        }
+        else if (mode == MODE_REL)
+        {
+            mem.data[at + 1] = 0; // taken or not, the next copy
+        }
+        else if (bytes == 2)
+        {
+            mem.data[at + 1] = OPCODE_BENCH_ZP;
+        }
+        at = next;
+    }
+
+    if (returns)
+    {
+        // LDX #$FF ; TXS, the stack pointer back where it started
+        mem.data[at++] = INS_LDX_IM;
+        mem.data[at++] = 0xFF;
+        mem.data[at++] = INS_TXS;
+    }
+    mem.data[at] = INS_JMP_ABS;
+    Write_Word(at + 1, OPCODE_BENCH_START);
+}
+
+// Status for a branch to be taken or not, false when it cannot be
+static bool Branch_Status(u8 opcode, bool taken, uint8_t *status)
+{
+    // all the flags a branch tests clear, then all set
+    const uint8_t candidates[] = {unused_FLAG_BIT, unused_FLAG_BIT | NEGATIVE_FLAG_BIT | OVERFLOW_FLAG_BIT | 0x03};
+    for (u32 i = 0; i < sizeof(candidates); i++)
+    {
+        Bench_Setup(opcode, BENCH_CASE_TAKEN, candidates[i]);
+        const bool was_taken = Execute(1) > Opcode_Cycles(opcode);
+        if (was_taken == taken)
+        {
+            *status = candidates[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+// Cycles per instruction of one pass over the sequence
+static double Bench_Cycles_Per_Instruction(void)
+{
+    static Stop_Conditions stop;
+    memset(&stop, 0, sizeof(stop));
+    Stop_At_PC(&stop, OPCODE_BENCH_START);
+    stop.max_cycles = 100 * OPCODE_BENCH_CYCLES;
+
+    const s32            first = Execute(1);
+    const Execute_Result pass  = Execute_Until(&stop);
+    if (pass.reason != STOP_PC)
+        return 0.0;
+    return (double)(first + pass.cycles_used) / (double)(pass.instructions + 1);
+}
+
+// Median host ns per instruction of 'engine'
+static double Bench_Time(const Execution_Engine *engine, double cycles_per_instruction)
+{
+    double ns_per_instruction[OPCODE_BENCH_REPETITIONS];
+
+    engine->run(OPCODE_BENCH_CYCLES); // warm-up
+    for (int run = 0; run < OPCODE_BENCH_REPETITIONS; run++)
+    {
+        const double start       = Seconds_Now();
+        const s32    cycles_used = engine->run(OPCODE_BENCH_CYCLES);
+        const double seconds     = Seconds_Now() - start;
+
+        ns_per_instruction[run] = seconds * 1e9 / ((double)cycles_used / cycles_per_instruction);
+    }
+    qsort(ns_per_instruction, OPCODE_BENCH_REPETITIONS, sizeof(double), Compare_Doubles);
+    return ns_per_instruction[OPCODE_BENCH_REPETITIONS / 2];
+}
+
+// Host CPU model, "unknown" when it cannot be found
+static void Host_CPU_Model(char *model, size_t size)
+{
+    snprintf(model, size, "unknown");
+#if defined(__linux__)
+    FILE *file = fopen("/proc/cpuinfo", "r");
+    if (file == NULL)
+        return;
+
+    char line[256];
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        const char *colon = strchr(line, ':');
+        if (strncmp(line, "model name", 10) != 0 || colon == NULL)
+            continue;
+
+        // without the leading space, the newline and anything JSON would need escaped
+        size_t used = 0;
+        for (const char *c = colon + 1 + (colon[1] == ' '); *c && *c != '\n' && used + 1 < size; c++)
+        {
+            if (*c != '"' && *c != '\\')
+                model[used++] = *c;
+        }
+        model[used] = '\0';
+        break;
+    }
+    fclose(file);
+#endif
+}
+
+static void Write_Header(FILE *file)
+{
+    char model[128];
+    Host_CPU_Model(model, sizeof(model));
+
+#if defined(__OPTIMIZE__)
+    const bool optimized = true;
+#else
+    const bool optimized = false;
+#endif
+#if defined(__VERSION__)
+    const char *compiler = __VERSION__;
+#else
+    const char *compiler = "unknown";
+#endif
+
+    fprintf(file, "{\n  \"benchmark\": \"opcodes\",\n  \"variant\": \"%s\",\n  \"cpu\": \"%s\",\n", H6502_VARIANT_NAME, model);
+    fprintf(file, "  \"compiler\": \"%s\",\n  \"optimized\": %s,\n", compiler, optimized ? "true" : "false");
+    fprintf(file,
+            "  \"flags\": {\"H6502_OPCODE_STATS\": %d, \"H6502_CALL_PROFILER\": %d, \"H6502_TRACE\": %d, \"H6502_TRACE_COLUMNS\": %d, "
+            "\"H6502_HEATMAP\": %d, \"H6502_EDGE_COVERAGE\": %d, \"H6502_TRACE_TEXT\": %d, \"H6502_SNAPSHOT\": %d, \"H6502_INPUT_LOG\": %d, "
+            "\"H6502_WRITE_WATCH\": %d},\n",
+            H6502_OPCODE_STATS, H6502_CALL_PROFILER, H6502_TRACE, H6502_TRACE_COLUMNS, H6502_HEATMAP, H6502_EDGE_COVERAGE,
+            H6502_TRACE_TEXT, H6502_SNAPSHOT, H6502_INPUT_LOG, H6502_WRITE_WATCH);
+    fprintf(file, "  \"sequence\": %d,\n  \"cycles_per_run\": %d,\n  \"repetitions\": %d,\n  \"results\": [", OPCODE_BENCH_COUNT,
+            OPCODE_BENCH_CYCLES, OPCODE_BENCH_REPETITIONS);
+}
+
+int main(int argc, char **argv)
+{
+    FILE *json = stdout;
+    if (argc > 1)
+    {
+        json = fopen(argv[1], "w");
+        if (json == NULL)
+        {
+            fprintf(stderr, "Error opening results file : %s\n", argv[1]);
+            return 1;
+        }
+        printf("6502 opcode benchmark - variant : %s\n", H6502_VARIANT_NAME);
+        printf("%-6s %-4s %-9s %-10s %7s", "opcode", "name", "mode", "case", "cyc/ins");
+        for (int e = 0; e < EXECUTION_ENGINE_COUNT; e++)
+        {
+            char label[32];
+            snprintf(label, sizeof(label), "ns %s", execution_engines[e].name);
+            printf(" %10s", label);
+        }
+        printf("\n");
+    }
+
+    Write_Header(json);
+    bool first = true;
+    for (int opcode = 0; opcode < 256; opcode++)
+    {
+        if (!Opcode_Is_Valid((u8)opcode) || opcode == INS_BRK)
+            continue;
+
+        const Address_Mode mode  = Opcode_Address_Mode((u8)opcode);
+        Bench_Case         cases[2];
+        int                case_count = 0;
+        if (mode == MODE_ABS_X || mode == MODE_ABS_Y || mode == MODE_IND_Y)
+        {
+            cases[case_count++] = BENCH_CASE_NO_CROSS;
+            cases[case_count++] = BENCH_CASE_PAGE_CROSS;
+        }
+        else if (mode == MODE_REL)
+        {
+            cases[case_count++] = BENCH_CASE_TAKEN;
+            cases[case_count++] = BENCH_CASE_NOT_TAKEN;
+        }
+        else
+        {
+            cases[case_count++] = BENCH_CASE_PLAIN;
+        }
+
+        for (int c = 0; c < case_count; c++)
+        {
+            uint8_t status = unused_FLAG_BIT;
+            if (mode == MODE_REL && !Branch_Status((u8)opcode, cases[c] == BENCH_CASE_TAKEN, &status))
+                continue; // BRA is never not taken
+
+            double ns[EXECUTION_ENGINE_COUNT];
+            double cycles_per_instruction = 0.0;
+            for (int e = 0; e < EXECUTION_ENGINE_COUNT; e++)
+            {
+                Bench_Setup((u8)opcode, cases[c], status);
+                cycles_per_instruction = Bench_Cycles_Per_Instruction();
+                if (cycles_per_instruction <= 0.0)
+                {
+                    fprintf(stderr, "Error running opcode 0x%02X\n", opcode);
+                    return 1;
+                }
+                ns[e] = Bench_Time(&execution_engines[e], cycles_per_instruction);
+            }
+
+            fprintf(json, "%s\n    {\"opcode\": %d, \"mnemonic\": \"%s\", \"mode\": \"%s\", \"case\": \"%s\", \"cycles_per_instruction\": %.3f",
+                    first ? "" : ",", opcode, Opcode_Mnemonic((u8)opcode), Address_Mode_Name(mode), bench_case_names[cases[c]],
+                    cycles_per_instruction);
+            for (int e = 0; e < EXECUTION_ENGINE_COUNT; e++)
+                fprintf(json, ", \"ns_%s\": %.3f", execution_engines[e].name, ns[e]);
+            fprintf(json, "}");
+            first = false;
+
+            if (json != stdout)
+            {
+                printf("0x%02X   %-4s %-9s %-10s %7.2f", opcode, Opcode_Mnemonic((u8)opcode), Address_Mode_Name(mode),
+                       bench_case_names[cases[c]], cycles_per_instruction);
+                for (int e = 0; e < EXECUTION_ENGINE_COUNT; e++)
+                    printf(" %10.2f", ns[e]);
+                printf("\n");
+            }
+        }
+    }
+    fprintf(json, "\n  ]\n}\n");
+
+    if (json != stdout && fclose(json) != 0)
+        return 1;
+    return 0;
+}
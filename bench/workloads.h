@@ -0,0 +1,453 @@
+#ifndef __WORKLOADS_H__
+#define __WORKLOADS_H__
+
+// Benchmark workloads
+//
+// Each workload is a 6502 program in Load_Program() format, documented NMOS
+// instructions only so it runs on every variant. It starts at 0x0200, sets up
+// its data and then does its task over and over: one pass ends on a JMP back
+// to the start of the pass at 'done_pc', where the result is in memory at
+// 'check_address'.
+
+#include "h6502.h"
+
+#define WORKLOAD_MAX_CHECK 4
+
+typedef struct Workload
+{
+    const char *name;
+    const u8   *program;
+    int         size;
+    u16         done_pc;
+    u16         check_address;
+    u8          check_size;
+    u8          check[WORKLOAD_MAX_CHECK];
+} Workload;
+
+// Sieve of Eratosthenes, the primes below 8192 with a byte a number at $2000
+// primes : $13-$14 = 1028
+static const u8 workload_sieve[] = {
+    0x00, 0x02,       // load address : 0x0200
+    0xA9, 0x00,       // 0x0200 : LDA #$00
+    0x85, 0x10,       // 0x0202 : STA $10
+    0xA9, 0x20,       // 0x0204 : LDA #$20
+    0x85, 0x11,       // 0x0206 : STA $11
+    0xA2, 0x20,       // 0x0208 : LDX #$20
+    0xA9, 0x00,       // 0x020A : LDA #$00
+    0xA8,             // 0x020C : TAY
+    0x91, 0x10,       // 0x020D : STA ($10),Y
+    0xC8,             // 0x020F : INY
+    0xD0, 0xFB,       // 0x0210 : BNE $020D
+    0xE6, 0x11,       // 0x0212 : INC $11
+    0xCA,             // 0x0214 : DEX
+    0xD0, 0xF6,       // 0x0215 : BNE $020D
+    0xA9, 0x02,       // 0x0217 : LDA #$02
+    0x85, 0x12,       // 0x0219 : STA $12
+    0xA5, 0x12,       // 0x021B : LDA $12
+    0xC9, 0x5B,       // 0x021D : CMP #$5B
+    0xB0, 0x27,       // 0x021F : BCS $0248
+    0x85, 0x10,       // 0x0221 : STA $10
+    0xA9, 0x20,       // 0x0223 : LDA #$20
+    0x85, 0x11,       // 0x0225 : STA $11
+    0xA0, 0x00,       // 0x0227 : LDY #$00
+    0xB1, 0x10,       // 0x0229 : LDA ($10),Y
+    0xD0, 0x17,       // 0x022B : BNE $0244
+    0x18,             // 0x022D : CLC
+    0xA5, 0x10,       // 0x022E : LDA $10
+    0x65, 0x12,       // 0x0230 : ADC $12
+    0x85, 0x10,       // 0x0232 : STA $10
+    0xA5, 0x11,       // 0x0234 : LDA $11
+    0x69, 0x00,       // 0x0236 : ADC #$00
+    0x85, 0x11,       // 0x0238 : STA $11
+    0xC9, 0x40,       // 0x023A : CMP #$40
+    0xB0, 0x06,       // 0x023C : BCS $0244
+    0xA9, 0x01,       // 0x023E : LDA #$01
+    0x91, 0x10,       // 0x0240 : STA ($10),Y
+    0xD0, 0xE9,       // 0x0242 : BNE $022D
+    0xE6, 0x12,       // 0x0244 : INC $12
+    0xD0, 0xD3,       // 0x0246 : BNE $021B
+    0xA9, 0x00,       // 0x0248 : LDA #$00
+    0x85, 0x13,       // 0x024A : STA $13
+    0x85, 0x14,       // 0x024C : STA $14
+    0x85, 0x10,       // 0x024E : STA $10
+    0xA9, 0x20,       // 0x0250 : LDA #$20
+    0x85, 0x11,       // 0x0252 : STA $11
+    0xA0, 0x02,       // 0x0254 : LDY #$02
+    0xB1, 0x10,       // 0x0256 : LDA ($10),Y
+    0xD0, 0x06,       // 0x0258 : BNE $0260
+    0xE6, 0x13,       // 0x025A : INC $13
+    0xD0, 0x02,       // 0x025C : BNE $0260
+    0xE6, 0x14,       // 0x025E : INC $14
+    0xC8,             // 0x0260 : INY
+    0xD0, 0xF3,       // 0x0261 : BNE $0256
+    0xE6, 0x11,       // 0x0263 : INC $11
+    0xA5, 0x11,       // 0x0265 : LDA $11
+    0xC9, 0x40,       // 0x0267 : CMP #$40
+    0xD0, 0xEB,       // 0x0269 : BNE $0256
+    0x4C, 0x00, 0x02, // 0x026B : JMP $0200
+};
+
+// 64 pairs of 16 bit numbers multiplied to 32 bits (shift and add) and divided
+// back (shift and subtract), errors : $1D = 0, XOR of the products : $1E
+static const u8 workload_multiply[] = {
+    0x00, 0x02,       // load address : 0x0200
+    0xA9, 0x00,       // 0x0200 : LDA #$00
+    0x85, 0x10,       // 0x0202 : STA $10
+    0x85, 0x11,       // 0x0204 : STA $11
+    0x85, 0x12,       // 0x0206 : STA $12
+    0x85, 0x13,       // 0x0208 : STA $13
+    0xA9, 0x00,       // 0x020A : LDA #$00
+    0x85, 0x1D,       // 0x020C : STA $1D
+    0x85, 0x1E,       // 0x020E : STA $1E
+    0xA9, 0x40,       // 0x0210 : LDA #$40
+    0x85, 0x1C,       // 0x0212 : STA $1C
+    0x18,             // 0x0214 : CLC
+    0xA5, 0x10,       // 0x0215 : LDA $10
+    0x69, 0x57,       // 0x0217 : ADC #$57
+    0x85, 0x10,       // 0x0219 : STA $10
+    0xA5, 0x11,       // 0x021B : LDA $11
+    0x69, 0x13,       // 0x021D : ADC #$13
+    0x85, 0x11,       // 0x021F : STA $11
+    0x18,             // 0x0221 : CLC
+    0xA5, 0x12,       // 0x0222 : LDA $12
+    0x69, 0x3D,       // 0x0224 : ADC #$3D
+    0x09, 0x01,       // 0x0226 : ORA #$01
+    0x85, 0x12,       // 0x0228 : STA $12
+    0xA5, 0x13,       // 0x022A : LDA $13
+    0x69, 0x0B,       // 0x022C : ADC #$0B
+    0x29, 0x7F,       // 0x022E : AND #$7F
+    0x85, 0x13,       // 0x0230 : STA $13
+    0xA5, 0x10,       // 0x0232 : LDA $10
+    0x85, 0x14,       // 0x0234 : STA $14
+    0xA5, 0x11,       // 0x0236 : LDA $11
+    0x85, 0x15,       // 0x0238 : STA $15
+    0xA9, 0x00,       // 0x023A : LDA #$00
+    0x85, 0x18,       // 0x023C : STA $18
+    0x85, 0x19,       // 0x023E : STA $19
+    0xA2, 0x10,       // 0x0240 : LDX #$10
+    0x46, 0x15,       // 0x0242 : LSR $15
+    0x66, 0x14,       // 0x0244 : ROR $14
+    0x90, 0x0D,       // 0x0246 : BCC $0255
+    0x18,             // 0x0248 : CLC
+    0xA5, 0x18,       // 0x0249 : LDA $18
+    0x65, 0x12,       // 0x024B : ADC $12
+    0x85, 0x18,       // 0x024D : STA $18
+    0xA5, 0x19,       // 0x024F : LDA $19
+    0x65, 0x13,       // 0x0251 : ADC $13
+    0x85, 0x19,       // 0x0253 : STA $19
+    0x66, 0x19,       // 0x0255 : ROR $19
+    0x66, 0x18,       // 0x0257 : ROR $18
+    0x66, 0x17,       // 0x0259 : ROR $17
+    0x66, 0x16,       // 0x025B : ROR $16
+    0xCA,             // 0x025D : DEX
+    0xD0, 0xE2,       // 0x025E : BNE $0242
+    0xA5, 0x1E,       // 0x0260 : LDA $1E
+    0x45, 0x16,       // 0x0262 : EOR $16
+    0x45, 0x17,       // 0x0264 : EOR $17
+    0x45, 0x18,       // 0x0266 : EOR $18
+    0x45, 0x19,       // 0x0268 : EOR $19
+    0x85, 0x1E,       // 0x026A : STA $1E
+    0xA9, 0x00,       // 0x026C : LDA #$00
+    0x85, 0x1A,       // 0x026E : STA $1A
+    0x85, 0x1B,       // 0x0270 : STA $1B
+    0xA2, 0x20,       // 0x0272 : LDX #$20
+    0x06, 0x16,       // 0x0274 : ASL $16
+    0x26, 0x17,       // 0x0276 : ROL $17
+    0x26, 0x18,       // 0x0278 : ROL $18
+    0x26, 0x19,       // 0x027A : ROL $19
+    0x26, 0x1A,       // 0x027C : ROL $1A
+    0x26, 0x1B,       // 0x027E : ROL $1B
+    0x38,             // 0x0280 : SEC
+    0xA5, 0x1A,       // 0x0281 : LDA $1A
+    0xE5, 0x12,       // 0x0283 : SBC $12
+    0xA8,             // 0x0285 : TAY
+    0xA5, 0x1B,       // 0x0286 : LDA $1B
+    0xE5, 0x13,       // 0x0288 : SBC $13
+    0x90, 0x06,       // 0x028A : BCC $0292
+    0x85, 0x1B,       // 0x028C : STA $1B
+    0x84, 0x1A,       // 0x028E : STY $1A
+    0xE6, 0x16,       // 0x0290 : INC $16
+    0xCA,             // 0x0292 : DEX
+    0xD0, 0xDF,       // 0x0293 : BNE $0274
+    0xA5, 0x16,       // 0x0295 : LDA $16
+    0xC5, 0x10,       // 0x0297 : CMP $10
+    0xD0, 0x10,       // 0x0299 : BNE $02AB
+    0xA5, 0x17,       // 0x029B : LDA $17
+    0xC5, 0x11,       // 0x029D : CMP $11
+    0xD0, 0x0A,       // 0x029F : BNE $02AB
+    0xA5, 0x18,       // 0x02A1 : LDA $18
+    0x05, 0x19,       // 0x02A3 : ORA $19
+    0x05, 0x1A,       // 0x02A5 : ORA $1A
+    0x05, 0x1B,       // 0x02A7 : ORA $1B
+    0xF0, 0x02,       // 0x02A9 : BEQ $02AD
+    0xE6, 0x1D,       // 0x02AB : INC $1D
+    0xC6, 0x1C,       // 0x02AD : DEC $1C
+    0xF0, 0x03,       // 0x02AF : BEQ $02B4
+    0x4C, 0x14, 0x02, // 0x02B1 : JMP $0214
+    0x4C, 0x0A, 0x02, // 0x02B4 : JMP $020A
+};
+
+// 16 KB copied from $4000 to $8000 a page at a time through zero page pointers
+// the source is filled with page XOR offset once
+static const u8 workload_memcpy[] = {
+    0x00, 0x02,       // load address : 0x0200
+    0xA9, 0x00,       // 0x0200 : LDA #$00
+    0x85, 0x10,       // 0x0202 : STA $10
+    0xA9, 0x40,       // 0x0204 : LDA #$40
+    0x85, 0x11,       // 0x0206 : STA $11
+    0xA0, 0x00,       // 0x0208 : LDY #$00
+    0x98,             // 0x020A : TYA
+    0x45, 0x11,       // 0x020B : EOR $11
+    0x91, 0x10,       // 0x020D : STA ($10),Y
+    0xC8,             // 0x020F : INY
+    0xD0, 0xF8,       // 0x0210 : BNE $020A
+    0xE6, 0x11,       // 0x0212 : INC $11
+    0xA5, 0x11,       // 0x0214 : LDA $11
+    0xC9, 0x80,       // 0x0216 : CMP #$80
+    0xD0, 0xF0,       // 0x0218 : BNE $020A
+    0xA9, 0x00,       // 0x021A : LDA #$00
+    0x85, 0x10,       // 0x021C : STA $10
+    0x85, 0x12,       // 0x021E : STA $12
+    0xA9, 0x40,       // 0x0220 : LDA #$40
+    0x85, 0x11,       // 0x0222 : STA $11
+    0xA9, 0x80,       // 0x0224 : LDA #$80
+    0x85, 0x13,       // 0x0226 : STA $13
+    0xA2, 0x40,       // 0x0228 : LDX #$40
+    0xA0, 0x00,       // 0x022A : LDY #$00
+    0xB1, 0x10,       // 0x022C : LDA ($10),Y
+    0x91, 0x12,       // 0x022E : STA ($12),Y
+    0xC8,             // 0x0230 : INY
+    0xD0, 0xF9,       // 0x0231 : BNE $022C
+    0xE6, 0x11,       // 0x0233 : INC $11
+    0xE6, 0x13,       // 0x0235 : INC $13
+    0xCA,             // 0x0237 : DEX
+    0xD0, 0xF2,       // 0x0238 : BNE $022C
+    0x4C, 0x1A, 0x02, // 0x023A : JMP $021A
+};
+
+// Bubble sort of 128 bytes at $3000 through a zero page pointer, filled from
+// an 8 bit LFSR at the start of each pass
+static const u8 workload_bubble_sort[] = {
+    0x00, 0x02,       // load address : 0x0200
+    0xA9, 0x00,       // 0x0200 : LDA #$00
+    0x85, 0x10,       // 0x0202 : STA $10
+    0xA9, 0x30,       // 0x0204 : LDA #$30
+    0x85, 0x11,       // 0x0206 : STA $11
+    0xA9, 0x01,       // 0x0208 : LDA #$01
+    0xA0, 0x00,       // 0x020A : LDY #$00
+    0x0A,             // 0x020C : ASL A
+    0x90, 0x02,       // 0x020D : BCC $0211
+    0x49, 0x1D,       // 0x020F : EOR #$1D
+    0x91, 0x10,       // 0x0211 : STA ($10),Y
+    0xC8,             // 0x0213 : INY
+    0xC0, 0x80,       // 0x0214 : CPY #$80
+    0xD0, 0xF4,       // 0x0216 : BNE $020C
+    0xA9, 0x00,       // 0x0218 : LDA #$00
+    0x85, 0x12,       // 0x021A : STA $12
+    0xA8,             // 0x021C : TAY
+    0xB1, 0x10,       // 0x021D : LDA ($10),Y
+    0xC8,             // 0x021F : INY
+    0xD1, 0x10,       // 0x0220 : CMP ($10),Y
+    0x90, 0x0E,       // 0x0222 : BCC $0232
+    0xF0, 0x0C,       // 0x0224 : BEQ $0232
+    0xAA,             // 0x0226 : TAX
+    0xB1, 0x10,       // 0x0227 : LDA ($10),Y
+    0x88,             // 0x0229 : DEY
+    0x91, 0x10,       // 0x022A : STA ($10),Y
+    0xC8,             // 0x022C : INY
+    0x8A,             // 0x022D : TXA
+    0x91, 0x10,       // 0x022E : STA ($10),Y
+    0x85, 0x12,       // 0x0230 : STA $12
+    0xC0, 0x7F,       // 0x0232 : CPY #$7F
+    0xD0, 0xE7,       // 0x0234 : BNE $021D
+    0xA5, 0x12,       // 0x0236 : LDA $12
+    0xD0, 0xDE,       // 0x0238 : BNE $0218
+    0x4C, 0x00, 0x02, // 0x023A : JMP $0200
+};
+
+// Recursive quicksort (Lomuto partition) of 255 bytes at $3000 through a zero
+// page pointer, filled from the same LFSR, sorted they are 1 to 255
+static const u8 workload_quicksort[] = {
+    0x00, 0x02,       // load address : 0x0200
+    0xA2, 0xFF,       // 0x0200 : LDX #$FF
+    0x9A,             // 0x0202 : TXS
+    0xA9, 0x00,       // 0x0203 : LDA #$00
+    0x85, 0x10,       // 0x0205 : STA $10
+    0xA9, 0x30,       // 0x0207 : LDA #$30
+    0x85, 0x11,       // 0x0209 : STA $11
+    0xA9, 0x01,       // 0x020B : LDA #$01
+    0xA0, 0x00,       // 0x020D : LDY #$00
+    0x0A,             // 0x020F : ASL A
+    0x90, 0x02,       // 0x0210 : BCC $0214
+    0x49, 0x1D,       // 0x0212 : EOR #$1D
+    0x91, 0x10,       // 0x0214 : STA ($10),Y
+    0xC8,             // 0x0216 : INY
+    0xC0, 0xFF,       // 0x0217 : CPY #$FF
+    0xD0, 0xF4,       // 0x0219 : BNE $020F
+    0xA9, 0x00,       // 0x021B : LDA #$00
+    0x85, 0x12,       // 0x021D : STA $12
+    0xA9, 0xFE,       // 0x021F : LDA #$FE
+    0x85, 0x13,       // 0x0221 : STA $13
+    0x20, 0x29, 0x02, // 0x0223 : JSR $0229
+    0x4C, 0x03, 0x02, // 0x0226 : JMP $0203
+    0xA5, 0x12,       // 0x0229 : LDA $12
+    0xC5, 0x13,       // 0x022B : CMP $13
+    0xB0, 0x64,       // 0x022D : BCS $0293
+    0xA4, 0x13,       // 0x022F : LDY $13
+    0xB1, 0x10,       // 0x0231 : LDA ($10),Y
+    0x85, 0x16,       // 0x0233 : STA $16
+    0xA5, 0x12,       // 0x0235 : LDA $12
+    0x85, 0x14,       // 0x0237 : STA $14
+    0x85, 0x15,       // 0x0239 : STA $15
+    0xA4, 0x15,       // 0x023B : LDY $15
+    0xC4, 0x13,       // 0x023D : CPY $13
+    0xF0, 0x1B,       // 0x023F : BEQ $025C
+    0xB1, 0x10,       // 0x0241 : LDA ($10),Y
+    0xC5, 0x16,       // 0x0243 : CMP $16
+    0xB0, 0x10,       // 0x0245 : BCS $0257
+    0xAA,             // 0x0247 : TAX
+    0xA4, 0x14,       // 0x0248 : LDY $14
+    0xB1, 0x10,       // 0x024A : LDA ($10),Y
+    0xA4, 0x15,       // 0x024C : LDY $15
+    0x91, 0x10,       // 0x024E : STA ($10),Y
+    0x8A,             // 0x0250 : TXA
+    0xA4, 0x14,       // 0x0251 : LDY $14
+    0x91, 0x10,       // 0x0253 : STA ($10),Y
+    0xE6, 0x14,       // 0x0255 : INC $14
+    0xE6, 0x15,       // 0x0257 : INC $15
+    0x4C, 0x3B, 0x02, // 0x0259 : JMP $023B
+    0xA4, 0x14,       // 0x025C : LDY $14
+    0xB1, 0x10,       // 0x025E : LDA ($10),Y
+    0xAA,             // 0x0260 : TAX
+    0xA4, 0x13,       // 0x0261 : LDY $13
+    0xB1, 0x10,       // 0x0263 : LDA ($10),Y
+    0xA4, 0x14,       // 0x0265 : LDY $14
+    0x91, 0x10,       // 0x0267 : STA ($10),Y
+    0x8A,             // 0x0269 : TXA
+    0xA4, 0x13,       // 0x026A : LDY $13
+    0x91, 0x10,       // 0x026C : STA ($10),Y
+    0xA5, 0x14,       // 0x026E : LDA $14
+    0xC5, 0x12,       // 0x0270 : CMP $12
+    0xF0, 0x13,       // 0x0272 : BEQ $0287
+    0xA5, 0x13,       // 0x0274 : LDA $13
+    0x48,             // 0x0276 : PHA
+    0xA5, 0x14,       // 0x0277 : LDA $14
+    0x48,             // 0x0279 : PHA
+    0xAA,             // 0x027A : TAX
+    0xCA,             // 0x027B : DEX
+    0x86, 0x13,       // 0x027C : STX $13
+    0x20, 0x29, 0x02, // 0x027E : JSR $0229
+    0x68,             // 0x0281 : PLA
+    0x85, 0x14,       // 0x0282 : STA $14
+    0x68,             // 0x0284 : PLA
+    0x85, 0x13,       // 0x0285 : STA $13
+    0xA6, 0x14,       // 0x0287 : LDX $14
+    0xE4, 0x13,       // 0x0289 : CPX $13
+    0xF0, 0x06,       // 0x028B : BEQ $0293
+    0xE8,             // 0x028D : INX
+    0x86, 0x12,       // 0x028E : STX $12
+    0x4C, 0x29, 0x02, // 0x0290 : JMP $0229
+    0x60,             // 0x0293 : RTS
+};
+
+// Bitwise CRC-32 (polynomial $EDB88320) of the 1 KB at $0200, the program itself
+// crc : $10-$13
+static const u8 workload_crc32[] = {
+    0x00, 0x02,       // load address : 0x0200
+    0xA9, 0xFF,       // 0x0200 : LDA #$FF
+    0x85, 0x10,       // 0x0202 : STA $10
+    0x85, 0x11,       // 0x0204 : STA $11
+    0x85, 0x12,       // 0x0206 : STA $12
+    0x85, 0x13,       // 0x0208 : STA $13
+    0xA9, 0x00,       // 0x020A : LDA #$00
+    0x85, 0x14,       // 0x020C : STA $14
+    0xA9, 0x02,       // 0x020E : LDA #$02
+    0x85, 0x15,       // 0x0210 : STA $15
+    0xA9, 0x04,       // 0x0212 : LDA #$04
+    0x85, 0x16,       // 0x0214 : STA $16
+    0xA0, 0x00,       // 0x0216 : LDY #$00
+    0xB1, 0x14,       // 0x0218 : LDA ($14),Y
+    0x45, 0x10,       // 0x021A : EOR $10
+    0x85, 0x10,       // 0x021C : STA $10
+    0xA2, 0x08,       // 0x021E : LDX #$08
+    0x46, 0x13,       // 0x0220 : LSR $13
+    0x66, 0x12,       // 0x0222 : ROR $12
+    0x66, 0x11,       // 0x0224 : ROR $11
+    0x66, 0x10,       // 0x0226 : ROR $10
+    0x90, 0x18,       // 0x0228 : BCC $0242
+    0xA5, 0x13,       // 0x022A : LDA $13
+    0x49, 0xED,       // 0x022C : EOR #$ED
+    0x85, 0x13,       // 0x022E : STA $13
+    0xA5, 0x12,       // 0x0230 : LDA $12
+    0x49, 0xB8,       // 0x0232 : EOR #$B8
+    0x85, 0x12,       // 0x0234 : STA $12
+    0xA5, 0x11,       // 0x0236 : LDA $11
+    0x49, 0x83,       // 0x0238 : EOR #$83
+    0x85, 0x11,       // 0x023A : STA $11
+    0xA5, 0x10,       // 0x023C : LDA $10
+    0x49, 0x20,       // 0x023E : EOR #$20
+    0x85, 0x10,       // 0x0240 : STA $10
+    0xCA,             // 0x0242 : DEX
+    0xD0, 0xDB,       // 0x0243 : BNE $0220
+    0xC8,             // 0x0245 : INY
+    0xD0, 0xD0,       // 0x0246 : BNE $0218
+    0xE6, 0x15,       // 0x0248 : INC $15
+    0xC6, 0x16,       // 0x024A : DEC $16
+    0xD0, 0xCA,       // 0x024C : BNE $0218
+    0xA2, 0x03,       // 0x024E : LDX #$03
+    0xB5, 0x10,       // 0x0250 : LDA $10,X
+    0x49, 0xFF,       // 0x0252 : EOR #$FF
+    0x95, 0x10,       // 0x0254 : STA $10,X
+    0xCA,             // 0x0256 : DEX
+    0x10, 0xF7,       // 0x0257 : BPL $0250
+    0x4C, 0x00, 0x02, // 0x0259 : JMP $0200
+};
+
+// Decimal mode counter, 12345 increments of a 6 digit BCD number
+// counter : $10-$12 = 01 23 45
+static const u8 workload_bcd_counter[] = {
+    0x00, 0x02,       // load address : 0x0200
+    0xA9, 0x00,       // 0x0200 : LDA #$00
+    0x85, 0x10,       // 0x0202 : STA $10
+    0x85, 0x11,       // 0x0204 : STA $11
+    0x85, 0x12,       // 0x0206 : STA $12
+    0xA9, 0x39,       // 0x0208 : LDA #$39
+    0x85, 0x13,       // 0x020A : STA $13
+    0xA9, 0x30,       // 0x020C : LDA #$30
+    0x85, 0x14,       // 0x020E : STA $14
+    0xF8,             // 0x0210 : SED
+    0x18,             // 0x0211 : CLC
+    0xA5, 0x10,       // 0x0212 : LDA $10
+    0x69, 0x01,       // 0x0214 : ADC #$01
+    0x85, 0x10,       // 0x0216 : STA $10
+    0xA5, 0x11,       // 0x0218 : LDA $11
+    0x69, 0x00,       // 0x021A : ADC #$00
+    0x85, 0x11,       // 0x021C : STA $11
+    0xA5, 0x12,       // 0x021E : LDA $12
+    0x69, 0x00,       // 0x0220 : ADC #$00
+    0x85, 0x12,       // 0x0222 : STA $12
+    0xA5, 0x13,       // 0x0224 : LDA $13
+    0xD0, 0x02,       // 0x0226 : BNE $022A
+    0xC6, 0x14,       // 0x0228 : DEC $14
+    0xC6, 0x13,       // 0x022A : DEC $13
+    0xD0, 0xE3,       // 0x022C : BNE $0211
+    0xA5, 0x14,       // 0x022E : LDA $14
+    0xD0, 0xDF,       // 0x0230 : BNE $0211
+    0xD8,             // 0x0232 : CLD
+    0x4C, 0x00, 0x02, // 0x0233 : JMP $0200
+};
+
+
+static const Workload workloads[] = {
+    {"sieve", workload_sieve, sizeof(workload_sieve), 0x026B, 0x0013, 2, {0x04, 0x04}},
+    {"multiply", workload_multiply, sizeof(workload_multiply), 0x02B4, 0x001D, 2, {0x00, 0x04}},
+    {"memcpy", workload_memcpy, sizeof(workload_memcpy), 0x023A, 0xBFFC, 4, {0x83, 0x82, 0x81, 0x80}},
+    {"bubble_sort", workload_bubble_sort, sizeof(workload_bubble_sort), 0x023A, 0x307C, 4, {0xF0, 0xF8, 0xFD, 0xFE}},
+    {"quicksort", workload_quicksort, sizeof(workload_quicksort), 0x0226, 0x30FB, 4, {0xFC, 0xFD, 0xFE, 0xFF}},
+    {"crc32", workload_crc32, sizeof(workload_crc32), 0x0259, 0x0010, 4, {0xC0, 0xEE, 0xCB, 0x3C}},
+    {"bcd_counter", workload_bcd_counter, sizeof(workload_bcd_counter), 0x0233, 0x0010, 3, {0x45, 0x23, 0x01}},
+};
+
+#define WORKLOAD_COUNT (sizeof(workloads) / sizeof(workloads[0]))
+
+#endif // __WORKLOADS_H__
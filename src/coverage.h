@@ -0,0 +1,209 @@
+#ifndef __COVERAGE_H__
+#define __COVERAGE_H__
+
+// AFL style edge coverage
+// Included by h6502.h when H6502_EDGE_COVERAGE is 1.
+//
+// Every change of control flow (branches, JMP, JSR, RTS, BRK and RTI) adds a
+// hit to a 64 KB map at hash(previous location, new PC), the same map and
+// hashing AFL's QEMU mode uses. Both outcomes of a branch are edges, a branch
+// not taken goes to the next instruction.
+//
+// Under afl-fuzz the map is AFL's shared memory ("__AFL_SHM_ID") and
+// Coverage_AFL_Loop() runs the fork server in persistent mode:
+//
+//  Coverage_Attach_AFL();
+//  while (Coverage_AFL_Loop(10000))
+//  {
+//      ... restore the machine, load the input, Execute() ...
+//  }
+//
+// Outside afl-fuzz the map is a local array and the loop runs once.
+// > https://github.com/AFLplusplus/AFLplusplus/blob/stable/instrumentation/README.persistent_mode.md
+
+#if !defined(_WIN32)
+#include <signal.h>
+#include <sys/shm.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#define COVERAGE_MAP_SIZE   (1u << 16) // AFL's MAP_SIZE
+#define COVERAGE_SHM_ENV    "__AFL_SHM_ID"
+#define COVERAGE_FORKSRV_FD 198 // commands from afl-fuzz, answers go to 199
+#define COVERAGE_PERSISTENT "##SIG_AFL_PERSISTENT##"
+
+typedef struct Coverage
+{
+    uint8_t *map;      // AFL's shared memory or coverage_local_map
+    u16      previous; // previous location >> 1
+    bool     shared;
+    bool     persistent;
+    bool     fork_server;
+} Coverage;
+
+static uint8_t  coverage_local_map[COVERAGE_MAP_SIZE] = {0};
+static Coverage coverage                              = {.map = coverage_local_map};
+
+// Control flow went to 'target'. The counter skips 0 when it wraps, so an
+// edge hit 256 times is not lost (AFL++'s "NeverZero").
+static inline void Coverage_Edge(u16 target)
+{
+    const u16 location = ((target >> 4) ^ (target << 8)) & (COVERAGE_MAP_SIZE - 1);
+    uint8_t  *counter  = &coverage.map[location ^ coverage.previous];
+    *counter += 1;
+    *counter += (*counter == 0);
+    coverage.previous = location >> 1;
+}
+
+#define H6502_COVERAGE_EDGE(target) Coverage_Edge(target)
+
+// Start of a new input, the first edge has no previous location
+static inline void Coverage_Start_Input(void)
+{
+    coverage.previous = 0;
+}
+
+static inline void Coverage_Clear(void)
+{
+    memset(coverage.map, 0, COVERAGE_MAP_SIZE);
+    coverage.previous = 0;
+}
+
+// Number of edges hit at least once
+static inline u32 Coverage_Count_Edges(void)
+{
+    u32 edges = 0;
+    for (u32 index = 0; index < COVERAGE_MAP_SIZE; index++)
+        edges += (coverage.map[index] != 0);
+    return edges;
+}
+
+// Use AFL's shared memory map when run by afl-fuzz, returns false (and keeps
+// the local map) otherwise
+static inline bool Coverage_Attach_AFL(void)
+{
+#if !defined(_WIN32)
+    const char *id = getenv(COVERAGE_SHM_ENV);
+    if (id == NULL || coverage.shared)
+        return coverage.shared;
+
+    void *map = shmat(atoi(id), NULL, 0);
+    if (map == (void *)-1)
+    {
+        fprintf(stderr, "Error attaching AFL shared memory : %s\n", id);
+        return false;
+    }
+
+    coverage.map        = map;
+    coverage.shared     = true;
+    coverage.persistent = getenv("__AFL_PERSISTENT") != NULL;
+    coverage.map[0]     = 1; // tells afl-fuzz the target is instrumented
+    return true;
+#else
+    return false;
+#endif
+}
+
+#if !defined(_WIN32)
+// AFL's fork server. The parent stays in here answering afl-fuzz, each child
+// returns and runs inputs. In persistent mode a child stops itself after an
+// input (SIGSTOP) and is continued for the next one instead of forking again.
+static inline void Coverage_Start_Fork_Server(void)
+{
+    uint8_t hello[4] = {0};
+    if (write(COVERAGE_FORKSRV_FD + 1, hello, 4) != 4)
+        return; // not run by afl-fuzz
+
+    coverage.fork_server = true;
+    pid_t child          = -1;
+    bool  child_stopped  = false;
+    while (true)
+    {
+        uint32_t was_killed;
+        int      status;
+        if (read(COVERAGE_FORKSRV_FD, &was_killed, 4) != 4)
+            _exit(1);
+
+        // afl-fuzz timed out and killed the stopped child
+        if (child_stopped && was_killed)
+        {
+            child_stopped = false;
+            if (waitpid(child, &status, 0) < 0)
+                _exit(1);
+        }
+
+        if (!child_stopped)
+        {
+            child = fork();
+            if (child < 0)
+                _exit(1);
+            if (child == 0)
+            {
+                close(COVERAGE_FORKSRV_FD);
+                close(COVERAGE_FORKSRV_FD + 1);
+                return;
+            }
+        }
+        else
+        {
+            kill(child, SIGCONT);
+            child_stopped = false;
+        }
+
+        if (write(COVERAGE_FORKSRV_FD + 1, &child, 4) != 4)
+            _exit(1);
+        if (waitpid(child, &status, coverage.persistent ? WUNTRACED : 0) < 0)
+            _exit(1);
+        if (WIFSTOPPED(status))
+            child_stopped = true;
+        if (write(COVERAGE_FORKSRV_FD + 1, &status, 4) != 4)
+            _exit(1);
+    }
+}
+#endif
+
+// True while there is another input to run, like AFL's __AFL_LOOP(). A
+// persistent child runs up to 'max_runs' inputs before afl-fuzz forks a new one.
+static inline bool Coverage_AFL_Loop(u32 max_runs)
+{
+    // afl-fuzz looks for this string to turn on persistent mode
+    static volatile const char signature[] = COVERAGE_PERSISTENT;
+    static bool                first_run   = true;
+    static u32                 runs_left   = 0;
+
+    if (first_run)
+    {
+        (void)signature[0];
+        first_run = false;
+        runs_left = max_runs;
+#if !defined(_WIN32)
+        if (coverage.shared)
+            Coverage_Start_Fork_Server();
+#endif
+        if (coverage.persistent)
+        {
+            Coverage_Clear();
+            coverage.map[0] = 1;
+        }
+        Coverage_Start_Input();
+        return true;
+    }
+
+#if !defined(_WIN32)
+    if (coverage.persistent && coverage.fork_server && --runs_left > 0)
+    {
+        raise(SIGSTOP);
+        coverage.map[0] = 1;
+        Coverage_Start_Input();
+        return true;
+    }
+
+    // anything run after the loop must not show up in the last input's map
+    if (coverage.persistent)
+        coverage.map = coverage_local_map;
+#endif
+    return false;
+}
+
+#endif // __COVERAGE_H__
@@ -0,0 +1,109 @@
+#ifndef __FUZZ_H__
+#define __FUZZ_H__
+
+// In-process persistent fuzzing
+// Needs H6502_SNAPSHOT=1, add H6502_EDGE_COVERAGE=1 for coverage guided fuzzers.
+//
+// The ROM is loaded once and the machine is saved as the baseline snapshot.
+// Every input then:
+//  - goes back to the baseline, copying only the pages the last run wrote
+//  - is copied to the input region, longer inputs are cut to its size
+//  - gets its length in A (low byte) and X (high byte)
+//  - runs from the entry PC until the exit PC, the crash PC, an opcode the
+//    variant does not handle or the cycle limit
+//
+// An unhandled opcode or reaching the crash PC is a crash, running out of
+// cycles is a hang. No process is started per input, see tools/fuzz.c for the
+// libFuzzer entry point and the AFL / corpus driver.
+
+#include "h6502.h"
+
+#if !H6502_SNAPSHOT
+#error "fuzz.h needs H6502_SNAPSHOT=1"
+#endif
+
+#define FUZZ_DEFAULT_MAX_CYCLES 100000
+
+typedef struct Fuzz_Config
+{
+    u16  input_address;  // where each input is copied
+    u32  input_size;     // longest input, up to the end of memory
+    u16  entry_pc;       // PC at the start of every run
+    u16  exit_pc;        // a run that gets here ended normally
+    u16  crash_pc;       // a run that gets here crashed, when check_crash_pc
+    bool check_crash_pc;
+    s32  max_cycles;     // 0 = FUZZ_DEFAULT_MAX_CYCLES
+} Fuzz_Config;
+
+typedef enum
+{
+    FUZZ_OK = 0,
+    FUZZ_CRASH,
+    FUZZ_HANG,
+} Fuzz_Outcome;
+
+static struct
+{
+    Fuzz_Config     config;
+    Stop_Conditions stop;
+    Snapshot        baseline;
+    uint64_t        runs;
+} fuzz = {0};
+
+// Load 'rom' (Load_Program() format) and save the baseline every input starts from
+static inline void Fuzz_Setup(const Fuzz_Config *config, const u8 *rom, int rom_size)
+{
+    fuzz.config = *config;
+    if (fuzz.config.input_size > MAX_MEM - fuzz.config.input_address)
+        fuzz.config.input_size = MAX_MEM - fuzz.config.input_address;
+    if (fuzz.config.max_cycles <= 0)
+        fuzz.config.max_cycles = FUZZ_DEFAULT_MAX_CYCLES;
+
+    memset(&fuzz.stop, 0, sizeof(fuzz.stop));
+    Stop_At_PC(&fuzz.stop, fuzz.config.exit_pc);
+    if (fuzz.config.check_crash_pc)
+        Stop_At_PC(&fuzz.stop, fuzz.config.crash_pc);
+    fuzz.stop.max_cycles = fuzz.config.max_cycles;
+
+    Initialise_Memory();
+    Reset_CPU();
+    Load_Program(rom, rom_size);
+    cpu.program_counter = fuzz.config.entry_pc;
+
+    Snapshot_Take(&fuzz.baseline);
+    fuzz.runs = 0;
+}
+
+static inline Execute_Result Fuzz_Run(const uint8_t *data, size_t size)
+{
+    Snapshot_Restore_Dirty(&fuzz.baseline);
+
+    const u32 length = (size < fuzz.config.input_size) ? (u32)size : fuzz.config.input_size;
+    if (length > 0)
+    {
+        memcpy(&mem.data[fuzz.config.input_address], data, length);
+        Snapshot_Mark_Dirty(fuzz.config.input_address, length);
+    }
+    cpu.accumulator = length & 0xFF;
+    cpu.index_reg_X = (length >> 8) & 0xFF;
+
+#if H6502_EDGE_COVERAGE
+    Coverage_Start_Input();
+#endif
+    fuzz.runs++;
+    return Execute_Until(&fuzz.stop);
+}
+
+// Valid until the next run, the machine is left as the run ended
+static inline Fuzz_Outcome Fuzz_Check(const Execute_Result *result)
+{
+    if (result->reason == STOP_BAD_INSTRUCTION)
+        return FUZZ_CRASH;
+    if (result->reason == STOP_PC && fuzz.config.check_crash_pc && cpu.program_counter == fuzz.config.crash_pc)
+        return FUZZ_CRASH;
+    if (result->reason == STOP_MAX_CYCLES)
+        return FUZZ_HANG;
+    return FUZZ_OK;
+}
+
+#endif // __FUZZ_H__
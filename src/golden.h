@@ -0,0 +1,618 @@
+#ifndef __GOLDEN_H__
+#define __GOLDEN_H__
+
+// Exhaustive golden tables of instruction results
+//
+// Every opcode the variant has is run from each combination of an operand
+// value (256), an input register value (256) and the C, D and V flags (8),
+// 524288 cases, and what it leaves is recorded: A, X, Y, S, P, the byte it
+// read or wrote, the PC and the cycles. The table made with one engine then
+// checks another, or the same one after a change.
+//
+//  Golden_Opcode entry;
+//  uint8_t      *data = Golden_Build_Opcode(Execute, 0x69, &entry);
+//  ...
+//  Golden_Result result = Golden_Verify_Opcode(Execute_Dispatch_Table, 0x69, &entry, data, false);
+//
+// A case runs one instruction at 0x0200, set up the same way each time:
+//  - the operand value is the immediate or branch offset, else the byte at
+//    the effective address, else the byte the stack pulls (0x01FE up)
+//  - the input register is X for CPX, DEX, INX, STX, TXA, TXS and PHX, Y for
+//    the Y versions, A for the rest. The other two are 0x5A (A), 0x13 (X)
+//    and 0x27 (Y), S is 0xFD
+//  - P is I and the unused bit, C, D and V from the case, N and Z as a load
+//    of the input register would leave them
+//  - zero page operands are 0x40, absolute ones 0x3450, pointers point to
+//    0x3456 and jumps go to 0x0300
+//
+// Tables are kept small by dropping what an opcode does not depend on. Each
+// bit of A, X, Y, S, P and the byte is stored as it is or XORed with its
+// input, whichever depends on fewer inputs (so a flag an instruction leaves
+// alone costs nothing). An input nothing depends on is not enumerated, a
+// field that is the same in every case is stored once. INX is 256 records of
+// X and P, ADC #imm is 256 x 256 x C x D records of A and P. The PC is stored
+// past the end of the instruction and the cycles past Opcode_Cycles(), so the
+// address modes of a mnemonic mostly store the same records, which the file
+// keeps once.
+//
+// File, all numbers little endian
+//  header  : "H6502GLD" | u8 version | u8 variant | 6 x u8 0
+//  entries : 256 x 40 bytes, see Golden_Put_Entry()
+//  data    : the records of each opcode, at its offset
+
+#include "h6502.h"
+
+#define GOLDEN_MAGIC        "H6502GLD"
+#define GOLDEN_VERSION      1
+#define GOLDEN_HEADER_SIZE  16
+#define GOLDEN_ENTRY_SIZE   40
+#define GOLDEN_CASES        (1u << 19) // operand, register, C, D, V
+#define GOLDEN_FIELDS       9
+#define GOLDEN_INPUT_FIELDS 6 // fields that have an input to XOR with
+#define GOLDEN_DIMENSIONS   5
+#define GOLDEN_BLOCK        4096 // records run before a compare
+#define GOLDEN_START        0x0200
+#define GOLDEN_STACK        0xFD
+
+// Case bits
+#define GOLDEN_OPERAND(c)  ((c) & 0xFF)
+#define GOLDEN_REGISTER(c) (((c) >> 8) & 0xFF)
+#define GOLDEN_C(c)        (((c) >> 16) & 1)
+#define GOLDEN_D(c)        (((c) >> 17) & 1)
+#define GOLDEN_V(c)        (((c) >> 18) & 1)
+
+typedef enum
+{
+    GOLDEN_A = 0,
+    GOLDEN_X,
+    GOLDEN_Y,
+    GOLDEN_S,
+    GOLDEN_P,
+    GOLDEN_M, // the byte at the effective address, or the top of the stack
+    GOLDEN_PC_LOW,
+    GOLDEN_PC_HIGH,
+    GOLDEN_CYCLES,
+} Golden_Field;
+
+static const char *const golden_field_names[GOLDEN_FIELDS] = {"A", "X", "Y", "S", "P", "M", "PC low", "PC high", "cycles"};
+
+// Case bits of each input
+static const u32 golden_dimension_bits[GOLDEN_DIMENSIONS] = {0x000FF, 0x0FF00, 0x10000, 0x20000, 0x40000};
+
+typedef struct Golden_Opcode
+{
+    bool     present;
+    u8       input_register;          // GOLDEN_A, GOLDEN_X or GOLDEN_Y
+    u32      cases;                   // case bits that are enumerated
+    u32      fields;                  // fields that are stored, one bit each
+    u32      record_size;             // bytes
+    u32      records;
+    u8       xor_mask[GOLDEN_FIELDS]; // bits stored XORed with their input
+    u8       constant[GOLDEN_FIELDS]; // fields that are not stored
+    uint64_t offset;                  // of the records in the file's data
+} Golden_Opcode;
+
+typedef struct Golden_Result
+{
+    u32  checked;
+    u32  failed;
+    char failure[160]; // the first
+} Golden_Result;
+
+static inline u8 Golden_Input_Register(u8 opcode)
+{
+    static const char *const x[] = {"CPX", "DEX", "INX", "STX", "TXA", "TXS", "PHX"};
+    static const char *const y[] = {"CPY", "DEY", "INY", "STY", "TYA", "PHY"};
+
+    const char *mnemonic = Opcode_Mnemonic(opcode);
+    for (u32 i = 0; mnemonic != NULL && i < sizeof(x) / sizeof(x[0]); i++)
+    {
+        if (strcmp(mnemonic, x[i]) == 0)
+            return GOLDEN_X;
+    }
+    for (u32 i = 0; mnemonic != NULL && i < sizeof(y) / sizeof(y[0]); i++)
+    {
+        if (strcmp(mnemonic, y[i]) == 0)
+            return GOLDEN_Y;
+    }
+    return GOLDEN_A;
+}
+
+static inline void Golden_Put_Pointer(u16 at, u16 address)
+{
+    mem.data[at & 0xFFFF]       = (u8)(address & 0xFF);
+    mem.data[(at + 1) & 0xFFFF] = (u8)(address >> 8);
+}
+
+// The input a field is XORed with
+static inline u8 Golden_Input(u8 input_register, u32 c, Golden_Field field)
+{
+    const u8 value = (u8)GOLDEN_REGISTER(c);
+    switch (field)
+    {
+    case GOLDEN_A: return (input_register == GOLDEN_A) ? value : 0x5A;
+    case GOLDEN_X: return (input_register == GOLDEN_X) ? value : 0x13;
+    case GOLDEN_Y: return (input_register == GOLDEN_Y) ? value : 0x27;
+    case GOLDEN_S: return GOLDEN_STACK;
+    case GOLDEN_P:
+        return (u8)(unused_FLAG_BIT | INTERUPT_DISABLE_FLAG_BIT | GOLDEN_C(c) | (GOLDEN_D(c) << 3) | (GOLDEN_V(c) << 6) |
+                    ((value == 0) ? 0x02 : 0x00) | (value & NEGATIVE_FLAG_BIT));
+    case GOLDEN_M: return (u8)GOLDEN_OPERAND(c);
+    default: return 0;
+    }
+}
+
+// Sets up 'cpu' and 'mem' for a case, returns where M is read from
+static inline u16 Golden_Set_Up(u8 opcode, u8 input_register, u32 c)
+{
+    const u8 operand    = (u8)GOLDEN_OPERAND(c);
+    cpu.accumulator     = Golden_Input(input_register, c, GOLDEN_A);
+    cpu.index_reg_X     = Golden_Input(input_register, c, GOLDEN_X);
+    cpu.index_reg_Y     = Golden_Input(input_register, c, GOLDEN_Y);
+    cpu.stack_pointer   = GOLDEN_STACK;
+    cpu.PS              = Golden_Input(input_register, c, GOLDEN_P);
+    cpu.program_counter = GOLDEN_START;
+
+    // pulls read the operand, pushes go to 0x01FD down
+    mem.data[0x01FB] = mem.data[0x01FC] = mem.data[0x01FD] = 0x00;
+    mem.data[0x01FE] = mem.data[0x01FF] = mem.data[0x0100] = operand;
+    Golden_Put_Pointer(0xFFFE, 0x0300); // BRK
+
+    // 'address' is where the operand goes, 'operand_bytes' what the instruction has after the opcode
+    u16 address       = 0x01FD;
+    u16 operand_bytes = 0;
+    switch (Opcode_Address_Mode(opcode))
+    {
+    case MODE_IM:
+    case MODE_REL: operand_bytes = operand; break;
+    case MODE_ZP: operand_bytes = address = 0x40; break;
+    case MODE_ZP_X:
+        operand_bytes = 0x40;
+        address       = (0x40 + cpu.index_reg_X) & 0xFF;
+        break;
+    case MODE_ZP_Y:
+        operand_bytes = 0x40;
+        address       = (0x40 + cpu.index_reg_Y) & 0xFF;
+        break;
+    case MODE_ABS: operand_bytes = address = 0x3450; break;
+    case MODE_ABS_X:
+        operand_bytes = 0x3450;
+        address       = 0x3450 + cpu.index_reg_X;
+        break;
+    case MODE_ABS_Y:
+        operand_bytes = 0x3450;
+        address       = 0x3450 + cpu.index_reg_Y;
+        break;
+    case MODE_IND_X:
+        operand_bytes = 0x40;
+        address       = 0x3456;
+        Golden_Put_Pointer((0x40 + cpu.index_reg_X) & 0xFF, address);
+        break;
+    case MODE_IND_Y:
+        operand_bytes = 0x40;
+        Golden_Put_Pointer(0x40, 0x3456);
+        address = 0x3456 + cpu.index_reg_Y;
+        break;
+    case MODE_ZP_IND:
+        operand_bytes = 0x40;
+        address       = 0x3456;
+        Golden_Put_Pointer(0x40, address);
+        break;
+    case MODE_IND:
+        operand_bytes = 0x3400;
+        address       = 0x0300;
+        Golden_Put_Pointer(0x3400, address);
+        break;
+    case MODE_ABS_IND_X:
+        operand_bytes = 0x3400;
+        address       = 0x0300;
+        Golden_Put_Pointer(0x3400 + cpu.index_reg_X, address);
+        break;
+    default: break; // implied and accumulator, the operand is on the stack
+    }
+
+    mem.data[GOLDEN_START]     = opcode;
+    mem.data[GOLDEN_START + 1] = (u8)(operand_bytes & 0xFF);
+    mem.data[GOLDEN_START + 2] = (u8)(operand_bytes >> 8);
+    if (address != 0x01FD)
+        mem.data[address & 0xFFFF] = operand;
+    return (u16)(address & 0xFFFF);
+}
+
+// Runs a case with 'run', the fields as they come out
+static inline void Golden_Run_Case(s32 (*run)(s32), u8 opcode, u8 input_register, u32 c, u8 out[GOLDEN_FIELDS])
+{
+    const u16 address = Golden_Set_Up(opcode, input_register, c);
+    const s32 cycles  = run(1);
+    const u16 next    = (u16)((GOLDEN_START + Opcode_Bytes(opcode)) & 0xFFFF);
+    const u16 pc      = (u16)((cpu.program_counter - next) & 0xFFFF);
+
+    out[GOLDEN_A]       = cpu.accumulator;
+    out[GOLDEN_X]       = cpu.index_reg_X;
+    out[GOLDEN_Y]       = cpu.index_reg_Y;
+    out[GOLDEN_S]       = cpu.stack_pointer;
+    out[GOLDEN_P]       = cpu.PS;
+    out[GOLDEN_M]       = mem.data[address];
+    out[GOLDEN_PC_LOW]  = (u8)(pc & 0xFF);
+    out[GOLDEN_PC_HIGH] = (u8)(pc >> 8);
+    out[GOLDEN_CYCLES]  = (u8)((cycles - Opcode_Cycles(opcode)) & 0xFF);
+}
+
+// The fields of a case as they are stored
+static inline void Golden_Encode(const Golden_Opcode *entry, u32 c, u8 out[GOLDEN_FIELDS])
+{
+    for (u32 field = 0; field < GOLDEN_INPUT_FIELDS; field++)
+        out[field] ^= Golden_Input(entry->input_register, c, (Golden_Field)field) & entry->xor_mask[field];
+}
+
+static inline u32 Golden_Count_Bits(u32 bits)
+{
+    u32 count = 0;
+    for (; bits != 0; bits &= bits - 1)
+        count++;
+    return count;
+}
+
+// Record number of a case, its enumerated bits packed together
+static inline u32 Golden_Record(u32 cases, u32 c)
+{
+    u32 record = 0;
+    u32 bit    = 0;
+    for (u32 mask = cases; mask != 0; mask &= mask - 1, bit++)
+    {
+        if (c & mask & (~mask + 1))
+            record |= 1u << bit;
+    }
+    return record;
+}
+
+// The next case with only enumerated bits, 0 after the last
+static inline u32 Golden_Next_Case(u32 cases, u32 c)
+{
+    return (c - cases) & cases;
+}
+
+// Runs every case of 'opcode' with 'run' and fills 'entry', NULL when there
+// is no memory. The records are malloc()ed
+static inline uint8_t *Golden_Build_Opcode(s32 (*run)(s32), u8 opcode, Golden_Opcode *entry)
+{
+    memset(entry, 0, sizeof(*entry));
+    entry->present        = true;
+    entry->input_register = Golden_Input_Register(opcode);
+
+    u8 *outputs = (u8 *)malloc((size_t)GOLDEN_CASES * GOLDEN_FIELDS);
+    if (outputs == NULL)
+        return NULL;
+    for (u32 c = 0; c < GOLDEN_CASES; c++)
+        Golden_Run_Case(run, opcode, entry->input_register, c, &outputs[(size_t)c * GOLDEN_FIELDS]);
+
+    // bits that change along each input, as they are and XORed with their input
+    u8 raw[GOLDEN_FIELDS][GOLDEN_DIMENSIONS]         = {{0}};
+    u8 xored[GOLDEN_INPUT_FIELDS][GOLDEN_DIMENSIONS] = {{0}};
+    for (u32 dimension = 0; dimension < GOLDEN_DIMENSIONS; dimension++)
+    {
+        const u32 bits = golden_dimension_bits[dimension];
+        for (u32 c = 0; c < GOLDEN_CASES; c++)
+        {
+            const u32 base = c & ~bits;
+            if (base == c)
+                continue;
+            const u8 *out   = &outputs[(size_t)c * GOLDEN_FIELDS];
+            const u8 *other = &outputs[(size_t)base * GOLDEN_FIELDS];
+            for (u32 field = 0; field < GOLDEN_FIELDS; field++)
+            {
+                const u8 change = out[field] ^ other[field];
+                raw[field][dimension] |= change;
+                if (field < GOLDEN_INPUT_FIELDS)
+                    xored[field][dimension] |= change ^ Golden_Input(entry->input_register, c, (Golden_Field)field) ^
+                                               Golden_Input(entry->input_register, base, (Golden_Field)field);
+            }
+        }
+    }
+
+    // each bit the way that depends on fewer inputs
+    for (u32 field = 0; field < GOLDEN_FIELDS; field++)
+    {
+        u32 depends = 0;
+        for (u32 bit = 0; bit < 8; bit++)
+        {
+            u32 as_is = 0, as_xor = 0;
+            for (u32 dimension = 0; dimension < GOLDEN_DIMENSIONS; dimension++)
+            {
+                as_is |= ((raw[field][dimension] >> bit) & 1u) << dimension;
+                if (field < GOLDEN_INPUT_FIELDS)
+                    as_xor |= ((xored[field][dimension] >> bit) & 1u) << dimension;
+            }
+            if (field < GOLDEN_INPUT_FIELDS && Golden_Count_Bits(as_xor) < Golden_Count_Bits(as_is))
+            {
+                entry->xor_mask[field] |= (u8)(1u << bit);
+                depends |= as_xor;
+            }
+            else
+                depends |= as_is;
+        }
+        for (u32 dimension = 0; dimension < GOLDEN_DIMENSIONS; dimension++)
+        {
+            if (depends & (1u << dimension))
+                entry->cases |= golden_dimension_bits[dimension];
+        }
+        if (depends != 0)
+            entry->fields |= 1u << field;
+    }
+
+    u8 first[GOLDEN_FIELDS];
+    memcpy(first, outputs, GOLDEN_FIELDS);
+    Golden_Encode(entry, 0, first);
+    memcpy(entry->constant, first, GOLDEN_FIELDS);
+    entry->record_size = Golden_Count_Bits(entry->fields);
+    entry->records     = 1u << Golden_Count_Bits(entry->cases);
+
+    uint8_t *records = (uint8_t *)malloc((size_t)entry->records * entry->record_size + 1);
+    if (records != NULL)
+    {
+        uint8_t *record = records;
+        u32      c      = 0;
+        do
+        {
+            u8 out[GOLDEN_FIELDS];
+            memcpy(out, &outputs[(size_t)c * GOLDEN_FIELDS], GOLDEN_FIELDS);
+            Golden_Encode(entry, c, out);
+            for (u32 field = 0; field < GOLDEN_FIELDS; field++)
+            {
+                if (entry->fields & (1u << field))
+                    *record++ = out[field];
+            }
+            c = Golden_Next_Case(entry->cases, c);
+        } while (c != 0);
+    }
+    free(outputs);
+    return records;
+}
+
+// Describes a field that differs, with the values as they come out
+static inline void Golden_Describe(char *failure, size_t size, u8 opcode, const Golden_Opcode *entry, u32 c, Golden_Field field, u8 value,
+                                   u8 expected)
+{
+    static const char registers[3] = {'A', 'X', 'Y'};
+    if (field < GOLDEN_INPUT_FIELDS)
+    {
+        const u8 input = Golden_Input(entry->input_register, c, field) & entry->xor_mask[field];
+        value ^= input;
+        expected ^= input;
+    }
+    snprintf(failure, size, "%02X %s %s : operand 0x%02X %c 0x%02X C%u D%u V%u : %s 0x%02X, expected 0x%02X", (unsigned)opcode,
+             Opcode_Mnemonic(opcode), Address_Mode_Name(Opcode_Address_Mode(opcode)), (unsigned)GOLDEN_OPERAND(c),
+             registers[entry->input_register], (unsigned)GOLDEN_REGISTER(c), (unsigned)GOLDEN_C(c), (unsigned)GOLDEN_D(c),
+             (unsigned)GOLDEN_V(c), golden_field_names[field], (unsigned)value, (unsigned)expected);
+}
+
+// Checks one case against its record, false with the first field that differs
+static inline bool Golden_Check_Case(const Golden_Opcode *entry, u8 opcode, const uint8_t *record, u32 c, const u8 out[GOLDEN_FIELDS],
+                                     Golden_Result *result)
+{
+    for (u32 field = 0; field < GOLDEN_FIELDS; field++)
+    {
+        const u8 expected = (entry->fields & (1u << field)) ? *record++ : entry->constant[field];
+        if (out[field] != expected)
+        {
+            if (result->failed == 0)
+                Golden_Describe(result->failure, sizeof(result->failure), opcode, entry, c, (Golden_Field)field, out[field], expected);
+            result->failed++;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Runs the cases of a table entry with 'run' and compares them with the
+// records. Only the stored cases unless 'every_case', then all 524288 with
+// each compared to the record it was folded into
+static inline Golden_Result Golden_Verify_Opcode(s32 (*run)(s32), u8 opcode, const Golden_Opcode *entry, const uint8_t *records,
+                                                 bool every_case)
+{
+    Golden_Result result = {0};
+    if (every_case)
+    {
+        for (u32 c = 0; c < GOLDEN_CASES; c++)
+        {
+            u8 out[GOLDEN_FIELDS];
+            Golden_Run_Case(run, opcode, entry->input_register, c, out);
+            Golden_Encode(entry, c, out);
+            const uint8_t *record = &records[(size_t)Golden_Record(entry->cases, c & entry->cases) * entry->record_size];
+            Golden_Check_Case(entry, opcode, record, c, out, &result);
+            result.checked++;
+        }
+        return result;
+    }
+
+    // a block of records at a time, packed like the table and compared in
+    // one memcmp(), the cases are only looked at one by one when it differs
+    static uint8_t block[GOLDEN_BLOCK * GOLDEN_FIELDS];
+    static u32     block_cases[GOLDEN_BLOCK];
+    u32            c     = 0;
+    u32            first = 0;
+    do
+    {
+        uint8_t *record   = block;
+        u32      count    = 0;
+        bool     constant = true;
+        do
+        {
+            u8 out[GOLDEN_FIELDS];
+            Golden_Run_Case(run, opcode, entry->input_register, c, out);
+            Golden_Encode(entry, c, out);
+            for (u32 field = 0; field < GOLDEN_FIELDS; field++)
+            {
+                if (entry->fields & (1u << field))
+                    *record++ = out[field];
+                else
+                    constant &= (out[field] == entry->constant[field]);
+            }
+            block_cases[count++] = c;
+            c                    = Golden_Next_Case(entry->cases, c);
+        } while (c != 0 && count < GOLDEN_BLOCK);
+
+        const uint8_t *expected = &records[(size_t)first * entry->record_size];
+        if (!constant || memcmp(block, expected, (size_t)count * entry->record_size) != 0)
+        {
+            for (u32 i = 0; i < count; i++)
+            {
+                u8 out[GOLDEN_FIELDS];
+                Golden_Run_Case(run, opcode, entry->input_register, block_cases[i], out);
+                Golden_Encode(entry, block_cases[i], out);
+                Golden_Check_Case(entry, opcode, &expected[(size_t)i * entry->record_size], block_cases[i], out, &result);
+            }
+        }
+        result.checked += count;
+        first += count;
+    } while (c != 0);
+    return result;
+}
+
+static inline void Golden_Put_32(uint8_t *bytes, uint32_t value)
+{
+    for (u32 i = 0; i < 4; i++)
+        bytes[i] = (uint8_t)(value >> (8 * i));
+}
+
+static inline uint32_t Golden_Get_32(const uint8_t *bytes)
+{
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+//  0 : u8 present | u8 input register | u8 record size | u8 0
+//  4 : u32 enumerated case bits | u32 stored fields | u32 records | u32 offset
+// 20 : u8 XOR mask[6] | u8 constant[9] | 5 x u8 0
+static inline void Golden_Put_Entry(uint8_t bytes[GOLDEN_ENTRY_SIZE], const Golden_Opcode *entry)
+{
+    memset(bytes, 0, GOLDEN_ENTRY_SIZE);
+    if (!entry->present)
+        return;
+    bytes[0] = 1;
+    bytes[1] = entry->input_register;
+    bytes[2] = (uint8_t)entry->record_size;
+    Golden_Put_32(&bytes[4], (uint32_t)entry->cases);
+    Golden_Put_32(&bytes[8], (uint32_t)entry->fields);
+    Golden_Put_32(&bytes[12], (uint32_t)entry->records);
+    Golden_Put_32(&bytes[16], (uint32_t)entry->offset);
+    for (u32 field = 0; field < GOLDEN_INPUT_FIELDS; field++)
+        bytes[20 + field] = entry->xor_mask[field];
+    for (u32 field = 0; field < GOLDEN_FIELDS; field++)
+        bytes[26 + field] = entry->constant[field];
+}
+
+// False when the entry does not make sense
+static inline bool Golden_Get_Entry(const uint8_t bytes[GOLDEN_ENTRY_SIZE], Golden_Opcode *entry)
+{
+    memset(entry, 0, sizeof(*entry));
+    entry->present = (bytes[0] == 1);
+    if (!entry->present)
+        return bytes[0] == 0;
+    entry->input_register = bytes[1];
+    entry->record_size    = bytes[2];
+    entry->cases          = Golden_Get_32(&bytes[4]);
+    entry->fields         = Golden_Get_32(&bytes[8]);
+    entry->records        = Golden_Get_32(&bytes[12]);
+    entry->offset         = Golden_Get_32(&bytes[16]);
+    for (u32 field = 0; field < GOLDEN_INPUT_FIELDS; field++)
+        entry->xor_mask[field] = bytes[20 + field];
+    for (u32 field = 0; field < GOLDEN_FIELDS; field++)
+        entry->constant[field] = bytes[26 + field];
+    return entry->input_register <= GOLDEN_Y && (entry->cases & ~(GOLDEN_CASES - 1)) == 0 && entry->fields < (1u << GOLDEN_FIELDS) &&
+           entry->record_size == Golden_Count_Bits(entry->fields) && entry->records == (1u << Golden_Count_Bits(entry->cases));
+}
+
+// A whole table, as in the file
+typedef struct Golden_Table
+{
+    Golden_Opcode opcodes[256];
+    uint8_t      *data;
+    uint64_t      size;
+} Golden_Table;
+
+// Writes the table, records that are the same as an earlier opcode's are
+// only written once. 'records' are each opcode's, the offsets are set here
+static inline bool Golden_Write(FILE *file, Golden_Opcode opcodes[256], uint8_t *const records[256])
+{
+    const uint8_t header[GOLDEN_HEADER_SIZE] = {'H', '6', '5', '0', '2', 'G', 'L', 'D', GOLDEN_VERSION, H6502_VARIANT};
+    bool          written                    = fwrite(header, 1, sizeof(header), file) == sizeof(header);
+
+    uint64_t offset = 0;
+    for (u32 opcode = 0; opcode < 256; opcode++)
+    {
+        Golden_Opcode *entry = &opcodes[opcode];
+        if (!entry->present)
+            continue;
+        const size_t size = (size_t)entry->records * entry->record_size;
+        entry->offset     = offset;
+        for (u32 earlier = 0; earlier < opcode; earlier++)
+        {
+            if (opcodes[earlier].present && (size_t)opcodes[earlier].records * opcodes[earlier].record_size == size &&
+                memcmp(records[earlier], records[opcode], size) == 0)
+            {
+                entry->offset = opcodes[earlier].offset;
+                break;
+            }
+        }
+        if (entry->offset == offset)
+            offset += size;
+    }
+
+    for (u32 opcode = 0; opcode < 256; opcode++)
+    {
+        uint8_t bytes[GOLDEN_ENTRY_SIZE];
+        Golden_Put_Entry(bytes, &opcodes[opcode]);
+        written &= fwrite(bytes, 1, sizeof(bytes), file) == sizeof(bytes);
+    }
+    offset = 0;
+    for (u32 opcode = 0; opcode < 256; opcode++)
+    {
+        const Golden_Opcode *entry = &opcodes[opcode];
+        if (entry->present && entry->offset == offset)
+        {
+            const size_t size = (size_t)entry->records * entry->record_size;
+            written &= fwrite(records[opcode], 1, size, file) == size;
+            offset += size;
+        }
+    }
+    return written;
+}
+
+// Reads a table written for this variant, false when it is not one
+static inline bool Golden_Read(FILE *file, Golden_Table *table)
+{
+    uint8_t header[GOLDEN_HEADER_SIZE];
+    memset(table, 0, sizeof(*table));
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, GOLDEN_MAGIC, 8) != 0 ||
+        header[8] != GOLDEN_VERSION || header[9] != H6502_VARIANT)
+        return false;
+
+    uint64_t size = 0;
+    for (u32 opcode = 0; opcode < 256; opcode++)
+    {
+        uint8_t        bytes[GOLDEN_ENTRY_SIZE];
+        Golden_Opcode *entry = &table->opcodes[opcode];
+        if (fread(bytes, 1, sizeof(bytes), file) != sizeof(bytes) || !Golden_Get_Entry(bytes, entry))
+            return false;
+        if (entry->present && entry->offset + (uint64_t)entry->records * entry->record_size > size)
+            size = entry->offset + (uint64_t)entry->records * entry->record_size;
+    }
+
+    table->data = (uint8_t *)malloc((size_t)size + 1);
+    table->size = size;
+    if (table->data == NULL || fread(table->data, 1, (size_t)size, file) != size || fgetc(file) != EOF)
+    {
+        free(table->data);
+        table->data = NULL;
+        return false;
+    }
+    return true;
+}
+
+static inline void Golden_Free(Golden_Table *table)
+{
+    free(table->data);
+    table->data = NULL;
+}
+
+#endif // __GOLDEN_H__
@@ -34,6 +34,88 @@ typedef int_fast32_t  s32;
 
 #define MAX_MEM 65536 // 1024 * 64 = 65536
 
+// CPU variants, each one is compiled into its own interpreter so there are no
+// runtime checks for which chip is being emulated. Select one with
+// -DH6502_VARIANT=H6502_VARIANT_xxx, the default is the documented NMOS 6502
+// > Undocumented opcodes : https://www.masswerk.at/nowgobang/2021/6502-illegal-opcodes
+// > 65C02 opcodes : http://www.6502.org/tutorials/65c02opcodes.html
+#define H6502_VARIANT_NMOS       0 // NMOS 6502, documented opcodes only
+#define H6502_VARIANT_NMOS_UNDOC 1 // NMOS 6502 + stable undocumented opcodes (LAX, SAX, DCP, ISC, SLO, RLA, SRE, RRA)
+#define H6502_VARIANT_65C02      2 // CMOS 65C02 (STZ, BRA, PHX/PLX, PHY/PLY, TSB/TRB, (zp) addressing)
+
+#ifndef H6502_VARIANT
+#define H6502_VARIANT H6502_VARIANT_NMOS
+#endif
+
+#define H6502_IS_NMOS          (H6502_VARIANT == H6502_VARIANT_NMOS || H6502_VARIANT == H6502_VARIANT_NMOS_UNDOC)
+#define H6502_IS_CMOS          (H6502_VARIANT == H6502_VARIANT_65C02)
+#define H6502_HAS_UNDOCUMENTED (H6502_VARIANT == H6502_VARIANT_NMOS_UNDOC)
+
+#if H6502_VARIANT == H6502_VARIANT_NMOS
+#define H6502_VARIANT_NAME "NMOS"
+#elif H6502_VARIANT == H6502_VARIANT_NMOS_UNDOC
+#define H6502_VARIANT_NAME "NMOS_UNDOC"
+#elif H6502_VARIANT == H6502_VARIANT_65C02
+#define H6502_VARIANT_NAME "65C02"
+#else
+#error "Unknown H6502_VARIANT"
+#endif
+
+// Per-opcode execution counters (see Opcode_Stats), compiled out when 0
+#ifndef H6502_OPCODE_STATS
+#define H6502_OPCODE_STATS 0
+#endif
+
+// Call stack profiler (see profiler.h), compiled out when 0
+#ifndef H6502_CALL_PROFILER
+#define H6502_CALL_PROFILER 0
+#endif
+
+// Binary execution trace (see trace.h), compiled out when 0
+#ifndef H6502_TRACE
+#define H6502_TRACE 0
+#endif
+
+// Columnar trace file (see trace_columns.h), compiled out when 0
+#ifndef H6502_TRACE_COLUMNS
+#define H6502_TRACE_COLUMNS 0
+#endif
+
+// Per-address read/write/execute counters (see heatmap.h), compiled out when 0
+#ifndef H6502_HEATMAP
+#define H6502_HEATMAP 0
+#endif
+
+// AFL style edge coverage map (see coverage.h), compiled out when 0
+#ifndef H6502_EDGE_COVERAGE
+#define H6502_EDGE_COVERAGE 0
+#endif
+
+// nestest style text trace and log differ (see trace_text.h), compiled out when 0
+#ifndef H6502_TRACE_TEXT
+#define H6502_TRACE_TEXT 0
+#endif
+
+// Snapshots restored by copying only the pages written (see snapshot.h), compiled out when 0
+#ifndef H6502_SNAPSHOT
+#define H6502_SNAPSHOT 0
+#endif
+
+// Record and replay of input port reads and host values (see input_log.h), compiled out when 0
+#ifndef H6502_INPUT_LOG
+#define H6502_INPUT_LOG 0
+#endif
+
+// Execute_Until() stopping on writes to a range (see Stop_On_Write()), compiled out when 0
+#ifndef H6502_WRITE_WATCH
+#define H6502_WRITE_WATCH 0
+#endif
+
+// Something wants to see every instruction
+#define H6502_INSTRUCTION_HOOKS (H6502_CALL_PROFILER || H6502_TRACE || H6502_TRACE_COLUMNS || H6502_TRACE_TEXT)
+
+#include "opcodes.h"
+
 typedef struct Memory
 {
     u8 data[MAX_MEM];
@@ -86,227 +168,83 @@ enum FlagBits
     ZERO_BIT                  = 0x01, // 0b''0000'0001
 };
 
-// opcodes
+// opcodes, generated from the opcode table in opcodes.h
 typedef enum
 {
-    // LDA - Load Accumulator
-    INS_LDA_IM    = 0xA9,
-    INS_LDA_ZP    = 0xA5,
-    INS_LDA_ZP_X  = 0xB5,
-    INS_LDA_ABS   = 0xAD,
-    INS_LDA_ABS_X = 0xBD,
-    INS_LDA_ABS_Y = 0xB9,
-    INS_LDA_IND_X = 0xA1,
-    INS_LDA_IND_Y = 0xB1,
-
-    // LDX - Load X Register
-    INS_LDX_IM    = 0xA2,
-    INS_LDX_ZP    = 0xA6,
-    INS_LDX_ZP_Y  = 0xB6,
-    INS_LDX_ABS   = 0xAE,
-    INS_LDX_ABS_Y = 0xBE,
-
-    // LDY - Load Y Register
-    INS_LDY_IM    = 0xA0,
-    INS_LDY_ZP    = 0xA4,
-    INS_LDY_ZP_X  = 0xB4,
-    INS_LDY_ABS   = 0xAC,
-    INS_LDY_ABS_X = 0xBC,
-
-    // STA - Store Accumulator
-    INS_STA_ZP    = 0x85,
-    INS_STA_ZP_X  = 0x95,
-    INS_STA_ABS   = 0x8D,
-    INS_STA_ABS_X = 0x9D,
-    INS_STA_ABS_Y = 0x99,
-    INS_STA_IND_X = 0x81,
-    INS_STA_IND_Y = 0x91,
-
-    // STX - Store X Register
-    INS_STX_ZP   = 0x86,
-    INS_STX_ZP_Y = 0x96,
-    INS_STX_ABS  = 0x8E,
-
-    // STY - Store Y Register
-    INS_STY_ZP   = 0x84,
-    INS_STY_ZP_X = 0x94,
-    INS_STY_ABS  = 0x8C,
-
-    // JMP - JuMP
-    INS_JMP_ABS = 0x4C,
-    INS_JMP_IND = 0x6C,
-
-    // JSR - Jump to SubRoutine
-    INS_JSR = 0x20,
-
-    // RTS - ReTurn from Subroutine
-    INS_RTS = 0x60,
-
-    // - Register Instructions -
-    // These instructions are implied mode, have a length of one byte and require two machine cycles.
-    INS_TAX = 0xAA, // Transfer Accumulator to Index X
-    INS_TXA = 0x8A, // Transfer Index X to Accumulator
-    INS_TAY = 0xA8, // Transfer Accumulator to Index Y
-    INS_TYA = 0x98, // Transfer Index Y to Accumulator
-
-    INS_DEX = 0xCA, // (DEcrement X)
-    INS_INX = 0xE8, // (INcrement X)
-    INS_DEY = 0x88, // (DEcrement Y)
-    INS_INY = 0xC8, // (INcrement Y)
-
-    // - Stack Instructions -
-    // These instructions are implied mode, have a length of one byte and require machine cycles as
-    // indicated. The stack is always on page one ($100-$1FF) and works top down.
-    INS_TSX = 0xBA, // Transfer Stack Pointer to Index X
-    INS_TXS = 0x9A, // Transfer Index X to Stack Register
-
-    INS_PHA = 0x48, // (PusH Accumulator) Push Accumulator on Stack
-    INS_PLA = 0x68, // (PuLl Accumulator) Pull Accumulator from Stack
-    INS_PHP = 0x08, // (PusH Processor status) Push Processor Status on Stack
-    INS_PLP = 0x28, // (PuLl Processor status) Pull Processor Status from Stack
-
-    // ORA - OR Memory with Accumulator
-    INS_ORA_IM    = 0x09,
-    INS_ORA_ZP    = 0x05,
-    INS_ORA_ZP_X  = 0x15,
-    INS_ORA_ABS   = 0x0D,
-    INS_ORA_ABS_X = 0x1D,
-    INS_ORA_ABS_Y = 0x19,
-    INS_ORA_IND_X = 0x01,
-    INS_ORA_IND_Y = 0x11,
-
-    // AND - bitwise AND with accumulator
-    INS_AND_IM    = 0x29,
-    INS_AND_ZP    = 0x25,
-    INS_AND_ZP_X  = 0x35,
-    INS_AND_ABS   = 0x2D,
-    INS_AND_ABS_X = 0x3D,
-    INS_AND_ABS_Y = 0x39,
-    INS_AND_IND_X = 0x21,
-    INS_AND_IND_Y = 0x31,
-
-    // EOR - Exclusive OR
-    INS_EOR_IM    = 0x49,
-    INS_EOR_ZP    = 0x45,
-    INS_EOR_ZP_X  = 0x55,
-    INS_EOR_ABS   = 0x4D,
-    INS_EOR_ABS_X = 0x5D,
-    INS_EOR_ABS_Y = 0x59,
-    INS_EOR_IND_X = 0x41,
-    INS_EOR_IND_Y = 0x51,
-
-    // BIT - test BITs
-    INS_BIT_ZP  = 0x24,
-    INS_BIT_ABS = 0x2C,
-
-    // DEC (DECrement memory)
-    INS_DEC_ZP    = 0xC6,
-    INS_DEC_ZP_X  = 0xD6,
-    INS_DEC_ABS   = 0xCE,
-    INS_DEC_ABS_X = 0xDE,
-
-    // INC (INCrement memory)
-    INS_INC_ZP    = 0xE6,
-    INS_INC_ZP_X  = 0xF6,
-    INS_INC_ABS   = 0xEE,
-    INS_INC_ABS_X = 0xFE,
-
-    // Branch Instructions
-    INS_BPL = 0x10, // BPL (Branch on PLus)
-    INS_BMI = 0x30, // BMI (Branch on MInus)
-    INS_BVC = 0x50, // BVC (Branch on oVerflow Clear)
-    INS_BVS = 0x70, // BVS (Branch on oVerflow Set)
-    INS_BCC = 0x90, // BCC (Branch on Carry Clear)
-    INS_BCS = 0xB0, // BCS (Branch on Carry Set)
-    INS_BNE = 0xD0, // BNE (Branch on Not Equal)
-    INS_BEQ = 0xF0, // BEQ (Branch on EQual)
-
-    // Flag (Processor Status) Instructions
-    INS_CLC = 0x18, // (CLear Carry)
-    INS_SEC = 0x38, // (SEt Carry)
-    INS_CLI = 0x58, // (CLear Interrupt)
-    INS_SEI = 0x78, // (SEt Interrupt)
-    INS_CLV = 0xB8, // (CLear oVerflow)
-    INS_CLD = 0xD8, // (CLear Decimal)
-    INS_SED = 0xF8, // (SEt Decimal)
-
-    // NOP (No OPeration)
-    INS_NOP = 0xEA,
-
-    // ADC (ADd with Carry)
-    INS_ADC_IM    = 0x69,
-    INS_ADC_ZP    = 0x65,
-    INS_ADC_ZP_X  = 0x75,
-    INS_ADC_ABS   = 0x6D,
-    INS_ADC_ABS_X = 0x7D,
-    INS_ADC_ABS_Y = 0x79,
-    INS_ADC_IND_X = 0x61,
-    INS_ADC_IND_Y = 0x71,
-
-    // SBC (SuBtract with Carry)
-    INS_SBC_IM    = 0xE9,
-    INS_SBC_ZP    = 0xE5,
-    INS_SBC_ZP_X  = 0xF5,
-    INS_SBC_ABS   = 0xED,
-    INS_SBC_ABS_X = 0xFD,
-    INS_SBC_ABS_Y = 0xF9,
-    INS_SBC_IND_X = 0xE1,
-    INS_SBC_IND_Y = 0xF1,
-
-    // CMP (CoMPare accumulator)
-    INS_CMP_IM    = 0xC9,
-    INS_CMP_ZP    = 0xC5,
-    INS_CMP_ZP_X  = 0xD5,
-    INS_CMP_ABS   = 0xCD,
-    INS_CMP_ABS_X = 0xDD,
-    INS_CMP_ABS_Y = 0xD9,
-    INS_CMP_IND_X = 0xC1,
-    INS_CMP_IND_Y = 0xD1,
-
-    // CPX (ComPare X register)
-    INS_CPX_IM  = 0xE0,
-    INS_CPX_ZP  = 0xE4,
-    INS_CPX_ABS = 0xEC,
-
-    // CPY (ComPare Y register)
-    INS_CPY_IM  = 0xC0,
-    INS_CPY_ZP  = 0xC4,
-    INS_CPY_ABS = 0xCC,
-
-    // ASL (Arithmetic Shift Left)
-    INS_ASL       = 0x0A,
-    INS_ASL_ZP    = 0x06,
-    INS_ASL_ZP_X  = 0x16,
-    INS_ASL_ABS   = 0x0E,
-    INS_ASL_ABS_X = 0x1E,
-
-    // LSR (Logical Shift Right)
-    INS_LSR       = 0x4A,
-    INS_LSR_ZP    = 0x46,
-    INS_LSR_ZP_X  = 0x56,
-    INS_LSR_ABS   = 0x4E,
-    INS_LSR_ABS_X = 0x5E,
-
-    // ROL (ROtate Left)
-    INS_ROL       = 0x2A,
-    INS_ROL_ZP    = 0x26,
-    INS_ROL_ZP_X  = 0x36,
-    INS_ROL_ABS   = 0x2E,
-    INS_ROL_ABS_X = 0x3E,
-
-    // ROR (ROtate Right)
-    INS_ROR       = 0x6A,
-    INS_ROR_ZP    = 0x66,
-    INS_ROR_ZP_X  = 0x76,
-    INS_ROR_ABS   = 0x6E,
-    INS_ROR_ABS_X = 0x7E
-
+#define H6502_OPCODE_ENUM(name, mnemonic, opcode, ...) INS_##name = opcode,
+    H6502_OPCODE_TABLE(H6502_OPCODE_ENUM)
+#undef H6502_OPCODE_ENUM
 } Opcode;
 
+typedef enum
+{
+#define H6502_ADDRESS_MODE_ENUM(mode) MODE_##mode,
+    H6502_ADDRESS_MODES(H6502_ADDRESS_MODE_ENUM)
+#undef H6502_ADDRESS_MODE_ENUM
+    MODE_COUNT
+} Address_Mode;
+
+// Every instruction length has to match its addressing mode
+#define H6502_CHECK_LENGTH(name, mnemonic, opcode, mode, bytes, ...) \
+    _Static_assert(bytes == H6502_MODE_BYTES_##mode, "INS_" #name " length does not match its addressing mode");
+H6502_OPCODE_TABLE(H6502_CHECK_LENGTH)
+#undef H6502_CHECK_LENGTH
+
+#if defined(__GNUC__) || defined(__clang__)
+#define H6502_UNUSED       __attribute__((unused))
+#define H6502_UNLIKELY(x)  __builtin_expect(!!(x), 0)
+#define H6502_FORCE_INLINE __attribute__((always_inline)) inline
+#else
+#define H6502_UNUSED
+#define H6502_UNLIKELY(x)  (x)
+#define H6502_FORCE_INLINE __forceinline
+#endif
+
 // ---------------------------------------------------------------------
 // GLOBAL memory and cpu
 static Memory mem = {0};
 static CPU    cpu = {0};
+
+#if H6502_OPCODE_STATS
+// Counters for one opcode, kept together so an instruction only touches one
+// cache line. The cycles are not added up, see Opcode_Stats_Cycles()
+typedef struct Opcode_Counters
+{
+    uint64_t executions;
+    uint64_t page_crossings; // page cross penalties taken, by indexing or a taken branch
+    uint64_t branches_taken;
+    uint64_t extra_cycles;   // past the base and page cross cycles: the taken branch cycle, decimal mode
+} Opcode_Counters;
+
+typedef struct Opcode_Stats
+{
+    Opcode_Counters counters[256];
+} Opcode_Stats;
+
+static Opcode_Stats opcode_stats = {0};
+
+// Called at the end of each instruction function, where the opcode, mode and
+// base cycles are constants. Most instructions only count the execution, the
+// other counters move when the instruction takes more than its base cycles,
+// for a branch that is when it is taken
+static H6502_FORCE_INLINE void Opcode_Stats_Record(u8 opcode, Address_Mode mode, s32 base_cycles, bool page_crossed, s32 cycles_taken)
+{
+    Opcode_Counters *counters = &opcode_stats.counters[opcode];
+    counters->executions++;
+    if (page_crossed)
+        counters->page_crossings++;
+    const s32 extra_cycles = cycles_taken - base_cycles - page_crossed;
+    if (extra_cycles != 0)
+    {
+        // a taken branch is a cycle, and another one when it lands in a new page
+        const bool branch_page_crossed = mode == MODE_REL && extra_cycles > 1;
+        counters->page_crossings += branch_page_crossed;
+        counters->extra_cycles += (uint64_t)(extra_cycles - branch_page_crossed);
+        if (mode == MODE_REL)
+            counters->branches_taken++;
+    }
+}
+#endif
 // ---------------------------------------------------------------------
 
 static inline void Initialise_Memory(void)
@@ -340,7 +278,7 @@ static inline void Reset_CPU(void)
 static inline void Display_CPU_State(void)
 {
     printf("A  : 0x%X \t(%d) \tSP: 0x%X \t(%d) \n", cpu.accumulator, cpu.accumulator, cpu.stack_pointer, cpu.stack_pointer);
-    printf("X  : 0x%X \t(%d) \tPC: 0x%X \t(%d) \n", cpu.index_reg_X, cpu.index_reg_X, cpu.program_counter, cpu.program_counter);
+    printf("X  : 0x%X \t(%d) \tPC: 0x%X \t(%d) \n", cpu.index_reg_X, cpu.index_reg_X, (unsigned int)cpu.program_counter, (int)cpu.program_counter);
     printf("Y  : 0x%X \t(%d) \n", cpu.index_reg_Y, cpu.index_reg_Y);
 
     char PS_str[] = "NV-BDIZC";
@@ -387,370 +325,478 @@ static inline u16 Load_Program(const u8 *program, int number_of_bytes)
     return load_address;
 }
 
+// Raw image file at 'address', returns its size, 0 when it cannot be read or
+// does not fit
+static inline size_t Load_Image(const char *path, u16 address)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error opening image : %s\n", path);
+        return 0;
+    }
+
+    const size_t size = fread(&mem.data[address], 1, MAX_MEM - address, file);
+    const bool   more = fgetc(file) != EOF;
+    fclose(file);
+    if (size == 0 || more)
+    {
+        fprintf(stderr, "Error loading image : %s (%s)\n", path, more ? "too large" : "empty");
+        return 0;
+    }
+    return size;
+}
+
 static inline u16 SP_To_Address(void)
 {
     return 0x100 | cpu.stack_pointer;
 }
 
-// 1 Cycle (fetch oppcode)
-static inline u8 Fetch_Byte(s32 *cycles)
-{
-    assert(cpu.program_counter < MAX_MEM);
+// Memory access
+// Cycles are not counted here, every instruction takes the cycles listed in
+// the opcode table. Addresses are wrapped to the 16-bit address bus.
 
-    const u8 data = mem.data[cpu.program_counter];
-    cpu.program_counter++;
-    (*cycles) -= 1;
-    return data;
-}
+#if H6502_HEATMAP
+#include "heatmap.h"
+#else
+#define H6502_HEATMAP_COUNT(kind, address) ((void)0)
+#endif
+
+#include "memory_diff.h"
+
+#if H6502_SNAPSHOT
+#include "snapshot.h"
+#else
+#define H6502_SNAPSHOT_DIRTY(address) ((void)0)
+#endif
+
+#include "save_state.h"
 
-// 1 Cycle
-static inline s8 Fetch_Signed_Byte(s32 *cycles)
+#if H6502_INPUT_LOG
+#include "input_log.h"
+#else
+#define H6502_INPUT_LOG_STEP() ((void)0)
+#endif
+
+// Read without it counting as an access, for traces and debug tools
+static inline u8 Peek_Byte(u16 address)
 {
-    return (s8)Fetch_Byte(cycles);
+    return mem.data[address & 0xFFFF];
 }
 
-// 2 Cycles
-static inline u16 Fetch_Word(s32 *cycles)
+static inline u16 Peek_Word(u16 address)
 {
-    assert(cpu.program_counter < MAX_MEM);
-
-    // 6502 is little endian
-    u16 data = mem.data[cpu.program_counter];
-    cpu.program_counter++;
+    return Peek_Byte(address) | (Peek_Byte(address + 1) << 8);
+}
 
-    data |= (mem.data[cpu.program_counter] << 8);
-    cpu.program_counter++;
+static inline u8 Read_Byte(u16 address)
+{
+    address &= 0xFFFF;
+    H6502_HEATMAP_COUNT(HEATMAP_READS, address);
+#if H6502_INPUT_LOG
+    if (H6502_UNLIKELY((u32)(address - input_port.low) < input_port.size))
+        return Input_Read(address);
+#endif
+    return mem.data[address];
+}
 
-    (*cycles) -= 2;
-    return data;
+#if H6502_WRITE_WATCH
+// Write watch used by Execute_Until(), "size" is 0 when nothing is watched
+static struct
+{
+    u32  low;
+    u32  size;
+    bool hit;
+    u16  address; // first watched address written to
+} write_watch = {0};
+
+// one compare covers the whole range, it is never true when size is 0
+static inline void Write_Watch_Check(u16 address)
+{
+    if (H6502_UNLIKELY((u32)(address - write_watch.low) < write_watch.size))
+    {
+        write_watch.hit     = true;
+        write_watch.address = address;
+        write_watch.size    = 0; // only the first write is kept
+    }
 }
+#define H6502_WRITE_WATCH_CHECK(address) Write_Watch_Check(address)
+#else
+#define H6502_WRITE_WATCH_CHECK(address) ((void)0)
+#endif
 
-// 1 cycle
-static inline void Write_Byte(s32 *cycles, u8 data, u16 address)
+static inline void Write_Byte(u8 data, u16 address)
 {
+    address &= 0xFFFF;
     mem.data[address] = data;
-    (*cycles) -= 1;
+    H6502_HEATMAP_COUNT(HEATMAP_WRITES, address);
+    H6502_SNAPSHOT_DIRTY(address);
+    H6502_WRITE_WATCH_CHECK(address);
 }
 
-// 1 Cycle
-static inline u8 Read_Byte(s32 *cycles, u16 address)
+static inline u16 Read_Word(u16 address)
 {
-    const u8 data = mem.data[address];
-    (*cycles) -= 1;
-    return data;
+    // 6502 is little endian
+    const u8 low_byte  = Read_Byte(address);
+    const u8 high_byte = Read_Byte(address + 1);
+
+    return low_byte | (high_byte << 8);
 }
 
-// 2 Cycles
-static inline u16 Read_Word(s32 *cycles, u16 address)
+// Pointers stored in the zero page wrap around inside the zero page
+static inline u16 Read_Word_Zero_Page(u8 address)
 {
-    const u8 low_byte  = Read_Byte(cycles, address);
-    const u8 high_byte = Read_Byte(cycles, address + 1);
+    const u8 low_byte  = Read_Byte(address);
+    const u8 high_byte = Read_Byte((address + 1) & 0xFF);
 
     return low_byte | (high_byte << 8);
 }
 
-// 2 Cycles
-void Write_Word(s32 *cycles, u16 data, u32 address)
+// Where JMP (Indirect) reads the high byte of its target from
+static inline u16 Indirect_High_Byte_Address(u16 pointer)
 {
-    // move to the next address and set it equal to
-    mem.data[address + 1] = (data >> 8); // 1 cycle
-    (*cycles) -= 1;
-    mem.data[address] = (data & 0xFF); // 1 cycle
-    (*cycles) -= 1;
+#if H6502_IS_CMOS
+    return (pointer + 1) & 0xFFFF;
+#else
+    // The PCH will always be fetched from the same page
+    // than PCL, i.e. page boundary crossing is not handled.
+    return (pointer & 0xFF00) | ((pointer + 1) & 0x00FF);
+#endif
 }
 
-/** Pop a 16-bit value from the stack */
-static inline u16 Pop_Word_From_Stack(s32 *cycles)
+// Pointer read by JMP (Indirect)
+static inline u16 Read_Word_Indirect(u16 pointer)
 {
-    const u16 value_from_stack = Read_Word(cycles, SP_To_Address() + 1);
-    cpu.stack_pointer += 2;
-    (*cycles) -= 1;
-    return value_from_stack;
+    return Read_Byte(pointer) | (Read_Byte(Indirect_High_Byte_Address(pointer)) << 8);
 }
 
-static inline void Push_Word_To_Stack(s32 *cycles, u16 value)
+// Fetch the byte at PC, then increment PC
+static inline u8 Fetch_Byte(void)
 {
-    // cycles , data, address
-    Write_Byte(cycles, value >> 8, 0x100 | cpu.stack_pointer);
-    cpu.stack_pointer--;
-    Write_Byte(cycles, value & 0xFF, 0x100 | cpu.stack_pointer);
-    cpu.stack_pointer--;
+    const u8 data = Peek_Byte(cpu.program_counter);
+    H6502_HEATMAP_COUNT(HEATMAP_EXECUTES, cpu.program_counter);
+    cpu.program_counter = (cpu.program_counter + 1) & 0xFFFF;
+    return data;
 }
 
-/** Push the PC-1 onto the stack */
-static inline void Push_PC_Minus_One_To_Stack(s32 *cycles)
+static inline u16 Fetch_Word(void)
 {
-    Push_Word_To_Stack(cycles, cpu.program_counter - 1);
+    const u8 low_byte  = Fetch_Byte();
+    const u8 high_byte = Fetch_Byte();
+
+    return low_byte | (high_byte << 8);
 }
 
-/** Push the PC+1 onto the stack */
-static inline void Push_PC_Plus_One_To_Stack(s32 *cycles)
+// Stack
+// The stack is always on page one ($100-$1FF) and works top down
+
+static inline void Push_Byte_Onto_Stack(u8 value)
 {
-    Push_Word_To_Stack(cycles, cpu.program_counter + 1);
+    Write_Byte(value, SP_To_Address());
+    cpu.stack_pointer--;
 }
 
-/** Push the PC onto the stack */
-static inline void Push_PC_To_Stack(s32 *cycles)
+static inline u8 Pop_Byte_From_Stack(void)
 {
-    Push_Word_To_Stack(cycles, cpu.program_counter);
+    cpu.stack_pointer++;
+    return Read_Byte(SP_To_Address());
 }
 
-static inline void Push_Byte_Onto_Stack(s32 *cycles, u8 value)
+/** Push a 16-bit value to the stack (high byte first) */
+static inline void Push_Word_To_Stack(u16 value)
 {
-    mem.data[SP_To_Address()] = value;
-    cpu.stack_pointer--;
-    (*cycles) -= 1;
+    Push_Byte_Onto_Stack(value >> 8);
+    Push_Byte_Onto_Stack(value & 0xFF);
 }
 
-// 2 cycles
-static inline u8 Pop_Byte_From_Stack(s32 *cycles)
+/** Pop a 16-bit value from the stack (low byte first) */
+static inline u16 Pop_Word_From_Stack(void)
 {
-    cpu.stack_pointer++;
-    (*cycles) -= 2;
-    return mem.data[SP_To_Address()];
+    const u8 low_byte  = Pop_Byte_From_Stack();
+    const u8 high_byte = Pop_Byte_From_Stack();
+
+    return low_byte | (high_byte << 8);
 }
 
-// A, X or Y Register
-static inline void Load_Register_Set_Status(u8 reg)
+/*	reg (register) - The A,X or Y Register */
+static inline void Set_Zero_and_Negative_Flags(u8 reg)
 {
     cpu.Z = (reg == 0);
-    cpu.N = (reg & 0x80) > 0;
+    cpu.N = (reg & NEGATIVE_FLAG_BIT) > 0;
 }
 
-// Addressing mode - Zero Page (1 cycle)
-//#define Address_Zero_Page(CYCLES) Fetch_Byte(CYCLES)
-static inline u8 Address_Zero_Page(s32 *cycles)
+// ---------------------------------------------------------------------
+// Addressing modes
+// Each mode returns the effective address of the operand and moves PC past
+// it. "page_crossed" is set when indexing moved the address into a new page,
+// the opcode table decides if that costs a cycle.
+// > https://www.c64-wiki.com/wiki/Addressing_mode
+
+#define ADDRESS_MODE(mode) static inline u16 Address_Mode_##mode(H6502_UNUSED bool *page_crossed)
+
+// Implied, there is no operand
+ADDRESS_MODE(IMP)
 {
-    return Fetch_Byte(cycles); // zero_page_address
+    return 0;
 }
 
-// Addressing mode - Zero Page (2 cycles)
-static inline u16 Address_Zero_Page_X(s32 *cycles)
+// Accumulator, the operand is the A register
+ADDRESS_MODE(ACC)
 {
-    u8 zero_page_address = Fetch_Byte(cycles);
-    zero_page_address += cpu.index_reg_X;
-    (*cycles) -= 1;
-
-    return zero_page_address;
+    return 0;
 }
 
-// Addressing mode - Zero Page (2 cycles)
-static inline u16 Address_Zero_Page_Y(s32 *cycles)
+// Immediate, the operand is the next byte
+ADDRESS_MODE(IM)
 {
-    u8 zero_page_address = Fetch_Byte(cycles);
-    zero_page_address += cpu.index_reg_Y;
-    (*cycles) -= 1;
-
-    return zero_page_address;
+    const u16 address   = cpu.program_counter;
+    cpu.program_counter = (cpu.program_counter + 1) & 0xFFFF;
+    return address;
 }
 
-// Addressing mode - Absolute (2 cycles)
-static inline u16 Address_Absolute(s32 *cycles)
+ADDRESS_MODE(ZP)
 {
-    const u16 absolute_address = Fetch_Word(cycles);
-    return absolute_address;
+    return Fetch_Byte();
 }
 
-// Addressing mode - Absolute X (2/3 cycles)
-static inline u16 Address_Absolute_X(s32 *cycles)
+ADDRESS_MODE(ZP_X)
 {
-    const u16 absolute_address      = Fetch_Word(cycles);
-    const u16 absolute_address_x    = absolute_address + cpu.index_reg_X;
-    const int crossed_page_boundary = (absolute_address ^ absolute_address_x) >> 8;
-    if (crossed_page_boundary)
-        (*cycles) -= 1;
-
-    return absolute_address_x;
+    return (Fetch_Byte() + cpu.index_reg_X) & 0xFF;
 }
 
-static inline u16 Address_Absolute_X_5_Cycle(s32 *cycles) // Special Case
+ADDRESS_MODE(ZP_Y)
 {
-    const u16 absolute_address   = Fetch_Word(cycles);
-    const u16 absolute_address_x = absolute_address + cpu.index_reg_X;
-    (*cycles) -= 1;
-
-    return absolute_address_x;
+    return (Fetch_Byte() + cpu.index_reg_Y) & 0xFF;
 }
 
-// Addressing mode - Absolute Y (2/3 cycles)
-static inline u16 Address_Absolute_Y(s32 *cycles)
+ADDRESS_MODE(ABS)
 {
-    const u16 absolute_address      = Fetch_Word(cycles);
-    const u16 absolute_address_y    = absolute_address + cpu.index_reg_Y;
-    const int crossed_page_boundary = (absolute_address ^ absolute_address_y) >> 8;
-    if (crossed_page_boundary)
-        (*cycles) -= 1;
-
-    return absolute_address_y;
+    return Fetch_Word();
 }
 
-static inline u16 Address_Absolute_Y_5_Cycle(s32 *cycles) // Special case
+ADDRESS_MODE(ABS_X)
 {
-    const u16 absolute_address   = Fetch_Word(cycles);
-    const u16 absolute_address_y = absolute_address + cpu.index_reg_Y;
-    (*cycles) -= 1;
+    const u16 absolute_address   = Fetch_Word();
+    const u16 absolute_address_x = (absolute_address + cpu.index_reg_X) & 0xFFFF;
+    *page_crossed                = (absolute_address ^ absolute_address_x) >> 8;
+    return absolute_address_x;
+}
 
+ADDRESS_MODE(ABS_Y)
+{
+    const u16 absolute_address   = Fetch_Word();
+    const u16 absolute_address_y = (absolute_address + cpu.index_reg_Y) & 0xFFFF;
+    *page_crossed                = (absolute_address ^ absolute_address_y) >> 8;
     return absolute_address_y;
 }
 
-// Addressing mode - Indirect X (4 cycles)
-static inline u16 Address_Indirect_X(s32 *cycles)
+// (Indirect), only used by JMP
+ADDRESS_MODE(IND)
 {
-    u8 zero_page_address = Fetch_Byte(cycles);
-    zero_page_address += cpu.index_reg_X;
-    (*cycles) -= 1;
-    const u16 effective_address = Read_Word(cycles, zero_page_address);
-    return effective_address;
+    return Read_Word_Indirect(Fetch_Word());
 }
 
-// Addressing mode - Indirect Y (3/4 cycles)
-static inline u16 Address_Indirect_Y(s32 *cycles)
+// (Zero Page,X)
+ADDRESS_MODE(IND_X)
 {
-    const u8  zero_page_address   = Fetch_Byte(cycles);
-    const u16 effective_address   = Read_Word(cycles, zero_page_address);
-    const u16 effective_address_y = effective_address + cpu.index_reg_Y;
-
-    const int crossed_page_boundary = (effective_address ^ effective_address_y) >> 8;
-    if (crossed_page_boundary)
-        (*cycles) -= 1;
-
-    return effective_address_y;
+    const u8 zero_page_address = Fetch_Byte() + cpu.index_reg_X;
+    return Read_Word_Zero_Page(zero_page_address);
 }
 
-// 4 Cycles
-static inline u16 Address_Indirect_Y_6_Cycles(s32 *cycles) // Special Case
+// (Zero Page),Y
+ADDRESS_MODE(IND_Y)
 {
-    const u8  zero_page_address   = Fetch_Byte(cycles);
-    const u16 effective_address   = Read_Word(cycles, zero_page_address);
-    const u16 effective_address_y = effective_address + cpu.index_reg_Y;
-    (*cycles) -= 1;
-
+    const u16 effective_address   = Read_Word_Zero_Page(Fetch_Byte());
+    const u16 effective_address_y = (effective_address + cpu.index_reg_Y) & 0xFFFF;
+    *page_crossed                 = (effective_address ^ effective_address_y) >> 8;
     return effective_address_y;
 }
 
-// Load a value at an 'address' into a given 'register' (1 cycle)
-static inline void Load_Register(s32 *cycles, u8 *reg, const u16 address)
+// Relative, returns the branch target
+ADDRESS_MODE(REL)
 {
-    (*reg) = Read_Byte(cycles, address);
-    Load_Register_Set_Status((*reg));
+    const s8 jump_offset = (s8)Fetch_Byte();
+    return (cpu.program_counter + jump_offset) & 0xFFFF;
 }
 
-// AND the A register with the value from 'address'
-static inline void AND_Register(s32 *cycles, const u16 address)
+// (Zero Page), 65C02
+ADDRESS_MODE(ZP_IND)
 {
-    cpu.accumulator &= Read_Byte(cycles, address);
-    Load_Register_Set_Status(cpu.accumulator);
+    return Read_Word_Zero_Page(Fetch_Byte());
 }
 
-// OR the A register with the value from 'address'
-static inline void OR_Register(s32 *cycles, const u16 address)
+// (Absolute,X), 65C02 JMP only
+ADDRESS_MODE(ABS_IND_X)
 {
-    cpu.accumulator |= Read_Byte(cycles, address);
-    Load_Register_Set_Status(cpu.accumulator);
+    return Read_Word((Fetch_Word() + cpu.index_reg_X) & 0xFFFF);
 }
 
-// EOR the A register with the value from 'address'
-static inline void EOR_Register(s32 *cycles, const u16 address)
-{
-    cpu.accumulator ^= Read_Byte(cycles, address);
-    Load_Register_Set_Status(cpu.accumulator);
-}
+#undef ADDRESS_MODE
+
+// ---------------------------------------------------------------------
+// Helpers shared by the operations
+
+#if H6502_EDGE_COVERAGE
+#include "coverage.h"
+#else
+#define H6502_COVERAGE_EDGE(target) ((void)0)
+#endif
 
-// 1 Cycle - Fetch
 // 2 Cycles - flag is set then jump
 // 3 Cycles - Crossing page
-static inline void Branch_If(s32 *cycles, u8 flag, u8 expected)
+static inline void Branch_If(s32 *cycles, u16 target, bool condition)
 {
-    const s8 jump_offset = Fetch_Signed_Byte(cycles);
-    if (flag == expected)
+    if (condition)
     {
-        const u16 old_program_counter = cpu.program_counter;
-        cpu.program_counter += jump_offset;
-        (*cycles) -= 1;
-
-        const bool page_change = (cpu.program_counter >> 8) != (old_program_counter >> 8);
-        if (page_change)
-        {
-            (*cycles) -= 1;
-        }
+        const bool page_change = (cpu.program_counter >> 8) != (target >> 8);
+        cpu.program_counter    = target;
+        (*cycles) -= 1 + page_change;
     }
+    H6502_COVERAGE_EDGE(cpu.program_counter);
 }
 
-/*	reg (register) - The A,X or Y Register */
-static inline void Set_Zero_and_Negative_Flags(u8 reg)
+/* Sets the processor status for a CMP/CPX/CPY instruction */
+static inline void Register_Compare(u8 operand, u8 register_value)
 {
-    cpu.Z = (reg == 0);
-    cpu.N = (reg & NEGATIVE_FLAG_BIT) > 0;
+    const u8 temp = register_value - operand;
+    cpu.N         = ((temp & NEGATIVE_FLAG_BIT) > 0);
+    cpu.Z         = (register_value == operand);
+    cpu.C         = (register_value >= operand);
 }
 
-/* Do add with carry given the the operand */
-static inline void ADC(u8 operand)
+/* Binary add with carry, sets C and V, returns the 9-bit sum */
+static inline u16 Add_Binary(u8 operand)
 {
-    assert(cpu.D == false && "haven't handled decimal mode!");
-
     const bool AreSignBitsTheSame = !((cpu.accumulator ^ operand) & NEGATIVE_FLAG_BIT);
     u16        sum                = cpu.accumulator;
     sum += operand;
     sum += cpu.C;
 
+    cpu.C = sum > 0xFF;
+    cpu.V = AreSignBitsTheSame && ((cpu.accumulator ^ sum) & NEGATIVE_FLAG_BIT);
+    return sum;
+}
+
+// Decimal mode
+// > http://www.6502.org/tutorials/decimal_mode.html (Appendix A)
+// The NMOS 6502 sets Z from the binary result and N from the intermediate
+// result, the 65C02 sets both from the decimal result and takes 1 extra cycle.
+static inline void ADC_Decimal(s32 *cycles, u8 operand)
+{
+    s16 low = (cpu.accumulator & 0x0F) + (operand & 0x0F) + cpu.C;
+    if (low >= 0x0A)
+        low = ((low + 0x06) & 0x0F) + 0x10;
+
+    // Sequence 2 : the signed intermediate result gives N and V
+    const s16 signed_sum = (s16)(s8)(cpu.accumulator & 0xF0) + (s16)(s8)(operand & 0xF0) + low;
+
+    s16 sum = (cpu.accumulator & 0xF0) + (operand & 0xF0) + low;
+    if (sum >= 0xA0)
+        sum += 0x60;
+
+#if H6502_IS_CMOS
+    (*cycles) -= 1;
+#else
+    (void)cycles;
+    cpu.Z = ((cpu.accumulator + operand + cpu.C) & 0xFF) == 0;
+    cpu.N = (signed_sum & NEGATIVE_FLAG_BIT) > 0;
+#endif
+    cpu.V           = signed_sum < -128 || signed_sum > 127;
+    cpu.C           = sum >= 0x100;
     cpu.accumulator = (sum & 0xFF);
+#if H6502_IS_CMOS
+    Set_Zero_and_Negative_Flags(cpu.accumulator);
+#endif
+}
+
+static inline void SBC_Decimal(s32 *cycles, u8 operand)
+{
+    const u8  borrow = !cpu.C;
+    const s16 low    = (cpu.accumulator & 0x0F) - (operand & 0x0F) - borrow;
+
+#if H6502_IS_CMOS
+    s16 result = cpu.accumulator - operand - borrow;
+    if (result < 0)
+        result -= 0x60;
+    if (low < 0)
+        result -= 0x06;
+    (*cycles) -= 1;
+#else
+    (void)cycles;
+    s16 result = (cpu.accumulator & 0xF0) - (operand & 0xF0) + ((low < 0) ? (((low - 0x06) & 0x0F) - 0x10) : low);
+    if (result < 0)
+        result -= 0x60;
+#endif
 
+    // Carry and overflow are the same as for a binary subtract
+    const u16 binary = Add_Binary(~operand);
+#if H6502_IS_CMOS
+    (void)binary;
+    cpu.accumulator = (result & 0xFF);
     Set_Zero_and_Negative_Flags(cpu.accumulator);
+#else
+    // the NMOS 6502 sets N and Z from the binary result
+    Set_Zero_and_Negative_Flags(binary & 0xFF);
+    cpu.accumulator = (result & 0xFF);
+#endif
+}
 
-    cpu.C = sum > 0xFF;
-    cpu.V = AreSignBitsTheSame && ((cpu.accumulator ^ operand) & NEGATIVE_FLAG_BIT);
+/* Do add with carry given the the operand */
+static inline void ADC(s32 *cycles, u8 operand)
+{
+    if (cpu.D)
+    {
+        ADC_Decimal(cycles, operand);
+        return;
+    }
+
+    cpu.accumulator = (Add_Binary(operand) & 0xFF);
+    Set_Zero_and_Negative_Flags(cpu.accumulator);
 };
 
 /* Do subtract with carry given the the operand */
-//#define SBC(OPERAND) ADC(~(OPERAND))
-void SBC(u8 operand)
+static inline void SBC(s32 *cycles, u8 operand)
 {
-    ADC(~operand);
-};
+    if (cpu.D)
+    {
+        SBC_Decimal(cycles, operand);
+        return;
+    }
 
-/* Sets the processor status for a CMP/CPX/CPY instruction */
-static inline void Register_Compare(u8 operand, u8 register_value)
-{
-    const u8 temp = register_value - operand;
-    cpu.N         = ((temp & NEGATIVE_FLAG_BIT) > 0);
-    cpu.Z         = (register_value == operand);
-    cpu.C         = (register_value >= operand);
-}
+    ADC(cycles, ~operand);
+};
 
 /* Arithmetic shift left */
-static inline u8 ASL(s32 *cycles, u8 operand)
+static inline u8 ASL(u8 operand)
 {
     cpu.C           = (operand & NEGATIVE_FLAG_BIT) > 0;
     const u8 result = operand << 1;
     Set_Zero_and_Negative_Flags(result);
-    (*cycles)--;
     return result;
 };
 
 /* Logical shift right */
-static inline u8 LSR(s32 *cycles, u8 operand)
+static inline u8 LSR(u8 operand)
 {
     cpu.C           = (operand & ZERO_BIT) > 0;
     const u8 result = operand >> 1;
     Set_Zero_and_Negative_Flags(result);
-    (*cycles)--;
     return result;
 };
 
 /* Rotate left */
-static inline u8 ROL(s32 *cycles, u8 operand)
+static inline u8 ROL(u8 operand)
 {
     const u8 new_bit_0 = cpu.C ? ZERO_BIT : 0;
     cpu.C              = (operand & NEGATIVE_FLAG_BIT) > 0;
     operand            = operand << 1;
     operand |= new_bit_0;
     Set_Zero_and_Negative_Flags(operand);
-    (*cycles)--;
     return operand;
 };
 
 /* Rotate right */
-static inline u8 ROR(s32 *cycles, u8 operand)
+static inline u8 ROR(u8 operand)
 {
     const bool OldBit0 = (operand & ZERO_BIT) > 0;
     operand            = operand >> 1;
@@ -758,1080 +804,1055 @@ static inline u8 ROR(s32 *cycles, u8 operand)
     {
         operand |= NEGATIVE_FLAG_BIT;
     }
-    (*cycles)--;
     cpu.C = OldBit0;
     Set_Zero_and_Negative_Flags(operand);
     return operand;
 };
 
-// execute "number_of_cycles" the instruction in memory
-inline s32 Execute(s32 number_of_cycles)
+/* BIT - Z from A & M, N and V are copied from bits 7 and 6 of M */
+static inline void Bit_Test(u8 value)
 {
-    const s32 number_of_cycles_requested = number_of_cycles;
+    cpu.Z = !(cpu.accumulator & value);
+    cpu.N = (value & NEGATIVE_FLAG_BIT) != 0;
+    cpu.V = (value & OVERFLOW_FLAG_BIT) != 0;
+}
 
-    bool bad_instruction = false;
-    while (number_of_cycles > 0 && bad_instruction == false)
-    {
-        const u8 instruction = Fetch_Byte(&number_of_cycles); // -1 cycle]
-#if 0
-        printf("Instruction loaded : 0x%X", instruction);
+// ---------------------------------------------------------------------
+// Operations
+// One per "operation" column of the opcode table, "address" is the
+// effective address from the addressing mode. Only extra cycles (taken
+// branches, 65C02 decimal mode) are taken off "cycles".
+
+#define OPERATION(name) static inline void Operation_##name(H6502_UNUSED s32 *cycles, H6502_UNUSED u16 address)
+
+// LDA/LDX/LDY - Load register
+OPERATION(LDA)
+{
+    cpu.accumulator = Read_Byte(address);
+    Set_Zero_and_Negative_Flags(cpu.accumulator);
+}
+OPERATION(LDX)
+{
+    cpu.index_reg_X = Read_Byte(address);
+    Set_Zero_and_Negative_Flags(cpu.index_reg_X);
+}
+OPERATION(LDY)
+{
+    cpu.index_reg_Y = Read_Byte(address);
+    Set_Zero_and_Negative_Flags(cpu.index_reg_Y);
+}
+
+// STA/STX/STY - Store register
+OPERATION(STA)
+{
+    Write_Byte(cpu.accumulator, address);
+}
+OPERATION(STX)
+{
+    Write_Byte(cpu.index_reg_X, address);
+}
+OPERATION(STY)
+{
+    Write_Byte(cpu.index_reg_Y, address);
+}
+
+// JMP - JuMP
+OPERATION(JMP)
+{
+    cpu.program_counter = address;
+    H6502_COVERAGE_EDGE(cpu.program_counter);
+}
+
+// JSR - Jump to SubRoutine
+//  1    PC     R  fetch opcode, increment PC
+//  2    PC     R  fetch low address byte, increment PC
+//  3  $0100,S  R  internal operation (predecrement S?)
+//  4  $0100,S  W  push PCH on stack, decrement S
+//  5  $0100,S  W  push PCL on stack, decrement S
+//  6    PC     R  copy low address byte to PCL, fetch high address byte to PCH
+OPERATION(JSR)
+{
+    // Push the PC-1 onto the stack
+    Push_Word_To_Stack(cpu.program_counter - 1);
+    cpu.program_counter = address;
+    H6502_COVERAGE_EDGE(cpu.program_counter);
+}
+
+// RTS - ReTurn from Subroutine
+// Pull top two bytes off the stack (PCL first), move to address + 1
+OPERATION(RTS)
+{
+    cpu.program_counter = (Pop_Word_From_Stack() + 1) & 0xFFFF;
+    H6502_COVERAGE_EDGE(cpu.program_counter);
+}
+
+// BRK - BReaK
+// Pushes PC+1 (the byte after BRK is padding) and the status with B set,
+// then jumps through the IRQ/BRK vector at $FFFE
+OPERATION(BRK)
+{
+    Push_Word_To_Stack(cpu.program_counter + 1);
+    Push_Byte_Onto_Stack(cpu.PS | BREAK_FLAG_BIT | unused_FLAG_BIT);
+    cpu.I = 1;
+#if H6502_IS_CMOS
+    cpu.D = 0;
 #endif
-        switch (instruction)
-        {
-            // LDA - Load Accumulator
-        case INS_LDA_IM: // 2 Cycles
-        {
-            cpu.accumulator = Fetch_Byte(&number_of_cycles); // -1 cycle
-            Load_Register_Set_Status(cpu.accumulator);
+    cpu.program_counter = Read_Word(0xFFFE);
+    H6502_COVERAGE_EDGE(cpu.program_counter);
+}
 
-            break;
-        }
-        case INS_LDA_ZP: // 3 Cycles
-        {
-            const u8 zero_page_address = Address_Zero_Page(&number_of_cycles);
-            Load_Register(&number_of_cycles, &cpu.accumulator, zero_page_address);
-            break;
-        }
-        case INS_LDA_ZP_X: // 4 Cycles
-        {
-            const u16 zero_page_x_address = Address_Zero_Page_X(&number_of_cycles);
-            Load_Register(&number_of_cycles, &cpu.accumulator, zero_page_x_address);
+// RTI - ReTurn from Interrupt
+OPERATION(RTI)
+{
+    cpu.PS              = (Pop_Byte_From_Stack() & ~BREAK_FLAG_BIT) | unused_FLAG_BIT;
+    cpu.program_counter = Pop_Word_From_Stack();
+    H6502_COVERAGE_EDGE(cpu.program_counter);
+}
 
-            break;
-        }
-        case INS_LDA_ABS: // 4 Cycles
-        {
-            //  1    PC     R  fetch opcode, increment PC
-            //  2    PC     R  fetch low byte of address, increment PC
-            //  3    PC     R  fetch high byte of address, increment PC
-            //  4  address  R  read from effective address
-            const u16 absolute_address = Address_Absolute(&number_of_cycles);
-            Load_Register(&number_of_cycles, &cpu.accumulator, absolute_address);
-            break;
-        }
-        case INS_LDA_ABS_X: // 4 Cycles (+1 if page crossed)
-        {
-            const u16 absolute_address = Address_Absolute_X(&number_of_cycles); // 2 cycles
-            Load_Register(&number_of_cycles, &cpu.accumulator, absolute_address);
-            break;
-        }
-        case INS_LDA_ABS_Y: // 4 Cycles (+1 if page crossed)
-        {
-            const u16 absolute_address = Address_Absolute_Y(&number_of_cycles); // 2 cycles
-            Load_Register(&number_of_cycles, &cpu.accumulator, absolute_address);
-            break;
-        }
-        case INS_LDA_IND_X: // 6 Cycles
-        {
-            //  1      PC       R  fetch opcode, increment PC
-            //  2      PC       R  fetch pointer address, increment PC
-            //  3    pointer    R  read from the address, add X to it
-            //  4   pointer+X   R  fetch effective address low
-            //  5  pointer+X+1  R  fetch effective address high
-            //  6    address    R  read from effective address
-
-            const u16 effective_address = Address_Indirect_X(&number_of_cycles);
-            Load_Register(&number_of_cycles, &cpu.accumulator, effective_address);
-            break;
-        }
-        case INS_LDA_IND_Y: // 5 Cycles (+1 if page crossed)
-        {
-            const u16 effective_address = Address_Indirect_Y(&number_of_cycles);
-            Load_Register(&number_of_cycles, &cpu.accumulator, effective_address);
-            break;
-        }
-            // LDX - Load X Register
-        case INS_LDX_IM:
-        {
-            cpu.index_reg_X = Fetch_Byte(&number_of_cycles); // -1 cycle
-            Load_Register_Set_Status(cpu.index_reg_X);
-            break;
-        }
-        case INS_LDX_ZP:
-        {
-            const u8 zero_page_address = Address_Zero_Page(&number_of_cycles);
-            Load_Register(&number_of_cycles, &cpu.index_reg_X, zero_page_address);
-            break;
-        }
-        case INS_LDX_ZP_Y:
-        {
-            const u16 zero_page_y_address = Address_Zero_Page_Y(&number_of_cycles);
-            Load_Register(&number_of_cycles, &cpu.index_reg_X, zero_page_y_address);
-            break;
-        }
-        case INS_LDX_ABS:
-        {
-            const u16 absolute_address = Address_Absolute(&number_of_cycles); // 2 cycles
-            Load_Register(&number_of_cycles, &cpu.index_reg_X, absolute_address);
-            break;
-        }
-        case INS_LDX_ABS_Y:
-        {
-            const u16 absolute_address = Address_Absolute_Y(&number_of_cycles); // 2 cycles
-            Load_Register(&number_of_cycles, &cpu.index_reg_X, absolute_address);
-            break;
-        }
-            // LDY - Load Y Register
-        case INS_LDY_IM:
-        {
-            cpu.index_reg_Y = Fetch_Byte(&number_of_cycles); // -1 cycle
-            Load_Register_Set_Status(cpu.index_reg_Y);
-            break;
-        }
-        case INS_LDY_ZP:
-        {
-            const u8 zero_page_address = Address_Zero_Page(&number_of_cycles);
-            Load_Register(&number_of_cycles, &cpu.index_reg_Y, zero_page_address);
-            break;
-        }
-        case INS_LDY_ZP_X:
-        {
-            const u16 zero_page_x_address = Address_Zero_Page_X(&number_of_cycles);
-            Load_Register(&number_of_cycles, &cpu.index_reg_Y, zero_page_x_address);
-            break;
-        }
-        case INS_LDY_ABS:
-        {
-            const u16 absolute_address = Address_Absolute(&number_of_cycles); // 2 cycles
-            Load_Register(&number_of_cycles, &cpu.index_reg_Y, absolute_address);
-            break;
-        }
-        case INS_LDY_ABS_X:
-        {
-            const u16 absolute_address = Address_Absolute_X(&number_of_cycles); // 2 cycles
-            Load_Register(&number_of_cycles, &cpu.index_reg_Y, absolute_address);
-            break;
-        }
-            // STA - Store Accumulator
-        case INS_STA_ZP: // 3 cycles
-        {
-            // STore Accumulator _ ZP value
-            // 1    PC     R  fetch opcode, increment PC
-            // 2    PC     R  fetch address, increment PC
-            // 3  address  W  write register to effective address
-            const u16 effective_address = Address_Zero_Page(&number_of_cycles); // 1 cycle
-            Write_Byte(&number_of_cycles, cpu.accumulator, effective_address);
-            break;
-        }
-        case INS_STA_ZP_X: // 4 cycles
-        {
-            const u16 effective_address = Address_Zero_Page_X(&number_of_cycles); // 2 cycles
-            Write_Byte(&number_of_cycles, cpu.accumulator, effective_address);
-            break;
-        }
-        case INS_STA_ABS: // 4 cycles
-        {
-            const u16 effective_address = Address_Absolute(&number_of_cycles); // 2 cycles
-            Write_Byte(&number_of_cycles, cpu.accumulator, effective_address);
-            break;
-        }
-        case INS_STA_ABS_X: // 5 cycles
-        {
-            const u16 effective_address = Address_Absolute_X_5_Cycle(&number_of_cycles); // 2 cycles
-            Write_Byte(&number_of_cycles, cpu.accumulator, effective_address);           // 1 cycle
-            break;
-        }
-        case INS_STA_ABS_Y: // 5 cycles
-        {
-            const u16 effective_address = Address_Absolute_Y_5_Cycle(&number_of_cycles); // 2 cycles
-            Write_Byte(&number_of_cycles, cpu.accumulator, effective_address);           // 1 cycle
-            break;
-        }
-        case INS_STA_IND_X: // 6 cycles
-        {
-            const u16 effective_address = Address_Indirect_X(&number_of_cycles); // 4 cycles
-            Write_Byte(&number_of_cycles, cpu.accumulator, effective_address);
-            break;
-        }
-        case INS_STA_IND_Y: // 6 cycles
-        {
-            const u16 effective_address = Address_Indirect_Y_6_Cycles(&number_of_cycles); // 4 cycles
-            Write_Byte(&number_of_cycles, cpu.accumulator, effective_address);            // 1 cycle
-            break;
-        }
-            // STX - Store X Register
-        case INS_STX_ZP:
-        {
-            const u16 effective_address = Address_Zero_Page(&number_of_cycles); // 1 cycles
-            Write_Byte(&number_of_cycles, cpu.index_reg_X, effective_address);
-            break;
-        }
-        case INS_STX_ZP_Y:
-        {
-            const u16 effective_address = Address_Zero_Page_Y(&number_of_cycles); // 2 cycles
-            Write_Byte(&number_of_cycles, cpu.index_reg_X, effective_address);
-            break;
-        }
-        case INS_STX_ABS:
-        {
-            const u16 effective_address = Address_Absolute(&number_of_cycles); // 2 cycles
-            Write_Byte(&number_of_cycles, cpu.index_reg_X, effective_address);
-            break;
-        }
-            // STY - Store Y Register
-        case INS_STY_ZP:
-        {
-            const u16 effective_address = Address_Zero_Page(&number_of_cycles); // 1 cycles
-            Write_Byte(&number_of_cycles, cpu.index_reg_Y, effective_address);
-            break;
-        }
-        case INS_STY_ZP_X:
-        {
-            const u16 effective_address = Address_Zero_Page_X(&number_of_cycles); // 2 cycles
-            Write_Byte(&number_of_cycles, cpu.index_reg_Y, effective_address);
-            break;
-        }
-        case INS_STY_ABS:
-        {
-            const u16 effective_address = Address_Absolute(&number_of_cycles); // 2 cycles
-            Write_Byte(&number_of_cycles, cpu.index_reg_Y, effective_address);
-            break;
-        }
+// - Register Instructions -
+OPERATION(TAX) // Transfer Accumulator to Index X
+{
+    cpu.index_reg_X = cpu.accumulator;
+    Set_Zero_and_Negative_Flags(cpu.index_reg_X);
+}
+OPERATION(TXA) // Transfer Index X to Accumulator
+{
+    cpu.accumulator = cpu.index_reg_X;
+    Set_Zero_and_Negative_Flags(cpu.accumulator);
+}
+OPERATION(TAY) // Transfer Accumulator to Index Y
+{
+    cpu.index_reg_Y = cpu.accumulator;
+    Set_Zero_and_Negative_Flags(cpu.index_reg_Y);
+}
+OPERATION(TYA) // Transfer Index Y to Accumulator
+{
+    cpu.accumulator = cpu.index_reg_Y;
+    Set_Zero_and_Negative_Flags(cpu.accumulator);
+}
+OPERATION(DEX) // (DEcrement X)
+{
+    cpu.index_reg_X--;
+    Set_Zero_and_Negative_Flags(cpu.index_reg_X);
+}
+OPERATION(INX) // (INcrement X)
+{
+    cpu.index_reg_X++;
+    Set_Zero_and_Negative_Flags(cpu.index_reg_X);
+}
+OPERATION(DEY) // (DEcrement Y)
+{
+    cpu.index_reg_Y--;
+    Set_Zero_and_Negative_Flags(cpu.index_reg_Y);
+}
+OPERATION(INY) // (INcrement Y)
+{
+    cpu.index_reg_Y++;
+    Set_Zero_and_Negative_Flags(cpu.index_reg_Y);
+}
+
+// - Stack Instructions -
+OPERATION(TSX) // Transfer Stack Pointer to Index X
+{
+    cpu.index_reg_X = cpu.stack_pointer;
+    Set_Zero_and_Negative_Flags(cpu.index_reg_X);
+}
+OPERATION(TXS) // Transfer Index X to Stack Register
+{
+    cpu.stack_pointer = cpu.index_reg_X;
+}
+OPERATION(PHA) // Push Accumulator on Stack
+{
+    Push_Byte_Onto_Stack(cpu.accumulator);
+}
+OPERATION(PLA) // Pull Accumulator from Stack
+{
+    cpu.accumulator = Pop_Byte_From_Stack();
+    Set_Zero_and_Negative_Flags(cpu.accumulator);
+}
+OPERATION(PHP) // Push Processor Status on Stack
+{
+    Push_Byte_Onto_Stack(cpu.PS);
+}
+OPERATION(PLP) // Pull Processor Status from Stack
+{
+    cpu.PS = Pop_Byte_From_Stack();
+}
+
+// ORA/AND/EOR - Logical operations with the accumulator
+OPERATION(ORA)
+{
+    cpu.accumulator |= Read_Byte(address);
+    Set_Zero_and_Negative_Flags(cpu.accumulator);
+}
+OPERATION(AND)
+{
+    cpu.accumulator &= Read_Byte(address);
+    Set_Zero_and_Negative_Flags(cpu.accumulator);
+}
+OPERATION(EOR)
+{
+    cpu.accumulator ^= Read_Byte(address);
+    Set_Zero_and_Negative_Flags(cpu.accumulator);
+}
+
+// BIT - test BITs
+OPERATION(BIT)
+{
+    Bit_Test(Read_Byte(address));
+}
+
+// DEC/INC - DECrement/INCrement memory
+OPERATION(DEC)
+{
+    const u8 value = Read_Byte(address) - 1;
+    Write_Byte(value, address);
+    Set_Zero_and_Negative_Flags(value);
+}
+OPERATION(INC)
+{
+    const u8 value = Read_Byte(address) + 1;
+    Write_Byte(value, address);
+    Set_Zero_and_Negative_Flags(value);
+}
+
+// Branch Instructions
+OPERATION(BPL) // BPL (Branch on PLus)
+{
+    Branch_If(cycles, address, cpu.N == 0);
+}
+OPERATION(BMI) // BMI (Branch on MInus)
+{
+    Branch_If(cycles, address, cpu.N == 1);
+}
+OPERATION(BVC) // BVC (Branch on oVerflow Clear)
+{
+    Branch_If(cycles, address, cpu.V == 0);
+}
+OPERATION(BVS) // BVS (Branch on oVerflow Set)
+{
+    Branch_If(cycles, address, cpu.V == 1);
+}
+OPERATION(BCC) // BCC (Branch on Carry Clear)
+{
+    Branch_If(cycles, address, cpu.C == 0);
+}
+OPERATION(BCS) // BCS (Branch on Carry Set)
+{
+    Branch_If(cycles, address, cpu.C == 1);
+}
+OPERATION(BNE) // BNE (Branch on Not Equal)
+{
+    Branch_If(cycles, address, cpu.Z == 0);
+}
+OPERATION(BEQ) // BEQ (Branch on EQual)
+{
+    Branch_If(cycles, address, cpu.Z == 1);
+}
+
+// Flag (Processor Status) Instructions
+OPERATION(CLC) // (CLear Carry)
+{
+    cpu.C = 0;
+}
+OPERATION(SEC) // (SEt Carry)
+{
+    cpu.C = 1;
+}
+OPERATION(CLI) // (CLear Interrupt)
+{
+    cpu.I = 0;
+}
+OPERATION(SEI) // (SEt Interrupt)
+{
+    cpu.I = 1;
+}
+OPERATION(CLV) // (CLear oVerflow)
+{
+    cpu.V = 0;
+}
+OPERATION(CLD) // (CLear Decimal)
+{
+    cpu.D = 0;
+}
+OPERATION(SED) // (SEt Decimal)
+{
+    cpu.D = 1;
+}
+
+// NOP (No OPeration)
+OPERATION(NOP)
+{
+}
+
+// ADC/SBC - ADd/SuBtract with Carry
+OPERATION(ADC)
+{
+    ADC(cycles, Read_Byte(address));
+}
+OPERATION(SBC)
+{
+    SBC(cycles, Read_Byte(address));
+}
+
+// CMP/CPX/CPY - Compare register
+OPERATION(CMP)
+{
+    Register_Compare(Read_Byte(address), cpu.accumulator);
+}
+OPERATION(CPX)
+{
+    Register_Compare(Read_Byte(address), cpu.index_reg_X);
+}
+OPERATION(CPY)
+{
+    Register_Compare(Read_Byte(address), cpu.index_reg_Y);
+}
+
+// ASL/LSR/ROL/ROR - Shifts, on memory or on the accumulator (_A)
+OPERATION(ASL)
+{
+    Write_Byte(ASL(Read_Byte(address)), address);
+}
+OPERATION(ASL_A)
+{
+    cpu.accumulator = ASL(cpu.accumulator);
+}
+OPERATION(LSR)
+{
+    Write_Byte(LSR(Read_Byte(address)), address);
+}
+OPERATION(LSR_A)
+{
+    cpu.accumulator = LSR(cpu.accumulator);
+}
+OPERATION(ROL)
+{
+    Write_Byte(ROL(Read_Byte(address)), address);
+}
+OPERATION(ROL_A)
+{
+    cpu.accumulator = ROL(cpu.accumulator);
+}
+OPERATION(ROR)
+{
+    Write_Byte(ROR(Read_Byte(address)), address);
+}
+OPERATION(ROR_A)
+{
+    cpu.accumulator = ROR(cpu.accumulator);
+}
+
+#if H6502_IS_CMOS
+// - 65C02 Instructions -
+OPERATION(STZ) // STore Zero
+{
+    Write_Byte(0, address);
+}
+OPERATION(BRA) // BRanch Always
+{
+    Branch_If(cycles, address, true);
+}
+OPERATION(PHX) // PusH X register
+{
+    Push_Byte_Onto_Stack(cpu.index_reg_X);
+}
+OPERATION(PLX) // PuLl X register
+{
+    cpu.index_reg_X = Pop_Byte_From_Stack();
+    Set_Zero_and_Negative_Flags(cpu.index_reg_X);
+}
+OPERATION(PHY) // PusH Y register
+{
+    Push_Byte_Onto_Stack(cpu.index_reg_Y);
+}
+OPERATION(PLY) // PuLl Y register
+{
+    cpu.index_reg_Y = Pop_Byte_From_Stack();
+    Set_Zero_and_Negative_Flags(cpu.index_reg_Y);
+}
+// TSB/TRB - Test and Set/Reset Bits, Z is set from A & M before the write
+OPERATION(TSB)
+{
+    const u8 value = Read_Byte(address);
+    cpu.Z          = !(cpu.accumulator & value);
+    Write_Byte(value | cpu.accumulator, address);
+}
+OPERATION(TRB)
+{
+    const u8 value = Read_Byte(address);
+    cpu.Z          = !(cpu.accumulator & value);
+    Write_Byte(value & ~cpu.accumulator, address);
+}
+OPERATION(INC_A) // INC A (INCrement accumulator)
+{
+    cpu.accumulator++;
+    Set_Zero_and_Negative_Flags(cpu.accumulator);
+}
+OPERATION(DEC_A) // DEC A (DECrement accumulator)
+{
+    cpu.accumulator--;
+    Set_Zero_and_Negative_Flags(cpu.accumulator);
+}
+OPERATION(BIT_IM) // Immediate BIT only affects the zero flag
+{
+    cpu.Z = !(cpu.accumulator & Read_Byte(address));
+}
+#endif
+
+#if H6502_HAS_UNDOCUMENTED
+// - Undocumented NMOS Instructions -
+// > https://www.masswerk.at/nowgobang/2021/6502-illegal-opcodes
+OPERATION(LAX) // LDA + LDX
+{
+    cpu.accumulator = Read_Byte(address);
+    cpu.index_reg_X = cpu.accumulator;
+    Set_Zero_and_Negative_Flags(cpu.accumulator);
+}
+OPERATION(SAX) // store A & X
+{
+    Write_Byte(cpu.accumulator & cpu.index_reg_X, address);
+}
+
+// Read-modify-write instructions, each one is a documented RMW instruction
+// followed by an accumulator operation on the new value
+OPERATION(DCP) // DEC + CMP
+{
+    const u8 value = Read_Byte(address) - 1;
+    Write_Byte(value, address);
+    Register_Compare(value, cpu.accumulator);
+}
+OPERATION(ISC) // INC + SBC
+{
+    const u8 value = Read_Byte(address) + 1;
+    Write_Byte(value, address);
+    SBC(cycles, value);
+}
+OPERATION(SLO) // ASL + ORA
+{
+    const u8 value = ASL(Read_Byte(address));
+    Write_Byte(value, address);
+    cpu.accumulator |= value;
+    Set_Zero_and_Negative_Flags(cpu.accumulator);
+}
+OPERATION(RLA) // ROL + AND
+{
+    const u8 value = ROL(Read_Byte(address));
+    Write_Byte(value, address);
+    cpu.accumulator &= value;
+    Set_Zero_and_Negative_Flags(cpu.accumulator);
+}
+OPERATION(SRE) // LSR + EOR
+{
+    const u8 value = LSR(Read_Byte(address));
+    Write_Byte(value, address);
+    cpu.accumulator ^= value;
+    Set_Zero_and_Negative_Flags(cpu.accumulator);
+}
+OPERATION(RRA) // ROR + ADC
+{
+    const u8 value = ROR(Read_Byte(address));
+    Write_Byte(value, address);
+    ADC(cycles, value);
+}
+#endif
+
+#undef OPERATION
+
+// ---------------------------------------------------------------------
+// Instructions, one function per opcode generated from the opcode table:
+// addressing mode -> base cycles (+ page cross penalty) -> operation
+
+// With the counters in them the instructions get big enough that GCC stops
+// inlining the common ones into the engines, which costs more than counting
+#if H6502_OPCODE_STATS
+#define H6502_INSTRUCTION_INLINE  H6502_FORCE_INLINE
+#define H6502_STATS_START(cycles) const s32 cycles_before = *(cycles);
+#define H6502_STATS_RECORD(opcode, mode, base_cycles, page_penalty, cycles) \
+    Opcode_Stats_Record(opcode, MODE_##mode, base_cycles, (page_penalty) & page_crossed, cycles_before - *(cycles));
+#else
+#define H6502_INSTRUCTION_INLINE inline
+#define H6502_STATS_START(cycles)
+#define H6502_STATS_RECORD(opcode, mode, base_cycles, page_penalty, cycles)
+#endif
+
+#define H6502_INSTRUCTION(name, mnemonic, opcode, mode, bytes, base_cycles, page_penalty, operation) \
+    static H6502_INSTRUCTION_INLINE void Instruction_##name(s32 *cycles)                              \
+    {                                                                                                 \
+        H6502_STATS_START(cycles)                                                                     \
+        bool      page_crossed = false;                                                               \
+        const u16 address      = Address_Mode_##mode(&page_crossed);                                  \
+        (*cycles) -= base_cycles + (page_penalty & page_crossed);                                     \
+        Operation_##operation(cycles, address);                                                       \
+        H6502_STATS_RECORD(opcode, mode, base_cycles, page_penalty, cycles)                           \
+    }
+H6502_OPCODE_TABLE(H6502_INSTRUCTION)
+#undef H6502_INSTRUCTION
+#undef H6502_INSTRUCTION_INLINE
+#undef H6502_STATS_START
+#undef H6502_STATS_RECORD
+
+// ---------------------------------------------------------------------
+// Opcode information tables, generated from the opcode table.
+// Opcodes that are not part of the selected variant have 0 cycles/bytes and
+// a NULL mnemonic.
+
+static inline u8 Opcode_Cycles(u8 opcode)
+{
+#define H6502_CYCLES_ENTRY(name, mnemonic, opcode, mode, bytes, base_cycles, ...) [opcode] = base_cycles,
+    static const uint8_t cycles[256] = {H6502_OPCODE_TABLE(H6502_CYCLES_ENTRY)};
+#undef H6502_CYCLES_ENTRY
+    return cycles[opcode];
+}
+
+static inline u8 Opcode_Bytes(u8 opcode)
+{
+#define H6502_BYTES_ENTRY(name, mnemonic, opcode, mode, bytes, ...) [opcode] = bytes,
+    static const uint8_t bytes[256] = {H6502_OPCODE_TABLE(H6502_BYTES_ENTRY)};
+#undef H6502_BYTES_ENTRY
+    return bytes[opcode];
+}
+
+static inline bool Opcode_Page_Penalty(u8 opcode)
+{
+#define H6502_PENALTY_ENTRY(name, mnemonic, opcode, mode, bytes, base_cycles, page_penalty, ...) [opcode] = page_penalty,
+    static const uint8_t page_penalty[256] = {H6502_OPCODE_TABLE(H6502_PENALTY_ENTRY)};
+#undef H6502_PENALTY_ENTRY
+    return page_penalty[opcode];
+}
+
+static inline Address_Mode Opcode_Address_Mode(u8 opcode)
+{
+#define H6502_MODE_ENTRY(name, mnemonic, opcode, mode, ...) [opcode] = MODE_##mode,
+    static const uint8_t modes[256] = {H6502_OPCODE_TABLE(H6502_MODE_ENTRY)};
+#undef H6502_MODE_ENTRY
+    return (Address_Mode)modes[opcode];
+}
+
+static inline const char *Opcode_Mnemonic(u8 opcode)
+{
+#define H6502_MNEMONIC_ENTRY(name, mnemonic, opcode, ...) [opcode] = #mnemonic,
+    static const char *const mnemonics[256] = {H6502_OPCODE_TABLE(H6502_MNEMONIC_ENTRY)};
+#undef H6502_MNEMONIC_ENTRY
+    return mnemonics[opcode];
+}
+
+static inline bool Opcode_Is_Valid(u8 opcode)
+{
+    return Opcode_Mnemonic(opcode) != NULL;
+}
+
+static inline const char *Address_Mode_Name(Address_Mode mode)
+{
+#define H6502_MODE_NAME_ENTRY(mode) [MODE_##mode] = #mode,
+    static const char *const names[MODE_COUNT] = {H6502_ADDRESS_MODES(H6502_MODE_NAME_ENTRY)};
+#undef H6502_MODE_NAME_ENTRY
+    return (mode < MODE_COUNT) ? names[mode] : "?";
+}
+
+#if H6502_OPCODE_STATS
+// ---------------------------------------------------------------------
+// Opcode statistics export
+
+static inline void Opcode_Stats_Reset(void)
+{
+    memset(&opcode_stats, 0, sizeof(opcode_stats));
+}
+
+// All the cycles the opcode took, including page cross and branch cycles
+static inline uint64_t Opcode_Stats_Cycles(u8 opcode)
+{
+    const Opcode_Counters *counters = &opcode_stats.counters[opcode];
+    return counters->executions * Opcode_Cycles(opcode) + counters->page_crossings + counters->extra_cycles;
+}
+
+static inline uint64_t Opcode_Stats_Branches_Not_Taken(u8 opcode)
+{
+    if (Opcode_Address_Mode(opcode) != MODE_REL)
+        return 0;
+    return opcode_stats.counters[opcode].executions - opcode_stats.counters[opcode].branches_taken;
+}
 
-        // JMP - JuMP
-        case INS_JMP_ABS:
-        {
-            const u16 address   = Address_Absolute(&number_of_cycles);
-            cpu.program_counter = address;
-            break;
-        }
-        case INS_JMP_IND:
-        {
-            /*
-                1     PC      R  fetch opcode, increment PC
-                2     PC      R  fetch pointer address low, increment PC
-                3     PC      R  fetch pointer address high, increment PC
-                4   pointer   R  fetch low address to latch
-                5  pointer+1* R  fetch PCH, copy latch to PCL
-
-                The PCH will always be fetched from the same page
-                than PCL, i.e. page boundary crossing is not handled.
-            */
-            const u16 address   = Address_Absolute(&number_of_cycles);
-            cpu.program_counter = Read_Word(&number_of_cycles, address);
-            break;
-        }
+// One line per executed opcode
+static inline void Opcode_Stats_Write_CSV(FILE *file)
+{
+    fprintf(file, "opcode,mnemonic,mode,executions,cycles,page_crossings,branches_taken,branches_not_taken\n");
+    for (int opcode = 0; opcode < 256; opcode++)
+    {
+        if (opcode_stats.counters[opcode].executions == 0 || !Opcode_Is_Valid((u8)opcode))
+            continue;
 
-            // JSR - Jump to SubRoutine
-        case INS_JSR: // Jump to Subroutine : Absolute, 0x20, 3bytes, 6 cycles
-        {
-            //  1    PC     R  fetch opcode, increment PC
-            //  2    PC     R  fetch low address byte, increment PC
-            //  3  $0100,S  R  internal operation (predecrement S?)
-            //  4  $0100,S  W  push PCH on stack, decrement S
-            //  5  $0100,S  W  push PCL on stack, decrement S
-            //  6    PC     R  copy low address byte to PCL, fetch high address byte to PCH
-
-            u16 sub_address = Fetch_Word(&number_of_cycles); // (*cycles) -= 2;
-            Push_PC_Minus_One_To_Stack(&number_of_cycles);   // (*cycles) -= 1; x2
-            cpu.program_counter = sub_address;
-            number_of_cycles -= 1;
+        fprintf(file, "0x%02X,%s,%s,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+                opcode, Opcode_Mnemonic((u8)opcode), Address_Mode_Name(Opcode_Address_Mode((u8)opcode)),
+                opcode_stats.counters[opcode].executions, Opcode_Stats_Cycles((u8)opcode), opcode_stats.counters[opcode].page_crossings,
+                opcode_stats.counters[opcode].branches_taken, Opcode_Stats_Branches_Not_Taken((u8)opcode));
+    }
+}
 
-            break;
-        }
-        // RTS - ReTurn from Subroutine
-        case INS_RTS:
-        {
-            //  1    PC     R  fetch opcode, increment PC
-            //  2    PC     R  read next instruction byte (and throw it away)
-            //  3  $0100,S  R  increment S
-            //  4  $0100,S  R  pull PCL from stack, increment S
-            //  5  $0100,S  R  pull PCH from stack
-            //  6    PC     R  increment PC
-
-            // Pull top two bytes off the stack (PCL first)
-            // move to address + 1
-            const u16 return_address = Pop_Word_From_Stack(&number_of_cycles);
-            cpu.program_counter      = return_address + 1;
-            number_of_cycles -= 2;
-            break;
-        }
-        // - Register Instructions -
-        case INS_TAX: // Transfer Accumulator to Index X
-        {
-            cpu.index_reg_X = cpu.accumulator;
-            number_of_cycles -= 1;
-            Load_Register_Set_Status(cpu.accumulator);
-            break;
-        }
-        case INS_TXA: // Transfer Index X to Accumulator
-        {
-            cpu.accumulator = cpu.index_reg_X;
-            number_of_cycles -= 1;
-            Load_Register_Set_Status(cpu.index_reg_X);
-            break;
-        }
-        case INS_TAY: // Transfer Accumulator to Index Y
-        {
-            cpu.index_reg_Y = cpu.accumulator;
-            number_of_cycles -= 1;
-            Load_Register_Set_Status(cpu.index_reg_Y);
-            break;
-        }
-        case INS_TYA: // Transfer Index Y to Accumulator
-        {
-            cpu.accumulator = cpu.index_reg_Y;
-            number_of_cycles -= 1;
-            Load_Register_Set_Status(cpu.index_reg_Y);
-            break;
-        }
-        case INS_DEX: // (DEcrement X)
-        {
-            cpu.index_reg_X--;
-            number_of_cycles -= 1;
-            Load_Register_Set_Status(cpu.index_reg_X);
-            break;
-        }
-        case INS_INX: // (INcrement X)
-        {
-            cpu.index_reg_X++;
-            number_of_cycles -= 1;
-            Load_Register_Set_Status(cpu.index_reg_X);
-            break;
-        }
-        case INS_DEY: // (DEcrement Y)
-        {
-            cpu.index_reg_Y--;
-            number_of_cycles -= 1;
-            Load_Register_Set_Status(cpu.index_reg_Y);
-            break;
-        }
-        case INS_INY: // (INcrement Y)
-        {
-            cpu.index_reg_Y++;
-            number_of_cycles -= 1;
-            Load_Register_Set_Status(cpu.index_reg_Y);
-            break;
-        }
-        // - Stack Instructions -
-        case INS_TSX: // Transfer Stack Pointer to Index X
-        {
-            cpu.index_reg_X = cpu.stack_pointer;
-            Load_Register_Set_Status(cpu.index_reg_X);
-            number_of_cycles -= 1;
-            break;
-        }
-        case INS_TXS: // Transfer Index X to Stack Register
-        {
-            cpu.stack_pointer = cpu.index_reg_X;
-            number_of_cycles -= 1;
-            break;
-        }
-        case INS_PHA: // Push Accumulator on Stack
-        {
-            //  1    PC     R  fetch opcode, increment PC
-            //  2    PC     R  read next instruction byte (and throw it away)
-            //  3  $0100,S  W  push register on stack, decrement S
+// Executed opcodes plus the totals for each addressing mode
+static inline void Opcode_Stats_Write_JSON(FILE *file)
+{
+    uint64_t mode_executions[MODE_COUNT] = {0};
+    uint64_t mode_cycles[MODE_COUNT]     = {0};
 
-            Push_Byte_Onto_Stack(&number_of_cycles, cpu.accumulator);
-            number_of_cycles -= 1;
-            break;
-        }
-        case INS_PLA: // Pull Accumulator from Stack
-        {             // 4 cycles
-            cpu.accumulator = Pop_Byte_From_Stack(&number_of_cycles);
-            Load_Register_Set_Status(cpu.accumulator);
-            number_of_cycles--;
-            break;
-        }
-        case INS_PHP: // Push Processor Status on Stack
-        {
-            Push_Byte_Onto_Stack(&number_of_cycles, cpu.PS);
-            number_of_cycles--;
-            break;
-        }
-        case INS_PLP: // Pull Processor Status from Stack
-        {             // 4 cycles
-            cpu.PS = Pop_Byte_From_Stack(&number_of_cycles);
-            number_of_cycles--;
-            break;
-        }
-        // ORA - OR Memory with Accumulator
-        case INS_ORA_IM:
-        {
-            cpu.accumulator |= Fetch_Byte(&number_of_cycles);
-            Load_Register_Set_Status(cpu.accumulator);
-            break;
-        }
-        case INS_ORA_ZP:
-        {
-            const u16 address = Address_Zero_Page(&number_of_cycles);
-            OR_Register(&number_of_cycles, address);
-            break;
-        }
-        case INS_ORA_ZP_X:
-        {
-            const u16 address = Address_Zero_Page_X(&number_of_cycles);
-            OR_Register(&number_of_cycles, address);
-            break;
-        }
-        case INS_ORA_ABS:
-        {
-            const u16 address = Address_Absolute(&number_of_cycles);
-            OR_Register(&number_of_cycles, address);
-            break;
-        }
-        case INS_ORA_ABS_X:
-        {
-            const u16 address = Address_Absolute_X(&number_of_cycles);
-            OR_Register(&number_of_cycles, address);
-            break;
-        }
-        case INS_ORA_ABS_Y:
-        {
-            const u16 address = Address_Absolute_Y(&number_of_cycles);
-            OR_Register(&number_of_cycles, address);
-            break;
-        }
-        case INS_ORA_IND_X:
-        {
-            const u16 address = Address_Indirect_X(&number_of_cycles);
-            OR_Register(&number_of_cycles, address);
-            break;
-        }
-        case INS_ORA_IND_Y:
-        {
-            const u16 address = Address_Indirect_Y(&number_of_cycles);
-            OR_Register(&number_of_cycles, address);
-            break;
-        }
-            // AND - bitwise AND with accumulator
-        case INS_AND_IM:
-        {
-            cpu.accumulator &= Fetch_Byte(&number_of_cycles);
-            Load_Register_Set_Status(cpu.accumulator);
-            break;
-        }
-        case INS_AND_ZP:
-        {
-            const u16 address = Address_Zero_Page(&number_of_cycles);
-            AND_Register(&number_of_cycles, address);
-            break;
-        }
-        case INS_AND_ZP_X:
-        {
-            const u16 address = Address_Zero_Page_X(&number_of_cycles);
-            AND_Register(&number_of_cycles, address);
-            break;
-        }
-        case INS_AND_ABS:
-        {
-            const u16 address = Address_Absolute(&number_of_cycles);
-            AND_Register(&number_of_cycles, address);
-            break;
-        }
-        case INS_AND_ABS_X:
-        {
-            const u16 address = Address_Absolute_X(&number_of_cycles);
-            AND_Register(&number_of_cycles, address);
-            break;
-        }
-        case INS_AND_ABS_Y:
-        {
-            const u16 address = Address_Absolute_Y(&number_of_cycles);
-            AND_Register(&number_of_cycles, address);
-            break;
-        }
-        case INS_AND_IND_X:
-        {
-            const u16 address = Address_Indirect_X(&number_of_cycles);
-            AND_Register(&number_of_cycles, address);
-            break;
-        }
-        case INS_AND_IND_Y:
-        {
-            const u16 address = Address_Indirect_Y(&number_of_cycles);
-            AND_Register(&number_of_cycles, address);
-            break;
-        }
-            // EOR - Exclusive OR
-        case INS_EOR_IM:
-        {
-            cpu.accumulator ^= Fetch_Byte(&number_of_cycles);
-            Load_Register_Set_Status(cpu.accumulator);
-            break;
-        }
-        case INS_EOR_ZP:
-        {
-            const u16 address = Address_Zero_Page(&number_of_cycles);
-            EOR_Register(&number_of_cycles, address);
-            break;
-        }
-        case INS_EOR_ZP_X:
-        {
-            const u16 address = Address_Zero_Page_X(&number_of_cycles);
-            EOR_Register(&number_of_cycles, address);
-            break;
-        }
-        case INS_EOR_ABS:
-        {
-            const u16 address = Address_Absolute(&number_of_cycles);
-            EOR_Register(&number_of_cycles, address);
-            break;
-        }
-        case INS_EOR_ABS_X:
-        {
-            const u16 address = Address_Absolute_X(&number_of_cycles);
-            EOR_Register(&number_of_cycles, address);
-            break;
-        }
-        case INS_EOR_ABS_Y:
-        {
-            const u16 address = Address_Absolute_Y(&number_of_cycles);
-            EOR_Register(&number_of_cycles, address);
-            break;
-        }
-        case INS_EOR_IND_X:
-        {
-            const u16 address = Address_Indirect_X(&number_of_cycles);
-            EOR_Register(&number_of_cycles, address);
-            break;
-        }
-        case INS_EOR_IND_Y:
-        {
-            const u16 address = Address_Indirect_Y(&number_of_cycles);
-            EOR_Register(&number_of_cycles, address);
-            break;
-        }
+    fprintf(file, "{\n  \"variant\": \"%s\",\n  \"opcodes\": [", H6502_VARIANT_NAME);
+    bool first = true;
+    for (int opcode = 0; opcode < 256; opcode++)
+    {
+        if (opcode_stats.counters[opcode].executions == 0 || !Opcode_Is_Valid((u8)opcode))
+            continue;
+
+        const Address_Mode mode = Opcode_Address_Mode((u8)opcode);
+        mode_executions[mode] += opcode_stats.counters[opcode].executions;
+        mode_cycles[mode] += Opcode_Stats_Cycles((u8)opcode);
+
+        fprintf(file, "%s\n    {\"opcode\": %d, \"mnemonic\": \"%s\", \"mode\": \"%s\", \"executions\": %" PRIu64
+                      ", \"cycles\": %" PRIu64 ", \"page_crossings\": %" PRIu64 ", \"branches_taken\": %" PRIu64
+                      ", \"branches_not_taken\": %" PRIu64 "}",
+                first ? "" : ",", opcode, Opcode_Mnemonic((u8)opcode), Address_Mode_Name(mode),
+                opcode_stats.counters[opcode].executions, Opcode_Stats_Cycles((u8)opcode), opcode_stats.counters[opcode].page_crossings,
+                opcode_stats.counters[opcode].branches_taken, Opcode_Stats_Branches_Not_Taken((u8)opcode));
+        first = false;
+    }
 
-        // BIT - test BITs
-        case INS_BIT_ZP:
-        {
-            const u16 address = Address_Zero_Page(&number_of_cycles);
-            const u8  value   = Read_Byte(&number_of_cycles, address);
-            cpu.Z             = !(cpu.accumulator & value);
-            cpu.N             = (value & NEGATIVE_FLAG_BIT) != 0;
-            cpu.V             = (value & OVERFLOW_FLAG_BIT) != 0;
-            break;
-        }
-        case INS_BIT_ABS:
-        {
-            const u16 address = Address_Absolute(&number_of_cycles);
-            const u8  value   = Read_Byte(&number_of_cycles, address);
-            cpu.Z             = !(cpu.accumulator & value);
-            cpu.N             = (value & NEGATIVE_FLAG_BIT) != 0;
-            cpu.V             = (value & OVERFLOW_FLAG_BIT) != 0;
-            break;
-        }
-        // DEC (DECrement memory)
-        case INS_DEC_ZP:
-        {
-            const u16 address = Address_Zero_Page(&number_of_cycles);
-            u8        value   = Read_Byte(&number_of_cycles, address);
-            value -= 1;
-            number_of_cycles -= 1;
-            Write_Byte(&number_of_cycles, value, address);
-            Load_Register_Set_Status(value);
-            break;
-        }
-        case INS_DEC_ZP_X:
-        {
-            const u16 address = Address_Zero_Page_X(&number_of_cycles);
-            u8        value   = Read_Byte(&number_of_cycles, address);
-            value -= 1;
-            number_of_cycles -= 1;
-            Write_Byte(&number_of_cycles, value, address);
-            Load_Register_Set_Status(value);
-            break;
-        }
-        case INS_DEC_ABS:
-        {
-            const u16 address = Address_Absolute(&number_of_cycles);
-            u8        value   = Read_Byte(&number_of_cycles, address);
-            value -= 1;
-            number_of_cycles -= 1;
-            Write_Byte(&number_of_cycles, value, address);
-            Load_Register_Set_Status(value);
-            break;
-        }
-        case INS_DEC_ABS_X:
-        {
-            const u16 address = Address_Absolute_X_5_Cycle(&number_of_cycles);
-            u8        value   = Read_Byte(&number_of_cycles, address);
-            value -= 1;
-            number_of_cycles -= 1;
-            Write_Byte(&number_of_cycles, value, address);
-            Load_Register_Set_Status(value);
-            break;
-        }
-        // INC (INCrement memory)
-        case INS_INC_ZP:
-        {
-            const u16 address = Address_Zero_Page(&number_of_cycles);
-            u8        value   = Read_Byte(&number_of_cycles, address);
-            value += 1;
-            number_of_cycles -= 1;
-            Write_Byte(&number_of_cycles, value, address);
-            Load_Register_Set_Status(value);
-            break;
-        }
-        case INS_INC_ZP_X:
-        {
-            const u16 address = Address_Zero_Page_X(&number_of_cycles);
-            u8        value   = Read_Byte(&number_of_cycles, address);
-            value += 1;
-            number_of_cycles -= 1;
-            Write_Byte(&number_of_cycles, value, address);
-            Load_Register_Set_Status(value);
-            break;
-        }
-        case INS_INC_ABS:
-        {
-            const u16 address = Address_Absolute(&number_of_cycles);
-            u8        value   = Read_Byte(&number_of_cycles, address);
-            value += 1;
-            number_of_cycles -= 1;
-            Write_Byte(&number_of_cycles, value, address);
-            Load_Register_Set_Status(value);
-            break;
-        }
-        case INS_INC_ABS_X:
+    fprintf(file, "\n  ],\n  \"modes\": [");
+    first = true;
+    for (int mode = 0; mode < MODE_COUNT; mode++)
+    {
+        if (mode_executions[mode] == 0)
+            continue;
+
+        fprintf(file, "%s\n    {\"mode\": \"%s\", \"executions\": %" PRIu64 ", \"cycles\": %" PRIu64 "}",
+                first ? "" : ",", Address_Mode_Name((Address_Mode)mode), mode_executions[mode], mode_cycles[mode]);
+        first = false;
+    }
+    fprintf(file, "\n  ]\n}\n");
+}
+#endif
+
+// Effective address of the instruction at 'address' with the current
+// registers, the same address its addressing mode gives when it runs.
+// 0 for implied and accumulator instructions. Does not change the cpu or memory.
+static inline u16 Effective_Address(u16 address)
+{
+    const u8  byte = Peek_Byte(address + 1);
+    const u16 word = Peek_Word(address + 1);
+
+    switch (Opcode_Address_Mode(Peek_Byte(address)))
+    {
+    case MODE_IM: return (address + 1) & 0xFFFF;
+    case MODE_ZP: return byte;
+    case MODE_ZP_X: return (byte + cpu.index_reg_X) & 0xFF;
+    case MODE_ZP_Y: return (byte + cpu.index_reg_Y) & 0xFF;
+    case MODE_ABS: return word;
+    case MODE_ABS_X: return (word + cpu.index_reg_X) & 0xFFFF;
+    case MODE_ABS_Y: return (word + cpu.index_reg_Y) & 0xFFFF;
+    case MODE_IND: return Peek_Byte(word) | (Peek_Byte(Indirect_High_Byte_Address(word)) << 8);
+    case MODE_IND_X: return Peek_Byte((byte + cpu.index_reg_X) & 0xFF) | (Peek_Byte((byte + cpu.index_reg_X + 1) & 0xFF) << 8);
+    case MODE_IND_Y: return ((Peek_Byte(byte) | (Peek_Byte((byte + 1) & 0xFF) << 8)) + cpu.index_reg_Y) & 0xFFFF;
+    case MODE_REL: return (address + 2 + (s8)byte) & 0xFFFF;
+    case MODE_ZP_IND: return Peek_Byte(byte) | (Peek_Byte((byte + 1) & 0xFF) << 8);
+    case MODE_ABS_IND_X: return Peek_Word((word + cpu.index_reg_X) & 0xFFFF);
+    default: return 0;
+    }
+}
+
+// Disassemble the instruction at 'address' into 'buffer' (e.g. "LDA $1234,X"),
+// returns the instruction length. Does not change the cpu or memory.
+static inline u8 Disassemble(u16 address, char *buffer, size_t buffer_size)
+{
+    const u8    opcode   = Peek_Byte(address);
+    const char *mnemonic = Opcode_Mnemonic(opcode);
+    if (mnemonic == NULL)
+    {
+        snprintf(buffer, buffer_size, ".byte $%02X", opcode);
+        return 1;
+    }
+
+    const unsigned int byte = Peek_Byte(address + 1);
+    const unsigned int word = Peek_Word(address + 1);
+
+    switch (Opcode_Address_Mode(opcode))
+    {
+    case MODE_IMP: snprintf(buffer, buffer_size, "%s", mnemonic); break;
+    case MODE_ACC: snprintf(buffer, buffer_size, "%s A", mnemonic); break;
+    case MODE_IM: snprintf(buffer, buffer_size, "%s #$%02X", mnemonic, byte); break;
+    case MODE_ZP: snprintf(buffer, buffer_size, "%s $%02X", mnemonic, byte); break;
+    case MODE_ZP_X: snprintf(buffer, buffer_size, "%s $%02X,X", mnemonic, byte); break;
+    case MODE_ZP_Y: snprintf(buffer, buffer_size, "%s $%02X,Y", mnemonic, byte); break;
+    case MODE_ABS: snprintf(buffer, buffer_size, "%s $%04X", mnemonic, word); break;
+    case MODE_ABS_X: snprintf(buffer, buffer_size, "%s $%04X,X", mnemonic, word); break;
+    case MODE_ABS_Y: snprintf(buffer, buffer_size, "%s $%04X,Y", mnemonic, word); break;
+    case MODE_IND: snprintf(buffer, buffer_size, "%s ($%04X)", mnemonic, word); break;
+    case MODE_IND_X: snprintf(buffer, buffer_size, "%s ($%02X,X)", mnemonic, byte); break;
+    case MODE_IND_Y: snprintf(buffer, buffer_size, "%s ($%02X),Y", mnemonic, byte); break;
+    case MODE_REL: snprintf(buffer, buffer_size, "%s $%04X", mnemonic, (unsigned int)((address + 2 + (s8)byte) & 0xFFFF)); break;
+    case MODE_ZP_IND: snprintf(buffer, buffer_size, "%s ($%02X)", mnemonic, byte); break;
+    case MODE_ABS_IND_X: snprintf(buffer, buffer_size, "%s ($%04X,X)", mnemonic, word); break;
+    default: snprintf(buffer, buffer_size, "%s ?", mnemonic); break;
+    }
+    return Opcode_Bytes(opcode);
+}
+
+// ---------------------------------------------------------------------
+// Execution engines
+
+#if H6502_CALL_PROFILER
+#include "profiler.h"
+#endif
+
+#if H6502_TRACE
+#include "trace.h"
+#endif
+
+#if H6502_TRACE_COLUMNS
+#include "trace_columns.h"
+#endif
+
+#if H6502_TRACE_TEXT
+#include "trace_text.h"
+#endif
+
+#if H6502_INSTRUCTION_HOOKS
+// Called by the engines before every instruction, PC is on the opcode
+static inline void Before_Instruction(void)
+{
+#if H6502_CALL_PROFILER
+    Call_Profiler_Instruction();
+#endif
+#if H6502_TRACE
+    Trace_Instruction();
+#endif
+#if H6502_TRACE_COLUMNS
+    Trace_Columns_Instruction();
+#endif
+#if H6502_TRACE_TEXT
+    Trace_Text_Instruction();
+#endif
+}
+
+// Called by the engines after every instruction
+static inline void After_Instruction(u8 opcode, s32 cycles_taken)
+{
+#if H6502_CALL_PROFILER
+    Call_Profiler_Record(opcode, cycles_taken);
+#endif
+#if H6502_TRACE
+    Trace_Count_Cycles(cycles_taken);
+#endif
+#if H6502_TRACE_COLUMNS
+    Trace_Columns_Count_Cycles(cycles_taken);
+#endif
+#if H6502_TRACE_TEXT
+    Trace_Text_Count_Cycles(cycles_taken);
+#endif
+    (void)opcode;
+    (void)cycles_taken;
+}
+#endif
+
+// Run one instruction, returns false if the opcode is not handled.
+// Always inlined, the engines are a lot slower when the switch is a call
+static H6502_FORCE_INLINE bool Execute_Instruction(u8 instruction, s32 *cycles)
+{
+#if 0
+    printf("Instruction loaded : 0x%X", instruction);
+#endif
+    switch (instruction)
+    {
+#define H6502_EXECUTE_CASE(name, mnemonic, opcode, ...) \
+    case opcode: Instruction_##name(cycles); break;
+        H6502_OPCODE_TABLE(H6502_EXECUTE_CASE)
+#undef H6502_EXECUTE_CASE
+    default:
+    {
+        print_db("Instruction not handled %x\n", instruction);
+        (*cycles) -= 1;
+        return false;
+    }
+    }
+    return true;
+}
+
+// execute "number_of_cycles" the instruction in memory
+static inline s32 Execute(s32 number_of_cycles)
+{
+    const s32 number_of_cycles_requested = number_of_cycles;
+
+    bool bad_instruction = false;
+    while (number_of_cycles > 0 && bad_instruction == false)
+    {
+        H6502_INPUT_LOG_STEP();
+#if H6502_INSTRUCTION_HOOKS
+        Before_Instruction();
+        const s32 cycles_before = number_of_cycles;
+        const u8  instruction   = Fetch_Byte();
+        bad_instruction         = !Execute_Instruction(instruction, &number_of_cycles);
+        After_Instruction(instruction, cycles_before - number_of_cycles);
+#else
+        bad_instruction = !Execute_Instruction(Fetch_Byte(), &number_of_cycles);
+#endif
+    } // while (number_of_cycles > 0)
+
+    const s32 number_of_cycles_remaining = number_of_cycles;
+    const s32 number_of_cycles_used      = (number_of_cycles == 0) ? number_of_cycles_requested : number_of_cycles_requested - number_of_cycles;
+
+#if 0
+    printf("number_of_cycles_requested : %d\n", number_of_cycles_requested);
+    printf("number_of_cycles_remaining : %d\n", number_of_cycles_remaining);
+    printf("number_of_cycles_used      : %d\n", number_of_cycles_used);
+    printf("current number_of_cycles   : %d\n", number_of_cycles);
+#else
+    (void)number_of_cycles_remaining;
+#endif
+
+    return number_of_cycles_used;
+}
+
+typedef void (*Instruction_Handler)(s32 *cycles);
+
+// Dispatch table, generated from the opcode table. NULL for opcodes that are
+// not part of the selected variant
+static inline Instruction_Handler Get_Instruction_Handler(u8 opcode)
+{
+#define H6502_HANDLER_ENTRY(name, mnemonic, opcode, ...) [opcode] = Instruction_##name,
+    static const Instruction_Handler handlers[256] = {H6502_OPCODE_TABLE(H6502_HANDLER_ENTRY)};
+#undef H6502_HANDLER_ENTRY
+    return handlers[opcode];
+}
+
+// Same as Execute() but dispatches through the handler table instead of the
+// switch, both run the same generated instructions
+static inline s32 Execute_Dispatch_Table(s32 number_of_cycles)
+{
+    const s32 number_of_cycles_requested = number_of_cycles;
+
+    while (number_of_cycles > 0)
+    {
+        H6502_INPUT_LOG_STEP();
+#if H6502_INSTRUCTION_HOOKS
+        Before_Instruction();
+#endif
+        const u8                  instruction = Fetch_Byte();
+        const Instruction_Handler handler     = Get_Instruction_Handler(instruction);
+        if (handler == NULL)
         {
-            const u16 address = Address_Absolute_X_5_Cycle(&number_of_cycles);
-            u8        value   = Read_Byte(&number_of_cycles, address);
-            value += 1;
+            print_db("Instruction not handled %x\n", instruction);
             number_of_cycles -= 1;
-            Write_Byte(&number_of_cycles, value, address);
-            Load_Register_Set_Status(value);
-            break;
-        }
-        // Branch Instructions
-        case INS_BPL: // BPL (Branch on PLus)
-        {
-            Branch_If(&number_of_cycles, cpu.N, 0);
-            break;
-        }
-        case INS_BMI: // BMI (Branch on MInus)
-        {
-            Branch_If(&number_of_cycles, cpu.N, 1);
-            break;
-        }
-        case INS_BVC: // BVC (Branch on oVerflow Clear)
-        {
-            Branch_If(&number_of_cycles, cpu.V, 0);
-            break;
-        }
-        case INS_BVS: // BVS (Branch on oVerflow Set)
-        {
-            Branch_If(&number_of_cycles, cpu.V, 1);
-            break;
-        }
-        case INS_BCC: // BCC (Branch on Carry Clear)
-        {
-            Branch_If(&number_of_cycles, cpu.C, 0);
-            break;
-        }
-        case INS_BCS: // BCS (Branch on Carry Set)
-        {
-            Branch_If(&number_of_cycles, cpu.C, 1);
-            break;
-        }
-        case INS_BNE: // BNE (Branch on Not Equal)
-        {
-            Branch_If(&number_of_cycles, cpu.Z, 0);
-            break;
-        }
-        case INS_BEQ: // BEQ (Branch on EQual)
-        {
-            Branch_If(&number_of_cycles, cpu.Z, 1);
-            break;
-        }
-        // Flag (Processor Status) Instructions
-        case INS_CLC: // (CLear Carry)
-        {
-            cpu.C = 0;
-            number_of_cycles--;
-            break;
-        }
-        case INS_SEC: // (SEt Carry)
-        {
-            cpu.C = 1;
-            number_of_cycles--;
-            break;
-        }
-        case INS_CLI: // (CLear Interrupt)
-        {
-            cpu.I = 0;
-            number_of_cycles--;
-            break;
-        }
-        case INS_SEI: // (SEt Interrupt)
-        {
-            cpu.I = 1;
-            number_of_cycles--;
-            break;
-        }
-        case INS_CLV: // (CLear oVerflow)
-        {
-            cpu.V = 0;
-            number_of_cycles--;
-            break;
-        }
-        case INS_CLD: // (CLear Decimal)
-        {
-            cpu.D = 0;
-            number_of_cycles--;
-            break;
-        }
-        case INS_SED: // (SEt Decimal)
-        {
-            cpu.D = 1;
-            number_of_cycles--;
-            break;
-        }
-        // NOP (No OPeration)
-        case INS_NOP:
-        {
-            number_of_cycles--;
-            break;
-        }
-        // ADC (ADd with Carry)
-        case INS_ADC_IM:
-        {
-            const u8 operand = Fetch_Byte(&number_of_cycles);
-            ADC(operand);
-            break;
-        }
-        case INS_ADC_ZP:
-        {
-            const u16 address = Address_Zero_Page(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            ADC(operand);
-            break;
-        }
-        case INS_ADC_ZP_X:
-        {
-            const u16 address = Address_Zero_Page_X(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            ADC(operand);
-            break;
-        }
-        case INS_ADC_ABS:
-        {
-            const u16 address = Address_Absolute(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            ADC(operand);
-            break;
-        }
-        case INS_ADC_ABS_X:
-        {
-            const u16 address = Address_Absolute_X(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            ADC(operand);
-            break;
-        }
-        case INS_ADC_ABS_Y:
-        {
-            const u16 address = Address_Absolute_Y(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            ADC(operand);
-            break;
-        }
-        case INS_ADC_IND_X:
-        {
-            const u16 address = Address_Indirect_X(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            ADC(operand);
-            break;
-        }
-        case INS_ADC_IND_Y:
-        {
-            const u16 address = Address_Indirect_Y(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            ADC(operand);
-            break;
-        }
-        // SBC (SuBtract with Carry)
-        case INS_SBC_IM:
-        {
-            const u8 operand = Fetch_Byte(&number_of_cycles);
-            SBC(operand);
-            break;
-        }
-        case INS_SBC_ZP:
-        {
-            const u16 address = Address_Zero_Page(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            SBC(operand);
-            break;
-        }
-        case INS_SBC_ZP_X:
-        {
-            const u16 address = Address_Zero_Page_X(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            SBC(operand);
-            break;
-        }
-        case INS_SBC_ABS:
-        {
-            const u16 address = Address_Absolute(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            SBC(operand);
-            break;
-        }
-        case INS_SBC_ABS_X:
-        {
-            const u16 address = Address_Zero_Page_X(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            SBC(operand);
-            break;
-        }
-        case INS_SBC_ABS_Y:
-        {
-            const u16 address = Address_Absolute_Y(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            SBC(operand);
-            break;
-        }
-        case INS_SBC_IND_X:
-        {
-            const u16 address = Address_Indirect_X(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            SBC(operand);
-            break;
-        }
-        case INS_SBC_IND_Y:
-        {
-            const u16 address = Address_Indirect_Y(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            SBC(operand);
-            break;
-        }
-            // CMP (CoMPare accumulator)
-        case INS_CMP_IM:
-        {
-            const u8 operand = Fetch_Byte(&number_of_cycles);
-            Register_Compare(operand, cpu.accumulator);
-            break;
-        }
-        case INS_CMP_ZP:
-        {
-            const u16 address = Address_Zero_Page(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            Register_Compare(operand, cpu.accumulator);
-            break;
-        }
-        case INS_CMP_ZP_X:
-        {
-            const u16 address = Address_Zero_Page_X(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            Register_Compare(operand, cpu.accumulator);
-            break;
-        }
-        case INS_CMP_ABS:
-        {
-            const u16 address = Address_Absolute(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            Register_Compare(operand, cpu.accumulator);
-            break;
-        }
-        case INS_CMP_ABS_X:
-        {
-            const u16 address = Address_Absolute_X(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            Register_Compare(operand, cpu.accumulator);
-            break;
-        }
-        case INS_CMP_ABS_Y:
-        {
-            const u16 address = Address_Absolute_Y(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            Register_Compare(operand, cpu.accumulator);
-            break;
-        }
-        case INS_CMP_IND_X:
-        {
-            const u16 address = Address_Indirect_X(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            Register_Compare(operand, cpu.accumulator);
-            break;
-        }
-        case INS_CMP_IND_Y:
-        {
-            const u16 address = Address_Indirect_Y(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            Register_Compare(operand, cpu.accumulator);
-            break;
-        }
-            // CPX (ComPare X register)
-        case INS_CPX_IM:
-        {
-            const u8 operand = Fetch_Byte(&number_of_cycles);
-            Register_Compare(operand, cpu.index_reg_X);
-            break;
-        }
-        case INS_CPX_ZP:
-        {
-            const u16 address = Address_Zero_Page(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            Register_Compare(operand, cpu.index_reg_X);
-            break;
-        }
-        case INS_CPX_ABS:
-        {
-            const u16 address = Address_Absolute(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            Register_Compare(operand, cpu.index_reg_X);
             break;
         }
+#if H6502_INSTRUCTION_HOOKS
+        const s32 cycles_before = number_of_cycles;
+        handler(&number_of_cycles);
+        After_Instruction(instruction, cycles_before - number_of_cycles);
+#else
+        handler(&number_of_cycles);
+#endif
+    }
 
-        // CPY (ComPare Y register)
-        case INS_CPY_IM:
-        {
-            const u8 operand = Fetch_Byte(&number_of_cycles);
-            Register_Compare(operand, cpu.index_reg_Y);
-            break;
-        }
-        case INS_CPY_ZP:
-        {
-            const u16 address = Address_Zero_Page(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            Register_Compare(operand, cpu.index_reg_Y);
-            break;
-        }
-        case INS_CPY_ABS:
-        {
-            const u16 address = Address_Absolute(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            Register_Compare(operand, cpu.index_reg_Y);
-            break;
-        }
-            // Arithmetic shift left
-        case INS_ASL:
-        {
-            cpu.accumulator = ASL(&number_of_cycles, cpu.accumulator);
-            break;
-        }
-        case INS_ASL_ZP:
-        {
-            const u16 address = Address_Zero_Page(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            const u8  result  = ASL(&number_of_cycles, operand);
-            Write_Byte(&number_of_cycles, result, address);
-            break;
-        }
-        case INS_ASL_ZP_X:
-        {
-            const u16 address = Address_Zero_Page_X(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            const u8  result  = ASL(&number_of_cycles, operand);
-            Write_Byte(&number_of_cycles, result, address);
-            break;
-        }
-        case INS_ASL_ABS:
-        {
-            const u16 address = Address_Absolute(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            const u8  result  = ASL(&number_of_cycles, operand);
-            Write_Byte(&number_of_cycles, result, address);
-            break;
-        }
-        case INS_ASL_ABS_X:
-        {
-            const u16 address = Address_Absolute_X_5_Cycle(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            const u8  result  = ASL(&number_of_cycles, operand);
-            Write_Byte(&number_of_cycles, result, address);
-            break;
-        }
-            // LSR (Logical Shift Right)
-        case INS_LSR:
-        {
-            cpu.accumulator = LSR(&number_of_cycles, cpu.accumulator);
-            break;
-        }
-        case INS_LSR_ZP:
-        {
-            const u16 address = Address_Zero_Page(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            const u8  result  = LSR(&number_of_cycles, operand);
-            Write_Byte(&number_of_cycles, result, address);
-            break;
-        }
-        case INS_LSR_ZP_X:
+    return number_of_cycles_requested - number_of_cycles;
+}
+
+// ---------------------------------------------------------------------
+// Execute until a stop condition is met
+//
+//  Stop_Conditions stop = {0};
+//  Stop_At_PC(&stop, 0x1234);
+//  Stop_On_Opcode(&stop, INS_RTS);
+//  Stop_On_Write(&stop, 0x0200, 0x02FF); // needs H6502_WRITE_WATCH=1
+//  stop.max_cycles = 1000000;
+//  const Execute_Result result = Execute_Until(&stop);
+//
+// PC and opcode conditions are checked before the instruction runs, so the
+// cpu is left on the instruction that matched. Write, instruction and cycle
+// conditions are checked after the instruction that triggered them.
+
+typedef enum
+{
+    STOP_NONE = 0,        // no condition given, nothing was run
+    STOP_PC,              // reached a target PC
+    STOP_OPCODE,          // next instruction is a watched opcode
+    STOP_WRITE,           // an instruction wrote to the watched range
+    STOP_MAX_INSTRUCTIONS,
+    STOP_MAX_CYCLES,
+    STOP_BAD_INSTRUCTION, // opcode not handled by this variant
+} Stop_Reason;
+
+typedef struct Stop_Conditions
+{
+    uint8_t pc[0x10000 / 8]; // bitset of target PCs
+    uint8_t opcode[256 / 8]; // bitset of opcodes to stop on
+    bool    check_pc;
+    bool    check_opcode;
+#if H6502_WRITE_WATCH
+    bool    check_write;
+    u16     write_low;        // watched write range, inclusive
+    u16     write_high;
+#endif
+    u32     max_instructions; // 0 = no limit
+    s32     max_cycles;       // 0 = no limit
+} Stop_Conditions;
+
+typedef struct Execute_Result
+{
+    Stop_Reason reason;
+    s32         cycles_used;
+    u32         instructions;
+    u16         write_address; // address written when reason is STOP_WRITE
+} Execute_Result;
+
+static inline void Stop_At_PC(Stop_Conditions *stop, u16 pc)
+{
+    stop->pc[(pc & 0xFFFF) >> 3] |= (uint8_t)(1 << (pc & 7));
+    stop->check_pc = true;
+}
+
+static inline void Stop_On_Opcode(Stop_Conditions *stop, u8 opcode)
+{
+    stop->opcode[opcode >> 3] |= (uint8_t)(1 << (opcode & 7));
+    stop->check_opcode = true;
+}
+
+#if H6502_WRITE_WATCH
+// Inclusive, the bounds are swapped when 'high' is below 'low'
+static inline void Stop_On_Write(Stop_Conditions *stop, u16 low, u16 high)
+{
+    stop->write_low   = (low <= high) ? low : high;
+    stop->write_high  = (low <= high) ? high : low;
+    stop->check_write = true;
+}
+#endif
+
+static inline bool Stop_Bit_Is_Set(const uint8_t *bitset, u16 index)
+{
+    return (bitset[index >> 3] >> (index & 7)) & 1;
+}
+
+static inline Execute_Result Execute_Until(const Stop_Conditions *stop)
+{
+    Execute_Result result = {STOP_NONE, 0, 0, 0};
+
+#if H6502_WRITE_WATCH
+    const bool check_write = stop->check_write;
+#else
+    const bool check_write = false;
+#endif
+    if (!stop->check_pc && !stop->check_opcode && !check_write && stop->max_instructions == 0 && stop->max_cycles == 0)
+    {
+        return result;
+    }
+
+#if H6502_WRITE_WATCH
+    if (stop->check_write)
+    {
+        write_watch.low  = stop->write_low;
+        write_watch.size = (u32)(stop->write_high - stop->write_low) + 1;
+        write_watch.hit  = false;
+    }
+#endif
+
+    // counts down, same as Execute()
+    const s32 cycles_requested = (stop->max_cycles > 0) ? stop->max_cycles : INT_FAST32_MAX;
+    s32       cycles           = cycles_requested;
+
+    while (true)
+    {
+        if (stop->check_pc && Stop_Bit_Is_Set(stop->pc, cpu.program_counter))
         {
-            const u16 address = Address_Zero_Page_X(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            const u8  result  = LSR(&number_of_cycles, operand);
-            Write_Byte(&number_of_cycles, result, address);
+            result.reason = STOP_PC;
             break;
         }
-        case INS_LSR_ABS:
+
+        const u8 instruction = Peek_Byte(cpu.program_counter);
+        if (stop->check_opcode && Stop_Bit_Is_Set(stop->opcode, instruction))
         {
-            const u16 address = Address_Absolute(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            const u8  result  = LSR(&number_of_cycles, operand);
-            Write_Byte(&number_of_cycles, result, address);
+            result.reason = STOP_OPCODE;
             break;
         }
-        case INS_LSR_ABS_X:
+
+#if H6502_INSTRUCTION_HOOKS
+        Before_Instruction();
+#endif
+        H6502_HEATMAP_COUNT(HEATMAP_EXECUTES, cpu.program_counter);
+        H6502_INPUT_LOG_STEP();
+        cpu.program_counter = (cpu.program_counter + 1) & 0xFFFF;
+#if H6502_INSTRUCTION_HOOKS
+        const s32  cycles_before = cycles;
+        const bool handled       = Execute_Instruction(instruction, &cycles);
+        After_Instruction(instruction, cycles_before - cycles);
+#else
+        const bool handled = Execute_Instruction(instruction, &cycles);
+#endif
+        result.instructions++;
+
+        if (!handled)
         {
-            const u16 address = Address_Absolute_X_5_Cycle(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            const u8  result  = LSR(&number_of_cycles, operand);
-            Write_Byte(&number_of_cycles, result, address);
+            result.reason = STOP_BAD_INSTRUCTION;
             break;
         }
-            // ROL (ROtate Left)
-        case INS_ROL:
+#if H6502_WRITE_WATCH
+        if (write_watch.hit)
         {
-            cpu.accumulator = ROL(&number_of_cycles, cpu.accumulator);
+            result.reason        = STOP_WRITE;
+            result.write_address = write_watch.address;
             break;
         }
-        case INS_ROL_ZP:
+#endif
+        if (result.instructions == stop->max_instructions)
         {
-            const u16 address = Address_Zero_Page(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            const u8  result  = ROL(&number_of_cycles, operand);
-            Write_Byte(&number_of_cycles, result, address);
+            result.reason = STOP_MAX_INSTRUCTIONS;
             break;
         }
-        case INS_ROL_ZP_X:
+        if (cycles <= 0)
         {
-            const u16 address = Address_Zero_Page_X(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            const u8  result  = ROL(&number_of_cycles, operand);
-            Write_Byte(&number_of_cycles, result, address);
+            result.reason = STOP_MAX_CYCLES;
             break;
         }
-        case INS_ROL_ABS:
-        {
-            const u16 address = Address_Absolute(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            const u8  result  = ROL(&number_of_cycles, operand);
-            Write_Byte(&number_of_cycles, result, address);
+    }
 
-            break;
-        }
-        case INS_ROL_ABS_X:
-        {
-            const u16 address = Address_Absolute_X_5_Cycle(&number_of_cycles);
-            const u8  operand = Read_Byte(&number_of_cycles, address);
-            const u8  result  = ROL(&number_of_cycles, operand);
-            Write_Byte(&number_of_cycles, result, address);
-            break;
-        }
-        default:
-        {
-            print_db("Instruction not handled %x\n", instruction);
-            bad_instruction = true;
-            break;
-        }
-        }
-    } // while (number_of_cycles > 0)
+#if H6502_WRITE_WATCH
+    write_watch.size = 0;
+    write_watch.hit  = false;
+#endif
 
-    const s32 number_of_cycles_remaining = number_of_cycles;
-    const s32 number_of_cycles_used      = (number_of_cycles == 0) ? number_of_cycles_requested : number_of_cycles_requested - number_of_cycles;
+    result.cycles_used = cycles_requested - cycles;
+    return result;
+}
 
-#if 0
-    printf("number_of_cycles_requested : %d\n", number_of_cycles_requested);
-    printf("number_of_cycles_remaining : %d\n", number_of_cycles_remaining);
-    printf("number_of_cycles_used      : %d\n", number_of_cycles_used);
-    printf("current number_of_cycles   : %d\n", number_of_cycles);
-#else
-    (void)number_of_cycles_remaining;
-#endif
+// Execute_Until() run for 'cycles' like Execute()
+static inline s32 Execute_Until_Cycles(s32 cycles)
+{
+    static Stop_Conditions stop;
+    if (cycles <= 0)
+        return 0;
+    stop.max_cycles = cycles;
+    return Execute_Until(&stop).cycles_used;
+}
 
-    return number_of_cycles_used;
+// The execution engines by name, for the tools and benchmarks that can run any
+// of them. Each runs at least 'cycles' like Execute(), 1 is one instruction
+typedef struct Execution_Engine
+{
+    const char *name;
+    s32 (*run)(s32 cycles);
+} Execution_Engine;
+
+static const Execution_Engine execution_engines[] = {
+    {"switch", Execute},
+    {"table", Execute_Dispatch_Table},
+    {"until", Execute_Until_Cycles},
+};
+
+#define EXECUTION_ENGINE_COUNT (int)(sizeof(execution_engines) / sizeof(execution_engines[0]))
+
+// NULL when there is no engine called 'name'
+static inline const Execution_Engine *Find_Execution_Engine(const char *name)
+{
+    for (int engine = 0; engine < EXECUTION_ENGINE_COUNT; engine++)
+    {
+        if (strcmp(execution_engines[engine].name, name) == 0)
+            return &execution_engines[engine];
+    }
+    return NULL;
 }
-#endif // __H6502_H__
\ No newline at end of file
+#endif // __H6502_H__
@@ -0,0 +1,207 @@
+#ifndef __HEATMAP_H__
+#define __HEATMAP_H__
+
+// Memory access heatmap
+// Included by h6502.h when H6502_HEATMAP is 1.
+//
+// Counts reads, writes and executes for every address. Read_Byte() counts a
+// read, Write_Byte() a write and Fetch_Byte() an execute (every instruction
+// byte fetched through PC, opcode and operands). Debug tools use Peek_Byte()
+// which is not counted.
+//
+// Each machine counts into its own 'heatmap', Heatmap_Add() and the binary
+// file add counts together so many machines or runs can be combined.
+//
+// Binary file : "H6502HMP" | u8 version | u8 kinds | 6 x u8 0 | u64 counts[kind][65536]
+// All counts are little endian.
+
+#define HEATMAP_MAGIC       "H6502HMP"
+#define HEATMAP_VERSION     1
+#define HEATMAP_HEADER_SIZE 16
+#define HEATMAP_ADDRESSES   0x10000
+
+typedef enum
+{
+    HEATMAP_READS = 0,
+    HEATMAP_WRITES,
+    HEATMAP_EXECUTES,
+    HEATMAP_KIND_COUNT
+} Heatmap_Kind;
+
+typedef struct Heatmap
+{
+    uint64_t counts[HEATMAP_KIND_COUNT][HEATMAP_ADDRESSES];
+} Heatmap;
+
+static Heatmap heatmap = {0};
+
+#define H6502_HEATMAP_COUNT(kind, address) (heatmap.counts[kind][(address) & 0xFFFF]++)
+
+static inline void Heatmap_Reset(Heatmap *map)
+{
+    memset(map, 0, sizeof(*map));
+}
+
+// Add the counts of another machine or run
+static inline void Heatmap_Add(Heatmap *total, const Heatmap *map)
+{
+    for (int kind = 0; kind < HEATMAP_KIND_COUNT; kind++)
+        for (u32 address = 0; address < HEATMAP_ADDRESSES; address++)
+            total->counts[kind][address] += map->counts[kind][address];
+}
+
+// ---------------------------------------------------------------------
+// Binary file
+
+static inline bool Heatmap_Write_Binary(const Heatmap *map, FILE *file)
+{
+    const uint8_t header[HEATMAP_HEADER_SIZE] = {'H', '6', '5', '0', '2', 'H', 'M', 'P', HEATMAP_VERSION, HEATMAP_KIND_COUNT};
+    fwrite(header, 1, sizeof(header), file);
+
+    uint8_t bytes[8 * 256];
+    for (int kind = 0; kind < HEATMAP_KIND_COUNT; kind++)
+    {
+        for (u32 page = 0; page < 256; page++)
+        {
+            for (u32 offset = 0; offset < 256; offset++)
+            {
+                const uint64_t count = map->counts[kind][page * 256 + offset];
+                for (int i = 0; i < 8; i++)
+                    bytes[offset * 8 + i] = (uint8_t)(count >> (8 * i));
+            }
+            fwrite(bytes, 1, sizeof(bytes), file);
+        }
+    }
+    return ferror(file) == 0;
+}
+
+// Adds the counts in the file to 'total', false if it is not a heatmap file
+static inline bool Heatmap_Read_Binary(Heatmap *total, FILE *file)
+{
+    uint8_t header[HEATMAP_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, HEATMAP_MAGIC, 8) != 0 ||
+        header[8] != HEATMAP_VERSION || header[9] != HEATMAP_KIND_COUNT)
+        return false;
+
+    uint8_t bytes[8 * 256];
+    for (int kind = 0; kind < HEATMAP_KIND_COUNT; kind++)
+    {
+        for (u32 page = 0; page < 256; page++)
+        {
+            if (fread(bytes, 1, sizeof(bytes), file) != sizeof(bytes))
+                return false;
+
+            for (u32 offset = 0; offset < 256; offset++)
+            {
+                uint64_t count = 0;
+                for (int i = 0; i < 8; i++)
+                    count |= (uint64_t)bytes[offset * 8 + i] << (8 * i);
+                total->counts[kind][page * 256 + offset] += count;
+            }
+        }
+    }
+    return true;
+}
+
+static inline bool Heatmap_Save(const Heatmap *map, const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error opening heatmap file : %s\n", path);
+        return false;
+    }
+
+    const bool ok = Heatmap_Write_Binary(map, file);
+    fclose(file);
+    return ok;
+}
+
+// Adds the counts saved in 'path' to 'total'
+static inline bool Heatmap_Load(Heatmap *total, const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error opening heatmap file : %s\n", path);
+        return false;
+    }
+
+    const bool ok = Heatmap_Read_Binary(total, file);
+    fclose(file);
+    return ok;
+}
+
+// ---------------------------------------------------------------------
+// Images, 256 x 256 with one pixel per address, a row is a page
+
+// Log scale brightness, 8 steps per doubling, 0 only when never accessed
+static inline u32 Heatmap_Level(uint64_t count)
+{
+    if (count == 0)
+        return 0;
+
+    u32 exponent = 0;
+    while ((count >> exponent) > 1)
+        exponent++;
+
+    const u32 fraction = (exponent >= 3) ? (u32)(count >> (exponent - 3)) & 7 : (u32)(count << (3 - exponent)) & 7;
+    return 1 + exponent * 8 + fraction;
+}
+
+static inline u32 Heatmap_Max_Level(const Heatmap *map, Heatmap_Kind kind)
+{
+    uint64_t max = 0;
+    for (u32 address = 0; address < HEATMAP_ADDRESSES; address++)
+    {
+        if (map->counts[kind][address] > max)
+            max = map->counts[kind][address];
+    }
+    return Heatmap_Level(max);
+}
+
+static inline uint8_t Heatmap_Pixel(uint64_t count, u32 max_level)
+{
+    return max_level ? (uint8_t)(Heatmap_Level(count) * 255 / max_level) : 0;
+}
+
+// Greyscale binary PGM of one kind of access
+static inline bool Heatmap_Write_PGM(const Heatmap *map, Heatmap_Kind kind, FILE *file)
+{
+    const u32 max_level = Heatmap_Max_Level(map, kind);
+
+    fprintf(file, "P5\n256 256\n255\n");
+    uint8_t row[256];
+    for (u32 page = 0; page < 256; page++)
+    {
+        for (u32 offset = 0; offset < 256; offset++)
+            row[offset] = Heatmap_Pixel(map->counts[kind][page * 256 + offset], max_level);
+        fwrite(row, 1, sizeof(row), file);
+    }
+    return ferror(file) == 0;
+}
+
+// Colour binary PPM, red is writes, green is reads and blue is executes
+static inline bool Heatmap_Write_PPM(const Heatmap *map, FILE *file)
+{
+    const u32 max_read    = Heatmap_Max_Level(map, HEATMAP_READS);
+    const u32 max_write   = Heatmap_Max_Level(map, HEATMAP_WRITES);
+    const u32 max_execute = Heatmap_Max_Level(map, HEATMAP_EXECUTES);
+
+    fprintf(file, "P6\n256 256\n255\n");
+    uint8_t row[256 * 3];
+    for (u32 page = 0; page < 256; page++)
+    {
+        for (u32 offset = 0; offset < 256; offset++)
+        {
+            const u32 address   = page * 256 + offset;
+            row[offset * 3 + 0] = Heatmap_Pixel(map->counts[HEATMAP_WRITES][address], max_write);
+            row[offset * 3 + 1] = Heatmap_Pixel(map->counts[HEATMAP_READS][address], max_read);
+            row[offset * 3 + 2] = Heatmap_Pixel(map->counts[HEATMAP_EXECUTES][address], max_execute);
+        }
+        fwrite(row, 1, sizeof(row), file);
+    }
+    return ferror(file) == 0;
+}
+
+#endif // __HEATMAP_H__
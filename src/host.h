@@ -0,0 +1,17 @@
+#ifndef __HOST_H__
+#define __HOST_H__
+
+// Host helpers shared by the tools and benchmarks, the emulator does not use
+// them
+
+#include <time.h>
+
+// Wall clock time in seconds, for timing runs
+static inline double Seconds_Now(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+#endif // __HOST_H__
@@ -0,0 +1,358 @@
+#ifndef __INPUT_LOG_H__
+#define __INPUT_LOG_H__
+
+// Record and replay of external inputs
+// Included by h6502.h when H6502_INPUT_LOG is 1.
+//
+// Everything that comes from outside the machine goes through here:
+//  - reads of the input port, an address range handled by a device callback
+//    instead of memory (Read_Byte() only, debug tools Peek_Byte() memory)
+//  - values from the host, Input_Host_Call()
+//
+// Recording logs every value with the number of instructions run since the
+// recording started. Replay hands the logged values back without calling the
+// device or the host, so a run is repeated exactly from the same start state.
+// A replay that asks for something else than the log has is marked diverged
+// and gets 0 from then on.
+//
+//  Input_Set_Port(0xD000, 0xD0FF, Keyboard_Read, &keyboard);
+//  Input_Record_Start("run.inl");   or   Input_Replay_Start("run.inl");
+//  Execute(cycles);
+//  Input_Record_Stop();                   Input_Replay_Stop();
+//
+// Log : "H6502INL" | u8 version | 7 x u8 0, then records, appended as they happen
+//  port read : u8 INPUT_PORT_READ | varint instructions since the last record | u16 address | u8 value
+//  host call : u8 INPUT_HOST_CALL | varint instructions since the last record | varint value
+// varints are 7 bits a byte, low bits first. Numbers are little endian.
+
+#define INPUT_LOG_MAGIC       "H6502INL"
+#define INPUT_LOG_VERSION     1
+#define INPUT_LOG_HEADER_SIZE 16
+#define INPUT_LOG_BUFFER_SIZE (1 << 16)
+#define INPUT_LOG_MAX_RECORD  16
+
+typedef enum
+{
+    INPUT_PORT_READ = 1,
+    INPUT_HOST_CALL = 2,
+} Input_Record_Kind;
+
+typedef enum
+{
+    INPUT_LIVE = 0,
+    INPUT_RECORD,
+    INPUT_REPLAY,
+} Input_Mode;
+
+typedef u8 (*Input_Port_Read)(void *context, u16 address);
+typedef uint32_t (*Input_Host_Function)(void *context);
+
+// The port, read the same way as the write watch, 'size' is 0 when there is none
+static struct
+{
+    u32             low;
+    u32             size;
+    Input_Port_Read read;
+    void           *context;
+} input_port = {0};
+
+static struct
+{
+    Input_Mode mode;
+    uint64_t   instructions; // run since the recording or replay started
+    uint64_t   last_stamp;   // instructions at the last record
+    uint64_t   records;
+
+    // recording
+    FILE   *file;
+    bool    close_file;
+    uint8_t buffer[INPUT_LOG_BUFFER_SIZE];
+    size_t  used;
+
+    // replay
+    uint8_t *log;
+    size_t   log_size;
+    size_t   position;
+    bool     diverged;
+    uint64_t diverged_at; // instructions when the replay diverged
+} input_log = {0};
+
+#define H6502_INPUT_LOG_STEP() (input_log.instructions++)
+
+// 'read' is called for every Read_Byte() of low..high, inclusive
+static inline void Input_Set_Port(u16 low, u16 high, Input_Port_Read read, void *context)
+{
+    input_port.low     = low & 0xFFFF;
+    input_port.size    = (read != NULL) ? (u32)((high & 0xFFFF) - input_port.low) + 1 : 0;
+    input_port.read    = read;
+    input_port.context = context;
+}
+
+// ---------------------------------------------------------------------
+// Recording
+
+static inline void Input_Log_Flush(void)
+{
+    if (input_log.used > 0)
+        fwrite(input_log.buffer, 1, input_log.used, input_log.file);
+    input_log.used = 0;
+}
+
+static inline uint8_t *Input_Log_Put_Varint(uint8_t *out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        *out++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (uint8_t)value;
+    return out;
+}
+
+// Kind and stamp of a new record, returns where its data goes
+static inline uint8_t *Input_Log_Begin(Input_Record_Kind kind)
+{
+    if (input_log.used > INPUT_LOG_BUFFER_SIZE - INPUT_LOG_MAX_RECORD)
+        Input_Log_Flush();
+
+    uint8_t *out = &input_log.buffer[input_log.used];
+    *out++       = (uint8_t)kind;
+    out          = Input_Log_Put_Varint(out, input_log.instructions - input_log.last_stamp);
+
+    input_log.last_stamp = input_log.instructions;
+    input_log.records++;
+    return out;
+}
+
+static inline void Input_Log_End(const uint8_t *out)
+{
+    input_log.used = (size_t)(out - input_log.buffer);
+}
+
+static inline bool Input_Record_Start_File(FILE *file, bool close_file)
+{
+    const uint8_t header[INPUT_LOG_HEADER_SIZE] = {'H', '6', '5', '0', '2', 'I', 'N', 'L', INPUT_LOG_VERSION};
+    if (fwrite(header, 1, sizeof(header), file) != sizeof(header))
+        return false;
+
+    input_log.mode         = INPUT_RECORD;
+    input_log.file         = file;
+    input_log.close_file   = close_file;
+    input_log.used         = 0;
+    input_log.instructions = 0;
+    input_log.last_stamp   = 0;
+    input_log.records      = 0;
+    return true;
+}
+
+static inline bool Input_Record_Start(const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error opening input log : %s\n", path);
+        return false;
+    }
+    if (!Input_Record_Start_File(file, true))
+    {
+        fclose(file);
+        return false;
+    }
+    return true;
+}
+
+static inline bool Input_Record_Stop(void)
+{
+    if (input_log.mode != INPUT_RECORD)
+        return false;
+
+    Input_Log_Flush();
+    bool ok = ferror(input_log.file) == 0;
+    if (input_log.close_file)
+        ok = (fclose(input_log.file) == 0) && ok;
+    else
+        fflush(input_log.file);
+
+    input_log.file = NULL;
+    input_log.mode = INPUT_LIVE;
+    return ok;
+}
+
+// ---------------------------------------------------------------------
+// Replay
+
+static inline bool Input_Replay_Start_Buffer(uint8_t *log, size_t size)
+{
+    if (size < INPUT_LOG_HEADER_SIZE || memcmp(log, INPUT_LOG_MAGIC, 8) != 0 || log[8] != INPUT_LOG_VERSION)
+    {
+        fprintf(stderr, "Error reading input log : not an input log\n");
+        return false;
+    }
+
+    input_log.mode         = INPUT_REPLAY;
+    input_log.log          = log;
+    input_log.log_size     = size;
+    input_log.position     = INPUT_LOG_HEADER_SIZE;
+    input_log.instructions = 0;
+    input_log.last_stamp   = 0;
+    input_log.records      = 0;
+    input_log.diverged     = false;
+    input_log.diverged_at  = 0;
+    return true;
+}
+
+// The whole log is read into memory so replay never waits on the file
+static inline bool Input_Replay_Start(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error opening input log : %s\n", path);
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    uint8_t *log = (size > 0) ? malloc((size_t)size) : NULL;
+    if (log == NULL || fread(log, 1, (size_t)size, file) != (size_t)size || !Input_Replay_Start_Buffer(log, (size_t)size))
+    {
+        fprintf(stderr, "Error reading input log : %s\n", path);
+        free(log);
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+    return true;
+}
+
+// True when every logged value was used and nothing diverged
+static inline bool Input_Replay_Done(void)
+{
+    return input_log.mode == INPUT_REPLAY && !input_log.diverged && input_log.position == input_log.log_size;
+}
+
+static inline void Input_Replay_Stop(void)
+{
+    if (input_log.mode != INPUT_REPLAY)
+        return;
+
+    free(input_log.log);
+    input_log.log  = NULL;
+    input_log.mode = INPUT_LIVE;
+}
+
+// Detaches a buffer given to Input_Replay_Start_Buffer() without freeing it
+static inline void Input_Replay_Stop_Buffer(void)
+{
+    input_log.log = NULL;
+    Input_Replay_Stop();
+}
+
+static inline bool Input_Log_Get_Varint(uint64_t *value)
+{
+    uint64_t result = 0;
+    for (u32 shift = 0; input_log.position < input_log.log_size && shift < 64; shift += 7)
+    {
+        const uint8_t byte = input_log.log[input_log.position++];
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (byte < 0x80)
+        {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline void Input_Replay_Diverged(void)
+{
+    if (!input_log.diverged)
+    {
+        input_log.diverged    = true;
+        input_log.diverged_at = input_log.instructions;
+    }
+}
+
+// Next record has to be 'kind' at this instruction
+static inline bool Input_Replay_Next(Input_Record_Kind kind)
+{
+    uint64_t stamp;
+    if (input_log.diverged || input_log.position >= input_log.log_size || input_log.log[input_log.position] != kind)
+    {
+        Input_Replay_Diverged();
+        return false;
+    }
+
+    const size_t start = input_log.position++;
+    if (!Input_Log_Get_Varint(&stamp) || input_log.last_stamp + stamp != input_log.instructions)
+    {
+        input_log.position = start;
+        Input_Replay_Diverged();
+        return false;
+    }
+
+    input_log.last_stamp = input_log.instructions;
+    input_log.records++;
+    return true;
+}
+
+// ---------------------------------------------------------------------
+// Inputs
+
+// Read_Byte() of the port
+static inline u8 Input_Read(u16 address)
+{
+    if (input_log.mode == INPUT_REPLAY)
+    {
+        const size_t start = input_log.position;
+        if (!Input_Replay_Next(INPUT_PORT_READ))
+            return 0;
+
+        // a record cut short by the end of the log diverges like a wrong address
+        const uint8_t *data = &input_log.log[input_log.position];
+        if (input_log.log_size - input_log.position < 3 || (u16)(data[0] | (data[1] << 8)) != address)
+        {
+            input_log.position = start;
+            Input_Replay_Diverged();
+            return 0;
+        }
+        input_log.position += 3;
+        return data[2];
+    }
+
+    const u8 value = input_port.read(input_port.context, address);
+    if (input_log.mode == INPUT_RECORD)
+    {
+        uint8_t *out = Input_Log_Begin(INPUT_PORT_READ);
+        *out++       = (uint8_t)address;
+        *out++       = (uint8_t)(address >> 8);
+        *out++       = (uint8_t)value;
+        Input_Log_End(out);
+    }
+    return value;
+}
+
+// Calls 'function' for a value from the host, when replaying the logged value
+// is returned and 'function' is not called
+static inline uint32_t Input_Host_Call(Input_Host_Function function, void *context)
+{
+    if (input_log.mode == INPUT_REPLAY)
+    {
+        uint64_t value;
+        if (!Input_Replay_Next(INPUT_HOST_CALL) || !Input_Log_Get_Varint(&value))
+        {
+            Input_Replay_Diverged();
+            return 0;
+        }
+        return (uint32_t)value;
+    }
+
+    const uint32_t value = function(context);
+    if (input_log.mode == INPUT_RECORD)
+        Input_Log_End(Input_Log_Put_Varint(Input_Log_Begin(INPUT_HOST_CALL), value));
+    return value;
+}
+
+#endif // __INPUT_LOG_H__
@@ -0,0 +1,303 @@
+#ifndef __LOCKSTEP_H__
+#define __LOCKSTEP_H__
+
+// Differential lockstep validation of two execution engines
+// Needs H6502_SNAPSHOT=1, each engine runs on its own machine (machine.h).
+//
+// Both machines start as the same fork of 'cpu' and 'mem'. The run goes a
+// block of instructions at a time: engine A runs the block one instruction at
+// a time and its registers and cycles after each are kept, then engine B runs
+// it and is checked after every instruction. Memory is compared at the end of
+// the block, pages both machines still share are skipped. When it differs the
+// block is run again one instruction at a time from forks taken at its start,
+// comparing memory after each, to find the instruction that wrote it.
+//
+//  static Lockstep lockstep;
+//  Lockstep_Start(&lockstep, Find_Execution_Engine("switch"), Find_Execution_Engine("table"), 64);
+//  if (Lockstep_Run(&lockstep, 100000) == LOCKSTEP_DIVERGED)
+//      Lockstep_Print_Divergence(&lockstep, stdout);
+//  Lockstep_Stop(&lockstep);
+//
+// A run stops before an opcode the variant does not have, the engines do not
+// have to agree on what happens then, or at the PC given to Lockstep_Stop_At().
+
+#include "machine.h"
+
+#define LOCKSTEP_MAX_BLOCK   4096
+#define LOCKSTEP_HISTORY     8192 // a power of two, at least LOCKSTEP_MAX_BLOCK + LOCKSTEP_CONTEXT
+#define LOCKSTEP_CONTEXT     16   // instructions shown before a divergence
+#define LOCKSTEP_MAX_REPORTS 8    // different bytes shown
+
+typedef enum
+{
+    LOCKSTEP_AGREE = 0, // ran all the instructions asked for
+    LOCKSTEP_STOPPED,   // next opcode is not in the variant, or at the stop PC
+    LOCKSTEP_DIVERGED,
+} Lockstep_Outcome;
+
+// One instruction as engine A ran it
+typedef struct Lockstep_Step
+{
+    u16 pc;
+    u8  bytes[3]; // the instruction, as it was when it ran
+    s32 cycles;
+    CPU cpu;      // after it
+} Lockstep_Step;
+
+typedef struct Lockstep_Difference
+{
+    u16 address;
+    u8  value_a;
+    u8  value_b;
+} Lockstep_Difference;
+
+typedef struct Lockstep
+{
+    const Execution_Engine *engine_a;
+    const Execution_Engine *engine_b;
+    Machine                *machine_a;
+    Machine                *machine_b;
+    u32                     block;
+    uint64_t                instructions; // run by both and agreed on
+    bool                    stop_at_pc;   // stop before the instruction at 'stop_pc' too
+    u16                     stop_pc;
+
+    // the last instructions, by instruction number
+    Lockstep_Step history[LOCKSTEP_HISTORY];
+
+    // the divergence
+    uint64_t            diverged_at;
+    CPU                 cpu_b;
+    s32                 cycles_b;
+    bool                memory_differs;
+    u32                 difference_count;
+    Lockstep_Difference differences[LOCKSTEP_MAX_REPORTS];
+    Memory_Diff         memory_diff; // all the bytes that differ, as ranges
+} Lockstep;
+
+static inline bool Lockstep_CPU_Equal(const CPU *a, const CPU *b)
+{
+    return a->program_counter == b->program_counter && a->stack_pointer == b->stack_pointer && a->accumulator == b->accumulator &&
+           a->index_reg_X == b->index_reg_X && a->index_reg_Y == b->index_reg_Y && a->PS == b->PS;
+}
+
+// Both machines from 'cpu' and 'mem' now, 'block' instructions between memory checks
+static inline void Lockstep_Start(Lockstep *lockstep, const Execution_Engine *engine_a, const Execution_Engine *engine_b, u32 block)
+{
+    lockstep->engine_a     = engine_a;
+    lockstep->engine_b     = engine_b;
+    lockstep->block        = (block < 1) ? 1 : (block > LOCKSTEP_MAX_BLOCK) ? LOCKSTEP_MAX_BLOCK : block;
+    lockstep->instructions = 0;
+    lockstep->stop_at_pc   = false;
+    lockstep->machine_a    = Machine_Create();
+    lockstep->machine_b    = Machine_Fork(lockstep->machine_a);
+}
+
+static inline void Lockstep_Stop(Lockstep *lockstep)
+{
+    Machine_Free(lockstep->machine_b);
+    Machine_Free(lockstep->machine_a);
+    lockstep->machine_a = NULL;
+    lockstep->machine_b = NULL;
+}
+
+// Runs stop before the instruction at 'pc', e.g. the trap a program ends on
+static inline void Lockstep_Stop_At(Lockstep *lockstep, u16 pc)
+{
+    lockstep->stop_at_pc = true;
+    lockstep->stop_pc    = pc;
+}
+
+// A byte changed in both machines, e.g. an opcode the variant does not have
+static inline void Lockstep_Poke(Lockstep *lockstep, u16 address, u8 value)
+{
+    Machine_Switch(lockstep->machine_a);
+    mem.data[address & 0xFFFF] = value;
+    Snapshot_Mark_Dirty(address, 1);
+    Machine_Switch(lockstep->machine_b);
+    mem.data[address & 0xFFFF] = value;
+    Snapshot_Mark_Dirty(address, 1);
+}
+
+// Bytes that differ between the machines, the first few kept
+static inline u32 Lockstep_Compare_Memory(Lockstep *lockstep, const Machine *a, const Machine *b)
+{
+    if (machines.current == a || machines.current == b)
+        Machine_Sync();
+
+    // pages both machines still share are the same
+    Memory_Diff *diff = &lockstep->memory_diff;
+    Memory_Diff_Clear(diff);
+    for (u32 index = 0; index < MACHINE_PAGES; index++)
+    {
+        const Machine_Page *page_a = a->table->pages[index];
+        const Machine_Page *page_b = b->table->pages[index];
+        if (page_a != page_b)
+            Memory_Diff_Range(diff, page_a->data, page_b->data, index * MACHINE_PAGE_SIZE, MACHINE_PAGE_SIZE);
+    }
+
+    u32 count = 0;
+    for (u32 i = 0; i < diff->range_count && i < MEMORY_DIFF_MAX_RANGES; i++)
+    {
+        for (u32 address = diff->ranges[i].first; address <= diff->ranges[i].last && count < LOCKSTEP_MAX_REPORTS; address++)
+        {
+            const u32 index  = address / MACHINE_PAGE_SIZE;
+            const u32 offset = address % MACHINE_PAGE_SIZE;
+            lockstep->differences[count++] =
+                (Lockstep_Difference){(u16)address, a->table->pages[index]->data[offset], b->table->pages[index]->data[offset]};
+        }
+    }
+    lockstep->difference_count = diff->bytes;
+    return lockstep->difference_count;
+}
+
+// Engine A runs up to 'count' instructions on its machine, returns how many
+static inline u32 Lockstep_Run_A(Lockstep *lockstep, Machine *machine, u32 count)
+{
+    Machine_Switch(machine);
+    for (u32 i = 0; i < count; i++)
+    {
+        const u16 pc = cpu.program_counter;
+        if (!Opcode_Is_Valid(Peek_Byte(pc)) || (lockstep->stop_at_pc && pc == lockstep->stop_pc))
+            return i;
+
+        Lockstep_Step *step = &lockstep->history[(lockstep->instructions + i) & (LOCKSTEP_HISTORY - 1)];
+        step->pc            = pc;
+        step->bytes[0]      = Peek_Byte(pc);
+        step->bytes[1]      = Peek_Byte((pc + 1) & 0xFFFF);
+        step->bytes[2]      = Peek_Byte((pc + 2) & 0xFFFF);
+        step->cycles        = lockstep->engine_a->run(1);
+        step->cpu           = cpu;
+    }
+    return count;
+}
+
+// Engine B runs 'count' instructions on its machine, false at the first that
+// does not match engine A
+static inline bool Lockstep_Run_B(Lockstep *lockstep, Machine *machine, u32 count)
+{
+    Machine_Switch(machine);
+    for (u32 i = 0; i < count; i++)
+    {
+        const Lockstep_Step *step   = &lockstep->history[(lockstep->instructions + i) & (LOCKSTEP_HISTORY - 1)];
+        const s32            cycles = lockstep->engine_b->run(1);
+        if (cycles != step->cycles || !Lockstep_CPU_Equal(&cpu, &step->cpu))
+        {
+            lockstep->diverged_at    = lockstep->instructions + i;
+            lockstep->cpu_b          = cpu;
+            lockstep->cycles_b       = cycles;
+            lockstep->memory_differs = false;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Memory differs after the block, find the first instruction it differs after
+static inline void Lockstep_Find_Write(Lockstep *lockstep, Machine *start_a, Machine *start_b, u32 count)
+{
+    Machine *a            = Machine_Fork(start_a);
+    Machine *b            = Machine_Fork(start_b);
+    lockstep->diverged_at = lockstep->instructions + count - 1;
+    for (u32 i = 0; i < count; i++)
+    {
+        Machine_Switch(a);
+        lockstep->engine_a->run(1);
+        Machine_Switch(b);
+        lockstep->cycles_b = lockstep->engine_b->run(1);
+        lockstep->cpu_b    = cpu;
+        if (Lockstep_Compare_Memory(lockstep, a, b) > 0)
+        {
+            lockstep->diverged_at = lockstep->instructions + i;
+            break;
+        }
+    }
+    lockstep->memory_differs = true;
+    Machine_Free(a);
+    Machine_Free(b);
+}
+
+// Runs both engines for up to 'max_instructions'
+static inline Lockstep_Outcome Lockstep_Run(Lockstep *lockstep, uint64_t max_instructions)
+{
+    uint64_t left = max_instructions;
+    while (left > 0)
+    {
+        const u32 block   = (left < lockstep->block) ? (u32)left : lockstep->block;
+        Machine  *start_a = Machine_Fork(lockstep->machine_a);
+        Machine  *start_b = Machine_Fork(lockstep->machine_b);
+
+        const u32 count  = Lockstep_Run_A(lockstep, lockstep->machine_a, block);
+        bool      agreed = Lockstep_Run_B(lockstep, lockstep->machine_b, count);
+        if (agreed && Lockstep_Compare_Memory(lockstep, lockstep->machine_a, lockstep->machine_b) > 0)
+        {
+            Lockstep_Find_Write(lockstep, start_a, start_b, count);
+            agreed = false;
+        }
+        Machine_Free(start_a);
+        Machine_Free(start_b);
+        if (!agreed)
+            return LOCKSTEP_DIVERGED;
+
+        lockstep->instructions += count;
+        left -= count;
+        if (count < block)
+            return LOCKSTEP_STOPPED;
+    }
+    return LOCKSTEP_AGREE;
+}
+
+static inline void Lockstep_Print_CPU(FILE *file, const CPU *state, s32 cycles)
+{
+    fprintf(file, "PC %04X A %02X X %02X Y %02X SP %02X P %02X  %" PRIdFAST32 " cycles", (unsigned)state->program_counter,
+            (unsigned)state->accumulator, (unsigned)state->index_reg_X, (unsigned)state->index_reg_Y, (unsigned)state->stack_pointer,
+            (unsigned)state->PS, cycles);
+}
+
+// The instructions before the divergence, disassembled as they were when they ran
+static inline void Lockstep_Print_Divergence(const Lockstep *lockstep, FILE *file)
+{
+    const uint64_t diverged = lockstep->diverged_at;
+    const uint64_t first    = (diverged >= LOCKSTEP_CONTEXT) ? diverged - LOCKSTEP_CONTEXT + 1 : 0;
+
+    fprintf(file, "%s and %s diverge at instruction %" PRIu64 " (%s)\n", lockstep->engine_a->name, lockstep->engine_b->name, diverged,
+            lockstep->memory_differs ? "memory" : "registers");
+    for (uint64_t number = first; number <= diverged; number++)
+    {
+        const Lockstep_Step *step = &lockstep->history[number & (LOCKSTEP_HISTORY - 1)];
+
+        // put the bytes back for Disassemble(), the code may have changed since
+        u8 saved[3];
+        for (u16 i = 0; i < 3; i++)
+        {
+            saved[i]                          = mem.data[(step->pc + i) & 0xFFFF];
+            mem.data[(step->pc + i) & 0xFFFF] = step->bytes[i];
+        }
+        char text[32];
+        Disassemble(step->pc, text, sizeof(text));
+        for (u16 i = 0; i < 3; i++)
+            mem.data[(step->pc + i) & 0xFFFF] = saved[i];
+
+        fprintf(file, "%s %10" PRIu64 "  %04X  %-14s ", (number == diverged) ? ">" : " ", number, (unsigned)step->pc, text);
+        Lockstep_Print_CPU(file, &step->cpu, step->cycles);
+        fprintf(file, "\n");
+    }
+
+    const Lockstep_Step *step = &lockstep->history[diverged & (LOCKSTEP_HISTORY - 1)];
+    fprintf(file, "%-6s after : ", lockstep->engine_a->name);
+    Lockstep_Print_CPU(file, &step->cpu, step->cycles);
+    fprintf(file, "\n%-6s after : ", lockstep->engine_b->name);
+    Lockstep_Print_CPU(file, &lockstep->cpu_b, lockstep->cycles_b);
+    fprintf(file, "\n");
+
+    if (lockstep->memory_differs)
+    {
+        for (u32 i = 0; i < lockstep->difference_count && i < LOCKSTEP_MAX_REPORTS; i++)
+            fprintf(file, "memory $%04X : %s %02X, %s %02X\n", (unsigned)lockstep->differences[i].address, lockstep->engine_a->name,
+                    (unsigned)lockstep->differences[i].value_a, lockstep->engine_b->name, (unsigned)lockstep->differences[i].value_b);
+        char text[160];
+        fprintf(file, "memory : %s\n", Memory_Diff_Format(&lockstep->memory_diff, text, sizeof(text)));
+    }
+}
+
+#endif // __LOCKSTEP_H__
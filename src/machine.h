@@ -0,0 +1,250 @@
+#ifndef __MACHINE_H__
+#define __MACHINE_H__
+
+// Machines that fork with copy-on-write memory
+// Needs H6502_SNAPSHOT=1, the dirty page flags tell which pages a machine wrote.
+//
+// A Machine is the CPU and a table of 256 pages of 256 bytes. Tables and
+// pages are refcounted: forking copies the CPU and adds a reference to the
+// table. The first write of a machine that shares its table gives it its own
+// table (references to the same pages), and a page is only copied when a
+// machine that shares it writes to it. A child costs the pages it writes.
+//
+// The emulator still runs on 'cpu' and 'mem'. Machine_Switch() makes a
+// machine the running one: it keeps what the last one wrote (Machine_Sync())
+// and copies in only the pages that are not already in 'mem', so switching
+// between a parent and its children copies the pages they differ in.
+//
+//  Machine *parent = Machine_Create();      // from 'cpu' and 'mem'
+//  Execute(cycles);
+//  Machine *child = Machine_Fork(parent);
+//  Machine_Switch(child);
+//  Execute(cycles);                          // parent is unchanged
+//  Machine_Free(child);
+//
+// Changes made straight to 'mem.data' need Snapshot_Mark_Dirty() to be kept.
+
+#include "h6502.h"
+
+#if !H6502_SNAPSHOT
+#error "machine.h needs H6502_SNAPSHOT=1"
+#endif
+
+#define MACHINE_PAGES     SNAPSHOT_PAGE_COUNT
+#define MACHINE_PAGE_SIZE SNAPSHOT_PAGE_SIZE
+
+typedef struct Machine_Page
+{
+    u32     refs; // tables, and 'mem' when it holds the page
+    uint8_t data[MACHINE_PAGE_SIZE];
+} Machine_Page;
+
+typedef struct Machine_Table
+{
+    u32           refs; // machines
+    Machine_Page *pages[MACHINE_PAGES];
+} Machine_Table;
+
+typedef struct Machine
+{
+    CPU            cpu;
+    Machine_Table *table;
+} Machine;
+
+static struct
+{
+    Machine      *current;                 // running on 'cpu' and 'mem', NULL for none
+    Machine_Page *resident[MACHINE_PAGES]; // the page each part of 'mem' holds, with a reference
+    uint64_t      pages_allocated;
+    uint64_t      pages_copied;            // copy-on-write and switches
+} machines = {0};
+
+static inline void *Machine_Allocate(size_t size)
+{
+    void *memory = malloc(size);
+    if (memory == NULL)
+    {
+        fprintf(stderr, "Error allocating machine : %zu bytes\n", size);
+        abort();
+    }
+    return memory;
+}
+
+static inline Machine_Page *Machine_Page_New(const u8 *data)
+{
+    Machine_Page *page = Machine_Allocate(sizeof(Machine_Page));
+    page->refs         = 1;
+    memcpy(page->data, data, MACHINE_PAGE_SIZE);
+    machines.pages_allocated++;
+    return page;
+}
+
+static inline void Machine_Page_Release(Machine_Page *page)
+{
+    if (page != NULL && --page->refs == 0)
+    {
+        free(page);
+        machines.pages_allocated--;
+    }
+}
+
+static inline void Machine_Table_Release(Machine_Table *table)
+{
+    if (--table->refs == 0)
+    {
+        for (u32 index = 0; index < MACHINE_PAGES; index++)
+            Machine_Page_Release(table->pages[index]);
+        free(table);
+    }
+}
+
+static inline void Machine_Set_Resident(u32 index, Machine_Page *page)
+{
+    page->refs++;
+    Machine_Page_Release(machines.resident[index]);
+    machines.resident[index] = page;
+}
+
+// A table only 'machine' uses, before it changes a page
+static inline Machine_Table *Machine_Own_Table(Machine *machine)
+{
+    Machine_Table *shared = machine->table;
+    if (shared->refs == 1)
+        return shared;
+
+    Machine_Table *table = Machine_Allocate(sizeof(Machine_Table));
+    table->refs          = 1;
+    for (u32 index = 0; index < MACHINE_PAGES; index++)
+    {
+        table->pages[index] = shared->pages[index];
+        table->pages[index]->refs++;
+    }
+    shared->refs--;
+    machine->table = table;
+    return table;
+}
+
+// Keep what the running machine wrote to 'mem' in its pages
+static inline void Machine_Sync(void)
+{
+    Machine *machine = machines.current;
+    if (machine == NULL)
+        return;
+
+    machine->cpu = cpu;
+    for (u32 index = 0; index < MACHINE_PAGES; index++)
+    {
+        if (!snapshot_dirty[index])
+            continue;
+        snapshot_dirty[index] = 0;
+
+        const u8 *data = &mem.data[index * MACHINE_PAGE_SIZE];
+        if (memcmp(machine->table->pages[index]->data, data, MACHINE_PAGE_SIZE) == 0)
+            continue;
+
+        // the table and 'mem' hold one reference each, anything more is another table
+        Machine_Table *table = Machine_Own_Table(machine);
+        Machine_Page  *page  = table->pages[index];
+        if (page->refs > 2)
+        {
+            Machine_Page *copy  = Machine_Page_New(data);
+            table->pages[index] = copy;
+            Machine_Set_Resident(index, copy);
+            Machine_Page_Release(page);
+        }
+        else
+        {
+            memcpy(page->data, data, MACHINE_PAGE_SIZE);
+        }
+        machines.pages_copied++;
+    }
+}
+
+// A machine from what is in 'cpu' and 'mem' now, it becomes the running machine
+static inline Machine *Machine_Create(void)
+{
+    Machine_Sync();
+
+    Machine *machine     = Machine_Allocate(sizeof(Machine));
+    machine->cpu         = cpu;
+    machine->table       = Machine_Allocate(sizeof(Machine_Table));
+    machine->table->refs = 1;
+    for (u32 index = 0; index < MACHINE_PAGES; index++)
+    {
+        machine->table->pages[index] = Machine_Page_New(&mem.data[index * MACHINE_PAGE_SIZE]);
+        Machine_Set_Resident(index, machine->table->pages[index]);
+    }
+
+    memset(snapshot_dirty, 0, sizeof(snapshot_dirty));
+    machines.current = machine;
+    return machine;
+}
+
+// A copy of 'parent' sharing its memory
+static inline Machine *Machine_Fork(Machine *parent)
+{
+    if (parent == machines.current)
+        Machine_Sync();
+
+    Machine *child = Machine_Allocate(sizeof(Machine));
+    child->cpu     = parent->cpu;
+    child->table   = parent->table;
+    child->table->refs++;
+    return child;
+}
+
+// Make 'machine' the one running on 'cpu' and 'mem'
+static inline void Machine_Switch(Machine *machine)
+{
+    if (machine == machines.current)
+        return;
+
+    Machine_Sync();
+    for (u32 index = 0; index < MACHINE_PAGES; index++)
+    {
+        // still dirty when written with no machine running
+        Machine_Page *page = machine->table->pages[index];
+        if (machines.resident[index] != page || snapshot_dirty[index])
+        {
+            memcpy(&mem.data[index * MACHINE_PAGE_SIZE], page->data, MACHINE_PAGE_SIZE);
+            Machine_Set_Resident(index, page);
+            machines.pages_copied++;
+        }
+    }
+
+    cpu = machine->cpu;
+    memset(snapshot_dirty, 0, sizeof(snapshot_dirty));
+    machines.current = machine;
+}
+
+// Pages only this machine uses
+static inline u32 Machine_Private_Pages(const Machine *machine)
+{
+    if (machine->table->refs > 1)
+        return 0;
+
+    u32 pages = 0;
+    for (u32 index = 0; index < MACHINE_PAGES; index++)
+    {
+        const Machine_Page *page = machine->table->pages[index];
+        pages += (page->refs - (machines.resident[index] == page)) == 1;
+    }
+    return pages;
+}
+
+// 'mem' and 'cpu' keep the machine's state when it was running
+static inline void Machine_Free(Machine *machine)
+{
+    if (machine == NULL)
+        return;
+    if (machine == machines.current)
+    {
+        Machine_Sync();
+        machines.current = NULL;
+    }
+
+    Machine_Table_Release(machine->table);
+    free(machine);
+}
+
+#endif // __MACHINE_H__
@@ -0,0 +1,166 @@
+#ifndef __MEMORY_DIFF_H__
+#define __MEMORY_DIFF_H__
+
+// Memory comparison
+// Included by h6502.h.
+//
+// Finds the bytes that differ between two memory images 32 bytes at a time,
+// with SSE2 or AVX2 compares when the compiler has them, and keeps them as
+// ranges of bytes next to each other, so a page of changes is one entry:
+//
+//  Memory_Diff diff;
+//  char        text[256];
+//  if (Memory_Diff_Compare(&diff, expected.data, mem.data, NULL) > 0)
+//      printf("%s\n", Memory_Diff_Format(&diff, text, sizeof(text)));
+//
+//  3 bytes differ in 2 ranges : $1000-$1001 $2000
+//
+// Pages with a 0 flag in 'pages' (e.g. snapshot_dirty) are taken to be the
+// same in both and not compared, most runs only write a few.
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define MEMORY_DIFF_CHUNK      32
+#define MEMORY_DIFF_PAGE_SIZE  256
+#define MEMORY_DIFF_PAGES      (MAX_MEM / MEMORY_DIFF_PAGE_SIZE)
+#define MEMORY_DIFF_MAX_RANGES 8 // ranges kept, all of them are counted
+
+typedef struct Memory_Range
+{
+    u16 first;
+    u16 last;
+} Memory_Range;
+
+typedef struct Memory_Diff
+{
+    u32          bytes;       // that differ
+    u32          range_count; // can be more than are kept
+    u32          end;         // past the last byte that differs, a byte there joins its range
+    Memory_Range ranges[MEMORY_DIFF_MAX_RANGES];
+} Memory_Diff;
+
+// A bit for each byte of the chunk that differs
+static inline uint32_t Memory_Diff_Chunk(const u8 *a, const u8 *b)
+{
+#if defined(__AVX2__)
+    const __m256i equal = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)a), _mm256_loadu_si256((const __m256i *)b));
+    return ~(uint32_t)_mm256_movemask_epi8(equal);
+#elif defined(__SSE2__)
+    const __m128i low  = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)a), _mm_loadu_si128((const __m128i *)b));
+    const __m128i high = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a + 16)), _mm_loadu_si128((const __m128i *)(b + 16)));
+    return ~((uint32_t)_mm_movemask_epi8(low) | ((uint32_t)_mm_movemask_epi8(high) << 16));
+#else
+    uint32_t differs = 0;
+    for (u32 i = 0; i < MEMORY_DIFF_CHUNK; i++)
+        differs |= (uint32_t)(a[i] != b[i]) << i;
+    return differs;
+#endif
+}
+
+static inline void Memory_Diff_Clear(Memory_Diff *diff)
+{
+    diff->bytes       = 0;
+    diff->range_count = 0;
+    diff->end         = 0;
+}
+
+// A byte that differs, addresses have to come in order
+static inline void Memory_Diff_Add(Memory_Diff *diff, u32 address)
+{
+    if (diff->bytes > 0 && address == diff->end)
+    {
+        if (diff->range_count <= MEMORY_DIFF_MAX_RANGES)
+            diff->ranges[diff->range_count - 1].last = (u16)address;
+    }
+    else
+    {
+        if (diff->range_count < MEMORY_DIFF_MAX_RANGES)
+            diff->ranges[diff->range_count] = (Memory_Range){(u16)address, (u16)address};
+        diff->range_count++;
+    }
+    diff->bytes++;
+    diff->end = address + 1;
+}
+
+// Compares 'size' bytes that are at 'address', after the ranges already found
+static inline u32 Memory_Diff_Range(Memory_Diff *diff, const u8 *a, const u8 *b, u32 address, u32 size)
+{
+    u32 offset = 0;
+    for (; offset + MEMORY_DIFF_CHUNK <= size; offset += MEMORY_DIFF_CHUNK)
+    {
+        for (uint32_t differs = Memory_Diff_Chunk(&a[offset], &b[offset]); differs != 0; differs &= differs - 1)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            const u32 bit = (u32)__builtin_ctz(differs);
+#else
+            u32 bit = 0;
+            while (!(differs & (1u << bit)))
+                bit++;
+#endif
+            Memory_Diff_Add(diff, address + offset + bit);
+        }
+    }
+    for (; offset < size; offset++)
+    {
+        if (a[offset] != b[offset])
+            Memory_Diff_Add(diff, address + offset);
+    }
+    return diff->bytes;
+}
+
+// Compares two 64 KB images, only the pages flagged in 'pages' unless it is
+// NULL. Returns the number of bytes that differ
+static inline u32 Memory_Diff_Compare(Memory_Diff *diff, const u8 *a, const u8 *b, const uint8_t *pages)
+{
+    Memory_Diff_Clear(diff);
+    for (u32 group = 0; group < MEMORY_DIFF_PAGES; group += 8)
+    {
+        // skip 8 clean pages at a time
+        uint64_t flags = ~(uint64_t)0;
+        if (pages != NULL)
+            memcpy(&flags, &pages[group], sizeof(flags));
+        if (flags == 0)
+            continue;
+
+        for (u32 page = group; page < group + 8; page++)
+        {
+            const u32 address = page * MEMORY_DIFF_PAGE_SIZE;
+            if (pages == NULL || pages[page])
+                Memory_Diff_Range(diff, &a[address], &b[address], address, MEMORY_DIFF_PAGE_SIZE);
+        }
+    }
+    return diff->bytes;
+}
+
+// "3 bytes differ in 2 ranges : $1000-$1001 $2000", cut short to fit
+static inline const char *Memory_Diff_Format(const Memory_Diff *diff, char *text, size_t size)
+{
+    if (size == 0)
+        return text;
+    if (diff->bytes == 0)
+    {
+        snprintf(text, size, "no bytes differ");
+        return text;
+    }
+
+    int used = snprintf(text, size, "%" PRIuFAST32 " byte%s differ%s in %" PRIuFAST32 " range%s :", diff->bytes,
+                        (diff->bytes == 1) ? "" : "s", (diff->bytes == 1) ? "s" : "", diff->range_count,
+                        (diff->range_count == 1) ? "" : "s");
+    for (u32 i = 0; i < diff->range_count && i < MEMORY_DIFF_MAX_RANGES && used >= 0 && (size_t)used < size; i++)
+    {
+        const Memory_Range *range = &diff->ranges[i];
+        if (range->first == range->last)
+            used += snprintf(&text[used], size - (size_t)used, " $%04X", (unsigned)range->first);
+        else
+            used += snprintf(&text[used], size - (size_t)used, " $%04X-$%04X", (unsigned)range->first, (unsigned)range->last);
+    }
+    if (diff->range_count > MEMORY_DIFF_MAX_RANGES && used >= 0 && (size_t)used < size)
+        snprintf(&text[used], size - (size_t)used, " ...");
+    return text;
+}
+
+#endif // __MEMORY_DIFF_H__
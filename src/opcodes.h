@@ -0,0 +1,374 @@
+#ifndef __OPCODES_H__
+#define __OPCODES_H__
+
+// Single source of truth for every opcode the interpreter knows about.
+// Each list is an X-macro, "OPCODE" is called once per instruction with:
+//
+//      OPCODE(name, mnemonic, opcode, mode, bytes, cycles, page_penalty, operation)
+//
+//  name         - enum name without the "INS_" prefix (INS_LDA_IM)
+//  mnemonic     - assembler mnemonic, used by the disassembler
+//  opcode       - opcode byte
+//  mode         - addressing mode, expands to "Address_Mode_<mode>" (see h6502.h)
+//  bytes        - instruction length in bytes, checked against the addressing mode
+//  cycles       - base cycles, including the opcode fetch
+//  page_penalty - 1 if crossing a page while indexing costs an extra cycle
+//  operation    - expands to "Operation_<operation>" (see h6502.h)
+//
+// Taken branches (+1, +1 more on a page cross) and the 65C02 decimal mode
+// cycle are added by the operation itself.
+//
+// The enum, the Execute() switch, the dispatch table, the cycle/length tables
+// and the disassembler are all generated from H6502_OPCODE_TABLE
+
+// Addressing mode - instruction length in bytes
+#define H6502_MODE_BYTES_IMP       1 // Implied
+#define H6502_MODE_BYTES_ACC       1 // Accumulator
+#define H6502_MODE_BYTES_IM        2 // Immediate
+#define H6502_MODE_BYTES_ZP        2 // Zero Page
+#define H6502_MODE_BYTES_ZP_X      2 // Zero Page,X
+#define H6502_MODE_BYTES_ZP_Y      2 // Zero Page,Y
+#define H6502_MODE_BYTES_ABS       3 // Absolute
+#define H6502_MODE_BYTES_ABS_X     3 // Absolute,X
+#define H6502_MODE_BYTES_ABS_Y     3 // Absolute,Y
+#define H6502_MODE_BYTES_IND       3 // (Indirect), JMP only
+#define H6502_MODE_BYTES_IND_X     2 // (Zero Page,X)
+#define H6502_MODE_BYTES_IND_Y     2 // (Zero Page),Y
+#define H6502_MODE_BYTES_REL       2 // Relative, branches
+#define H6502_MODE_BYTES_ZP_IND    2 // (Zero Page), 65C02
+#define H6502_MODE_BYTES_ABS_IND_X 3 // (Absolute,X), 65C02
+
+// Addressing modes, in the same order as above
+#define H6502_ADDRESS_MODES(MODE) \
+    MODE(IMP)                     \
+    MODE(ACC)                     \
+    MODE(IM)                      \
+    MODE(ZP)                      \
+    MODE(ZP_X)                    \
+    MODE(ZP_Y)                    \
+    MODE(ABS)                     \
+    MODE(ABS_X)                   \
+    MODE(ABS_Y)                   \
+    MODE(IND)                     \
+    MODE(IND_X)                   \
+    MODE(IND_Y)                   \
+    MODE(REL)                     \
+    MODE(ZP_IND)                  \
+    MODE(ABS_IND_X)
+
+// Documented opcodes that behave the same on every variant
+#define H6502_OPCODES_DOCUMENTED(OPCODE)                               \
+    /* LDA - Load Accumulator */                                       \
+    OPCODE(LDA_IM,        LDA, 0xA9, IM,        2, 2, 0, LDA)          \
+    OPCODE(LDA_ZP,        LDA, 0xA5, ZP,        2, 3, 0, LDA)          \
+    OPCODE(LDA_ZP_X,      LDA, 0xB5, ZP_X,      2, 4, 0, LDA)          \
+    OPCODE(LDA_ABS,       LDA, 0xAD, ABS,       3, 4, 0, LDA)          \
+    OPCODE(LDA_ABS_X,     LDA, 0xBD, ABS_X,     3, 4, 1, LDA)          \
+    OPCODE(LDA_ABS_Y,     LDA, 0xB9, ABS_Y,     3, 4, 1, LDA)          \
+    OPCODE(LDA_IND_X,     LDA, 0xA1, IND_X,     2, 6, 0, LDA)          \
+    OPCODE(LDA_IND_Y,     LDA, 0xB1, IND_Y,     2, 5, 1, LDA)          \
+    /* LDX - Load X Register */                                        \
+    OPCODE(LDX_IM,        LDX, 0xA2, IM,        2, 2, 0, LDX)          \
+    OPCODE(LDX_ZP,        LDX, 0xA6, ZP,        2, 3, 0, LDX)          \
+    OPCODE(LDX_ZP_Y,      LDX, 0xB6, ZP_Y,      2, 4, 0, LDX)          \
+    OPCODE(LDX_ABS,       LDX, 0xAE, ABS,       3, 4, 0, LDX)          \
+    OPCODE(LDX_ABS_Y,     LDX, 0xBE, ABS_Y,     3, 4, 1, LDX)          \
+    /* LDY - Load Y Register */                                        \
+    OPCODE(LDY_IM,        LDY, 0xA0, IM,        2, 2, 0, LDY)          \
+    OPCODE(LDY_ZP,        LDY, 0xA4, ZP,        2, 3, 0, LDY)          \
+    OPCODE(LDY_ZP_X,      LDY, 0xB4, ZP_X,      2, 4, 0, LDY)          \
+    OPCODE(LDY_ABS,       LDY, 0xAC, ABS,       3, 4, 0, LDY)          \
+    OPCODE(LDY_ABS_X,     LDY, 0xBC, ABS_X,     3, 4, 1, LDY)          \
+    /* STA - Store Accumulator */                                      \
+    OPCODE(STA_ZP,        STA, 0x85, ZP,        2, 3, 0, STA)          \
+    OPCODE(STA_ZP_X,      STA, 0x95, ZP_X,      2, 4, 0, STA)          \
+    OPCODE(STA_ABS,       STA, 0x8D, ABS,       3, 4, 0, STA)          \
+    OPCODE(STA_ABS_X,     STA, 0x9D, ABS_X,     3, 5, 0, STA)          \
+    OPCODE(STA_ABS_Y,     STA, 0x99, ABS_Y,     3, 5, 0, STA)          \
+    OPCODE(STA_IND_X,     STA, 0x81, IND_X,     2, 6, 0, STA)          \
+    OPCODE(STA_IND_Y,     STA, 0x91, IND_Y,     2, 6, 0, STA)          \
+    /* STX - Store X Register */                                       \
+    OPCODE(STX_ZP,        STX, 0x86, ZP,        2, 3, 0, STX)          \
+    OPCODE(STX_ZP_Y,      STX, 0x96, ZP_Y,      2, 4, 0, STX)          \
+    OPCODE(STX_ABS,       STX, 0x8E, ABS,       3, 4, 0, STX)          \
+    /* STY - Store Y Register */                                       \
+    OPCODE(STY_ZP,        STY, 0x84, ZP,        2, 3, 0, STY)          \
+    OPCODE(STY_ZP_X,      STY, 0x94, ZP_X,      2, 4, 0, STY)          \
+    OPCODE(STY_ABS,       STY, 0x8C, ABS,       3, 4, 0, STY)          \
+    /* JMP - JuMP (JMP (ind) differs between variants) */              \
+    OPCODE(JMP_ABS,       JMP, 0x4C, ABS,       3, 3, 0, JMP)          \
+    /* JSR - Jump to SubRoutine */                                     \
+    OPCODE(JSR,           JSR, 0x20, ABS,       3, 6, 0, JSR)          \
+    /* RTS - ReTurn from Subroutine */                                 \
+    OPCODE(RTS,           RTS, 0x60, IMP,       1, 6, 0, RTS)          \
+    /* BRK - BReaK (software interrupt) */                             \
+    OPCODE(BRK,           BRK, 0x00, IMP,       1, 7, 0, BRK)          \
+    /* RTI - ReTurn from Interrupt */                                  \
+    OPCODE(RTI,           RTI, 0x40, IMP,       1, 6, 0, RTI)          \
+    /* Register Instructions */                                        \
+    OPCODE(TAX,           TAX, 0xAA, IMP,       1, 2, 0, TAX)          \
+    OPCODE(TXA,           TXA, 0x8A, IMP,       1, 2, 0, TXA)          \
+    OPCODE(TAY,           TAY, 0xA8, IMP,       1, 2, 0, TAY)          \
+    OPCODE(TYA,           TYA, 0x98, IMP,       1, 2, 0, TYA)          \
+    OPCODE(DEX,           DEX, 0xCA, IMP,       1, 2, 0, DEX)          \
+    OPCODE(INX,           INX, 0xE8, IMP,       1, 2, 0, INX)          \
+    OPCODE(DEY,           DEY, 0x88, IMP,       1, 2, 0, DEY)          \
+    OPCODE(INY,           INY, 0xC8, IMP,       1, 2, 0, INY)          \
+    /* Stack Instructions */                                           \
+    OPCODE(TSX,           TSX, 0xBA, IMP,       1, 2, 0, TSX)          \
+    OPCODE(TXS,           TXS, 0x9A, IMP,       1, 2, 0, TXS)          \
+    OPCODE(PHA,           PHA, 0x48, IMP,       1, 3, 0, PHA)          \
+    OPCODE(PLA,           PLA, 0x68, IMP,       1, 4, 0, PLA)          \
+    OPCODE(PHP,           PHP, 0x08, IMP,       1, 3, 0, PHP)          \
+    OPCODE(PLP,           PLP, 0x28, IMP,       1, 4, 0, PLP)          \
+    /* ORA - OR Memory with Accumulator */                             \
+    OPCODE(ORA_IM,        ORA, 0x09, IM,        2, 2, 0, ORA)          \
+    OPCODE(ORA_ZP,        ORA, 0x05, ZP,        2, 3, 0, ORA)          \
+    OPCODE(ORA_ZP_X,      ORA, 0x15, ZP_X,      2, 4, 0, ORA)          \
+    OPCODE(ORA_ABS,       ORA, 0x0D, ABS,       3, 4, 0, ORA)          \
+    OPCODE(ORA_ABS_X,     ORA, 0x1D, ABS_X,     3, 4, 1, ORA)          \
+    OPCODE(ORA_ABS_Y,     ORA, 0x19, ABS_Y,     3, 4, 1, ORA)          \
+    OPCODE(ORA_IND_X,     ORA, 0x01, IND_X,     2, 6, 0, ORA)          \
+    OPCODE(ORA_IND_Y,     ORA, 0x11, IND_Y,     2, 5, 1, ORA)          \
+    /* AND - bitwise AND with accumulator */                           \
+    OPCODE(AND_IM,        AND, 0x29, IM,        2, 2, 0, AND)          \
+    OPCODE(AND_ZP,        AND, 0x25, ZP,        2, 3, 0, AND)          \
+    OPCODE(AND_ZP_X,      AND, 0x35, ZP_X,      2, 4, 0, AND)          \
+    OPCODE(AND_ABS,       AND, 0x2D, ABS,       3, 4, 0, AND)          \
+    OPCODE(AND_ABS_X,     AND, 0x3D, ABS_X,     3, 4, 1, AND)          \
+    OPCODE(AND_ABS_Y,     AND, 0x39, ABS_Y,     3, 4, 1, AND)          \
+    OPCODE(AND_IND_X,     AND, 0x21, IND_X,     2, 6, 0, AND)          \
+    OPCODE(AND_IND_Y,     AND, 0x31, IND_Y,     2, 5, 1, AND)          \
+    /* EOR - Exclusive OR */                                           \
+    OPCODE(EOR_IM,        EOR, 0x49, IM,        2, 2, 0, EOR)          \
+    OPCODE(EOR_ZP,        EOR, 0x45, ZP,        2, 3, 0, EOR)          \
+    OPCODE(EOR_ZP_X,      EOR, 0x55, ZP_X,      2, 4, 0, EOR)          \
+    OPCODE(EOR_ABS,       EOR, 0x4D, ABS,       3, 4, 0, EOR)          \
+    OPCODE(EOR_ABS_X,     EOR, 0x5D, ABS_X,     3, 4, 1, EOR)          \
+    OPCODE(EOR_ABS_Y,     EOR, 0x59, ABS_Y,     3, 4, 1, EOR)          \
+    OPCODE(EOR_IND_X,     EOR, 0x41, IND_X,     2, 6, 0, EOR)          \
+    OPCODE(EOR_IND_Y,     EOR, 0x51, IND_Y,     2, 5, 1, EOR)          \
+    /* BIT - test BITs */                                              \
+    OPCODE(BIT_ZP,        BIT, 0x24, ZP,        2, 3, 0, BIT)          \
+    OPCODE(BIT_ABS,       BIT, 0x2C, ABS,       3, 4, 0, BIT)          \
+    /* DEC - DECrement memory */                                       \
+    OPCODE(DEC_ZP,        DEC, 0xC6, ZP,        2, 5, 0, DEC)          \
+    OPCODE(DEC_ZP_X,      DEC, 0xD6, ZP_X,      2, 6, 0, DEC)          \
+    OPCODE(DEC_ABS,       DEC, 0xCE, ABS,       3, 6, 0, DEC)          \
+    OPCODE(DEC_ABS_X,     DEC, 0xDE, ABS_X,     3, 7, 0, DEC)          \
+    /* INC - INCrement memory */                                       \
+    OPCODE(INC_ZP,        INC, 0xE6, ZP,        2, 5, 0, INC)          \
+    OPCODE(INC_ZP_X,      INC, 0xF6, ZP_X,      2, 6, 0, INC)          \
+    OPCODE(INC_ABS,       INC, 0xEE, ABS,       3, 6, 0, INC)          \
+    OPCODE(INC_ABS_X,     INC, 0xFE, ABS_X,     3, 7, 0, INC)          \
+    /* Branch Instructions */                                          \
+    OPCODE(BPL,           BPL, 0x10, REL,       2, 2, 0, BPL)          \
+    OPCODE(BMI,           BMI, 0x30, REL,       2, 2, 0, BMI)          \
+    OPCODE(BVC,           BVC, 0x50, REL,       2, 2, 0, BVC)          \
+    OPCODE(BVS,           BVS, 0x70, REL,       2, 2, 0, BVS)          \
+    OPCODE(BCC,           BCC, 0x90, REL,       2, 2, 0, BCC)          \
+    OPCODE(BCS,           BCS, 0xB0, REL,       2, 2, 0, BCS)          \
+    OPCODE(BNE,           BNE, 0xD0, REL,       2, 2, 0, BNE)          \
+    OPCODE(BEQ,           BEQ, 0xF0, REL,       2, 2, 0, BEQ)          \
+    /* Flag (Processor Status) Instructions */                         \
+    OPCODE(CLC,           CLC, 0x18, IMP,       1, 2, 0, CLC)          \
+    OPCODE(SEC,           SEC, 0x38, IMP,       1, 2, 0, SEC)          \
+    OPCODE(CLI,           CLI, 0x58, IMP,       1, 2, 0, CLI)          \
+    OPCODE(SEI,           SEI, 0x78, IMP,       1, 2, 0, SEI)          \
+    OPCODE(CLV,           CLV, 0xB8, IMP,       1, 2, 0, CLV)          \
+    OPCODE(CLD,           CLD, 0xD8, IMP,       1, 2, 0, CLD)          \
+    OPCODE(SED,           SED, 0xF8, IMP,       1, 2, 0, SED)          \
+    /* NOP - No OPeration */                                           \
+    OPCODE(NOP,           NOP, 0xEA, IMP,       1, 2, 0, NOP)          \
+    /* ADC - ADd with Carry */                                         \
+    OPCODE(ADC_IM,        ADC, 0x69, IM,        2, 2, 0, ADC)          \
+    OPCODE(ADC_ZP,        ADC, 0x65, ZP,        2, 3, 0, ADC)          \
+    OPCODE(ADC_ZP_X,      ADC, 0x75, ZP_X,      2, 4, 0, ADC)          \
+    OPCODE(ADC_ABS,       ADC, 0x6D, ABS,       3, 4, 0, ADC)          \
+    OPCODE(ADC_ABS_X,     ADC, 0x7D, ABS_X,     3, 4, 1, ADC)          \
+    OPCODE(ADC_ABS_Y,     ADC, 0x79, ABS_Y,     3, 4, 1, ADC)          \
+    OPCODE(ADC_IND_X,     ADC, 0x61, IND_X,     2, 6, 0, ADC)          \
+    OPCODE(ADC_IND_Y,     ADC, 0x71, IND_Y,     2, 5, 1, ADC)          \
+    /* SBC - SuBtract with Carry */                                    \
+    OPCODE(SBC_IM,        SBC, 0xE9, IM,        2, 2, 0, SBC)          \
+    OPCODE(SBC_ZP,        SBC, 0xE5, ZP,        2, 3, 0, SBC)          \
+    OPCODE(SBC_ZP_X,      SBC, 0xF5, ZP_X,      2, 4, 0, SBC)          \
+    OPCODE(SBC_ABS,       SBC, 0xED, ABS,       3, 4, 0, SBC)          \
+    OPCODE(SBC_ABS_X,     SBC, 0xFD, ABS_X,     3, 4, 1, SBC)          \
+    OPCODE(SBC_ABS_Y,     SBC, 0xF9, ABS_Y,     3, 4, 1, SBC)          \
+    OPCODE(SBC_IND_X,     SBC, 0xE1, IND_X,     2, 6, 0, SBC)          \
+    OPCODE(SBC_IND_Y,     SBC, 0xF1, IND_Y,     2, 5, 1, SBC)          \
+    /* CMP - CoMPare accumulator */                                    \
+    OPCODE(CMP_IM,        CMP, 0xC9, IM,        2, 2, 0, CMP)          \
+    OPCODE(CMP_ZP,        CMP, 0xC5, ZP,        2, 3, 0, CMP)          \
+    OPCODE(CMP_ZP_X,      CMP, 0xD5, ZP_X,      2, 4, 0, CMP)          \
+    OPCODE(CMP_ABS,       CMP, 0xCD, ABS,       3, 4, 0, CMP)          \
+    OPCODE(CMP_ABS_X,     CMP, 0xDD, ABS_X,     3, 4, 1, CMP)          \
+    OPCODE(CMP_ABS_Y,     CMP, 0xD9, ABS_Y,     3, 4, 1, CMP)          \
+    OPCODE(CMP_IND_X,     CMP, 0xC1, IND_X,     2, 6, 0, CMP)          \
+    OPCODE(CMP_IND_Y,     CMP, 0xD1, IND_Y,     2, 5, 1, CMP)          \
+    /* CPX - ComPare X register */                                     \
+    OPCODE(CPX_IM,        CPX, 0xE0, IM,        2, 2, 0, CPX)          \
+    OPCODE(CPX_ZP,        CPX, 0xE4, ZP,        2, 3, 0, CPX)          \
+    OPCODE(CPX_ABS,       CPX, 0xEC, ABS,       3, 4, 0, CPX)          \
+    /* CPY - ComPare Y register */                                     \
+    OPCODE(CPY_IM,        CPY, 0xC0, IM,        2, 2, 0, CPY)          \
+    OPCODE(CPY_ZP,        CPY, 0xC4, ZP,        2, 3, 0, CPY)          \
+    OPCODE(CPY_ABS,       CPY, 0xCC, ABS,       3, 4, 0, CPY)          \
+    /* ASL - Arithmetic Shift Left (ABS_X differs between variants) */ \
+    OPCODE(ASL,           ASL, 0x0A, ACC,       1, 2, 0, ASL_A)        \
+    OPCODE(ASL_ZP,        ASL, 0x06, ZP,        2, 5, 0, ASL)          \
+    OPCODE(ASL_ZP_X,      ASL, 0x16, ZP_X,      2, 6, 0, ASL)          \
+    OPCODE(ASL_ABS,       ASL, 0x0E, ABS,       3, 6, 0, ASL)          \
+    /* LSR - Logical Shift Right */                                    \
+    OPCODE(LSR,           LSR, 0x4A, ACC,       1, 2, 0, LSR_A)        \
+    OPCODE(LSR_ZP,        LSR, 0x46, ZP,        2, 5, 0, LSR)          \
+    OPCODE(LSR_ZP_X,      LSR, 0x56, ZP_X,      2, 6, 0, LSR)          \
+    OPCODE(LSR_ABS,       LSR, 0x4E, ABS,       3, 6, 0, LSR)          \
+    /* ROL - ROtate Left */                                            \
+    OPCODE(ROL,           ROL, 0x2A, ACC,       1, 2, 0, ROL_A)        \
+    OPCODE(ROL_ZP,        ROL, 0x26, ZP,        2, 5, 0, ROL)          \
+    OPCODE(ROL_ZP_X,      ROL, 0x36, ZP_X,      2, 6, 0, ROL)          \
+    OPCODE(ROL_ABS,       ROL, 0x2E, ABS,       3, 6, 0, ROL)          \
+    /* ROR - ROtate Right */                                           \
+    OPCODE(ROR,           ROR, 0x6A, ACC,       1, 2, 0, ROR_A)        \
+    OPCODE(ROR_ZP,        ROR, 0x66, ZP,        2, 5, 0, ROR)          \
+    OPCODE(ROR_ZP_X,      ROR, 0x76, ZP_X,      2, 6, 0, ROR)          \
+    OPCODE(ROR_ABS,       ROR, 0x6E, ABS,       3, 6, 0, ROR)
+
+// Documented opcodes that differ on the NMOS 6502
+#define H6502_OPCODES_NMOS(OPCODE)                                       \
+    /* JMP (ind) - the high byte of the pointer does not cross a page */ \
+    OPCODE(JMP_IND,       JMP, 0x6C, IND,       3, 5, 0, JMP)            \
+    /* Shifts ABS_X always take 7 cycles */                              \
+    OPCODE(ASL_ABS_X,     ASL, 0x1E, ABS_X,     3, 7, 0, ASL)            \
+    OPCODE(LSR_ABS_X,     LSR, 0x5E, ABS_X,     3, 7, 0, LSR)            \
+    OPCODE(ROL_ABS_X,     ROL, 0x3E, ABS_X,     3, 7, 0, ROL)            \
+    OPCODE(ROR_ABS_X,     ROR, 0x7E, ABS_X,     3, 7, 0, ROR)
+
+// 65C02 opcodes, including its versions of the NMOS opcodes above
+#define H6502_OPCODES_65C02(OPCODE)                              \
+    /* JMP (ind) - fixed page wrap, 1 extra cycle */             \
+    OPCODE(JMP_IND,       JMP, 0x6C, IND,       3, 6, 0, JMP)    \
+    /* Shifts ABS_X only take 7 cycles on a page cross */        \
+    OPCODE(ASL_ABS_X,     ASL, 0x1E, ABS_X,     3, 6, 1, ASL)    \
+    OPCODE(LSR_ABS_X,     LSR, 0x5E, ABS_X,     3, 6, 1, LSR)    \
+    OPCODE(ROL_ABS_X,     ROL, 0x3E, ABS_X,     3, 6, 1, ROL)    \
+    OPCODE(ROR_ABS_X,     ROR, 0x7E, ABS_X,     3, 6, 1, ROR)    \
+    /* STZ - STore Zero */                                       \
+    OPCODE(STZ_ZP,        STZ, 0x64, ZP,        2, 3, 0, STZ)    \
+    OPCODE(STZ_ZP_X,      STZ, 0x74, ZP_X,      2, 4, 0, STZ)    \
+    OPCODE(STZ_ABS,       STZ, 0x9C, ABS,       3, 4, 0, STZ)    \
+    OPCODE(STZ_ABS_X,     STZ, 0x9E, ABS_X,     3, 5, 0, STZ)    \
+    /* BRA - BRanch Always */                                    \
+    OPCODE(BRA,           BRA, 0x80, REL,       2, 2, 0, BRA)    \
+    /* Stack Instructions */                                     \
+    OPCODE(PHX,           PHX, 0xDA, IMP,       1, 3, 0, PHX)    \
+    OPCODE(PLX,           PLX, 0xFA, IMP,       1, 4, 0, PLX)    \
+    OPCODE(PHY,           PHY, 0x5A, IMP,       1, 3, 0, PHY)    \
+    OPCODE(PLY,           PLY, 0x7A, IMP,       1, 4, 0, PLY)    \
+    /* TSB - Test and Set Bits */                                \
+    OPCODE(TSB_ZP,        TSB, 0x04, ZP,        2, 5, 0, TSB)    \
+    OPCODE(TSB_ABS,       TSB, 0x0C, ABS,       3, 6, 0, TSB)    \
+    /* TRB - Test and Reset Bits */                              \
+    OPCODE(TRB_ZP,        TRB, 0x14, ZP,        2, 5, 0, TRB)    \
+    OPCODE(TRB_ABS,       TRB, 0x1C, ABS,       3, 6, 0, TRB)    \
+    /* INC A / DEC A */                                          \
+    OPCODE(INC,           INC, 0x1A, ACC,       1, 2, 0, INC_A)  \
+    OPCODE(DEC,           DEC, 0x3A, ACC,       1, 2, 0, DEC_A)  \
+    /* BIT - immediate only affects Z */                         \
+    OPCODE(BIT_IM,        BIT, 0x89, IM,        2, 2, 0, BIT_IM) \
+    OPCODE(BIT_ZP_X,      BIT, 0x34, ZP_X,      2, 4, 0, BIT)    \
+    OPCODE(BIT_ABS_X,     BIT, 0x3C, ABS_X,     3, 4, 1, BIT)    \
+    /* JMP (abs,X) */                                            \
+    OPCODE(JMP_ABS_IND_X, JMP, 0x7C, ABS_IND_X, 3, 6, 0, JMP)    \
+    /* (zp) - Zero Page Indirect */                              \
+    OPCODE(ORA_ZP_IND,    ORA, 0x12, ZP_IND,    2, 5, 0, ORA)    \
+    OPCODE(AND_ZP_IND,    AND, 0x32, ZP_IND,    2, 5, 0, AND)    \
+    OPCODE(EOR_ZP_IND,    EOR, 0x52, ZP_IND,    2, 5, 0, EOR)    \
+    OPCODE(ADC_ZP_IND,    ADC, 0x72, ZP_IND,    2, 5, 0, ADC)    \
+    OPCODE(STA_ZP_IND,    STA, 0x92, ZP_IND,    2, 5, 0, STA)    \
+    OPCODE(LDA_ZP_IND,    LDA, 0xB2, ZP_IND,    2, 5, 0, LDA)    \
+    OPCODE(CMP_ZP_IND,    CMP, 0xD2, ZP_IND,    2, 5, 0, CMP)    \
+    OPCODE(SBC_ZP_IND,    SBC, 0xF2, ZP_IND,    2, 5, 0, SBC)
+
+// Stable undocumented NMOS opcodes
+#define H6502_OPCODES_UNDOCUMENTED(OPCODE)                    \
+    /* LAX - LDA + LDX */                                     \
+    OPCODE(LAX_ZP,        LAX, 0xA7, ZP,        2, 3, 0, LAX) \
+    OPCODE(LAX_ZP_Y,      LAX, 0xB7, ZP_Y,      2, 4, 0, LAX) \
+    OPCODE(LAX_ABS,       LAX, 0xAF, ABS,       3, 4, 0, LAX) \
+    OPCODE(LAX_ABS_Y,     LAX, 0xBF, ABS_Y,     3, 4, 1, LAX) \
+    OPCODE(LAX_IND_X,     LAX, 0xA3, IND_X,     2, 6, 0, LAX) \
+    OPCODE(LAX_IND_Y,     LAX, 0xB3, IND_Y,     2, 5, 1, LAX) \
+    /* SAX - store A & X */                                   \
+    OPCODE(SAX_ZP,        SAX, 0x87, ZP,        2, 3, 0, SAX) \
+    OPCODE(SAX_ZP_Y,      SAX, 0x97, ZP_Y,      2, 4, 0, SAX) \
+    OPCODE(SAX_ABS,       SAX, 0x8F, ABS,       3, 4, 0, SAX) \
+    OPCODE(SAX_IND_X,     SAX, 0x83, IND_X,     2, 6, 0, SAX) \
+    /* DCP - DEC + CMP */                                     \
+    OPCODE(DCP_ZP,        DCP, 0xC7, ZP,        2, 5, 0, DCP) \
+    OPCODE(DCP_ZP_X,      DCP, 0xD7, ZP_X,      2, 6, 0, DCP) \
+    OPCODE(DCP_ABS,       DCP, 0xCF, ABS,       3, 6, 0, DCP) \
+    OPCODE(DCP_ABS_X,     DCP, 0xDF, ABS_X,     3, 7, 0, DCP) \
+    OPCODE(DCP_ABS_Y,     DCP, 0xDB, ABS_Y,     3, 7, 0, DCP) \
+    OPCODE(DCP_IND_X,     DCP, 0xC3, IND_X,     2, 8, 0, DCP) \
+    OPCODE(DCP_IND_Y,     DCP, 0xD3, IND_Y,     2, 8, 0, DCP) \
+    /* ISC - INC + SBC */                                     \
+    OPCODE(ISC_ZP,        ISC, 0xE7, ZP,        2, 5, 0, ISC) \
+    OPCODE(ISC_ZP_X,      ISC, 0xF7, ZP_X,      2, 6, 0, ISC) \
+    OPCODE(ISC_ABS,       ISC, 0xEF, ABS,       3, 6, 0, ISC) \
+    OPCODE(ISC_ABS_X,     ISC, 0xFF, ABS_X,     3, 7, 0, ISC) \
+    OPCODE(ISC_ABS_Y,     ISC, 0xFB, ABS_Y,     3, 7, 0, ISC) \
+    OPCODE(ISC_IND_X,     ISC, 0xE3, IND_X,     2, 8, 0, ISC) \
+    OPCODE(ISC_IND_Y,     ISC, 0xF3, IND_Y,     2, 8, 0, ISC) \
+    /* SLO - ASL + ORA */                                     \
+    OPCODE(SLO_ZP,        SLO, 0x07, ZP,        2, 5, 0, SLO) \
+    OPCODE(SLO_ZP_X,      SLO, 0x17, ZP_X,      2, 6, 0, SLO) \
+    OPCODE(SLO_ABS,       SLO, 0x0F, ABS,       3, 6, 0, SLO) \
+    OPCODE(SLO_ABS_X,     SLO, 0x1F, ABS_X,     3, 7, 0, SLO) \
+    OPCODE(SLO_ABS_Y,     SLO, 0x1B, ABS_Y,     3, 7, 0, SLO) \
+    OPCODE(SLO_IND_X,     SLO, 0x03, IND_X,     2, 8, 0, SLO) \
+    OPCODE(SLO_IND_Y,     SLO, 0x13, IND_Y,     2, 8, 0, SLO) \
+    /* RLA - ROL + AND */                                     \
+    OPCODE(RLA_ZP,        RLA, 0x27, ZP,        2, 5, 0, RLA) \
+    OPCODE(RLA_ZP_X,      RLA, 0x37, ZP_X,      2, 6, 0, RLA) \
+    OPCODE(RLA_ABS,       RLA, 0x2F, ABS,       3, 6, 0, RLA) \
+    OPCODE(RLA_ABS_X,     RLA, 0x3F, ABS_X,     3, 7, 0, RLA) \
+    OPCODE(RLA_ABS_Y,     RLA, 0x3B, ABS_Y,     3, 7, 0, RLA) \
+    OPCODE(RLA_IND_X,     RLA, 0x23, IND_X,     2, 8, 0, RLA) \
+    OPCODE(RLA_IND_Y,     RLA, 0x33, IND_Y,     2, 8, 0, RLA) \
+    /* SRE - LSR + EOR */                                     \
+    OPCODE(SRE_ZP,        SRE, 0x47, ZP,        2, 5, 0, SRE) \
+    OPCODE(SRE_ZP_X,      SRE, 0x57, ZP_X,      2, 6, 0, SRE) \
+    OPCODE(SRE_ABS,       SRE, 0x4F, ABS,       3, 6, 0, SRE) \
+    OPCODE(SRE_ABS_X,     SRE, 0x5F, ABS_X,     3, 7, 0, SRE) \
+    OPCODE(SRE_ABS_Y,     SRE, 0x5B, ABS_Y,     3, 7, 0, SRE) \
+    OPCODE(SRE_IND_X,     SRE, 0x43, IND_X,     2, 8, 0, SRE) \
+    OPCODE(SRE_IND_Y,     SRE, 0x53, IND_Y,     2, 8, 0, SRE) \
+    /* RRA - ROR + ADC */                                     \
+    OPCODE(RRA_ZP,        RRA, 0x67, ZP,        2, 5, 0, RRA) \
+    OPCODE(RRA_ZP_X,      RRA, 0x77, ZP_X,      2, 6, 0, RRA) \
+    OPCODE(RRA_ABS,       RRA, 0x6F, ABS,       3, 6, 0, RRA) \
+    OPCODE(RRA_ABS_X,     RRA, 0x7F, ABS_X,     3, 7, 0, RRA) \
+    OPCODE(RRA_ABS_Y,     RRA, 0x7B, ABS_Y,     3, 7, 0, RRA) \
+    OPCODE(RRA_IND_X,     RRA, 0x63, IND_X,     2, 8, 0, RRA) \
+    OPCODE(RRA_IND_Y,     RRA, 0x73, IND_Y,     2, 8, 0, RRA)
+
+// The full opcode table for the selected H6502_VARIANT
+#if H6502_VARIANT == H6502_VARIANT_NMOS
+#define H6502_OPCODE_TABLE(OPCODE)   \
+    H6502_OPCODES_DOCUMENTED(OPCODE) \
+    H6502_OPCODES_NMOS(OPCODE)
+#elif H6502_VARIANT == H6502_VARIANT_NMOS_UNDOC
+#define H6502_OPCODE_TABLE(OPCODE)   \
+    H6502_OPCODES_DOCUMENTED(OPCODE) \
+    H6502_OPCODES_NMOS(OPCODE)       \
+    H6502_OPCODES_UNDOCUMENTED(OPCODE)
+#elif H6502_VARIANT == H6502_VARIANT_65C02
+#define H6502_OPCODE_TABLE(OPCODE)   \
+    H6502_OPCODES_DOCUMENTED(OPCODE) \
+    H6502_OPCODES_65C02(OPCODE)
+#endif
+
+#endif // __OPCODES_H__
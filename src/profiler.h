@@ -0,0 +1,283 @@
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+// Call stack profiler
+// Included by h6502.h when H6502_CALL_PROFILER is 1.
+//
+// A shadow call stack follows JSR/RTS and BRK/RTI, every instruction's cycles
+// are added to the call path that is running. The paths are written as
+// "folded stacks", one line per path, which flamegraph.pl and speedscope read:
+//
+//  reset;main;print_string 1234
+//
+// Names come from an optional label file, addresses without a label are
+// written as "$C000".
+// > https://github.com/brendangregg/FlameGraph
+
+#define PROFILER_MAX_NODES  4096 // distinct call paths
+#define PROFILER_MAX_DEPTH  129  // the 256 byte stack holds 128 return addresses
+#define PROFILER_MAX_LABEL  64
+#define PROFILER_NO_NODE    -1
+
+// One call path, children are a linked list
+typedef struct Profiler_Node
+{
+    u16      address; // address that was called
+    s32      parent;
+    s32      first_child;
+    s32      next_sibling;
+    uint64_t cycles; // cycles spent in this path, not counting the calls it made
+} Profiler_Node;
+
+typedef struct Profiler_Frame
+{
+    s32 node;
+    s32 stack_pointer; // stack pointer before the call, the frame ends when it is back here
+} Profiler_Frame;
+
+typedef struct Call_Profiler
+{
+    Profiler_Node  nodes[PROFILER_MAX_NODES];
+    s32            node_count;
+    Profiler_Frame frames[PROFILER_MAX_DEPTH];
+    s32            depth;
+    u32            dropped_calls; // calls not followed, out of nodes or frames
+} Call_Profiler;
+
+typedef struct Profiler_Label
+{
+    u16  address;
+    char name[PROFILER_MAX_LABEL];
+} Profiler_Label;
+
+typedef struct Profiler_Labels
+{
+    Profiler_Label *labels; // sorted by address
+    size_t          count;
+} Profiler_Labels;
+
+static Call_Profiler   call_profiler   = {0};
+static Profiler_Labels profiler_labels = {0};
+
+static inline s32 Profiler_New_Node(u16 address, s32 parent)
+{
+    if (call_profiler.node_count >= PROFILER_MAX_NODES)
+        return PROFILER_NO_NODE;
+
+    const s32      index = call_profiler.node_count++;
+    Profiler_Node *node  = &call_profiler.nodes[index];
+    node->address        = address;
+    node->parent         = parent;
+    node->first_child    = PROFILER_NO_NODE;
+    node->next_sibling   = PROFILER_NO_NODE;
+    node->cycles         = 0;
+
+    if (parent != PROFILER_NO_NODE)
+    {
+        node->next_sibling                      = call_profiler.nodes[parent].first_child;
+        call_profiler.nodes[parent].first_child = index;
+    }
+    return index;
+}
+
+// Start a new profile, the root of every path is the current PC
+static inline void Call_Profiler_Reset(void)
+{
+    call_profiler.node_count    = 0;
+    call_profiler.depth         = 0;
+    call_profiler.dropped_calls = 0;
+
+    call_profiler.frames[0].node          = Profiler_New_Node(cpu.program_counter, PROFILER_NO_NODE);
+    call_profiler.frames[0].stack_pointer = 0x100; // never ends
+}
+
+static inline void Profiler_Push_Call(u16 address, s32 stack_pointer)
+{
+    if (call_profiler.depth + 1 >= PROFILER_MAX_DEPTH)
+    {
+        call_profiler.dropped_calls++;
+        return;
+    }
+
+    const s32 parent = call_profiler.frames[call_profiler.depth].node;
+    s32       child  = call_profiler.nodes[parent].first_child;
+    while (child != PROFILER_NO_NODE && call_profiler.nodes[child].address != address)
+    {
+        child = call_profiler.nodes[child].next_sibling;
+    }
+    if (child == PROFILER_NO_NODE)
+    {
+        child = Profiler_New_Node(address, parent);
+        if (child == PROFILER_NO_NODE)
+        {
+            call_profiler.dropped_calls++;
+            return;
+        }
+    }
+
+    call_profiler.depth++;
+    call_profiler.frames[call_profiler.depth].node          = child;
+    call_profiler.frames[call_profiler.depth].stack_pointer = stack_pointer;
+}
+
+// Drop every frame whose stack space has been given back. This also copes
+// with code that pulls return addresses off the stack itself.
+static inline void Profiler_Return(void)
+{
+    while (call_profiler.depth > 0 && call_profiler.frames[call_profiler.depth].stack_pointer <= cpu.stack_pointer)
+    {
+        call_profiler.depth--;
+    }
+}
+
+// Called before every instruction, PC is on the opcode. Without a
+// Call_Profiler_Reset() the root is the first instruction that runs.
+static inline void Call_Profiler_Instruction(void)
+{
+    if (call_profiler.node_count == 0)
+        Call_Profiler_Reset();
+}
+
+// Called after every instruction
+static inline void Call_Profiler_Record(u8 opcode, s32 cycles_taken)
+{
+    call_profiler.nodes[call_profiler.frames[call_profiler.depth].node].cycles += (uint64_t)cycles_taken;
+
+    switch (opcode)
+    {
+    case INS_JSR: Profiler_Push_Call(cpu.program_counter, cpu.stack_pointer + 2); break; // pushed PC
+    case INS_BRK: Profiler_Push_Call(cpu.program_counter, cpu.stack_pointer + 3); break; // pushed PC and PS
+    case INS_RTS:
+    case INS_RTI: Profiler_Return(); break;
+    default: break;
+    }
+}
+
+// ---------------------------------------------------------------------
+// Labels
+
+static inline int Profiler_Compare_Labels(const void *a, const void *b)
+{
+    const Profiler_Label *label_a = (const Profiler_Label *)a;
+    const Profiler_Label *label_b = (const Profiler_Label *)b;
+    return (int)label_a->address - (int)label_b->address;
+}
+
+static inline void Profiler_Free_Labels(void)
+{
+    free(profiler_labels.labels);
+    profiler_labels.labels = NULL;
+    profiler_labels.count  = 0;
+}
+
+// Reads one label per line, either "C000 reset" / "$C000 reset" or the VICE
+// format written by ld65 -Ln, "al 00C000 .reset". Lines starting with ';' or
+// '#' are skipped. Returns the number of labels loaded.
+static inline size_t Profiler_Load_Labels_From_File(FILE *file)
+{
+    Profiler_Free_Labels();
+
+    size_t capacity = 0;
+    char   line[256];
+    while (fgets(line, sizeof(line), file))
+    {
+        unsigned int address = 0;
+        char         name[PROFILER_MAX_LABEL];
+
+        if (line[0] == ';' || line[0] == '#')
+            continue;
+        if (sscanf(line, "al %x .%63s", &address, name) != 2 &&
+            sscanf(line, " $%x %63s", &address, name) != 2 &&
+            sscanf(line, " %x %63s", &address, name) != 2)
+            continue;
+
+        if (profiler_labels.count == capacity)
+        {
+            capacity               = capacity ? capacity * 2 : 64;
+            Profiler_Label *labels = realloc(profiler_labels.labels, capacity * sizeof(Profiler_Label));
+            if (labels == NULL)
+                break;
+            profiler_labels.labels = labels;
+        }
+
+        Profiler_Label *label = &profiler_labels.labels[profiler_labels.count++];
+        label->address        = address & 0xFFFF;
+        snprintf(label->name, sizeof(label->name), "%s", name);
+    }
+
+    qsort(profiler_labels.labels, profiler_labels.count, sizeof(Profiler_Label), Profiler_Compare_Labels);
+    return profiler_labels.count;
+}
+
+static inline size_t Profiler_Load_Labels(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error opening label file : %s\n", path);
+        return 0;
+    }
+
+    const size_t count = Profiler_Load_Labels_From_File(file);
+    fclose(file);
+    return count;
+}
+
+// Label for an address, or "$XXXX"
+static inline const char *Profiler_Label_Name(u16 address, char *buffer, size_t buffer_size)
+{
+    const Profiler_Label  key   = {.address = address};
+    const Profiler_Label *label = NULL;
+    if (profiler_labels.count > 0)
+        label = bsearch(&key, profiler_labels.labels, profiler_labels.count, sizeof(Profiler_Label), Profiler_Compare_Labels);
+
+    if (label != NULL)
+        return label->name;
+
+    snprintf(buffer, buffer_size, "$%04X", (unsigned int)address);
+    return buffer;
+}
+
+// ---------------------------------------------------------------------
+// Output
+
+// One "root;caller;callee cycles" line for every path that used cycles
+static inline void Call_Profiler_Write_Folded(FILE *file)
+{
+    for (s32 index = 0; index < call_profiler.node_count; index++)
+    {
+        if (call_profiler.nodes[index].cycles == 0)
+            continue;
+
+        s32 path[PROFILER_MAX_DEPTH];
+        s32 path_length = 0;
+        for (s32 node = index; node != PROFILER_NO_NODE && path_length < PROFILER_MAX_DEPTH; node = call_profiler.nodes[node].parent)
+        {
+            path[path_length++] = node;
+        }
+
+        while (path_length > 0)
+        {
+            char      buffer[8];
+            const s32 node = path[--path_length];
+            fprintf(file, "%s%c", Profiler_Label_Name(call_profiler.nodes[node].address, buffer, sizeof(buffer)), path_length > 0 ? ';' : ' ');
+        }
+        fprintf(file, "%" PRIu64 "\n", call_profiler.nodes[index].cycles);
+    }
+}
+
+static inline bool Call_Profiler_Save_Folded(const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error opening folded stacks file : %s\n", path);
+        return false;
+    }
+
+    Call_Profiler_Write_Folded(file);
+    fclose(file);
+    return true;
+}
+
+#endif // __PROFILER_H__
@@ -0,0 +1,577 @@
+#ifndef __PROGRAM_GEN_H__
+#define __PROGRAM_GEN_H__
+
+// Random well-formed programs from a seed
+//
+//  static Program_Generator generator;
+//  static Program           program;
+//  Program_Config config;
+//  Program_Default_Config(&config);
+//  config.branch_per_256 = 64;
+//  Program_Generator_Init(&generator, &config);
+//  Program_Generate(&generator, seed, &program);
+//  Program_Load(&program);
+//  ... run until cpu.program_counter == program.trap
+//
+// A program sets the stack and a few zero page pointers, runs the random
+// instructions and ends in a JMP to itself at 'trap'. It always gets there:
+//  - branches and JMPs only go forward, to the start of an instruction
+//  - a JSR calls a subroutine placed right after it and jumped over, the
+//    subroutine pulls what it pushed before its RTS
+//  - no branch goes over a push or a pull, so the stack depth at each
+//    instruction is known and kept within max_stack_depth
+//  - loads and stores go to the data region, the zero page region or the
+//    stack. Indexed and indirect modes get an LDX or LDY of the index just
+//    before them so their address is known too
+//  - self-modifying code only stores into the immediate operand of a random
+//    instruction further on
+// BRK, RTI, JMP (indirect) and TXS are never picked.
+//
+// An instruction is one random draw and a lookup of how its opcode is laid
+// out, there is no branch on the address mode.
+
+#include "h6502.h"
+
+#define PROGRAM_MAX_BYTES   0x4000
+#define PROGRAM_POINTERS    4  // zero page pointers into the data region, at zero_page_low
+#define PROGRAM_PICK_BITS   12 // opcode pick table of 1 << 12, by weight
+#define PROGRAM_PICK_SIZE   (1 << PROGRAM_PICK_BITS)
+#define PROGRAM_MAX_PENDING 16 // branches and stores not placed yet
+#define PROGRAM_MAX_UNIT    6  // bytes one step writes at most
+#define PROGRAM_BRANCH_BITS 4  // a branch goes up to 1 << 4 instructions forward
+#define PROGRAM_CALL_BITS   4  // a subroutine has up to 1 << 4 instructions
+#define PROGRAM_MAX_CALL    (1 << PROGRAM_CALL_BITS)
+
+typedef struct Program_Config
+{
+    u16 code_address;        // where the program is loaded and starts
+    u32 max_bytes;           // longest program, up to PROGRAM_MAX_BYTES
+    u32 instructions;        // random instructions, not counting index loads
+    u8  opcode_weights[256]; // relative weight of each opcode, 0 for never
+    u8  branch_per_256;      // chance of a branch or JMP forward at each step
+    u8  call_per_256;        // chance of a JSR to a subroutine
+    u8  smc_per_256;         // chance of a store into a later immediate operand
+    u8  max_stack_depth;     // bytes on the stack at most
+    u16 data_low;            // region for absolute and indirect accesses
+    u16 data_high;
+    u8  zero_page_low;       // region for zero page accesses, pointers first
+    u8  zero_page_high;
+} Program_Config;
+
+typedef struct Program
+{
+    u16      address; // load address and entry PC
+    u16      trap;    // PC of the final JMP to itself
+    u32      size;
+    uint64_t seed;
+    u8       code[PROGRAM_MAX_BYTES];
+} Program;
+
+typedef enum
+{
+    PROGRAM_OP_NORMAL = 0,
+    PROGRAM_OP_PUSH,
+    PROGRAM_OP_PULL,
+    PROGRAM_OP_NEVER, // control flow and TXS
+} Program_Op_Kind;
+
+// Where an instruction's operand comes from
+typedef enum
+{
+    PROGRAM_OPERAND_NONE = 0,
+    PROGRAM_OPERAND_VALUE,             // #value
+    PROGRAM_OPERAND_ZERO_PAGE,         // zp
+    PROGRAM_OPERAND_ZERO_PAGE_INDEXED, // zp - index, for zp,X and zp,Y
+    PROGRAM_OPERAND_DATA,              // abs
+    PROGRAM_OPERAND_DATA_INDEXED,      // abs - index, for abs,X and abs,Y
+    PROGRAM_OPERAND_POINTER_INDEXED,   // pointer - index, for (zp,X)
+    PROGRAM_OPERAND_POINTER,           // pointer, for (zp),Y and (zp)
+    PROGRAM_OPERAND_COUNT,
+} Program_Operand;
+
+typedef struct Program_Layout
+{
+    u8 kind;          // Program_Op_Kind
+    u8 prefix;        // LDX #index or LDY #index before it
+    u8 prefix_bytes;  // 0 or 2
+    u8 operand;       // Program_Operand
+    u8 operand_bytes; // 0, 1 or 2
+} Program_Layout;
+
+typedef struct Program_Generator
+{
+    Program_Config config;
+    u8             pick[PROGRAM_PICK_SIZE]; // opcodes, as often as their weight
+    Program_Layout layout[256];
+    u8             branches[16]; // branch opcodes of the variant
+    u32            branch_count;
+    u32            zero_page_first; // zero page after the pointers
+    u32            zero_page_count;
+    u32            data_count;
+} Program_Generator;
+
+// Generation state, only used while a program is made
+typedef struct Program_Builder
+{
+    const Program_Generator *generator;
+    Program                 *program;
+    uint64_t                 random;
+    u32                      position;
+    u32                      units; // steps so far, branches count in these
+    u32                      stack_depth;
+    u32                      call_depth; // stack depth the running subroutine started at
+    bool                     in_call;
+    u32                      branch_count;
+    u32                      branch_due;    // first unit a waiting branch must be placed by
+    u32                      branch_due_at; // or position
+    u32                      branch_at[PROGRAM_MAX_PENDING];     // operand position
+    u32                      branch_target[PROGRAM_MAX_PENDING]; // unit it lands on
+    bool                     branch_absolute[PROGRAM_MAX_PENDING];
+    u32                      smc_count;
+    u32                      smc_at[PROGRAM_MAX_PENDING]; // address of a STA waiting for an operand
+} Program_Builder;
+
+// Every opcode of the variant that can be picked, code at 0x0400, data at
+// 0x2000-0x7FFF
+static inline void Program_Default_Config(Program_Config *config)
+{
+    memset(config, 0, sizeof(*config));
+    config->code_address    = 0x0400;
+    config->max_bytes       = 0x1000;
+    config->instructions    = 32;
+    config->branch_per_256  = 32;
+    config->call_per_256    = 4;
+    config->smc_per_256     = 4;
+    config->max_stack_depth = 32;
+    config->data_low        = 0x2000;
+    config->data_high       = 0x7FFF;
+    config->zero_page_low   = 0x00;
+    config->zero_page_high  = 0xFF;
+    for (u32 opcode = 0; opcode < 256; opcode++)
+        config->opcode_weights[opcode] = Opcode_Is_Valid((u8)opcode) ? 1 : 0;
+}
+
+static inline bool Program_Mnemonic_Is(u8 opcode, const char *const *names)
+{
+    const char *mnemonic = Opcode_Mnemonic(opcode);
+    for (; *names != NULL; names++)
+    {
+        if (mnemonic != NULL && strcmp(mnemonic, *names) == 0)
+            return true;
+    }
+    return false;
+}
+
+static inline Program_Layout Program_Opcode_Layout(u8 opcode)
+{
+    static const char *const never[]  = {"BRK", "JMP", "JSR", "RTI", "RTS", "TXS", NULL};
+    static const char *const pushes[] = {"PHA", "PHP", "PHX", "PHY", NULL};
+    static const char *const pulls[]  = {"PLA", "PLP", "PLX", "PLY", NULL};
+
+    Program_Layout layout = {.kind = PROGRAM_OP_NORMAL};
+    if (!Opcode_Is_Valid(opcode) || Program_Mnemonic_Is(opcode, never))
+        layout.kind = PROGRAM_OP_NEVER;
+    else if (Program_Mnemonic_Is(opcode, pushes))
+        layout.kind = PROGRAM_OP_PUSH;
+    else if (Program_Mnemonic_Is(opcode, pulls))
+        layout.kind = PROGRAM_OP_PULL;
+
+    switch (Opcode_Address_Mode(opcode))
+    {
+    case MODE_IM: layout.operand = PROGRAM_OPERAND_VALUE; break;
+    case MODE_ZP: layout.operand = PROGRAM_OPERAND_ZERO_PAGE; break;
+    case MODE_ZP_X:
+        layout.prefix  = INS_LDX_IM;
+        layout.operand = PROGRAM_OPERAND_ZERO_PAGE_INDEXED;
+        break;
+    case MODE_ZP_Y:
+        layout.prefix  = INS_LDY_IM;
+        layout.operand = PROGRAM_OPERAND_ZERO_PAGE_INDEXED;
+        break;
+    case MODE_ABS: layout.operand = PROGRAM_OPERAND_DATA; break;
+    case MODE_ABS_X:
+        layout.prefix  = INS_LDX_IM;
+        layout.operand = PROGRAM_OPERAND_DATA_INDEXED;
+        break;
+    case MODE_ABS_Y:
+        layout.prefix  = INS_LDY_IM;
+        layout.operand = PROGRAM_OPERAND_DATA_INDEXED;
+        break;
+    case MODE_IND_X:
+        layout.prefix  = INS_LDX_IM;
+        layout.operand = PROGRAM_OPERAND_POINTER_INDEXED;
+        break;
+    case MODE_IND_Y:
+        layout.prefix  = INS_LDY_IM;
+        layout.operand = PROGRAM_OPERAND_POINTER;
+        break;
+    case MODE_ZP_IND: layout.operand = PROGRAM_OPERAND_POINTER; break;
+    case MODE_IMP:
+    case MODE_ACC: break;
+    default: layout.kind = PROGRAM_OP_NEVER; break; // branches, JMP (indirect)
+    }
+    layout.prefix_bytes  = (layout.prefix != 0) ? 2 : 0;
+    layout.operand_bytes = (u8)(Opcode_Bytes(opcode) > 0 ? Opcode_Bytes(opcode) - 1 : 0);
+    return layout;
+}
+
+// False when the regions overlap or are too small
+static inline bool Program_Generator_Init(Program_Generator *generator, const Program_Config *config)
+{
+    const u32 code_low  = config->code_address;
+    const u32 code_high = code_low + config->max_bytes - 1;
+    if (config->max_bytes < 64 || config->max_bytes > PROGRAM_MAX_BYTES || code_high > 0xFFFF || code_low < 0x0200 ||
+        (code_low <= config->data_high && config->data_low <= code_high) || config->data_low < 0x0200 ||
+        config->data_high < config->data_low + 0xFF || config->zero_page_high < config->zero_page_low + 2 * PROGRAM_POINTERS)
+        return false;
+
+    generator->config          = *config;
+    generator->branch_count    = 0;
+    generator->zero_page_first = config->zero_page_low + 2 * PROGRAM_POINTERS;
+    generator->zero_page_count = config->zero_page_high - generator->zero_page_first + 1;
+    generator->data_count      = config->data_high - config->data_low + 1;
+    u32 total                  = 0;
+    for (u32 opcode = 0; opcode < 256; opcode++)
+    {
+        generator->layout[opcode] = Program_Opcode_Layout((u8)opcode);
+        if (Opcode_Is_Valid((u8)opcode) && Opcode_Address_Mode((u8)opcode) == MODE_REL &&
+            generator->branch_count < sizeof(generator->branches))
+            generator->branches[generator->branch_count++] = (u8)opcode; // placed by branch_per_256
+        if (generator->layout[opcode].kind != PROGRAM_OP_NEVER)
+            total += config->opcode_weights[opcode];
+    }
+
+    // each opcode gets its share of the table, NOP when nothing can be picked
+    u32 filled = 0;
+    u32 weight = 0;
+    for (u32 opcode = 0; opcode < 256 && total > 0; opcode++)
+    {
+        if (generator->layout[opcode].kind == PROGRAM_OP_NEVER)
+            continue;
+        weight += config->opcode_weights[opcode];
+        const u32 end = (u32)((uint64_t)weight * PROGRAM_PICK_SIZE / total);
+        for (; filled < end; filled++)
+            generator->pick[filled] = (u8)opcode;
+    }
+    for (; filled < PROGRAM_PICK_SIZE; filled++)
+        generator->pick[filled] = INS_NOP;
+    return true;
+}
+
+// splitmix64, the next number from 'state'. Also what tools use for their own
+// random data
+static inline uint64_t Random_Next(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z          = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z          = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t Program_Random(Program_Builder *builder)
+{
+    return Random_Next(&builder->random);
+}
+
+// 0 to count - 1 from 16 random bits, count up to 0x10000
+static inline u32 Program_Scale(uint64_t bits, u32 count)
+{
+    return (u32)(((bits & 0xFFFF) * count) >> 16);
+}
+
+static inline void Program_Emit(Program_Builder *builder, u8 byte)
+{
+    builder->program->code[builder->position++] = byte;
+}
+
+static inline void Program_Emit_Word(Program_Builder *builder, u16 word)
+{
+    Program_Emit(builder, (u8)(word & 0xFF));
+    Program_Emit(builder, (u8)(word >> 8));
+}
+
+static inline u16 Program_Here(const Program_Builder *builder)
+{
+    return (u16)((builder->program->address + builder->position) & 0xFFFF);
+}
+
+static inline void Program_Patch_Word(Program_Builder *builder, u32 at, u16 word)
+{
+    builder->program->code[at]     = (u8)(word & 0xFF);
+    builder->program->code[at + 1] = (u8)(word >> 8);
+}
+
+// An address in the data region with 'room' bytes after it
+static inline u16 Program_Data_Address(const Program_Generator *generator, uint64_t bits, u32 room)
+{
+    return (u16)(generator->config.data_low + Program_Scale(bits, generator->data_count - room));
+}
+
+// Branches waiting for this place land here
+static inline void Program_Place_Branch(Program_Builder *builder, u32 branch)
+{
+    const u32 at = builder->branch_at[branch];
+    if (builder->branch_absolute[branch])
+        Program_Patch_Word(builder, at, Program_Here(builder));
+    else
+        builder->program->code[at] = (u8)(builder->position - (at + 1));
+
+    builder->branch_count--;
+    builder->branch_at[branch]       = builder->branch_at[builder->branch_count];
+    builder->branch_target[branch]   = builder->branch_target[builder->branch_count];
+    builder->branch_absolute[branch] = builder->branch_absolute[builder->branch_count];
+}
+
+static inline u32 Program_Min(u32 a, u32 b)
+{
+    return (a < b) ? a : b;
+}
+
+// Position past which a waiting branch could not reach the next step
+static inline u32 Program_Branch_Reach(const Program_Builder *builder, u32 branch)
+{
+    return builder->branch_absolute[branch] ? UINT32_MAX : builder->branch_at[branch] + 1 + 127 - PROGRAM_MAX_UNIT;
+}
+
+// Start of a step: branches that land here, or could not reach past the next step
+static inline void Program_Step(Program_Builder *builder)
+{
+    if (builder->units >= builder->branch_due || builder->position > builder->branch_due_at)
+    {
+        builder->branch_due    = UINT32_MAX;
+        builder->branch_due_at = UINT32_MAX;
+        for (u32 branch = 0; branch < builder->branch_count;)
+        {
+            const u32 reach = Program_Branch_Reach(builder, branch);
+            if (builder->branch_target[branch] <= builder->units || builder->position > reach)
+                Program_Place_Branch(builder, branch);
+            else
+            {
+                builder->branch_due    = Program_Min(builder->branch_due, builder->branch_target[branch]);
+                builder->branch_due_at = Program_Min(builder->branch_due_at, reach);
+                branch++;
+            }
+        }
+    }
+    builder->units++;
+}
+
+// Every waiting branch lands here, nothing jumps past what comes next
+static inline void Program_Place_All_Branches(Program_Builder *builder)
+{
+    while (builder->branch_count > 0)
+        Program_Place_Branch(builder, 0);
+}
+
+// One instruction picked by weight, with the index load its mode needs.
+// 'bits' is the step's draw, the low 8 are already used
+static inline void Program_Emit_Instruction(Program_Builder *builder, uint64_t bits)
+{
+    const Program_Generator *generator = builder->generator;
+    u8                       opcode    = generator->pick[(bits >> 8) & (PROGRAM_PICK_SIZE - 1)];
+    const Program_Layout    *layout    = &generator->layout[opcode];
+
+    if (layout->kind != PROGRAM_OP_NORMAL)
+    {
+        Program_Place_All_Branches(builder);
+        const bool push = (layout->kind == PROGRAM_OP_PUSH);
+        if (push ? builder->stack_depth >= generator->config.max_stack_depth : builder->stack_depth <= builder->call_depth)
+            opcode = INS_NOP; // no room, or nothing of ours to pull
+        else if (push)
+            builder->stack_depth++;
+        else
+            builder->stack_depth--;
+        layout = &generator->layout[opcode];
+    }
+
+    const u8  index     = (u8)((bits >> 20) & 0xFF);
+    const u8  zero_page = (u8)(generator->zero_page_first + ((((bits >> 28) & 0xFF) * generator->zero_page_count) >> 8));
+    const u8  pointer   = (u8)(generator->config.zero_page_low + 2 * ((bits >> 36) & (PROGRAM_POINTERS - 1)));
+    const u16 data      = Program_Data_Address(generator, bits >> 48, 0);
+
+    const uint16_t operands[PROGRAM_OPERAND_COUNT] = {
+        [PROGRAM_OPERAND_NONE]              = 0,
+        [PROGRAM_OPERAND_VALUE]             = (u8)((bits >> 40) & 0xFF),
+        [PROGRAM_OPERAND_ZERO_PAGE]         = zero_page,
+        [PROGRAM_OPERAND_ZERO_PAGE_INDEXED] = (u8)((zero_page - index) & 0xFF),
+        [PROGRAM_OPERAND_DATA]              = data,
+        [PROGRAM_OPERAND_DATA_INDEXED]      = (u16)((data - index) & 0xFFFF),
+        [PROGRAM_OPERAND_POINTER_INDEXED]   = (u8)((pointer - index) & 0xFF),
+        [PROGRAM_OPERAND_POINTER]           = pointer,
+    };
+
+    // every byte is written whether it is used or not, the position only
+    // moves over those that are
+    u8 *code = &builder->program->code[builder->position];
+    code[0]  = layout->prefix;
+    code[1]  = index;
+    code += layout->prefix_bytes;
+    const u16 operand = operands[layout->operand];
+    code[0]           = opcode;
+    code[1]           = (u8)(operand & 0xFF);
+    code[2]           = (u8)(operand >> 8);
+    builder->position += layout->prefix_bytes + 1 + layout->operand_bytes;
+
+    if (layout->operand == PROGRAM_OPERAND_VALUE && builder->smc_count > 0)
+    {
+        // a waiting store writes this operand
+        builder->smc_count--;
+        Program_Patch_Word(builder, builder->smc_at[builder->smc_count], (u16)(Program_Here(builder) - 1));
+    }
+}
+
+// A branch or a JMP over the next few steps, 'bits' as for an instruction
+static inline void Program_Emit_Branch(Program_Builder *builder, uint64_t bits)
+{
+    const Program_Generator *generator = builder->generator;
+    if (builder->branch_count == PROGRAM_MAX_PENDING || generator->branch_count == 0)
+        return;
+
+    bits >>= 8;
+    const u32 pending                 = builder->branch_count++;
+    builder->branch_target[pending]   = builder->units + 1 + (u32)(bits & ((1 << PROGRAM_BRANCH_BITS) - 1));
+    builder->branch_absolute[pending] = ((bits >> 8) & 7) == 0;
+    if (builder->branch_absolute[pending])
+    {
+        Program_Emit(builder, INS_JMP_ABS);
+        builder->branch_at[pending] = builder->position;
+        Program_Emit_Word(builder, 0);
+    }
+    else
+    {
+        Program_Emit(builder, generator->branches[Program_Scale(bits >> 16, generator->branch_count)]);
+        builder->branch_at[pending] = builder->position;
+        Program_Emit(builder, 0);
+    }
+    builder->branch_due    = Program_Min(builder->branch_due, builder->branch_target[pending]);
+    builder->branch_due_at = Program_Min(builder->branch_due_at, Program_Branch_Reach(builder, pending));
+}
+
+// LDA #value ; STA into the operand of an immediate instruction further on
+static inline void Program_Emit_Self_Modify(Program_Builder *builder, uint64_t bits)
+{
+    bits >>= 8;
+    Program_Emit(builder, INS_LDA_IM);
+    Program_Emit(builder, (u8)(bits & 0xFF));
+    Program_Emit(builder, INS_STA_ABS);
+    if (builder->smc_count < PROGRAM_MAX_PENDING)
+        builder->smc_at[builder->smc_count++] = builder->position;
+    Program_Emit_Word(builder, Program_Data_Address(builder->generator, bits >> 16, 0)); // until an operand is found
+}
+
+static inline bool Program_Room(const Program_Builder *builder, u32 bytes)
+{
+    const Program_Config *config = &builder->generator->config;
+    // the end needs pulls and an RTS for a subroutine, and the JMP
+    return builder->position + bytes + config->max_stack_depth + 4 <= config->max_bytes;
+}
+
+static inline void Program_Emit_Steps(Program_Builder *builder, u32 steps);
+
+// JSR sub ; JMP over ; sub: ... RTS ; over:
+static inline void Program_Emit_Call(Program_Builder *builder)
+{
+    Program_Place_All_Branches(builder);
+    Program_Emit(builder, INS_JSR);
+    const u32 call = builder->position;
+    Program_Emit_Word(builder, 0);
+    Program_Emit(builder, INS_JMP_ABS);
+    const u32 over = builder->position;
+    Program_Emit_Word(builder, 0);
+    Program_Patch_Word(builder, call, Program_Here(builder));
+
+    builder->in_call = true;
+    builder->stack_depth += 2;
+    builder->call_depth = builder->stack_depth;
+    Program_Emit_Steps(builder, 1 + (u32)(Program_Random(builder) & (PROGRAM_MAX_CALL - 1)));
+
+    Program_Place_All_Branches(builder);
+    for (; builder->stack_depth > builder->call_depth; builder->stack_depth--)
+        Program_Emit(builder, INS_PLA);
+    Program_Emit(builder, INS_RTS);
+    builder->stack_depth -= 2;
+    builder->call_depth = 0;
+    builder->in_call    = false;
+    Program_Patch_Word(builder, over, Program_Here(builder));
+}
+
+static inline void Program_Emit_Steps(Program_Builder *builder, u32 steps)
+{
+    const Program_Config *config = &builder->generator->config;
+    const u32             branch = config->branch_per_256;
+    const u32             call   = branch + config->call_per_256;
+    const u32             smc    = call + config->smc_per_256;
+    for (u32 step = 0; step < steps && Program_Room(builder, PROGRAM_MAX_UNIT); step++)
+    {
+        Program_Step(builder);
+        const uint64_t bits = Program_Random(builder);
+        const u32      roll = (u32)(bits & 0xFF);
+        if (roll >= smc)
+            Program_Emit_Instruction(builder, bits);
+        else if (roll < branch)
+            Program_Emit_Branch(builder, bits);
+        else if (roll >= call)
+            Program_Emit_Self_Modify(builder, bits);
+        else if (!builder->in_call && builder->stack_depth + 2 <= config->max_stack_depth &&
+                 Program_Room(builder, 6 + PROGRAM_MAX_CALL * PROGRAM_MAX_UNIT + 1))
+            Program_Emit_Call(builder);
+        else
+            Program_Emit_Instruction(builder, bits);
+    }
+}
+
+// The program of 'seed'
+static inline void Program_Generate(const Program_Generator *generator, uint64_t seed, Program *program)
+{
+    const Program_Config *config = &generator->config;
+    Program_Builder       builder;
+    builder.generator    = generator;
+    builder.program      = program;
+    builder.random       = seed;
+    builder.position     = 0;
+    builder.units        = 0;
+    builder.stack_depth  = 0;
+    builder.call_depth   = 0;
+    builder.in_call      = false;
+    builder.branch_count  = 0;
+    builder.branch_due    = UINT32_MAX;
+    builder.branch_due_at = UINT32_MAX;
+    builder.smc_count     = 0;
+    program->address     = config->code_address;
+    program->seed        = seed;
+
+    // LDX #$FF ; TXS, then the pointers into the data region
+    Program_Emit(&builder, INS_LDX_IM);
+    Program_Emit(&builder, 0xFF);
+    Program_Emit(&builder, INS_TXS);
+    const uint64_t bits = Program_Random(&builder);
+    for (u32 pointer = 0; pointer < PROGRAM_POINTERS; pointer++)
+    {
+        const u16 target = Program_Data_Address(generator, bits >> (16 * pointer), 0xFF);
+        for (u32 half = 0; half < 2; half++)
+        {
+            Program_Emit(&builder, INS_LDA_IM);
+            Program_Emit(&builder, (u8)(half ? target >> 8 : target & 0xFF));
+            Program_Emit(&builder, INS_STA_ZP);
+            Program_Emit(&builder, (u8)(config->zero_page_low + 2 * pointer + half));
+        }
+    }
+
+    Program_Emit_Steps(&builder, config->instructions);
+
+    // JMP * , what is still waiting lands on it
+    Program_Place_All_Branches(&builder);
+    program->trap = Program_Here(&builder);
+    Program_Emit(&builder, INS_JMP_ABS);
+    Program_Emit_Word(&builder, program->trap);
+    program->size = builder.position;
+}
+
+// Into memory, PC at the start
+static inline void Program_Load(const Program *program)
+{
+    memcpy(&mem.data[program->address], program->code, program->size);
+    cpu.program_counter = program->address;
+}
+
+#endif // __PROGRAM_GEN_H__
@@ -0,0 +1,352 @@
+#ifndef __REWIND_H__
+#define __REWIND_H__
+
+// Rewind buffer
+//
+// Rewind_Execute() runs the machine and saves its state every 'interval'
+// cycles. Only what changed since the last state is kept: memory XOR the last
+// state, run-length encoded, so a state where a few hundred bytes changed
+// takes a few hundred bytes. The deltas go into a ring of a fixed size, the
+// oldest are dropped when it is full.
+//
+//  Rewind rewind;
+//  Rewind_Init(&rewind, 64 << 20, 100000); // 64 MB, every 100000 cycles
+//  Rewind_Execute(&rewind, cycles);
+//  ...
+//  Rewind_To_Cycle(&rewind, cycle);        // any cycle since Rewind_Oldest_Cycle()
+//
+// The newest state is kept in full. Going back applies the deltas from the
+// newest to the one wanted, then runs the machine instruction by instruction
+// up to the cycle. The emulator is deterministic so this is the same machine
+// as the first time round, as long as nothing outside Execute() changed it.
+// The deltas are applied to a scratch copy, a broken one leaves the machine
+// and the buffer as they were.
+//
+// Delta : { varint same bytes | varint changed bytes | changed bytes XOR } ...
+// varints are 7 bits a byte, low bits first
+
+#include "h6502.h"
+
+#define REWIND_MAX_DELTA  (MAX_MEM + 16) // when every byte changed
+#define REWIND_FRAME_COST 1024           // budget bytes per state kept in the index
+#define REWIND_SAME_RUN   4              // equal bytes that end a run of changed ones
+
+// The state before a delta, applying the delta to the next state gives it
+typedef struct Rewind_Frame
+{
+    uint64_t cycle;
+    CPU      cpu;
+    size_t   offset; // delta in the ring
+    u32      size;
+} Rewind_Frame;
+
+typedef struct Rewind
+{
+    uint8_t      *ring;
+    size_t        ring_size;
+    size_t        tail; // where the next delta goes
+    Rewind_Frame *frames;
+    u32           frame_capacity;
+    u32           first; // oldest frame
+    u32           count;
+
+    // newest state
+    Memory   latest;
+    CPU      latest_cpu;
+    uint64_t latest_cycle;
+
+    Memory   scratch; // the state Rewind_To_Cycle() goes back to, until it is whole
+    uint8_t  delta[REWIND_MAX_DELTA];
+    uint64_t cycle; // cycles run through Rewind_Execute()
+    uint64_t next_snapshot;
+    s32      interval;
+} Rewind;
+
+// 'budget' bytes for the deltas and their index, false when it cannot be allocated
+static inline bool Rewind_Init(Rewind *rewind, size_t budget, s32 interval)
+{
+    rewind->tail           = 0;
+    rewind->first          = 0;
+    rewind->count          = 0;
+    rewind->frame_capacity = (u32)(budget / REWIND_FRAME_COST);
+    if (rewind->frame_capacity < 2)
+        rewind->frame_capacity = 2;
+    rewind->ring_size = budget - rewind->frame_capacity * sizeof(Rewind_Frame);
+    if (budget < rewind->frame_capacity * sizeof(Rewind_Frame) + REWIND_MAX_DELTA)
+        rewind->ring_size = REWIND_MAX_DELTA;
+
+    rewind->frames = malloc(rewind->frame_capacity * sizeof(Rewind_Frame));
+    rewind->ring   = malloc(rewind->ring_size);
+    if (rewind->frames == NULL || rewind->ring == NULL)
+    {
+        fprintf(stderr, "Error allocating rewind buffer : %zu bytes\n", budget);
+        free(rewind->frames);
+        free(rewind->ring);
+        rewind->frames = NULL;
+        rewind->ring   = NULL;
+        return false;
+    }
+
+    rewind->interval = (interval > 0) ? interval : 1;
+
+    // the machine as it is now is the first state
+    memcpy(rewind->latest.data, mem.data, MAX_MEM);
+    rewind->latest_cpu    = cpu;
+    rewind->latest_cycle  = 0;
+    rewind->cycle         = 0;
+    rewind->next_snapshot = (uint64_t)rewind->interval;
+    return true;
+}
+
+static inline void Rewind_Free(Rewind *rewind)
+{
+    free(rewind->frames);
+    free(rewind->ring);
+    rewind->frames = NULL;
+    rewind->ring   = NULL;
+    rewind->count  = 0;
+}
+
+static inline uint64_t Rewind_Oldest_Cycle(const Rewind *rewind)
+{
+    return rewind->count ? rewind->frames[rewind->first].cycle : rewind->latest_cycle;
+}
+
+// Bytes of deltas in the ring
+static inline size_t Rewind_Delta_Bytes(const Rewind *rewind)
+{
+    size_t bytes = 0;
+    for (u32 i = 0; i < rewind->count; i++)
+        bytes += rewind->frames[(rewind->first + i) % rewind->frame_capacity].size;
+    return bytes;
+}
+
+static inline uint8_t *Rewind_Put_Varint(uint8_t *out, u32 value)
+{
+    while (value >= 0x80)
+    {
+        *out++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (uint8_t)value;
+    return out;
+}
+
+static inline const uint8_t *Rewind_Get_Varint(const uint8_t *in, const uint8_t *end, u32 *value)
+{
+    u32 result = 0;
+    for (u32 shift = 0; in < end && shift < 32; shift += 7)
+    {
+        const uint8_t byte = *in++;
+        result |= (u32)(byte & 0x7F) << shift;
+        if (byte < 0x80)
+        {
+            *value = result;
+            return in;
+        }
+    }
+    return NULL;
+}
+
+// Encodes memory XOR 'latest' into 'delta' and makes 'latest' the same as
+// memory, returns the delta size
+static inline u32 Rewind_Encode_Delta(Rewind *rewind)
+{
+    u8       *latest = rewind->latest.data;
+    uint8_t  *out    = rewind->delta;
+    u32       from   = 0;
+    u32       at     = 0;
+    while (at < MAX_MEM)
+    {
+        // skip what did not change, 8 bytes at a time
+        while (at + 8 <= MAX_MEM)
+        {
+            uint64_t now, before;
+            memcpy(&now, &mem.data[at], sizeof(now));
+            memcpy(&before, &latest[at], sizeof(before));
+            if (now != before)
+                break;
+            at += 8;
+        }
+        while (at < MAX_MEM && mem.data[at] == latest[at])
+            at++;
+        if (at == MAX_MEM)
+            break;
+
+        // changed bytes, until REWIND_SAME_RUN equal ones
+        const u32 changed = at;
+        u32       end     = at;
+        while (at < MAX_MEM && at - end < REWIND_SAME_RUN)
+        {
+            if (mem.data[at] != latest[at])
+                end = at + 1;
+            at++;
+        }
+
+        out = Rewind_Put_Varint(out, changed - from);
+        out = Rewind_Put_Varint(out, end - changed);
+        for (u32 address = changed; address < end; address++)
+        {
+            *out++          = (uint8_t)(mem.data[address] ^ latest[address]);
+            latest[address] = mem.data[address];
+        }
+        from = end;
+        at   = end;
+    }
+    return (u32)(out - rewind->delta);
+}
+
+// XOR a delta into 'memory', false when it is broken. A broken delta can
+// have been applied in part
+static inline bool Rewind_Apply_Delta(u8 *memory, const uint8_t *delta, u32 size)
+{
+    const uint8_t *in      = delta;
+    const uint8_t *end     = delta + size;
+    u32            address = 0;
+    while (in < end)
+    {
+        u32 same, changed;
+        in = Rewind_Get_Varint(in, end, &same);
+        if (in == NULL)
+            return false;
+        in = Rewind_Get_Varint(in, end, &changed);
+        if (in == NULL || (u32)(end - in) < changed || same > MAX_MEM - address || changed > MAX_MEM - address - same)
+            return false;
+
+        address += same;
+        for (u32 i = 0; i < changed; i++)
+            memory[address + i] ^= in[i];
+        address += changed;
+        in += changed;
+    }
+    return true;
+}
+
+static inline void Rewind_Drop_Oldest(Rewind *rewind)
+{
+    rewind->first = (rewind->first + 1) % rewind->frame_capacity;
+    rewind->count--;
+}
+
+// Makes room for 'size' bytes at the tail, dropping the oldest deltas. Every
+// delta takes one byte more than its size, so the tail is only ever at the
+// oldest delta when the ring has wrapped.
+static inline void Rewind_Make_Room(Rewind *rewind, size_t size)
+{
+    if (rewind->count == rewind->frame_capacity)
+        Rewind_Drop_Oldest(rewind);
+
+    while (rewind->count > 0)
+    {
+        const size_t oldest = rewind->frames[rewind->first].offset;
+        if (rewind->tail <= oldest)
+        {
+            // free space is between the tail and the oldest delta
+            if (oldest - rewind->tail >= size)
+                return;
+            Rewind_Drop_Oldest(rewind);
+        }
+        else if (rewind->ring_size - rewind->tail >= size)
+        {
+            return;
+        }
+        else
+        {
+            rewind->tail = 0; // wrap, the end of the ring is left unused
+        }
+    }
+    rewind->tail = 0;
+}
+
+// Save the machine as the newest state
+static inline void Rewind_Snapshot(Rewind *rewind)
+{
+    const u32 size = Rewind_Encode_Delta(rewind);
+    Rewind_Make_Room(rewind, (size_t)size + 1);
+
+    Rewind_Frame *frame = &rewind->frames[(rewind->first + rewind->count) % rewind->frame_capacity];
+    frame->cycle        = rewind->latest_cycle;
+    frame->cpu          = rewind->latest_cpu;
+    frame->offset       = rewind->tail;
+    frame->size         = size;
+    memcpy(&rewind->ring[rewind->tail], rewind->delta, size);
+    rewind->tail += (size_t)size + 1;
+    rewind->count++;
+
+    rewind->latest_cpu   = cpu;
+    rewind->latest_cycle = rewind->cycle;
+}
+
+// Execute() that saves a state every 'interval' cycles
+static inline s32 Rewind_Execute(Rewind *rewind, s32 number_of_cycles)
+{
+    s32 cycles_used = 0;
+    while (cycles_used < number_of_cycles)
+    {
+        const uint64_t until_snapshot = rewind->next_snapshot - rewind->cycle;
+        const s32      left           = number_of_cycles - cycles_used;
+        const s32      slice          = (until_snapshot < (uint64_t)left) ? (s32)until_snapshot : left;
+
+        const s32 used = Execute(slice);
+        if (used <= 0)
+            break;
+        cycles_used += used;
+        rewind->cycle += (uint64_t)used;
+
+        if (rewind->cycle >= rewind->next_snapshot)
+        {
+            Rewind_Snapshot(rewind);
+            rewind->next_snapshot = rewind->cycle + (uint64_t)rewind->interval;
+        }
+    }
+    return cycles_used;
+}
+
+// Back to the first instruction boundary at or after 'cycle'. Later states
+// are dropped, running on from here saves new ones. False when 'cycle' is
+// older than the buffer or newer than the machine, or a delta is broken, and
+// then nothing is changed.
+static inline bool Rewind_To_Cycle(Rewind *rewind, uint64_t cycle)
+{
+    if (cycle < Rewind_Oldest_Cycle(rewind) || cycle > rewind->cycle)
+        return false;
+
+    // the deltas from the newest state, which the machine may have run on
+    // from. The frames are only dropped once they have all applied
+    memcpy(rewind->scratch.data, rewind->latest.data, MAX_MEM);
+    const CPU *state = &rewind->latest_cpu;
+    uint64_t   at    = rewind->latest_cycle;
+    size_t     tail  = rewind->tail;
+    u32        count = rewind->count;
+    while (count > 0 && at > cycle)
+    {
+        const Rewind_Frame *frame = &rewind->frames[(rewind->first + count - 1) % rewind->frame_capacity];
+        if (!Rewind_Apply_Delta(rewind->scratch.data, &rewind->ring[frame->offset], frame->size))
+            return false;
+        state = &frame->cpu;
+        at    = frame->cycle;
+        tail  = frame->offset;
+        count--;
+    }
+
+    memcpy(rewind->latest.data, rewind->scratch.data, MAX_MEM);
+    memcpy(mem.data, rewind->scratch.data, MAX_MEM);
+    cpu                   = *state;
+    rewind->latest_cpu    = *state;
+    rewind->latest_cycle  = at;
+    rewind->cycle         = at;
+    rewind->tail          = tail;
+    rewind->count         = count;
+    rewind->next_snapshot = at + (uint64_t)rewind->interval;
+
+    while (rewind->cycle < cycle)
+    {
+        const s32 used = Execute(1);
+        if (used <= 0)
+            return false;
+        rewind->cycle += (uint64_t)used;
+    }
+    return true;
+}
+
+#endif // __REWIND_H__
@@ -0,0 +1,263 @@
+#ifndef __SAVE_STATE_H__
+#define __SAVE_STATE_H__
+
+// Save states
+// Included by h6502.h.
+//
+// The whole machine (registers and 64 KB of memory) in a versioned byte
+// format that is the same on every host, so a state can be moved to another
+// machine or build and loaded there.
+//
+//  header : "H6502SAV" | u8 version | u8 variant | 6 x u8 0
+//  chunks : u8 tag[4] | u32 size | size bytes, until the "END " chunk
+//
+//  "CPU " : u16 PC | u8 SP | u8 A | u8 X | u8 Y | u8 P | u8 0
+//  "MEM " : u8 kind[256] then for each page, by kind
+//           SAVE_STATE_PAGE_ZERO : nothing
+//           SAVE_STATE_PAGE_FILL : u8 value, all 256 bytes are the same
+//           SAVE_STATE_PAGE_RAW  : u8 data[256]
+//
+// All numbers are little endian. Loading skips chunks it does not know, so
+// later versions can add state (interrupt lines, devices) that older builds
+// ignore. A state from another CPU variant is refused.
+
+#define SAVE_STATE_MAGIC       "H6502SAV"
+#define SAVE_STATE_VERSION     1
+#define SAVE_STATE_HEADER_SIZE 16
+#define SAVE_STATE_CHUNK_SIZE  8 // tag and size
+#define SAVE_STATE_CPU_SIZE    8
+#define SAVE_STATE_PAGES       (MAX_MEM / 256)
+
+// Largest state, every page raw
+#define SAVE_STATE_MAX_SIZE \
+    (SAVE_STATE_HEADER_SIZE + 3 * SAVE_STATE_CHUNK_SIZE + SAVE_STATE_CPU_SIZE + SAVE_STATE_PAGES + MAX_MEM)
+
+typedef enum
+{
+    SAVE_STATE_PAGE_ZERO = 0,
+    SAVE_STATE_PAGE_FILL,
+    SAVE_STATE_PAGE_RAW,
+} Save_State_Page;
+
+static inline void Save_State_Put_32(uint8_t *bytes, uint32_t value)
+{
+    bytes[0] = (uint8_t)value;
+    bytes[1] = (uint8_t)(value >> 8);
+    bytes[2] = (uint8_t)(value >> 16);
+    bytes[3] = (uint8_t)(value >> 24);
+}
+
+static inline uint32_t Save_State_Get_32(const uint8_t *bytes)
+{
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+static inline uint8_t *Save_State_Put_Chunk(uint8_t *out, const char tag[4], uint32_t size)
+{
+    memcpy(out, tag, 4);
+    Save_State_Put_32(out + 4, size);
+    return out + SAVE_STATE_CHUNK_SIZE;
+}
+
+// How a page is stored, 'value' is the fill byte
+static inline Save_State_Page Save_State_Page_Kind(const u8 *page, uint8_t *value)
+{
+    // compare 8 bytes at a time with the first byte repeated
+    const uint64_t pattern = page[0] * 0x0101010101010101ull;
+    uint64_t       differ  = 0;
+    for (u32 offset = 0; offset < 256; offset += 8)
+    {
+        uint64_t word;
+        memcpy(&word, &page[offset], sizeof(word));
+        differ |= word ^ pattern;
+    }
+
+    *value = page[0];
+    if (differ != 0)
+        return SAVE_STATE_PAGE_RAW;
+    return (page[0] == 0) ? SAVE_STATE_PAGE_ZERO : SAVE_STATE_PAGE_FILL;
+}
+
+// Writes the machine to 'buffer', returns the size of the state or 0 when
+// 'capacity' is too small (SAVE_STATE_MAX_SIZE is always enough)
+static inline size_t Save_State_Write(uint8_t *buffer, size_t capacity)
+{
+    if (capacity < SAVE_STATE_MAX_SIZE)
+        return 0;
+
+    uint8_t *out = buffer;
+    memset(out, 0, SAVE_STATE_HEADER_SIZE);
+    memcpy(out, SAVE_STATE_MAGIC, 8);
+    out[8] = SAVE_STATE_VERSION;
+    out[9] = H6502_VARIANT;
+    out += SAVE_STATE_HEADER_SIZE;
+
+    out    = Save_State_Put_Chunk(out, "CPU ", SAVE_STATE_CPU_SIZE);
+    out[0] = (uint8_t)cpu.program_counter;
+    out[1] = (uint8_t)(cpu.program_counter >> 8);
+    out[2] = (uint8_t)cpu.stack_pointer;
+    out[3] = (uint8_t)cpu.accumulator;
+    out[4] = (uint8_t)cpu.index_reg_X;
+    out[5] = (uint8_t)cpu.index_reg_Y;
+    out[6] = cpu.PS;
+    out[7] = 0;
+    out += SAVE_STATE_CPU_SIZE;
+
+    // the size is known once the pages are written
+    uint8_t *memory_chunk = out;
+    uint8_t *kinds        = out + SAVE_STATE_CHUNK_SIZE;
+    out                   = kinds + SAVE_STATE_PAGES;
+    for (u32 page = 0; page < SAVE_STATE_PAGES; page++)
+    {
+        const u8     *data = &mem.data[page * 256];
+        uint8_t       value;
+        const uint8_t kind = (uint8_t)Save_State_Page_Kind(data, &value);
+        kinds[page]        = kind;
+        if (kind == SAVE_STATE_PAGE_FILL)
+        {
+            *out++ = value;
+        }
+        else if (kind == SAVE_STATE_PAGE_RAW)
+        {
+            memcpy(out, data, 256);
+            out += 256;
+        }
+    }
+    Save_State_Put_Chunk(memory_chunk, "MEM ", (uint32_t)(out - kinds));
+
+    out = Save_State_Put_Chunk(out, "END ", 0);
+    return (size_t)(out - buffer);
+}
+
+// Size of a "MEM " chunk from its page kinds, 0 when a kind is unknown
+static inline size_t Save_State_Memory_Size(const uint8_t *kinds)
+{
+    size_t size = SAVE_STATE_PAGES;
+    for (u32 page = 0; page < SAVE_STATE_PAGES; page++)
+    {
+        if (kinds[page] == SAVE_STATE_PAGE_FILL)
+            size += 1;
+        else if (kinds[page] == SAVE_STATE_PAGE_RAW)
+            size += 256;
+        else if (kinds[page] != SAVE_STATE_PAGE_ZERO)
+            return 0;
+    }
+    return size;
+}
+
+// Loads a state written by Save_State_Write(), the machine is only changed
+// when the whole state is valid
+static inline bool Save_State_Read(const uint8_t *buffer, size_t size)
+{
+    if (size < SAVE_STATE_HEADER_SIZE || memcmp(buffer, SAVE_STATE_MAGIC, 8) != 0 || buffer[8] != SAVE_STATE_VERSION)
+        return false;
+    if (buffer[9] != H6502_VARIANT)
+    {
+        fprintf(stderr, "Error loading save state : saved by another CPU variant\n");
+        return false;
+    }
+
+    // check every chunk before anything is changed
+    const uint8_t *cpu_state = NULL;
+    const uint8_t *memory    = NULL;
+    bool           ended     = false;
+    size_t         position  = SAVE_STATE_HEADER_SIZE;
+    while (!ended)
+    {
+        if (size - position < SAVE_STATE_CHUNK_SIZE)
+            return false;
+
+        const uint8_t *chunk      = &buffer[position];
+        const size_t   chunk_size = Save_State_Get_32(chunk + 4);
+        const uint8_t *data       = chunk + SAVE_STATE_CHUNK_SIZE;
+        position += SAVE_STATE_CHUNK_SIZE;
+        if (size - position < chunk_size)
+            return false;
+
+        if (memcmp(chunk, "CPU ", 4) == 0)
+        {
+            if (chunk_size < SAVE_STATE_CPU_SIZE)
+                return false;
+            cpu_state = data;
+        }
+        else if (memcmp(chunk, "MEM ", 4) == 0)
+        {
+            if (chunk_size < SAVE_STATE_PAGES || Save_State_Memory_Size(data) != chunk_size)
+                return false;
+            memory = data;
+        }
+        else if (memcmp(chunk, "END ", 4) == 0)
+        {
+            ended = true;
+        }
+        position += chunk_size;
+    }
+    if (cpu_state == NULL || memory == NULL)
+        return false;
+
+    cpu.program_counter = cpu_state[0] | (cpu_state[1] << 8);
+    cpu.stack_pointer   = cpu_state[2];
+    cpu.accumulator     = cpu_state[3];
+    cpu.index_reg_X     = cpu_state[4];
+    cpu.index_reg_Y     = cpu_state[5];
+    cpu.PS              = cpu_state[6];
+
+    const uint8_t *in = memory + SAVE_STATE_PAGES;
+    for (u32 page = 0; page < SAVE_STATE_PAGES; page++)
+    {
+        u8 *data = &mem.data[page * 256];
+        if (memory[page] == SAVE_STATE_PAGE_ZERO)
+        {
+            memset(data, 0, 256);
+        }
+        else if (memory[page] == SAVE_STATE_PAGE_FILL)
+        {
+            memset(data, *in++, 256);
+        }
+        else
+        {
+            memcpy(data, in, 256);
+            in += 256;
+        }
+    }
+
+#if H6502_SNAPSHOT
+    // memory is no longer what the last snapshot had
+    Snapshot_Mark_Dirty(0, MAX_MEM);
+#endif
+    return true;
+}
+
+static inline bool Save_State_Save(const char *path)
+{
+    static uint8_t buffer[SAVE_STATE_MAX_SIZE];
+    const size_t   size = Save_State_Write(buffer, sizeof(buffer));
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error opening save state file : %s\n", path);
+        return false;
+    }
+
+    const bool ok = fwrite(buffer, 1, size, file) == size;
+    return (fclose(file) == 0) && ok;
+}
+
+static inline bool Save_State_Load(const char *path)
+{
+    static uint8_t buffer[SAVE_STATE_MAX_SIZE + 1];
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error opening save state file : %s\n", path);
+        return false;
+    }
+
+    const size_t size = fread(buffer, 1, sizeof(buffer), file);
+    fclose(file);
+    return Save_State_Read(buffer, size);
+}
+
+#endif // __SAVE_STATE_H__
@@ -0,0 +1,438 @@
+#ifndef __SINGLE_STEP_H__
+#define __SINGLE_STEP_H__
+
+// Single step conformance tests
+//
+// Per-opcode test files in the common single step JSON format, an array of
+// cases a file:
+//
+//  {"name": "a9 5c 1e",
+//   "initial": {"pc": 512, "s": 253, "a": 1, "x": 2, "y": 3, "p": 36, "ram": [[512, 169], [513, 92]]},
+//   "final":   {"pc": 514, "s": 253, "a": 92, "x": 2, "y": 3, "p": 36, "ram": [[512, 169], [513, 92]]},
+//   "cycles":  [[512, 169, "read"], [513, 92, "read"]]}
+//
+// The reader streams, it pulls one case at a time through a small buffer so a
+// file is never in memory whole. Unknown keys are skipped.
+//
+// Single_Step_Run() sets the initial state, runs one instruction with
+// Execute() and checks the registers, the final memory and the number of bus
+// cycles (the emulator does not log the bus, so only the count). Only the
+// addresses a case names and the top of its stack are set and cleared
+// afterwards, not the whole 64 KB.
+//
+//  Single_Step_Reader *reader = Single_Step_Open("a9.json");
+//  static Single_Step_Case test;
+//  while (Single_Step_Next(reader, &test))
+//      passed += Single_Step_Run(&test, failure, sizeof(failure));
+//  Single_Step_Close(reader);
+
+#include "h6502.h"
+
+#define SINGLE_STEP_BUFFER_SIZE (1 << 16)
+#define SINGLE_STEP_MAX_RAM     64
+#define SINGLE_STEP_MAX_NAME    64
+#define SINGLE_STEP_FLAGS       0xCF // B and bit 5 are not flags in the register
+
+typedef struct Single_Step_State
+{
+    u16 pc;
+    u8  s, a, x, y, p;
+    u32 ram_count;
+    u16 address[SINGLE_STEP_MAX_RAM];
+    u8  value[SINGLE_STEP_MAX_RAM];
+} Single_Step_State;
+
+typedef struct Single_Step_Case
+{
+    char              name[SINGLE_STEP_MAX_NAME];
+    Single_Step_State initial;
+    Single_Step_State final;
+    u32               cycles;
+} Single_Step_Case;
+
+typedef struct Single_Step_Reader
+{
+    FILE   *file;
+    bool    close_file;
+    bool    started; // past the opening '['
+    bool    ended;
+    bool    error;
+    size_t  position;
+    size_t  size;
+    uint8_t buffer[SINGLE_STEP_BUFFER_SIZE];
+} Single_Step_Reader;
+
+// ---------------------------------------------------------------------
+// Reader
+
+static inline Single_Step_Reader *Single_Step_Open_File(FILE *file, bool close_file)
+{
+    Single_Step_Reader *reader = malloc(sizeof(Single_Step_Reader));
+    if (reader == NULL)
+    {
+        if (close_file)
+            fclose(file);
+        return NULL;
+    }
+    reader->file       = file;
+    reader->close_file = close_file;
+    reader->started    = false;
+    reader->ended      = false;
+    reader->error      = false;
+    reader->position   = 0;
+    reader->size       = 0;
+    return reader;
+}
+
+// NULL when the file cannot be opened
+static inline Single_Step_Reader *Single_Step_Open(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    return (file != NULL) ? Single_Step_Open_File(file, true) : NULL;
+}
+
+static inline void Single_Step_Close(Single_Step_Reader *reader)
+{
+    if (reader == NULL)
+        return;
+    if (reader->close_file)
+        fclose(reader->file);
+    free(reader);
+}
+
+// Next character without taking it, EOF at the end
+static inline int Single_Step_Peek(Single_Step_Reader *reader)
+{
+    if (reader->position == reader->size)
+    {
+        reader->position = 0;
+        reader->size     = fread(reader->buffer, 1, sizeof(reader->buffer), reader->file);
+        if (reader->size == 0)
+            return EOF;
+    }
+    return reader->buffer[reader->position];
+}
+
+static inline int Single_Step_Get(Single_Step_Reader *reader)
+{
+    const int c = Single_Step_Peek(reader);
+    if (c != EOF)
+        reader->position++;
+    return c;
+}
+
+// Next character that is not white space, without taking it
+static inline int Single_Step_Peek_Token(Single_Step_Reader *reader)
+{
+    int c = Single_Step_Peek(reader);
+    while (c == ' ' || c == '\n' || c == '\r' || c == '\t')
+    {
+        reader->position++;
+        c = Single_Step_Peek(reader);
+    }
+    return c;
+}
+
+static inline bool Single_Step_Expect(Single_Step_Reader *reader, int expected)
+{
+    if (Single_Step_Peek_Token(reader) != expected)
+    {
+        reader->error = true;
+        return false;
+    }
+    reader->position++;
+    return true;
+}
+
+// A string, cut to fit 'size' (escapes are kept as the character after '\')
+static inline bool Single_Step_Read_String(Single_Step_Reader *reader, char *out, size_t size)
+{
+    if (!Single_Step_Expect(reader, '"'))
+        return false;
+
+    size_t used = 0;
+    int    c;
+    while ((c = Single_Step_Get(reader)) != '"')
+    {
+        if (c == '\\')
+            c = Single_Step_Get(reader);
+        if (c == EOF)
+        {
+            reader->error = true;
+            return false;
+        }
+        if (used + 1 < size)
+            out[used++] = (char)c;
+    }
+    if (size > 0)
+        out[used] = '\0';
+    return true;
+}
+
+// An integer, a fraction or exponent is read and dropped
+static inline bool Single_Step_Read_Number(Single_Step_Reader *reader, long *value)
+{
+    int  c        = Single_Step_Peek_Token(reader);
+    bool negative = (c == '-');
+    if (negative)
+    {
+        reader->position++;
+        c = Single_Step_Peek(reader);
+    }
+    if (c < '0' || c > '9')
+    {
+        reader->error = true;
+        return false;
+    }
+
+    long result = 0;
+    while (c >= '0' && c <= '9')
+    {
+        result = result * 10 + (c - '0');
+        reader->position++;
+        c = Single_Step_Peek(reader);
+    }
+    while (c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-' || (c >= '0' && c <= '9'))
+    {
+        reader->position++;
+        c = Single_Step_Peek(reader);
+    }
+    *value = negative ? -result : result;
+    return true;
+}
+
+// Any value, nested ones included
+static inline bool Single_Step_Skip_Value(Single_Step_Reader *reader)
+{
+    u32 depth = 0;
+    do
+    {
+        int c = Single_Step_Peek_Token(reader);
+        if (c == '"')
+        {
+            if (!Single_Step_Read_String(reader, NULL, 0))
+                return false;
+        }
+        else if (c == '{' || c == '[')
+        {
+            reader->position++;
+            depth++;
+        }
+        else if (c == '}' || c == ']')
+        {
+            if (depth == 0)
+            {
+                reader->error = true;
+                return false;
+            }
+            reader->position++;
+            depth--;
+        }
+        else if (c == ',' || c == ':')
+        {
+            reader->position++;
+        }
+        else if (c == EOF)
+        {
+            reader->error = true;
+            return false;
+        }
+        else
+        {
+            // number, true, false or null
+            while ((c = Single_Step_Peek(reader)) != EOF && c != ',' && c != '}' && c != ']' && c != ' ' && c != '\n' && c != '\r' &&
+                   c != '\t')
+                reader->position++;
+        }
+    } while (depth > 0);
+    return true;
+}
+
+// Runs the block for each element of an array or object, the function
+// returns false on an error
+#define SINGLE_STEP_FOR_EACH(reader, open, close, ...)             \
+    do                                                             \
+    {                                                              \
+        if (!Single_Step_Expect(reader, open))                     \
+            return false;                                          \
+        bool more = Single_Step_Peek_Token(reader) != (close);     \
+        while (more)                                               \
+        {                                                          \
+            __VA_ARGS__                                            \
+            if (reader->error)                                     \
+                return false;                                      \
+            more = Single_Step_Peek_Token(reader) == ',';          \
+            if (more)                                              \
+                reader->position++;                                \
+        }                                                          \
+        if (!Single_Step_Expect(reader, close))                    \
+            return false;                                          \
+    } while (0)
+
+static inline bool Single_Step_Read_RAM(Single_Step_Reader *reader, Single_Step_State *state)
+{
+    state->ram_count = 0;
+    SINGLE_STEP_FOR_EACH(reader, '[', ']', {
+        long address = 0, value = 0;
+        if (!Single_Step_Expect(reader, '[') || !Single_Step_Read_Number(reader, &address) || !Single_Step_Expect(reader, ',') ||
+            !Single_Step_Read_Number(reader, &value) || !Single_Step_Expect(reader, ']'))
+            return false;
+        if (state->ram_count < SINGLE_STEP_MAX_RAM)
+        {
+            state->address[state->ram_count] = (u16)address & 0xFFFF;
+            state->value[state->ram_count]   = (u8)value;
+            state->ram_count++;
+        }
+    });
+    return true;
+}
+
+static inline bool Single_Step_Read_State(Single_Step_Reader *reader, Single_Step_State *state)
+{
+    memset(state, 0, sizeof(*state));
+    SINGLE_STEP_FOR_EACH(reader, '{', '}', {
+        char key[16];
+        long value = 0;
+        if (!Single_Step_Read_String(reader, key, sizeof(key)) || !Single_Step_Expect(reader, ':'))
+            return false;
+
+        const int next = Single_Step_Peek_Token(reader);
+        if (strcmp(key, "ram") == 0)
+            Single_Step_Read_RAM(reader, state);
+        else if (next != '-' && (next < '0' || next > '9'))
+            Single_Step_Skip_Value(reader);
+        else if (Single_Step_Read_Number(reader, &value))
+        {
+            if (strcmp(key, "pc") == 0)
+                state->pc = (u16)value & 0xFFFF;
+            else if (strcmp(key, "s") == 0)
+                state->s = (u8)value;
+            else if (strcmp(key, "a") == 0)
+                state->a = (u8)value;
+            else if (strcmp(key, "x") == 0)
+                state->x = (u8)value;
+            else if (strcmp(key, "y") == 0)
+                state->y = (u8)value;
+            else if (strcmp(key, "p") == 0)
+                state->p = (u8)value;
+        }
+    });
+    return true;
+}
+
+// Only the number of bus cycles is kept
+static inline bool Single_Step_Read_Cycles(Single_Step_Reader *reader, u32 *cycles)
+{
+    *cycles = 0;
+    SINGLE_STEP_FOR_EACH(reader, '[', ']', {
+        if (Single_Step_Skip_Value(reader))
+            (*cycles)++;
+    });
+    return true;
+}
+
+static inline bool Single_Step_Read_Case(Single_Step_Reader *reader, Single_Step_Case *test)
+{
+    test->name[0] = '\0';
+    test->cycles  = 0;
+    SINGLE_STEP_FOR_EACH(reader, '{', '}', {
+        char key[16];
+        if (!Single_Step_Read_String(reader, key, sizeof(key)) || !Single_Step_Expect(reader, ':'))
+            return false;
+
+        if (strcmp(key, "name") == 0)
+            Single_Step_Read_String(reader, test->name, sizeof(test->name));
+        else if (strcmp(key, "initial") == 0)
+            Single_Step_Read_State(reader, &test->initial);
+        else if (strcmp(key, "final") == 0)
+            Single_Step_Read_State(reader, &test->final);
+        else if (strcmp(key, "cycles") == 0)
+            Single_Step_Read_Cycles(reader, &test->cycles);
+        else
+            Single_Step_Skip_Value(reader);
+    });
+    return true;
+}
+
+// Next case of the file, false at the end or on an error (reader->error)
+static inline bool Single_Step_Next(Single_Step_Reader *reader, Single_Step_Case *test)
+{
+    if (reader->ended || reader->error)
+        return false;
+
+    if (!reader->started)
+    {
+        if (!Single_Step_Expect(reader, '['))
+            return false;
+        reader->started = true;
+    }
+    else if (Single_Step_Peek_Token(reader) == ',')
+    {
+        reader->position++;
+    }
+
+    if (Single_Step_Peek_Token(reader) == ']')
+    {
+        reader->position++;
+        reader->ended = true;
+        return false;
+    }
+    return Single_Step_Read_Case(reader, test) && !reader->error;
+}
+
+// ---------------------------------------------------------------------
+// Running
+
+// Runs one case, false with what differs first in 'failure' when it fails
+static inline bool Single_Step_Run(const Single_Step_Case *test, char *failure, size_t size)
+{
+    const Single_Step_State *initial = &test->initial;
+    const Single_Step_State *final   = &test->final;
+
+    for (u32 i = 0; i < initial->ram_count; i++)
+        mem.data[initial->address[i]] = initial->value[i];
+    cpu.program_counter = initial->pc;
+    cpu.stack_pointer   = initial->s;
+    cpu.accumulator     = initial->a;
+    cpu.index_reg_X     = initial->x;
+    cpu.index_reg_Y     = initial->y;
+    cpu.PS              = initial->p;
+
+    const s32 cycles = Execute(1);
+
+    bool passed = true;
+#define SINGLE_STEP_CHECK(what, ours, theirs)                                                                          \
+    if (passed && (ours) != (theirs))                                                                                  \
+    {                                                                                                                  \
+        snprintf(failure, size, "%s : %s 0x%02X, expected 0x%02X", test->name, what, (unsigned)(ours), (unsigned)(theirs)); \
+        passed = false;                                                                                                \
+    }
+    SINGLE_STEP_CHECK("pc", cpu.program_counter, final->pc)
+    SINGLE_STEP_CHECK("s", cpu.stack_pointer, final->s)
+    SINGLE_STEP_CHECK("a", cpu.accumulator, final->a)
+    SINGLE_STEP_CHECK("x", cpu.index_reg_X, final->x)
+    SINGLE_STEP_CHECK("y", cpu.index_reg_Y, final->y)
+    SINGLE_STEP_CHECK("p", cpu.PS & SINGLE_STEP_FLAGS, final->p & SINGLE_STEP_FLAGS)
+    for (u32 i = 0; i < final->ram_count && passed; i++)
+    {
+        if (mem.data[final->address[i]] != final->value[i])
+        {
+            snprintf(failure, size, "%s : ram[0x%04X] 0x%02X, expected 0x%02X", test->name, (unsigned)final->address[i],
+                     (unsigned)mem.data[final->address[i]], (unsigned)final->value[i]);
+            passed = false;
+        }
+    }
+    SINGLE_STEP_CHECK("cycles", (u32)cycles, test->cycles)
+#undef SINGLE_STEP_CHECK
+
+    // back to zero for the next case
+    for (u32 i = 0; i < initial->ram_count; i++)
+        mem.data[initial->address[i]] = 0;
+    for (u32 i = 0; i < final->ram_count; i++)
+        mem.data[final->address[i]] = 0;
+    for (u32 i = 0; i < 3; i++)
+        mem.data[0x0100 | ((initial->s - i) & 0xFF)] = 0; // pushes a case may not list, BRK pushes three
+    return passed;
+}
+
+#endif // __SINGLE_STEP_H__
@@ -0,0 +1,100 @@
+#ifndef __SNAPSHOT_H__
+#define __SNAPSHOT_H__
+
+// Machine snapshots with dirty page tracking
+// Included by h6502.h when H6502_SNAPSHOT is 1.
+//
+// Write_Byte() marks the 256 byte page it writes to, so going back to a
+// snapshot only copies the pages written since it was taken (or last restored)
+// instead of all 64 KB. This is what makes a fuzzer or a search run thousands
+// of short runs a second from the same starting state:
+//
+//  Snapshot_Take(&start);
+//  while (...)
+//  {
+//      ... change memory, Execute() ...
+//      Snapshot_Restore_Dirty(&start);
+//  }
+//
+// Only writes made by instructions are tracked. Changes made straight to
+// 'mem.data' (Load_Program(), tests) need Snapshot_Mark_Dirty() or a full
+// Snapshot_Restore().
+
+#define SNAPSHOT_PAGE_SIZE  256
+#define SNAPSHOT_PAGE_COUNT (MAX_MEM / SNAPSHOT_PAGE_SIZE)
+
+typedef struct Snapshot
+{
+    CPU    cpu;
+    Memory mem;
+} Snapshot;
+
+// 1 for every page written since the last take or restore
+static uint8_t snapshot_dirty[SNAPSHOT_PAGE_COUNT] = {0};
+
+// A plain store, no branch, Write_Byte() runs it on every write
+#define H6502_SNAPSHOT_DIRTY(address) (snapshot_dirty[((address) & 0xFFFF) >> 8] = 1)
+
+static inline void Snapshot_Mark_Dirty(u16 address, u32 size)
+{
+    if (size == 0)
+        return;
+
+    const u32 first = (address & 0xFFFF) >> 8;
+    const u32 last  = ((address & 0xFFFF) + size - 1) >> 8;
+    for (u32 page = first; page <= last; page++)
+        snapshot_dirty[page & (SNAPSHOT_PAGE_COUNT - 1)] = 1;
+}
+
+static inline void Snapshot_Take(Snapshot *snapshot)
+{
+    snapshot->cpu = cpu;
+    memcpy(snapshot->mem.data, mem.data, MAX_MEM);
+    memset(snapshot_dirty, 0, sizeof(snapshot_dirty));
+}
+
+// Back to 'snapshot', copying all of memory
+static inline void Snapshot_Restore(const Snapshot *snapshot)
+{
+    cpu = snapshot->cpu;
+    memcpy(mem.data, snapshot->mem.data, MAX_MEM);
+    memset(snapshot_dirty, 0, sizeof(snapshot_dirty));
+}
+
+// Back to 'snapshot', copying only the dirty pages. Memory has to be the same
+// as 'snapshot' apart from them, i.e. it is the last snapshot taken or restored.
+// Returns the number of pages copied.
+static inline u32 Snapshot_Restore_Dirty(const Snapshot *snapshot)
+{
+    cpu = snapshot->cpu;
+
+    u32 pages = 0;
+    for (u32 group = 0; group < SNAPSHOT_PAGE_COUNT; group += 8)
+    {
+        // most runs touch a few pages, skip 8 clean ones at a time
+        uint64_t flags;
+        memcpy(&flags, &snapshot_dirty[group], sizeof(flags));
+        if (flags == 0)
+            continue;
+
+        for (u32 page = group; page < group + 8; page++)
+        {
+            if (snapshot_dirty[page])
+            {
+                memcpy(&mem.data[page * SNAPSHOT_PAGE_SIZE], &snapshot->mem.data[page * SNAPSHOT_PAGE_SIZE], SNAPSHOT_PAGE_SIZE);
+                pages++;
+            }
+        }
+        memset(&snapshot_dirty[group], 0, 8);
+    }
+    return pages;
+}
+
+// What changed in memory since 'snapshot', which is the last snapshot taken
+// or restored. Only the dirty pages are compared
+static inline u32 Snapshot_Diff(const Snapshot *snapshot, Memory_Diff *diff)
+{
+    return Memory_Diff_Compare(diff, snapshot->mem.data, mem.data, snapshot_dirty);
+}
+
+#endif // __SNAPSHOT_H__
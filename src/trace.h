@@ -0,0 +1,317 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+// Binary execution trace
+// Included by h6502.h when H6502_TRACE is 1.
+//
+// Every instruction adds a 16 byte Trace_Record (the cpu state before it ran)
+// to a single producer/single consumer ring. A background thread drains the
+// ring to the trace file so the emulator never waits on the disk, it only
+// waits when the ring is full.
+//
+//  Trace_Start("run.trace");
+//  Execute(...);
+//  Trace_Stop();
+//
+// File : "H6502TRC" | u8 version | u8 record size | u8 variant | 5 x u8 0 | records...
+// All multi-byte fields are little endian.
+
+#include <stdatomic.h>
+
+// The writer thread runs on C11 threads where the C library has them, on
+// Win32 or POSIX threads where it does not (__STDC_NO_THREADS__)
+#if !defined(__STDC_NO_THREADS__)
+#include <threads.h>
+typedef thrd_t Trace_Thread;
+#elif defined(_WIN32)
+#include <windows.h>
+typedef HANDLE Trace_Thread;
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+typedef pthread_t Trace_Thread;
+#endif
+
+#define TRACE_MAGIC         "H6502TRC"
+#define TRACE_VERSION       1
+#define TRACE_HEADER_SIZE   16
+#define TRACE_RING_RECORDS  (1u << 16) // must be a power of two
+#define TRACE_WRITE_RECORDS 4096       // largest single fwrite
+
+typedef struct Trace_Record
+{
+    uint8_t cycle[6]; // cycles before this instruction, 48-bit little endian
+    uint8_t pc[2];
+    uint8_t opcode;
+    uint8_t operand[2]; // the two bytes after the opcode, used or not
+    uint8_t a;
+    uint8_t x;
+    uint8_t y;
+    uint8_t sp;
+    uint8_t p;
+} Trace_Record;
+
+_Static_assert(sizeof(Trace_Record) == 16, "Trace_Record must stay 16 bytes");
+
+typedef struct Trace_Writer
+{
+    Trace_Record ring[TRACE_RING_RECORDS];
+
+    // head is only written by the emulator, tail only by the writer thread
+    _Alignas(64) atomic_size_t head;
+    _Alignas(64) atomic_size_t tail;
+    size_t      cached_tail; // emulator's last look at tail
+    atomic_bool stop;
+    atomic_bool error; // a write came up short
+
+    bool         running;
+    FILE        *file;
+    Trace_Thread thread;
+    uint64_t     cycle;
+    uint64_t     records_written;
+} Trace_Writer;
+
+static Trace_Writer trace_writer = {0};
+
+static inline void Trace_Put_Cycle(Trace_Record *record, uint64_t cycle)
+{
+    for (int i = 0; i < 6; i++)
+    {
+        record->cycle[i] = (uint8_t)(cycle >> (8 * i));
+    }
+}
+
+static inline uint64_t Trace_Record_Cycle(const Trace_Record *record)
+{
+    uint64_t cycle = 0;
+    for (int i = 0; i < 6; i++)
+    {
+        cycle |= (uint64_t)record->cycle[i] << (8 * i);
+    }
+    return cycle;
+}
+
+static inline u16 Trace_Record_PC(const Trace_Record *record)
+{
+    return record->pc[0] | (record->pc[1] << 8);
+}
+
+static inline void Trace_Thread_Sleep(void)
+{
+#if !defined(__STDC_NO_THREADS__)
+    thrd_sleep(&(struct timespec){.tv_nsec = 100000}, NULL); // 0.1 ms
+#elif defined(_WIN32)
+    Sleep(1);
+#else
+    nanosleep(&(struct timespec){.tv_nsec = 100000}, NULL);
+#endif
+}
+
+static inline void Trace_Thread_Yield(void)
+{
+#if !defined(__STDC_NO_THREADS__)
+    thrd_yield();
+#elif defined(_WIN32)
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+// Writer thread, drains the ring until told to stop and the ring is empty
+static inline int Trace_Writer_Thread(void *argument)
+{
+    (void)argument;
+
+    while (true)
+    {
+        const size_t tail = atomic_load_explicit(&trace_writer.tail, memory_order_relaxed);
+        const size_t head = atomic_load_explicit(&trace_writer.head, memory_order_acquire);
+
+        if (head == tail)
+        {
+            if (atomic_load_explicit(&trace_writer.stop, memory_order_acquire) &&
+                atomic_load_explicit(&trace_writer.head, memory_order_acquire) == tail)
+                break;
+
+            Trace_Thread_Sleep();
+            continue;
+        }
+
+        // write up to the end of the ring, the rest goes next time round
+        const size_t start = tail & (TRACE_RING_RECORDS - 1);
+        size_t       count = head - tail;
+        if (count > TRACE_RING_RECORDS - start)
+            count = TRACE_RING_RECORDS - start;
+        if (count > TRACE_WRITE_RECORDS)
+            count = TRACE_WRITE_RECORDS;
+
+        // records that cannot be written are still taken off the ring so the
+        // emulator does not wait on them
+        if (fwrite(&trace_writer.ring[start], sizeof(Trace_Record), count, trace_writer.file) != count)
+            atomic_store_explicit(&trace_writer.error, true, memory_order_relaxed);
+        atomic_store_explicit(&trace_writer.tail, tail + count, memory_order_release);
+    }
+    return 0;
+}
+
+#if defined(__STDC_NO_THREADS__) && defined(_WIN32)
+static inline DWORD WINAPI Trace_Writer_Win32(LPVOID argument)
+{
+    return (DWORD)Trace_Writer_Thread(argument);
+}
+#elif defined(__STDC_NO_THREADS__)
+static inline void *Trace_Writer_POSIX(void *argument)
+{
+    Trace_Writer_Thread(argument);
+    return NULL;
+}
+#endif
+
+static inline bool Trace_Thread_Create(Trace_Thread *thread)
+{
+#if !defined(__STDC_NO_THREADS__)
+    return thrd_create(thread, Trace_Writer_Thread, NULL) == thrd_success;
+#elif defined(_WIN32)
+    *thread = CreateThread(NULL, 0, Trace_Writer_Win32, NULL, 0, NULL);
+    return *thread != NULL;
+#else
+    return pthread_create(thread, NULL, Trace_Writer_POSIX, NULL) == 0;
+#endif
+}
+
+static inline void Trace_Thread_Join(Trace_Thread thread)
+{
+#if !defined(__STDC_NO_THREADS__)
+    thrd_join(thread, NULL);
+#elif defined(_WIN32)
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+#else
+    pthread_join(thread, NULL);
+#endif
+}
+
+// Open the trace file and start the writer thread
+static inline bool Trace_Start(const char *path)
+{
+    if (trace_writer.running)
+        return false;
+
+    trace_writer.file = fopen(path, "wb");
+    if (trace_writer.file == NULL)
+    {
+        fprintf(stderr, "Error opening trace file : %s\n", path);
+        return false;
+    }
+
+    const uint8_t header[TRACE_HEADER_SIZE] = {'H', '6', '5', '0', '2', 'T', 'R', 'C', TRACE_VERSION, sizeof(Trace_Record), H6502_VARIANT};
+    const bool    header_written            = fwrite(header, 1, sizeof(header), trace_writer.file) == sizeof(header);
+
+    atomic_init(&trace_writer.head, 0);
+    atomic_init(&trace_writer.tail, 0);
+    atomic_init(&trace_writer.stop, false);
+    atomic_init(&trace_writer.error, !header_written);
+    trace_writer.cached_tail     = 0;
+    trace_writer.cycle           = 0;
+    trace_writer.records_written = 0;
+
+    if (!Trace_Thread_Create(&trace_writer.thread))
+    {
+        fclose(trace_writer.file);
+        trace_writer.file = NULL;
+        return false;
+    }
+
+    trace_writer.running = true;
+    return true;
+}
+
+// Write out everything left in the ring and close the file, false if any
+// of the trace could not be written
+static inline bool Trace_Stop(void)
+{
+    if (!trace_writer.running)
+        return false;
+
+    atomic_store_explicit(&trace_writer.stop, true, memory_order_release);
+    Trace_Thread_Join(trace_writer.thread);
+
+    bool ok = !atomic_load_explicit(&trace_writer.error, memory_order_relaxed) && ferror(trace_writer.file) == 0;
+    ok      = (fclose(trace_writer.file) == 0) && ok;
+
+    trace_writer.file    = NULL;
+    trace_writer.running = false;
+    return ok;
+}
+
+// Called before every instruction, PC is on the opcode
+static inline void Trace_Instruction(void)
+{
+    if (!trace_writer.running)
+        return;
+
+    const size_t head = atomic_load_explicit(&trace_writer.head, memory_order_relaxed);
+    if (head - trace_writer.cached_tail >= TRACE_RING_RECORDS)
+    {
+        // ring looks full, wait for the writer to catch up
+        while ((trace_writer.cached_tail = atomic_load_explicit(&trace_writer.tail, memory_order_acquire)) + TRACE_RING_RECORDS <= head)
+        {
+            Trace_Thread_Yield();
+        }
+    }
+
+    Trace_Record *record = &trace_writer.ring[head & (TRACE_RING_RECORDS - 1)];
+    const u16     pc     = cpu.program_counter;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // build the record in two registers, the byte layout is the same
+    const uint64_t low  = (trace_writer.cycle & 0xFFFFFFFFFFFF) | ((uint64_t)pc << 48);
+    const uint64_t high = (uint64_t)Peek_Byte(pc) | ((uint64_t)Peek_Byte(pc + 1) << 8) | ((uint64_t)Peek_Byte(pc + 2) << 16) |
+                          ((uint64_t)cpu.accumulator << 24) | ((uint64_t)cpu.index_reg_X << 32) | ((uint64_t)cpu.index_reg_Y << 40) |
+                          ((uint64_t)cpu.stack_pointer << 48) | ((uint64_t)cpu.PS << 56);
+    memcpy(&record->cycle[0], &low, sizeof(low));
+    memcpy(&record->opcode, &high, sizeof(high));
+#else
+    Trace_Put_Cycle(record, trace_writer.cycle);
+    record->pc[0]      = pc & 0xFF;
+    record->pc[1]      = pc >> 8;
+    record->opcode     = Peek_Byte(pc);
+    record->operand[0] = Peek_Byte(pc + 1);
+    record->operand[1] = Peek_Byte(pc + 2);
+    record->a          = cpu.accumulator;
+    record->x          = cpu.index_reg_X;
+    record->y          = cpu.index_reg_Y;
+    record->sp         = cpu.stack_pointer;
+    record->p          = cpu.PS;
+#endif
+
+    trace_writer.records_written++;
+    atomic_store_explicit(&trace_writer.head, head + 1, memory_order_release);
+}
+
+// Called after every instruction
+static inline void Trace_Count_Cycles(s32 cycles_taken)
+{
+    trace_writer.cycle += (uint64_t)cycles_taken;
+}
+
+// ---------------------------------------------------------------------
+// Reading
+
+// Check the header, leaves the file on the first record
+static inline bool Trace_Read_Header(FILE *file)
+{
+    uint8_t header[TRACE_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header))
+        return false;
+
+    return memcmp(header, TRACE_MAGIC, 8) == 0 && header[8] == TRACE_VERSION && header[9] == sizeof(Trace_Record);
+}
+
+static inline bool Trace_Read_Record(FILE *file, Trace_Record *record)
+{
+    return fread(record, sizeof(Trace_Record), 1, file) == 1;
+}
+
+#endif // __TRACE_H__
@@ -0,0 +1,719 @@
+#ifndef __TRACE_COLUMNS_H__
+#define __TRACE_COLUMNS_H__
+
+// Columnar trace file
+// Included by h6502.h when H6502_TRACE_COLUMNS is 1.
+//
+// Instructions are stored in chunks of TRACE_COLUMNS_CHUNK_RECORDS. Inside a
+// chunk every field is its own column of varints. Each value is stored as the
+// zigzag difference from a prediction, and runs of correct predictions are
+// stored as a single zero run token:
+//
+//  PC                      : the PC that followed the previous PC last time
+//  cycles, opcode, address : the value from the last time this PC ran
+//  A, X, Y, SP, P          : the value in the previous instruction
+//
+// so a loop costs a few bits per instruction. Every chunk starts from zeroed
+// predictions so it can be decoded on its own, and a reader only decodes the
+// columns it asks for (cycle, opcode and address also need PC).
+//
+// Column token : varint(zigzag << 1) for a difference, varint(count << 1 | 1) for count zeros
+//
+//  header  : "H6502COL" | u8 version | u8 column count | u8 variant | u8 0 | u32 chunk records
+//  chunk   : u32 records | u64 first cycle | u32 column size x TRACE_COLUMN_COUNT | column data...
+//  index   : per chunk, u64 offset | u64 first cycle | u64 last cycle | u16 lowest PC | u16 highest PC | 32 byte PC page bitmap
+//  footer  : u64 index offset | u32 chunk count | "H6502IDX"
+//
+// All fields are little endian. The index is sorted by cycle, seeking to a
+// cycle is a binary search. The page bitmap has a bit for each 256 byte page
+// that had an instruction executed in the chunk.
+//
+//  Trace_Columns_Start("run.tcol");
+//  Execute(...);
+//  Trace_Columns_Stop();
+
+#define TRACE_COLUMNS_MAGIC         "H6502COL"
+#define TRACE_COLUMNS_INDEX_MAGIC   "H6502IDX"
+#define TRACE_COLUMNS_VERSION       1
+#define TRACE_COLUMNS_CHUNK_RECORDS 65536
+#define TRACE_COLUMNS_HEADER_SIZE   16
+#define TRACE_COLUMNS_INDEX_SIZE    (8 + 8 + 8 + 2 + 2 + 32)
+#define TRACE_COLUMNS_FOOTER_SIZE   (8 + 4 + 8)
+
+typedef enum
+{
+    TRACE_COLUMN_PC = 0,
+    TRACE_COLUMN_CYCLE,
+    TRACE_COLUMN_OPCODE,
+    TRACE_COLUMN_A,
+    TRACE_COLUMN_X,
+    TRACE_COLUMN_Y,
+    TRACE_COLUMN_SP,
+    TRACE_COLUMN_P,
+    TRACE_COLUMN_ADDRESS, // see Effective_Address()
+    TRACE_COLUMN_COUNT
+} Trace_Column;
+
+#define TRACE_COLUMNS_ALL ((1u << TRACE_COLUMN_COUNT) - 1)
+
+#define TRACE_COLUMNS_CHUNK_HEADER_SIZE (4 + 8 + 4 * TRACE_COLUMN_COUNT)
+#define TRACE_COLUMNS_COLUMN_CAPACITY   (TRACE_COLUMNS_CHUNK_RECORDS * 16) // a zero run and a 10 byte varint per record
+
+// One instruction, the state before it ran
+typedef struct Trace_Columns_Entry
+{
+    uint64_t cycle;
+    u16      pc;
+    u8       opcode;
+    u8       a;
+    u8       x;
+    u8       y;
+    u8       sp;
+    u8       p;
+    u16      address;
+} Trace_Columns_Entry;
+
+typedef struct Trace_Columns_Index
+{
+    uint64_t offset;
+    uint64_t first_cycle;
+    uint64_t last_cycle;
+    u16      lowest_pc;
+    u16      highest_pc;
+    uint8_t  pages[32];
+} Trace_Columns_Index;
+
+// What happened the last time a PC ran, indexed by PC
+typedef struct Trace_Columns_Prediction
+{
+    u16      next_pc;
+    u16      address;
+    uint32_t cycles;
+    u8       opcode;
+} Trace_Columns_Prediction;
+
+typedef struct Trace_Columns_Writer
+{
+    FILE *file;
+
+    uint8_t *column[TRACE_COLUMN_COUNT];
+    size_t   column_size[TRACE_COLUMN_COUNT];
+    u32      zero_run[TRACE_COLUMN_COUNT]; // correct predictions not written yet
+
+    Trace_Columns_Prediction *predict;
+
+    u32                 records; // in the current chunk
+    Trace_Columns_Entry previous;
+    Trace_Columns_Index current;
+
+    Trace_Columns_Index *index;
+    u32                  chunk_count;
+    u32                  index_capacity;
+
+    uint64_t cycle; // running cycle count when driven by the emulator
+    bool     error; // the index could not grow, nothing more is recorded
+} Trace_Columns_Writer;
+
+// ---------------------------------------------------------------------
+// Encoding
+
+static inline void Trace_Columns_Put_U16(uint8_t *out, uint16_t value)
+{
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+static inline void Trace_Columns_Put_U32(uint8_t *out, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+        out[i] = (uint8_t)(value >> (8 * i));
+}
+
+static inline void Trace_Columns_Put_U64(uint8_t *out, uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+        out[i] = (uint8_t)(value >> (8 * i));
+}
+
+static inline uint16_t Trace_Columns_Get_U16(const uint8_t *in)
+{
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static inline uint32_t Trace_Columns_Get_U32(const uint8_t *in)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++)
+        value |= (uint32_t)in[i] << (8 * i);
+    return value;
+}
+
+static inline uint64_t Trace_Columns_Get_U64(const uint8_t *in)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++)
+        value |= (uint64_t)in[i] << (8 * i);
+    return value;
+}
+
+// LEB128, returns the number of bytes written
+static inline size_t Trace_Columns_Put_Varint(uint8_t *out, uint64_t value)
+{
+    size_t length = 0;
+    while (value >= 0x80)
+    {
+        out[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (uint8_t)value;
+    return length;
+}
+
+// Returns the number of bytes read, 0 if the varint runs past 'end'
+static inline size_t Trace_Columns_Get_Varint(const uint8_t *in, const uint8_t *end, uint64_t *value)
+{
+    uint64_t result = 0;
+    size_t   length = 0;
+    for (int shift = 0; in + length < end && shift < 64; shift += 7)
+    {
+        const uint8_t byte = in[length++];
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            *value = result;
+            return length;
+        }
+    }
+    return 0;
+}
+
+// Small signed deltas to small unsigned numbers, 0 -1 1 -2 2 -> 0 1 2 3 4
+static inline uint64_t Trace_Columns_Zigzag(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t Trace_Columns_Unzigzag(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+// File offsets past 4 GB, long is 32 bits on Windows
+static inline int Trace_Columns_Seek(FILE *file, int64_t offset, int origin)
+{
+#if defined(_WIN32)
+    return _fseeki64(file, offset, origin);
+#else
+    return fseeko(file, (off_t)offset, origin);
+#endif
+}
+
+static inline int64_t Trace_Columns_Tell(FILE *file)
+{
+#if defined(_WIN32)
+    return _ftelli64(file);
+#else
+    return (int64_t)ftello(file);
+#endif
+}
+
+// ---------------------------------------------------------------------
+// Writing
+
+static inline void Trace_Columns_Start_Chunk(Trace_Columns_Writer *writer)
+{
+    writer->records = 0;
+    memset(&writer->previous, 0, sizeof(writer->previous));
+    memset(&writer->current, 0, sizeof(writer->current));
+    memset(writer->column_size, 0, sizeof(writer->column_size));
+    memset(writer->zero_run, 0, sizeof(writer->zero_run));
+    memset(writer->predict, 0, 0x10000 * sizeof(Trace_Columns_Prediction));
+    writer->current.lowest_pc = 0xFFFF;
+}
+
+static inline bool Trace_Columns_Writer_Open(Trace_Columns_Writer *writer, const char *path)
+{
+    memset(writer, 0, sizeof(*writer));
+
+    writer->file = fopen(path, "wb");
+    if (writer->file == NULL)
+    {
+        fprintf(stderr, "Error opening columnar trace file : %s\n", path);
+        return false;
+    }
+
+    bool ok         = (writer->predict = malloc(0x10000 * sizeof(Trace_Columns_Prediction))) != NULL;
+    for (int column = 0; column < TRACE_COLUMN_COUNT; column++)
+        ok = ok && (writer->column[column] = malloc(TRACE_COLUMNS_COLUMN_CAPACITY)) != NULL;
+    if (!ok)
+    {
+        fclose(writer->file);
+        writer->file = NULL;
+        for (int column = 0; column < TRACE_COLUMN_COUNT; column++)
+            free(writer->column[column]);
+        free(writer->predict);
+        return false;
+    }
+
+    uint8_t header[TRACE_COLUMNS_HEADER_SIZE] = {'H', '6', '5', '0', '2', 'C', 'O', 'L', TRACE_COLUMNS_VERSION, TRACE_COLUMN_COUNT, H6502_VARIANT};
+    Trace_Columns_Put_U32(&header[12], TRACE_COLUMNS_CHUNK_RECORDS);
+    fwrite(header, 1, sizeof(header), writer->file);
+
+    Trace_Columns_Start_Chunk(writer);
+    return true;
+}
+
+static inline void Trace_Columns_Put_Token(Trace_Columns_Writer *writer, Trace_Column column, uint64_t token)
+{
+    writer->column_size[column] += Trace_Columns_Put_Varint(&writer->column[column][writer->column_size[column]], token);
+}
+
+static inline void Trace_Columns_Flush_Zeros(Trace_Columns_Writer *writer, Trace_Column column)
+{
+    if (writer->zero_run[column] == 0)
+        return;
+    Trace_Columns_Put_Token(writer, column, ((uint64_t)writer->zero_run[column] << 1) | 1);
+    writer->zero_run[column] = 0;
+}
+
+// Add the difference between a value and its prediction to a column
+static inline void Trace_Columns_Put(Trace_Columns_Writer *writer, Trace_Column column, int64_t difference)
+{
+    if (difference == 0)
+    {
+        writer->zero_run[column]++;
+        return;
+    }
+    Trace_Columns_Flush_Zeros(writer, column);
+    Trace_Columns_Put_Token(writer, column, Trace_Columns_Zigzag(difference) << 1);
+}
+
+static inline void Trace_Columns_Flush_Chunk(Trace_Columns_Writer *writer)
+{
+    if (writer->records == 0 || writer->error)
+        return;
+
+    for (int column = 0; column < TRACE_COLUMN_COUNT; column++)
+        Trace_Columns_Flush_Zeros(writer, (Trace_Column)column);
+
+    if (writer->chunk_count == writer->index_capacity)
+    {
+        // the footer has a u32 chunk count
+        const uint64_t       capacity = writer->index_capacity ? (uint64_t)writer->index_capacity * 2 : 64;
+        Trace_Columns_Index *index    = NULL;
+        if (capacity <= UINT32_MAX && capacity <= SIZE_MAX / sizeof(Trace_Columns_Index))
+            index = realloc(writer->index, (size_t)capacity * sizeof(Trace_Columns_Index));
+        if (index == NULL)
+        {
+            // the chunk is dropped and the trace ends with the chunks before it
+            fprintf(stderr, "Error allocating the columnar trace index : %" PRIu64 " chunks\n", capacity);
+            writer->error = true;
+            Trace_Columns_Start_Chunk(writer);
+            return;
+        }
+        writer->index          = index;
+        writer->index_capacity = (u32)capacity;
+    }
+
+    const int64_t offset = Trace_Columns_Tell(writer->file);
+    if (offset < 0)
+    {
+        writer->error = true;
+        Trace_Columns_Start_Chunk(writer);
+        return;
+    }
+    writer->current.offset     = (uint64_t)offset;
+    writer->current.last_cycle = writer->previous.cycle;
+
+    uint8_t header[TRACE_COLUMNS_CHUNK_HEADER_SIZE];
+    Trace_Columns_Put_U32(&header[0], writer->records);
+    Trace_Columns_Put_U64(&header[4], writer->current.first_cycle);
+    for (int column = 0; column < TRACE_COLUMN_COUNT; column++)
+        Trace_Columns_Put_U32(&header[12 + 4 * column], (uint32_t)writer->column_size[column]);
+    fwrite(header, 1, sizeof(header), writer->file);
+
+    for (int column = 0; column < TRACE_COLUMN_COUNT; column++)
+        fwrite(writer->column[column], 1, writer->column_size[column], writer->file);
+
+    writer->index[writer->chunk_count++] = writer->current;
+    Trace_Columns_Start_Chunk(writer);
+}
+
+static inline void Trace_Columns_Add(Trace_Columns_Writer *writer, const Trace_Columns_Entry *entry)
+{
+    if (writer->error)
+        return;
+    if (writer->records == 0)
+    {
+        writer->current.first_cycle = entry->cycle;
+        writer->previous.cycle      = entry->cycle;
+    }
+
+    const Trace_Columns_Entry *previous = &writer->previous;
+    Trace_Columns_Prediction  *last     = &writer->predict[previous->pc]; // the instruction before this one
+    Trace_Columns_Prediction  *here     = &writer->predict[entry->pc];
+    const uint64_t             cycles   = entry->cycle - previous->cycle;
+
+    Trace_Columns_Put(writer, TRACE_COLUMN_PC, (int16_t)(entry->pc - last->next_pc));
+    Trace_Columns_Put(writer, TRACE_COLUMN_CYCLE, (int64_t)(cycles - last->cycles));
+    last->next_pc = entry->pc;
+    last->cycles  = (uint32_t)cycles;
+
+    Trace_Columns_Put(writer, TRACE_COLUMN_OPCODE, (int8_t)(entry->opcode - here->opcode));
+    Trace_Columns_Put(writer, TRACE_COLUMN_ADDRESS, (int16_t)(entry->address - here->address));
+    here->opcode  = entry->opcode;
+    here->address = entry->address;
+
+    Trace_Columns_Put(writer, TRACE_COLUMN_A, (int8_t)(entry->a - previous->a));
+    Trace_Columns_Put(writer, TRACE_COLUMN_X, (int8_t)(entry->x - previous->x));
+    Trace_Columns_Put(writer, TRACE_COLUMN_Y, (int8_t)(entry->y - previous->y));
+    Trace_Columns_Put(writer, TRACE_COLUMN_SP, (int8_t)(entry->sp - previous->sp));
+    Trace_Columns_Put(writer, TRACE_COLUMN_P, (int8_t)(entry->p - previous->p));
+
+    if (entry->pc < writer->current.lowest_pc)
+        writer->current.lowest_pc = entry->pc;
+    if (entry->pc > writer->current.highest_pc)
+        writer->current.highest_pc = entry->pc;
+    writer->current.pages[entry->pc >> 11] |= (uint8_t)(1 << ((entry->pc >> 8) & 7));
+
+    writer->previous = *entry;
+    if (++writer->records >= TRACE_COLUMNS_CHUNK_RECORDS)
+        Trace_Columns_Flush_Chunk(writer);
+}
+
+// Write the last chunk, the index and the footer
+static inline bool Trace_Columns_Writer_Close(Trace_Columns_Writer *writer)
+{
+    if (writer->file == NULL)
+        return false;
+
+    Trace_Columns_Flush_Chunk(writer);
+
+    const int64_t index_offset = Trace_Columns_Tell(writer->file);
+    for (u32 chunk = 0; chunk < writer->chunk_count; chunk++)
+    {
+        const Trace_Columns_Index *index = &writer->index[chunk];
+        uint8_t                    entry[TRACE_COLUMNS_INDEX_SIZE];
+        Trace_Columns_Put_U64(&entry[0], index->offset);
+        Trace_Columns_Put_U64(&entry[8], index->first_cycle);
+        Trace_Columns_Put_U64(&entry[16], index->last_cycle);
+        Trace_Columns_Put_U16(&entry[24], index->lowest_pc);
+        Trace_Columns_Put_U16(&entry[26], index->highest_pc);
+        memcpy(&entry[28], index->pages, sizeof(index->pages));
+        fwrite(entry, 1, sizeof(entry), writer->file);
+    }
+
+    uint8_t footer[TRACE_COLUMNS_FOOTER_SIZE];
+    Trace_Columns_Put_U64(&footer[0], (uint64_t)index_offset);
+    Trace_Columns_Put_U32(&footer[8], writer->chunk_count);
+    memcpy(&footer[12], TRACE_COLUMNS_INDEX_MAGIC, 8);
+    fwrite(footer, 1, sizeof(footer), writer->file);
+
+    const bool ok = (ferror(writer->file) == 0) && !writer->error && index_offset >= 0;
+    fclose(writer->file);
+    writer->file = NULL;
+
+    for (int column = 0; column < TRACE_COLUMN_COUNT; column++)
+    {
+        free(writer->column[column]);
+        writer->column[column] = NULL;
+    }
+    free(writer->index);
+    free(writer->predict);
+    writer->index   = NULL;
+    writer->predict = NULL;
+    return ok;
+}
+
+// ---------------------------------------------------------------------
+// Emulator hooks, one trace per machine
+
+static Trace_Columns_Writer trace_columns = {0};
+
+static inline bool Trace_Columns_Start(const char *path)
+{
+    return Trace_Columns_Writer_Open(&trace_columns, path);
+}
+
+static inline bool Trace_Columns_Stop(void)
+{
+    return Trace_Columns_Writer_Close(&trace_columns);
+}
+
+// Called before every instruction, PC is on the opcode
+static inline void Trace_Columns_Instruction(void)
+{
+    if (trace_columns.file == NULL)
+        return;
+
+    const u16                 pc    = cpu.program_counter;
+    const Trace_Columns_Entry entry = {
+        .cycle   = trace_columns.cycle,
+        .pc      = pc,
+        .opcode  = Peek_Byte(pc),
+        .a       = cpu.accumulator,
+        .x       = cpu.index_reg_X,
+        .y       = cpu.index_reg_Y,
+        .sp      = cpu.stack_pointer,
+        .p       = cpu.PS,
+        .address = Effective_Address(pc),
+    };
+    Trace_Columns_Add(&trace_columns, &entry);
+}
+
+// Called after every instruction
+static inline void Trace_Columns_Count_Cycles(s32 cycles_taken)
+{
+    trace_columns.cycle += (uint64_t)cycles_taken;
+}
+
+// ---------------------------------------------------------------------
+// Reading
+
+typedef struct Trace_Columns_Reader
+{
+    FILE                *file;
+    Trace_Columns_Index *index;
+    u32                  chunk_count;
+    u32                  chunk_records; // most records in one chunk
+
+    Trace_Columns_Prediction *predict;
+} Trace_Columns_Reader;
+
+// Decoded columns of one chunk, only the columns asked for are filled in
+typedef struct Trace_Columns_Chunk
+{
+    u32       records;
+    uint64_t *cycle;
+    uint16_t *pc;
+    uint16_t *address;
+    uint8_t  *byte_column[TRACE_COLUMN_COUNT]; // opcode, A, X, Y, SP and P
+} Trace_Columns_Chunk;
+
+static inline void Trace_Columns_Reader_Close(Trace_Columns_Reader *reader)
+{
+    if (reader->file != NULL)
+        fclose(reader->file);
+    free(reader->index);
+    free(reader->predict);
+    memset(reader, 0, sizeof(*reader));
+}
+
+// Reads the header and the chunk index
+static inline bool Trace_Columns_Reader_Open(Trace_Columns_Reader *reader, const char *path)
+{
+    memset(reader, 0, sizeof(*reader));
+
+    reader->file = fopen(path, "rb");
+    if (reader->file == NULL)
+        return false;
+
+    uint8_t header[TRACE_COLUMNS_HEADER_SIZE];
+    uint8_t footer[TRACE_COLUMNS_FOOTER_SIZE];
+    if (fread(header, 1, sizeof(header), reader->file) != sizeof(header) || memcmp(header, TRACE_COLUMNS_MAGIC, 8) != 0 ||
+        header[8] != TRACE_COLUMNS_VERSION || header[9] != TRACE_COLUMN_COUNT ||
+        Trace_Columns_Seek(reader->file, -(int64_t)sizeof(footer), SEEK_END) != 0 || fread(footer, 1, sizeof(footer), reader->file) != sizeof(footer) ||
+        memcmp(&footer[12], TRACE_COLUMNS_INDEX_MAGIC, 8) != 0)
+    {
+        Trace_Columns_Reader_Close(reader);
+        return false;
+    }
+
+    reader->chunk_records = Trace_Columns_Get_U32(&header[12]);
+    reader->chunk_count   = Trace_Columns_Get_U32(&footer[8]);
+    reader->index         = calloc(reader->chunk_count ? reader->chunk_count : 1, sizeof(Trace_Columns_Index));
+    reader->predict       = malloc(0x10000 * sizeof(Trace_Columns_Prediction));
+    if (reader->index == NULL || reader->predict == NULL || Trace_Columns_Seek(reader->file, (int64_t)Trace_Columns_Get_U64(&footer[0]), SEEK_SET) != 0)
+    {
+        Trace_Columns_Reader_Close(reader);
+        return false;
+    }
+
+    for (u32 chunk = 0; chunk < reader->chunk_count; chunk++)
+    {
+        uint8_t entry[TRACE_COLUMNS_INDEX_SIZE];
+        if (fread(entry, 1, sizeof(entry), reader->file) != sizeof(entry))
+        {
+            Trace_Columns_Reader_Close(reader);
+            return false;
+        }
+
+        Trace_Columns_Index *index = &reader->index[chunk];
+        index->offset              = Trace_Columns_Get_U64(&entry[0]);
+        index->first_cycle         = Trace_Columns_Get_U64(&entry[8]);
+        index->last_cycle          = Trace_Columns_Get_U64(&entry[16]);
+        index->lowest_pc           = Trace_Columns_Get_U16(&entry[24]);
+        index->highest_pc          = Trace_Columns_Get_U16(&entry[26]);
+        memcpy(index->pages, &entry[28], sizeof(index->pages));
+    }
+    return true;
+}
+
+// Chunk holding 'cycle', or the chunk_count if the trace ends before it.
+// Binary search over the index.
+static inline u32 Trace_Columns_Find_Cycle(const Trace_Columns_Reader *reader, uint64_t cycle)
+{
+    u32 low  = 0;
+    u32 high = reader->chunk_count;
+    while (low < high)
+    {
+        const u32 middle = low + (high - low) / 2;
+        if (reader->index[middle].last_cycle < cycle)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+// Can the chunk have run an instruction at 'pc'
+static inline bool Trace_Columns_Chunk_May_Have_PC(const Trace_Columns_Reader *reader, u32 chunk, u16 pc)
+{
+    const Trace_Columns_Index *index = &reader->index[chunk];
+    return pc >= index->lowest_pc && pc <= index->highest_pc && ((index->pages[pc >> 11] >> ((pc >> 8) & 7)) & 1);
+}
+
+static inline bool Trace_Columns_Chunk_Alloc(Trace_Columns_Chunk *chunk, const Trace_Columns_Reader *reader)
+{
+    memset(chunk, 0, sizeof(*chunk));
+    const size_t records = reader->chunk_records;
+
+    chunk->cycle   = malloc(records * sizeof(uint64_t));
+    chunk->pc      = malloc(records * sizeof(uint16_t));
+    chunk->address = malloc(records * sizeof(uint16_t));
+    bool ok        = chunk->cycle && chunk->pc && chunk->address;
+    for (int column = TRACE_COLUMN_OPCODE; column <= TRACE_COLUMN_P; column++)
+    {
+        chunk->byte_column[column] = malloc(records);
+        ok                         = ok && chunk->byte_column[column];
+    }
+    return ok;
+}
+
+static inline void Trace_Columns_Chunk_Free(Trace_Columns_Chunk *chunk)
+{
+    free(chunk->cycle);
+    free(chunk->pc);
+    free(chunk->address);
+    for (int column = 0; column < TRACE_COLUMN_COUNT; column++)
+        free(chunk->byte_column[column]);
+    memset(chunk, 0, sizeof(*chunk));
+}
+
+// Reads the differences back out of a column's tokens
+typedef struct Trace_Columns_Decoder
+{
+    const uint8_t *in;
+    const uint8_t *end;
+    uint64_t       zero_run;
+    bool           ok;
+} Trace_Columns_Decoder;
+
+static inline int64_t Trace_Columns_Next(Trace_Columns_Decoder *decoder)
+{
+    if (decoder->zero_run > 0)
+    {
+        decoder->zero_run--;
+        return 0;
+    }
+
+    uint64_t     token  = 0;
+    const size_t length = Trace_Columns_Get_Varint(decoder->in, decoder->end, &token);
+    if (length == 0)
+    {
+        decoder->ok = false;
+        return 0;
+    }
+    decoder->in += length;
+
+    if (token & 1)
+    {
+        decoder->zero_run = (token >> 1) - 1;
+        return 0;
+    }
+    return Trace_Columns_Unzigzag(token >> 1);
+}
+
+// Decode the columns in 'column_mask' (1 << TRACE_COLUMN_x) of one chunk.
+// Columns that are not asked for are skipped without being read.
+static inline bool Trace_Columns_Read_Chunk(Trace_Columns_Reader *reader, u32 chunk_number, u32 column_mask, Trace_Columns_Chunk *chunk)
+{
+    if (chunk_number >= reader->chunk_count)
+        return false;
+
+    uint8_t header[TRACE_COLUMNS_CHUNK_HEADER_SIZE];
+    if (Trace_Columns_Seek(reader->file, (int64_t)reader->index[chunk_number].offset, SEEK_SET) != 0 ||
+        fread(header, 1, sizeof(header), reader->file) != sizeof(header))
+        return false;
+
+    chunk->records = Trace_Columns_Get_U32(&header[0]);
+    if (chunk->records > reader->chunk_records)
+        return false;
+
+    // the predictions for these are per PC
+    if (column_mask & ((1u << TRACE_COLUMN_CYCLE) | (1u << TRACE_COLUMN_OPCODE) | (1u << TRACE_COLUMN_ADDRESS)))
+        column_mask |= 1u << TRACE_COLUMN_PC;
+    memset(reader->predict, 0, 0x10000 * sizeof(Trace_Columns_Prediction));
+
+    const uint64_t first_cycle = Trace_Columns_Get_U64(&header[4]);
+    int64_t        skip        = 0;
+    uint8_t       *data        = NULL;
+
+    bool ok = true;
+    for (int column = 0; column < TRACE_COLUMN_COUNT && ok; column++)
+    {
+        const size_t size = Trace_Columns_Get_U32(&header[12 + 4 * column]);
+        if (!(column_mask & (1u << column)))
+        {
+            skip += (int64_t)size;
+            continue;
+        }
+
+        uint8_t *buffer = realloc(data, size ? size : 1);
+        ok              = buffer != NULL && Trace_Columns_Seek(reader->file, skip, SEEK_CUR) == 0 && fread(buffer, 1, size, reader->file) == size;
+        if (buffer != NULL)
+            data = buffer;
+        skip = 0;
+
+        Trace_Columns_Decoder decoder = {.in = data, .end = data + size, .ok = ok};
+        u16                   pc      = 0; // the previous record's
+        uint64_t              cycle   = first_cycle;
+        u8                    value   = 0;
+        for (u32 record = 0; record < chunk->records && decoder.ok; record++)
+        {
+            const int64_t             difference = Trace_Columns_Next(&decoder);
+            Trace_Columns_Prediction *last       = &reader->predict[pc];
+
+            switch (column)
+            {
+            case TRACE_COLUMN_PC:
+                chunk->pc[record] = last->next_pc = (u16)(last->next_pc + difference);
+                pc                = chunk->pc[record];
+                break;
+            case TRACE_COLUMN_CYCLE:
+                last->cycles = (uint32_t)(last->cycles + (uint64_t)difference);
+                cycle += last->cycles;
+                chunk->cycle[record] = cycle;
+                pc                   = chunk->pc[record];
+                break;
+            case TRACE_COLUMN_OPCODE:
+                last = &reader->predict[chunk->pc[record]];
+                chunk->byte_column[column][record] = last->opcode = (u8)(last->opcode + difference);
+                break;
+            case TRACE_COLUMN_ADDRESS:
+                last = &reader->predict[chunk->pc[record]];
+                chunk->address[record] = last->address = (u16)(last->address + difference);
+                break;
+            default:
+                chunk->byte_column[column][record] = value = (u8)(value + difference);
+                break;
+            }
+        }
+        ok = decoder.ok;
+    }
+
+    free(data);
+    return ok;
+}
+
+#endif // __TRACE_COLUMNS_H__
@@ -0,0 +1,489 @@
+#ifndef __TRACE_TEXT_H__
+#define __TRACE_TEXT_H__
+
+// Text trace in the nestest.log style, and a differ for reference logs
+// Included by h6502.h when H6502_TRACE_TEXT is 1.
+//
+//  C000  4C F5 C5  A:00 X:00 Y:00 P:24 SP:FD CYC:7
+//
+// One line per instruction with the state before it ran. Lines are built with
+// table lookups straight into a large buffer, printf is far too slow for logs
+// of a hundred million lines.
+//
+//  Trace_Text_Start("run.log");
+//  trace_text.cycle = 7; // nestest starts counting after the reset sequence
+//  Execute(...);
+//  Trace_Text_Stop();
+//
+//  Trace_Text_Diff_Files("run.log", "nestest.log", stdout, 5);
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define TRACE_TEXT_BUFFER_SIZE (1u << 18)
+#define TRACE_TEXT_PREFIX_SIZE 46                          // everything before the cycle count
+#define TRACE_TEXT_MAX_LINE    (TRACE_TEXT_PREFIX_SIZE + 21) // 20 digits and '\n'
+
+// The state printed on one line
+typedef struct Trace_Text_State
+{
+    uint64_t cycle;
+    u16      pc;
+    u8       bytes[3]; // opcode and operands
+    u8       length;   // instruction bytes, 1 to 3
+    u8       a;
+    u8       x;
+    u8       y;
+    u8       p;
+    u8       sp;
+} Trace_Text_State;
+
+typedef struct Trace_Text_Writer
+{
+    FILE    *file;
+    bool     close_file; // false when given a FILE* to write to
+    char    *buffer;
+    size_t   used;
+    uint64_t cycle;
+    uint64_t lines;
+} Trace_Text_Writer;
+
+static Trace_Text_Writer trace_text = {0};
+
+// "00" to "FF"
+static const char trace_text_hex[513] =
+    "000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F"
+    "202122232425262728292A2B2C2D2E2F303132333435363738393A3B3C3D3E3F"
+    "404142434445464748494A4B4C4D4E4F505152535455565758595A5B5C5D5E5F"
+    "606162636465666768696A6B6C6D6E6F707172737475767778797A7B7C7D7E7F"
+    "808182838485868788898A8B8C8D8E8F909192939495969798999A9B9C9D9E9F"
+    "A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+    "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECFD0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+    "E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEFF0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
+// "00" to "99"
+static const char trace_text_decimal[201] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static inline void Trace_Text_Hex(char *out, u8 value)
+{
+    memcpy(out, &trace_text_hex[value * 2], 2);
+}
+
+static inline size_t Trace_Text_Digits(uint64_t value)
+{
+    size_t digits = 1;
+    while (value >= 10000)
+    {
+        value /= 10000;
+        digits += 4;
+    }
+    return digits + (value >= 10) + (value >= 100) + (value >= 1000);
+}
+
+// Writes the number without a terminator, returns the number of digits.
+// Filled in from the end, two digits at a time.
+static inline size_t Trace_Text_Decimal(char *out, uint64_t value)
+{
+    const size_t length = Trace_Text_Digits(value);
+    char        *end    = out + length;
+    while (value >= 100)
+    {
+        end -= 2;
+        memcpy(end, &trace_text_decimal[(value % 100) * 2], 2);
+        value /= 100;
+    }
+    if (value >= 10)
+        memcpy(end - 2, &trace_text_decimal[value * 2], 2);
+    else
+        end[-1] = (char)('0' + value);
+    return length;
+}
+
+// Formats one line including the '\n', 'out' needs TRACE_TEXT_MAX_LINE bytes.
+// Returns the line length.
+static inline size_t Trace_Text_Format_Line(char *out, const Trace_Text_State *state)
+{
+    // 0         1         2         3         4
+    // 0123456789012345678901234567890123456789012345
+    // C000  4C F5 C5  A:00 X:00 Y:00 P:24 SP:FD CYC:
+    static const char prefix[TRACE_TEXT_PREFIX_SIZE + 1] = "0000  00        A:00 X:00 Y:00 P:00 SP:00 CYC:";
+    memcpy(out, prefix, TRACE_TEXT_PREFIX_SIZE);
+
+    Trace_Text_Hex(&out[0], (u8)(state->pc >> 8));
+    Trace_Text_Hex(&out[2], (u8)state->pc);
+    Trace_Text_Hex(&out[6], state->bytes[0]);
+    if (state->length > 1)
+        Trace_Text_Hex(&out[9], state->bytes[1]);
+    if (state->length > 2)
+        Trace_Text_Hex(&out[12], state->bytes[2]);
+    Trace_Text_Hex(&out[18], state->a);
+    Trace_Text_Hex(&out[23], state->x);
+    Trace_Text_Hex(&out[28], state->y);
+    Trace_Text_Hex(&out[33], state->p);
+    Trace_Text_Hex(&out[39], state->sp);
+
+    size_t length  = TRACE_TEXT_PREFIX_SIZE;
+    length        += Trace_Text_Decimal(&out[length], state->cycle);
+    out[length++]  = '\n';
+    return length;
+}
+
+// ---------------------------------------------------------------------
+// Writing
+
+static inline void Trace_Text_Flush(void)
+{
+    if (trace_text.used > 0)
+        fwrite(trace_text.buffer, 1, trace_text.used, trace_text.file);
+    trace_text.used = 0;
+}
+
+// Trace to an open file (stdout for example), it is not closed by Trace_Text_Stop()
+static inline bool Trace_Text_Start_File(FILE *file)
+{
+    if (trace_text.file != NULL || file == NULL)
+        return false;
+
+    trace_text.buffer = malloc(TRACE_TEXT_BUFFER_SIZE);
+    if (trace_text.buffer == NULL)
+        return false;
+
+    trace_text.file       = file;
+    trace_text.close_file = false;
+    trace_text.used       = 0;
+    trace_text.cycle      = 0;
+    trace_text.lines      = 0;
+    return true;
+}
+
+static inline bool Trace_Text_Start(const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error opening text trace file : %s\n", path);
+        return false;
+    }
+
+    if (!Trace_Text_Start_File(file))
+    {
+        fclose(file);
+        return false;
+    }
+    trace_text.close_file = true;
+    return true;
+}
+
+static inline void Trace_Text_Stop(void)
+{
+    if (trace_text.file == NULL)
+        return;
+
+    Trace_Text_Flush();
+    if (trace_text.close_file)
+        fclose(trace_text.file);
+    else
+        fflush(trace_text.file);
+
+    free(trace_text.buffer);
+    trace_text.buffer = NULL;
+    trace_text.file   = NULL;
+}
+
+// Called before every instruction, PC is on the opcode
+static inline void Trace_Text_Instruction(void)
+{
+    if (trace_text.file == NULL)
+        return;
+
+    if (trace_text.used > TRACE_TEXT_BUFFER_SIZE - TRACE_TEXT_MAX_LINE)
+        Trace_Text_Flush();
+
+    const u16        pc     = cpu.program_counter;
+    const u8         opcode = Peek_Byte(pc);
+    const u8         length = Opcode_Bytes(opcode);
+    Trace_Text_State state  = {
+         .cycle  = trace_text.cycle,
+         .pc     = pc,
+         .bytes  = {opcode, Peek_Byte(pc + 1), Peek_Byte(pc + 2)},
+         .length = length ? length : 1,
+         .a      = cpu.accumulator,
+         .x      = cpu.index_reg_X,
+         .y      = cpu.index_reg_Y,
+         .p      = cpu.PS,
+         .sp     = cpu.stack_pointer,
+    };
+    trace_text.used += Trace_Text_Format_Line(&trace_text.buffer[trace_text.used], &state);
+    trace_text.lines++;
+}
+
+// Called after every instruction
+static inline void Trace_Text_Count_Cycles(s32 cycles_taken)
+{
+    trace_text.cycle += (uint64_t)cycles_taken;
+}
+
+// ---------------------------------------------------------------------
+// Diffing
+
+typedef struct Trace_Text_Diff_Result
+{
+    bool     match;  // every line the same and the same number of lines
+    uint64_t line;   // first line that differs, counted from 1, or the number of lines compared
+    size_t   column; // first column that differs, counted from 1
+} Trace_Text_Diff_Result;
+
+// A whole file in memory, mapped where we can
+typedef struct Trace_Text_File
+{
+    const char *data;
+    size_t      size;
+    bool        mapped;
+} Trace_Text_File;
+
+static inline bool Trace_Text_Open_File(Trace_Text_File *text, const char *path)
+{
+    memset(text, 0, sizeof(*text));
+#if !defined(_WIN32)
+    const int descriptor = open(path, O_RDONLY);
+    if (descriptor < 0)
+        return false;
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0)
+    {
+        close(descriptor);
+        return false;
+    }
+
+    text->size = (size_t)status.st_size;
+    if (text->size > 0)
+    {
+#if defined(MAP_POPULATE)
+        const int flags = MAP_PRIVATE | MAP_POPULATE; // one fault instead of one per page
+#else
+        const int flags = MAP_PRIVATE;
+#endif
+        void *data = mmap(NULL, text->size, PROT_READ, flags, descriptor, 0);
+        if (data == MAP_FAILED)
+        {
+            close(descriptor);
+            return false;
+        }
+        madvise(data, text->size, MADV_SEQUENTIAL);
+        text->data   = data;
+        text->mapped = true;
+    }
+    close(descriptor);
+    return true;
+#else
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+        return false;
+
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *data = malloc(size > 0 ? (size_t)size : 1);
+    if (data == NULL || fread(data, 1, (size_t)size, file) != (size_t)size)
+    {
+        free(data);
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+
+    text->data = data;
+    text->size = (size_t)size;
+    return true;
+#endif
+}
+
+static inline void Trace_Text_Close_File(Trace_Text_File *text)
+{
+#if !defined(_WIN32)
+    if (text->mapped)
+        munmap((void *)text->data, text->size);
+#else
+    free((void *)text->data);
+#endif
+    memset(text, 0, sizeof(*text));
+}
+
+// Plain loops so the compiler can vectorise them. The inner count fits a
+// byte, summing bytes is a lot cheaper than widening every compare to 64 bits.
+static inline uint64_t Trace_Text_Count_Lines(const char *data, size_t size)
+{
+    uint64_t lines = 0;
+    size_t   i     = 0;
+    for (; i + 255 <= size; i += 255)
+    {
+        uint8_t count = 0;
+        for (size_t j = 0; j < 255; j++)
+            count += (data[i + j] == '\n');
+        lines += count;
+    }
+    for (; i < size; i++)
+        lines += (data[i] == '\n');
+    return lines;
+}
+
+// Length of the line at 'data' without the '\n' or "\r\n"
+static inline size_t Trace_Text_Line_Length(const char *data, const char *end, const char **next)
+{
+    const char *newline = memchr(data, '\n', (size_t)(end - data));
+    *next               = newline ? newline + 1 : end;
+
+    size_t length = (size_t)((newline ? newline : end) - data);
+    if (length > 0 && data[length - 1] == '\r')
+        length--;
+    return length;
+}
+
+static inline void Trace_Text_Print_Line(FILE *report, const char *prefix, uint64_t number, const char *line, size_t length)
+{
+    fprintf(report, "%s %8" PRIu64 " | %.*s\n", prefix, number, (int)length, line);
+}
+
+// Compares our log with a reference log line by line, "\r\n" and "\n" are the
+// same. Equal blocks are compared with memcmp, lines are only split up once
+// the blocks stop matching. On a difference 'context' lines before it are
+// written to 'report' (if not NULL) with both versions of the line.
+static inline Trace_Text_Diff_Result Trace_Text_Diff(const char *ours, size_t ours_size, const char *reference, size_t reference_size,
+                                                     FILE *report, size_t context)
+{
+    enum
+    {
+        TRACE_TEXT_DIFF_BLOCK = 1 << 16
+    };
+
+    Trace_Text_Diff_Result result = {.match = true};
+    const char            *a      = ours;
+    const char            *b      = reference;
+    const char *const      a_end  = ours + ours_size;
+    const char *const      b_end  = reference + reference_size;
+
+    // fast path, stop one block short of the first difference. Lines are
+    // counted while the block is still in the cache.
+    size_t same = 0;
+    while (same < ours_size && same < reference_size)
+    {
+        size_t block = TRACE_TEXT_DIFF_BLOCK;
+        if (block > ours_size - same)
+            block = ours_size - same;
+        if (block > reference_size - same)
+            block = reference_size - same;
+        if (memcmp(ours + same, reference + same, block) != 0)
+            break;
+        result.line += Trace_Text_Count_Lines(ours + same, block);
+        same += block;
+    }
+
+    // back up to the start of a line, no newlines are passed so the count holds
+    while (same > 0 && ours[same - 1] != '\n')
+        same--;
+    a += same;
+    b += same;
+
+    // slow path, one line at a time
+    while (a < a_end && b < b_end)
+    {
+        const char  *a_next;
+        const char  *b_next;
+        const size_t a_length = Trace_Text_Line_Length(a, a_end, &a_next);
+        const size_t b_length = Trace_Text_Line_Length(b, b_end, &b_next);
+        result.line++;
+
+        if (a_length != b_length || memcmp(a, b, a_length) != 0)
+        {
+            result.match  = false;
+            result.column = 1;
+            while (result.column <= a_length && result.column <= b_length && a[result.column - 1] == b[result.column - 1])
+                result.column++;
+            break;
+        }
+        a = a_next;
+        b = b_next;
+    }
+
+    // one log ran out first
+    if (result.match && (a < a_end || b < b_end))
+    {
+        result.match  = false;
+        result.column = 1;
+        result.line++;
+    }
+
+    if (result.match || report == NULL)
+        return result;
+
+    fprintf(report, "Logs differ at line %" PRIu64 ", column %zu\n", result.line, result.column);
+
+    // find the start of the context, walking back from the line that differs
+    const char *line = a;
+    for (size_t count = 0; count < context && line > ours; count++)
+    {
+        line--;
+        while (line > ours && line[-1] != '\n')
+            line--;
+    }
+
+    uint64_t number = result.line - Trace_Text_Count_Lines(line, (size_t)(a - line));
+    while (line < a)
+    {
+        const char  *next;
+        const size_t length = Trace_Text_Line_Length(line, a_end, &next);
+        Trace_Text_Print_Line(report, "   ", number++, line, length);
+        line = next;
+    }
+
+    const char *next;
+    if (a < a_end)
+        Trace_Text_Print_Line(report, "ours", result.line, a, Trace_Text_Line_Length(a, a_end, &next));
+    else
+        fprintf(report, "ours %8" PRIu64 " | <end of log>\n", result.line);
+    if (b < b_end)
+        Trace_Text_Print_Line(report, "ref ", result.line, b, Trace_Text_Line_Length(b, b_end, &next));
+    else
+        fprintf(report, "ref  %8" PRIu64 " | <end of log>\n", result.line);
+    fprintf(report, "                %*s^\n", (int)result.column - 1, "");
+    return result;
+}
+
+// Trace_Text_Diff() on two files, a missing file counts as a difference at line 0
+static inline Trace_Text_Diff_Result Trace_Text_Diff_Files(const char *ours_path, const char *reference_path, FILE *report, size_t context)
+{
+    Trace_Text_Diff_Result result = {0};
+    Trace_Text_File        ours;
+    Trace_Text_File        reference;
+
+    if (!Trace_Text_Open_File(&ours, ours_path))
+    {
+        fprintf(stderr, "Error opening log : %s\n", ours_path);
+        return result;
+    }
+    if (!Trace_Text_Open_File(&reference, reference_path))
+    {
+        fprintf(stderr, "Error opening log : %s\n", reference_path);
+        Trace_Text_Close_File(&ours);
+        return result;
+    }
+
+    result = Trace_Text_Diff(ours.data, ours.size, reference.data, reference.size, report, context);
+
+    Trace_Text_Close_File(&ours);
+    Trace_Text_Close_File(&reference);
+    return result;
+}
+
+#endif // __TRACE_TEXT_H__
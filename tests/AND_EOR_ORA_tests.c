@@ -70,7 +70,6 @@ static void Logical_Operator_Immediate(enum LogicOperator opp)
     const s32 NUM_OF_CYCLES = 2;
 
     const s32 cycles_used = Execute(NUM_OF_CYCLES);
-    (NUM_OF_CYCLES, &mem);
 
     // then:
     const u8   expected_result   = Do_Logical_Operation(0xCC, 0x84, opp);
@@ -109,7 +108,6 @@ static void Logical_Operator_Zero_Page(enum LogicOperator opp)
     const s32 NUM_OF_CYCLES = 3;
 
     const s32 cycles_used = Execute(NUM_OF_CYCLES);
-    (NUM_OF_CYCLES, &mem);
 
     // then:
     const u8   expected_result   = Do_Logical_Operation(0xCC, 0x37, opp);
@@ -317,7 +315,6 @@ static void Load_Register_ABS_Y_When_Crossing_Page_Boundary(enum LogicOperator o
     const s32 NUM_OF_CYCLES = 5;
 
     const s32 cycles_used = Execute(NUM_OF_CYCLES);
-    (NUM_OF_CYCLES, &mem);
 
     // then:
     const u8   expected_result   = Do_Logical_Operation(0xCC, 0x37, opp);
@@ -529,7 +526,6 @@ static void Logical_Operator_Zero_Page_X_When_It_Wraps(enum LogicOperator opp)
     const s32 NUM_OF_CYCLES = 4;
 
     const s32 cycles_used = Execute(NUM_OF_CYCLES);
-    (NUM_OF_CYCLES, &mem);
 
     // then:
     const u8   expected_result   = Do_Logical_Operation(0xCC, 0x37, opp);
@@ -857,6 +857,142 @@ void SBC_ABS_Can_Subtract_Two_Negative_Numbers(void)
     Test_SBC_ABS(Test);
 }
 
+void SBC_IM_Can_Subtract_Two_Unsigned_Numbers(void)
+{
+    struct ADC_Test_Data Test;
+    Test.Carry       = true;
+    Test.Accumulator = 20;
+    Test.Operand     = 17;
+    Test.Answer      = 3;
+    Test.ExpectC     = true;
+    Test.ExpectN     = false;
+    Test.ExpectV     = false;
+    Test.ExpectZ     = false;
+    Test_SBC_IM(Test);
+}
+
+void SBC_IM_Can_Subtract_One_From_Zero_With_Carry_And_Get_Minus_Two(void)
+{
+    struct ADC_Test_Data Test;
+    Test.Carry       = false;
+    Test.Accumulator = 0;
+    Test.Operand     = 1;
+    Test.Answer      = (u8)(-2);
+    Test.ExpectC     = false;
+    Test.ExpectN     = true;
+    Test.ExpectV     = false;
+    Test.ExpectZ     = false;
+    Test_SBC_IM(Test);
+}
+
+void SBC_ABS_X_Can_Subtract_Two_Unsigned_Numbers(void)
+{
+    struct ADC_Test_Data Test;
+    Test.Carry       = true;
+    Test.Accumulator = 20;
+    Test.Operand     = 17;
+    Test.Answer      = 3;
+    Test.ExpectC     = true;
+    Test.ExpectN     = false;
+    Test.ExpectV     = false;
+    Test.ExpectZ     = false;
+    Test_SBC_ABS_X(Test);
+}
+
+void SBC_ABS_X_Can_Subtract_Two_Negative_Numbers_And_Get_Signed_Overflow(void)
+{
+    struct ADC_Test_Data Test;
+    Test.Carry       = true;
+    Test.Accumulator = (u8)(-128);
+    Test.Operand     = 1;
+    Test.Answer      = 127;
+    Test.ExpectC     = true;
+    Test.ExpectN     = false;
+    Test.ExpectV     = true;
+    Test.ExpectZ     = false;
+    Test_SBC_ABS_X(Test);
+}
+
+void SBC_ABS_Y_Can_Subtract_Two_Unsigned_Numbers(void)
+{
+    struct ADC_Test_Data Test;
+    Test.Carry       = true;
+    Test.Accumulator = 20;
+    Test.Operand     = 17;
+    Test.Answer      = 3;
+    Test.ExpectC     = true;
+    Test.ExpectN     = false;
+    Test.ExpectV     = false;
+    Test.ExpectZ     = false;
+    Test_SBC_ABS_Y(Test);
+}
+
+void SBC_ABS_Y_Can_Subtract_A_Postitive_And_Negative_Numbers_And_Get_Signed_Overflow(void)
+{
+    struct ADC_Test_Data Test;
+    Test.Carry       = true;
+    Test.Accumulator = 127;
+    Test.Operand     = (u8)(-1);
+    Test.Answer      = 128;
+    Test.ExpectC     = false;
+    Test.ExpectN     = true;
+    Test.ExpectV     = true;
+    Test.ExpectZ     = false;
+    Test_SBC_ABS_Y(Test);
+}
+
+// Decimal mode ----------
+// Only the result and carry are checked, N/V/Z differ between the NMOS and CMOS variants
+
+static void Test_Decimal_IM(u8 accumulator, u8 operand, bool carry, u8 answer, bool expect_carry, enum Operation op)
+{
+    // given:
+    cpu.program_counter = 0xFF00;
+    cpu.accumulator     = accumulator;
+    cpu.C               = carry;
+    cpu.D               = 1;
+
+    mem.data[0xFF00] = (op == OPERATION_ADD) ? INS_ADC_IM : INS_SBC_IM;
+    mem.data[0xFF01] = operand;
+
+#if H6502_IS_CMOS
+    const s32 EXPECTED_CYCLES = 3;
+#else
+    const s32 EXPECTED_CYCLES = 2;
+#endif
+    CPU before = cpu;
+
+    // when:
+    const s32 cycles_used = Execute(EXPECTED_CYCLES);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(EXPECTED_CYCLES, cycles_used);
+    TEST_ASSERT_EQUAL_HEX8(answer, cpu.accumulator);
+    TEST_ASSERT_EQUAL_UINT8(expect_carry, cpu.C);
+
+    Verify_Unmodified_Flags(before);
+}
+
+void ADC_IM_Can_Add_Two_Decimal_Numbers(void)
+{
+    Test_Decimal_IM(0x15, 0x27, false, 0x42, false, OPERATION_ADD);
+}
+
+void ADC_IM_Can_Add_Two_Decimal_Numbers_With_Carry_Out(void)
+{
+    Test_Decimal_IM(0x58, 0x46, true, 0x05, true, OPERATION_ADD);
+}
+
+void SBC_IM_Can_Subtract_Two_Decimal_Numbers(void)
+{
+    Test_Decimal_IM(0x42, 0x15, true, 0x27, true, OPERATION_SUB);
+}
+
+void SBC_IM_Can_Subtract_Two_Decimal_Numbers_With_Borrow(void)
+{
+    Test_Decimal_IM(0x10, 0x20, true, 0x90, false, OPERATION_SUB);
+}
+
 int main(void)
 {
     UNITY_BEGIN();
@@ -897,5 +1033,18 @@ int main(void)
     RUN_TEST(SBC_ABS_Can_Subtract_Two_Unsigned_Numbers);
     RUN_TEST(SBC_ABS_Can_Subtract_Two_Negative_Numbers);
 
+    RUN_TEST(SBC_IM_Can_Subtract_Two_Unsigned_Numbers);
+    RUN_TEST(SBC_IM_Can_Subtract_One_From_Zero_With_Carry_And_Get_Minus_Two);
+    RUN_TEST(SBC_ABS_X_Can_Subtract_Two_Unsigned_Numbers);
+    RUN_TEST(SBC_ABS_X_Can_Subtract_Two_Negative_Numbers_And_Get_Signed_Overflow);
+    RUN_TEST(SBC_ABS_Y_Can_Subtract_Two_Unsigned_Numbers);
+    RUN_TEST(SBC_ABS_Y_Can_Subtract_A_Postitive_And_Negative_Numbers_And_Get_Signed_Overflow);
+
+    // Decimal mode
+    RUN_TEST(ADC_IM_Can_Add_Two_Decimal_Numbers);
+    RUN_TEST(ADC_IM_Can_Add_Two_Decimal_Numbers_With_Carry_Out);
+    RUN_TEST(SBC_IM_Can_Subtract_Two_Decimal_Numbers);
+    RUN_TEST(SBC_IM_Can_Subtract_Two_Decimal_Numbers_With_Borrow);
+
     return UNITY_END();
 }
\ No newline at end of file
@@ -0,0 +1,264 @@
+#include "Unity/unity.h"
+#include "h6502.h"
+
+#include <stdbool.h>
+
+// https://github.com/ThrowTheSwitch/Unity
+
+// 65C02 only instructions, built for the "65C02" variant
+
+void setUp(void) /* Is run before every test, put unit init calls here. */
+{
+    Reset_CPU();
+}
+void tearDown(void) {} /* Is run after every test, put unit clean-up calls here. */
+
+// STZ (STore Zero)
+void STZ_ZP_Can_Store_Zero_Into_Memory(void)
+{
+    // given:
+    cpu.program_counter = 0xFF00;
+    cpu.accumulator     = 0x42;
+
+    mem.data[0xFF00] = INS_STZ_ZP;
+    mem.data[0xFF01] = 0x80;
+    mem.data[0x0080] = 0x37;
+
+    // when:
+    const CPU before        = cpu;
+    const s32 NUM_OF_CYCLES = 3;
+
+    const s32 cycles_used = Execute(NUM_OF_CYCLES);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(NUM_OF_CYCLES, cycles_used);
+    TEST_ASSERT_EQUAL_UINT8(0x00, mem.data[0x0080]);
+    TEST_ASSERT_EQUAL_UINT8(before.PS, cpu.PS);
+    TEST_ASSERT_EQUAL_UINT8(0x42, cpu.accumulator);
+}
+
+void STZ_ABS_X_Can_Store_Zero_Into_Memory(void)
+{
+    // given:
+    cpu.program_counter = 0xFF00;
+    cpu.index_reg_X     = 0x0F;
+
+    mem.data[0xFF00] = INS_STZ_ABS_X;
+    mem.data[0xFF01] = 0x00;
+    mem.data[0xFF02] = 0x80;
+    mem.data[0x800F] = 0x37;
+
+    // when:
+    const s32 NUM_OF_CYCLES = 5;
+
+    const s32 cycles_used = Execute(NUM_OF_CYCLES);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(NUM_OF_CYCLES, cycles_used);
+    TEST_ASSERT_EQUAL_UINT8(0x00, mem.data[0x800F]);
+}
+
+// BRA (BRanch Always)
+void BRA_Will_Always_Branch(void)
+{
+    // given:
+    cpu.program_counter = 0xFF00;
+    cpu.PS              = 0xFF;
+
+    mem.data[0xFF00] = INS_BRA;
+    mem.data[0xFF01] = 0x10;
+
+    // when:
+    const CPU before        = cpu;
+    const s32 NUM_OF_CYCLES = 3;
+
+    const s32 cycles_used = Execute(NUM_OF_CYCLES);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(NUM_OF_CYCLES, cycles_used);
+    TEST_ASSERT_EQUAL_UINT16(0xFF12, cpu.program_counter);
+    TEST_ASSERT_EQUAL_UINT8(before.PS, cpu.PS);
+}
+
+// PHX/PLX (PusH/PuLl X register)
+void PHX_And_PLX_Can_Push_And_Pull_The_X_Register(void)
+{
+    // given:
+    cpu.program_counter = 0xFF00;
+    cpu.index_reg_X     = 0x84;
+
+    mem.data[0xFF00] = INS_PHX;
+    mem.data[0xFF01] = INS_LDX_IM;
+    mem.data[0xFF02] = 0x00;
+    mem.data[0xFF03] = INS_PLX;
+
+    // when:
+    const s32 NUM_OF_CYCLES = 3 + 2 + 4;
+
+    const s32 cycles_used = Execute(NUM_OF_CYCLES);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(NUM_OF_CYCLES, cycles_used);
+    TEST_ASSERT_EQUAL_UINT8(0x84, cpu.index_reg_X);
+    TEST_ASSERT_EQUAL_UINT8(0xFF, cpu.stack_pointer);
+    TEST_ASSERT_TRUE(cpu.N);
+    TEST_ASSERT_FALSE(cpu.Z);
+}
+
+// TSB (Test and Set Bits)
+void TSB_ZP_Can_Set_Bits_And_Test_Against_The_Accumulator(void)
+{
+    // given:
+    cpu.program_counter = 0xFF00;
+    cpu.accumulator     = 0x0F;
+    cpu.Z               = 0;
+
+    mem.data[0xFF00] = INS_TSB_ZP;
+    mem.data[0xFF01] = 0x42;
+    mem.data[0x0042] = 0xF0;
+
+    // when:
+    const s32 NUM_OF_CYCLES = 5;
+
+    const s32 cycles_used = Execute(NUM_OF_CYCLES);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(NUM_OF_CYCLES, cycles_used);
+    TEST_ASSERT_EQUAL_UINT8(0xFF, mem.data[0x0042]);
+    TEST_ASSERT_TRUE(cpu.Z);
+}
+
+// TRB (Test and Reset Bits)
+void TRB_ABS_Can_Reset_Bits_And_Test_Against_The_Accumulator(void)
+{
+    // given:
+    cpu.program_counter = 0xFF00;
+    cpu.accumulator     = 0x0F;
+    cpu.Z               = 1;
+
+    mem.data[0xFF00] = INS_TRB_ABS;
+    mem.data[0xFF01] = 0x00;
+    mem.data[0xFF02] = 0x80;
+    mem.data[0x8000] = 0x3C;
+
+    // when:
+    const s32 NUM_OF_CYCLES = 6;
+
+    const s32 cycles_used = Execute(NUM_OF_CYCLES);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(NUM_OF_CYCLES, cycles_used);
+    TEST_ASSERT_EQUAL_UINT8(0x30, mem.data[0x8000]);
+    TEST_ASSERT_FALSE(cpu.Z);
+}
+
+// (zp) - Zero Page Indirect
+void LDA_ZP_IND_Can_Load_A_Value_Into_The_A_Register(void)
+{
+    // given:
+    cpu.program_counter = 0xFF00;
+
+    mem.data[0xFF00] = INS_LDA_ZP_IND;
+    mem.data[0xFF01] = 0x02;
+    mem.data[0x0002] = 0x00;
+    mem.data[0x0003] = 0x80;
+    mem.data[0x8000] = 0x37;
+
+    // when:
+    const s32 NUM_OF_CYCLES = 5;
+
+    const s32 cycles_used = Execute(NUM_OF_CYCLES);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(NUM_OF_CYCLES, cycles_used);
+    TEST_ASSERT_EQUAL_UINT8(0x37, cpu.accumulator);
+    TEST_ASSERT_FALSE(cpu.Z);
+    TEST_ASSERT_FALSE(cpu.N);
+}
+
+void STA_ZP_IND_Can_Write_The_A_Register_Into_Memory(void)
+{
+    // given:
+    cpu.program_counter = 0xFF00;
+    cpu.accumulator     = 0x42;
+
+    mem.data[0xFF00] = INS_STA_ZP_IND;
+    mem.data[0xFF01] = 0x02;
+    mem.data[0x0002] = 0x00;
+    mem.data[0x0003] = 0x80;
+
+    // when:
+    const s32 NUM_OF_CYCLES = 5;
+
+    const s32 cycles_used = Execute(NUM_OF_CYCLES);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(NUM_OF_CYCLES, cycles_used);
+    TEST_ASSERT_EQUAL_UINT8(0x42, mem.data[0x8000]);
+}
+
+// JMP (ind) does not have the NMOS page wrap bug, but takes an extra cycle
+void JMP_IND_Reads_The_High_Byte_From_The_Next_Page(void)
+{
+    // given:
+    cpu.program_counter = 0xFF00;
+
+    mem.data[0xFF00] = INS_JMP_IND;
+    mem.data[0xFF01] = 0xFF;
+    mem.data[0xFF02] = 0x80;
+    mem.data[0x80FF] = 0x34;
+    mem.data[0x8100] = 0x12;
+    mem.data[0x8000] = 0x56;
+
+    // when:
+    const s32 NUM_OF_CYCLES = 6;
+
+    const s32 cycles_used = Execute(NUM_OF_CYCLES);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(NUM_OF_CYCLES, cycles_used);
+    TEST_ASSERT_EQUAL_UINT16(0x1234, cpu.program_counter);
+}
+
+// Decimal mode sets N and Z from the BCD result, and costs 1 extra cycle
+void ADC_IM_In_Decimal_Mode_Sets_Zero_From_The_Decimal_Result(void)
+{
+    // given:
+    cpu.program_counter = 0xFF00;
+    cpu.accumulator     = 0x99;
+    cpu.D               = 1;
+    cpu.C               = 0;
+
+    mem.data[0xFF00] = INS_ADC_IM;
+    mem.data[0xFF01] = 0x01;
+
+    // when:
+    const s32 NUM_OF_CYCLES = 3;
+
+    const s32 cycles_used = Execute(NUM_OF_CYCLES);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(NUM_OF_CYCLES, cycles_used);
+    TEST_ASSERT_EQUAL_UINT8(0x00, cpu.accumulator);
+    TEST_ASSERT_TRUE(cpu.C);
+    TEST_ASSERT_TRUE(cpu.Z);
+    TEST_ASSERT_FALSE(cpu.N);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(STZ_ZP_Can_Store_Zero_Into_Memory);
+    RUN_TEST(STZ_ABS_X_Can_Store_Zero_Into_Memory);
+    RUN_TEST(BRA_Will_Always_Branch);
+    RUN_TEST(PHX_And_PLX_Can_Push_And_Pull_The_X_Register);
+    RUN_TEST(TSB_ZP_Can_Set_Bits_And_Test_Against_The_Accumulator);
+    RUN_TEST(TRB_ABS_Can_Reset_Bits_And_Test_Against_The_Accumulator);
+    RUN_TEST(LDA_ZP_IND_Can_Load_A_Value_Into_The_A_Register);
+    RUN_TEST(STA_ZP_IND_Can_Write_The_A_Register_Into_Memory);
+    RUN_TEST(JMP_IND_Reads_The_High_Byte_From_The_Next_Page);
+    RUN_TEST(ADC_IM_In_Decimal_Mode_Sets_Zero_From_The_Decimal_Result);
+
+    return UNITY_END();
+}
@@ -0,0 +1,176 @@
+#define H6502_CALL_PROFILER 1
+
+#include "Unity/unity.h"
+#include "h6502.h"
+
+#include <stdbool.h>
+
+// https://github.com/ThrowTheSwitch/Unity
+
+void setUp(void) /* Is run before every test, put unit init calls here. */
+{
+    Reset_CPU();
+    Profiler_Free_Labels();
+}
+void tearDown(void) {} /* Is run after every test, put unit clean-up calls here. */
+
+// 0x0200 : JSR $0300
+// 0x0203 : JSR $0400
+// 0x0206 : NOP
+// 0x0300 : JSR $0400
+// 0x0303 : RTS
+// 0x0400 : NOP
+// 0x0401 : RTS
+static void Load_Test_Program(void)
+{
+    const u8 main_code[] = {INS_JSR, 0x00, 0x03, INS_JSR, 0x00, 0x04, INS_NOP};
+    const u8 outer[]     = {INS_JSR, 0x00, 0x04, INS_RTS};
+    const u8 inner[]     = {INS_NOP, INS_RTS};
+    memcpy(&mem.data[0x0200], main_code, sizeof(main_code));
+    memcpy(&mem.data[0x0300], outer, sizeof(outer));
+    memcpy(&mem.data[0x0400], inner, sizeof(inner));
+
+    cpu.program_counter = 0x0200;
+    Call_Profiler_Reset();
+}
+
+static void Run_Test_Program(void)
+{
+    Stop_Conditions stop = {0};
+    Stop_At_PC(&stop, 0x0206);
+    Execute_Until(&stop);
+}
+
+static const char *Write_Folded_Stacks(char *text, size_t text_size)
+{
+    FILE *file = tmpfile();
+    TEST_ASSERT_NOT_NULL(file);
+    Call_Profiler_Write_Folded(file);
+    rewind(file);
+
+    const size_t length = fread(text, 1, text_size - 1, file);
+    text[length]        = '\0';
+    fclose(file);
+    return text;
+}
+
+void Call_Profiler_Attributes_Cycles_To_Call_Paths(void)
+{
+    // given:
+    Load_Test_Program();
+
+    // when:
+    Run_Test_Program();
+
+    // then: JSR cycles belong to the caller, RTS cycles to the callee
+    char text[512];
+    Write_Folded_Stacks(text, sizeof(text));
+    TEST_ASSERT_NOT_NULL(strstr(text, "$0200 12\n"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "$0200;$0300 12\n"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "$0200;$0300;$0400 8\n"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "$0200;$0400 8\n"));
+    TEST_ASSERT_EQUAL_INT32(0, call_profiler.depth);
+}
+
+void Call_Profiler_Uses_Names_From_A_Label_File(void)
+{
+    // given:
+    FILE *labels = tmpfile();
+    TEST_ASSERT_NOT_NULL(labels);
+    fputs("; labels\n0200 main\n$0300 outer\nal 000400 .inner\n", labels);
+    rewind(labels);
+    TEST_ASSERT_EQUAL_size_t(3, Profiler_Load_Labels_From_File(labels));
+    fclose(labels);
+
+    Load_Test_Program();
+
+    // when:
+    Run_Test_Program();
+
+    // then:
+    char text[512];
+    Write_Folded_Stacks(text, sizeof(text));
+    TEST_ASSERT_NOT_NULL(strstr(text, "main;outer;inner 8\n"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "main;inner 8\n"));
+}
+
+void Call_Profiler_Follows_Code_That_Drops_Its_Return_Address(void)
+{
+    // given: the subroutine pulls its return address and jumps back itself
+    const u8 main_code[] = {INS_JSR, 0x00, 0x03, INS_NOP};
+    const u8 routine[]   = {INS_PLA, INS_PLA, INS_JSR, 0x00, 0x04, INS_JMP_ABS, 0x03, 0x02};
+    const u8 inner[]     = {INS_RTS};
+    memcpy(&mem.data[0x0200], main_code, sizeof(main_code));
+    memcpy(&mem.data[0x0300], routine, sizeof(routine));
+    memcpy(&mem.data[0x0400], inner, sizeof(inner));
+    cpu.program_counter = 0x0200;
+    Call_Profiler_Reset();
+
+    // when:
+    Stop_Conditions stop = {0};
+    Stop_At_PC(&stop, 0x0203);
+    Execute_Until(&stop);
+
+    // then: the inner RTS gives back the stack of both calls
+    TEST_ASSERT_EQUAL_INT32(0, call_profiler.depth);
+}
+
+void BRK_And_RTI_Are_Followed_As_A_Call(void)
+{
+    // given:
+    mem.data[0x0200] = INS_BRK;
+    mem.data[0x0202] = INS_NOP;
+    mem.data[0xFFFE] = 0x00;
+    mem.data[0xFFFF] = 0x80;
+    mem.data[0x8000] = INS_RTI;
+    cpu.program_counter = 0x0200;
+    Call_Profiler_Reset();
+
+    // when:
+    Stop_Conditions stop = {0};
+    Stop_At_PC(&stop, 0x0202);
+    Execute_Until(&stop);
+
+    // then:
+    char text[512];
+    Write_Folded_Stacks(text, sizeof(text));
+    TEST_ASSERT_NOT_NULL(strstr(text, "$0200 7\n"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "$0200;$8000 6\n"));
+    TEST_ASSERT_EQUAL_INT32(0, call_profiler.depth);
+}
+
+void Call_Profiler_Starts_At_The_First_Instruction_Without_A_Reset(void)
+{
+    // given: a profiler that was never reset
+    const u8 main_code[] = {INS_JSR, 0x00, 0x04, INS_NOP};
+    const u8 inner[]     = {INS_NOP, INS_RTS};
+    memcpy(&mem.data[0x0200], main_code, sizeof(main_code));
+    memcpy(&mem.data[0x0400], inner, sizeof(inner));
+    cpu.program_counter = 0x0200;
+    memset(&call_profiler, 0, sizeof(call_profiler));
+
+    // when:
+    Stop_Conditions stop = {0};
+    Stop_At_PC(&stop, 0x0203);
+    Execute_Until(&stop);
+
+    // then: the root is where the run started, not the JSR's target
+    char text[512];
+    Write_Folded_Stacks(text, sizeof(text));
+    TEST_ASSERT_NOT_NULL(strstr(text, "$0200 6\n"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "$0200;$0400 8\n"));
+    TEST_ASSERT_EQUAL_INT32(0, call_profiler.depth);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(Call_Profiler_Attributes_Cycles_To_Call_Paths);
+    RUN_TEST(Call_Profiler_Uses_Names_From_A_Label_File);
+    RUN_TEST(Call_Profiler_Follows_Code_That_Drops_Its_Return_Address);
+    RUN_TEST(BRK_And_RTI_Are_Followed_As_A_Call);
+    RUN_TEST(Call_Profiler_Starts_At_The_First_Instruction_Without_A_Reset);
+
+    return UNITY_END();
+}
@@ -100,6 +100,8 @@ static void CMP_IM(struct CMP_Test_Data test, enum Register register_to_compare)
         reg    = &cpu.index_reg_Y;
         opcode = INS_CPY_IM;
         break;
+    default:
+        break;
     };
     *reg = test.register_value;
 
@@ -142,6 +144,8 @@ static void CMP_ZP(struct CMP_Test_Data test, enum Register register_to_compare)
         reg    = &cpu.index_reg_Y;
         opcode = INS_CPY_ZP;
         break;
+    default:
+        break;
     };
     *reg = test.register_value;
 
@@ -217,6 +221,8 @@ static void CMP_ABS(struct CMP_Test_Data test, enum Register register_to_compare
         reg    = &cpu.index_reg_Y;
         opcode = INS_CPY_ABS;
         break;
+    default:
+        break;
     };
     *reg = test.register_value;
 
@@ -0,0 +1,141 @@
+#define H6502_EDGE_COVERAGE 1
+
+#include "Unity/unity.h"
+#include "h6502.h"
+
+#include <stdbool.h>
+
+// https://github.com/ThrowTheSwitch/Unity
+
+void setUp(void) /* Is run before every test, put unit init calls here. */
+{
+    Reset_CPU();
+    Coverage_Clear();
+}
+void tearDown(void) /* Is run after every test, put unit clean-up calls here. */
+{
+}
+
+// 0x0200 : LDX #count
+// 0x0202 : DEX
+// 0x0203 : BNE $0202
+// 0x0205 : JSR $0300
+// 0x0208 : JMP $0208
+// 0x0300 : RTS
+static void Run_Loop(u8 count)
+{
+    const u8 program[] = {INS_LDX_IM, count, INS_DEX, INS_BNE, 0xFD, INS_JSR, 0x00, 0x03, INS_JMP_ABS, 0x08, 0x02};
+    memcpy(&mem.data[0x0200], program, sizeof(program));
+    mem.data[0x0300]    = INS_RTS;
+    cpu.program_counter = 0x0200;
+
+    Coverage_Start_Input();
+    Stop_Conditions stop = {0};
+    Stop_At_PC(&stop, 0x0208);
+    Execute_Until(&stop);
+}
+
+static u32 Coverage_Hits(void)
+{
+    u32 hits = 0;
+    for (u32 index = 0; index < COVERAGE_MAP_SIZE; index++)
+        hits += coverage.map[index];
+    return hits;
+}
+
+void Coverage_Records_An_Edge_For_Each_Change_Of_Control_Flow(void)
+{
+    // when:
+    Run_Loop(4);
+
+    // then: BNE taken from the start and 2 times from itself, BNE not taken, JSR, RTS
+    TEST_ASSERT_EQUAL_UINT32(6, Coverage_Hits());
+    TEST_ASSERT_EQUAL_UINT32(5, Coverage_Count_Edges());
+}
+
+void Coverage_Is_The_Same_For_The_Same_Path(void)
+{
+    // given:
+    Run_Loop(3);
+    uint8_t first[COVERAGE_MAP_SIZE];
+    memcpy(first, coverage.map, sizeof(first));
+
+    // when:
+    Coverage_Clear();
+    Run_Loop(3);
+
+    // then:
+    TEST_ASSERT_EQUAL_MEMORY(first, coverage.map, sizeof(first));
+
+    // when: the loop runs once, the branch is never taken
+    Coverage_Clear();
+    Run_Loop(1);
+
+    // then:
+    TEST_ASSERT_EQUAL_UINT32(3, Coverage_Count_Edges());
+}
+
+void Coverage_Counters_Never_Wrap_To_Zero(void)
+{
+    // when: the same edge 256 times
+    for (int run = 0; run < 256; run++)
+    {
+        Coverage_Start_Input();
+        Coverage_Edge(0x1234);
+    }
+
+    // then:
+    TEST_ASSERT_EQUAL_UINT32(1, Coverage_Count_Edges());
+    TEST_ASSERT_EQUAL_UINT32(1, Coverage_Hits());
+}
+
+void Coverage_Uses_AFL_Shared_Memory(void)
+{
+#if !defined(_WIN32)
+    // given: what afl-fuzz does before it starts the target
+    const int id = shmget(IPC_PRIVATE, COVERAGE_MAP_SIZE, IPC_CREAT | IPC_EXCL | 0600);
+    if (id < 0)
+        TEST_IGNORE_MESSAGE("no System V shared memory");
+
+    uint8_t *afl_map = shmat(id, NULL, 0);
+    TEST_ASSERT_TRUE(afl_map != (void *)-1);
+    memset(afl_map, 0, COVERAGE_MAP_SIZE);
+
+    char text[16];
+    snprintf(text, sizeof(text), "%d", id);
+    setenv(COVERAGE_SHM_ENV, text, 1);
+
+    // when:
+    TEST_ASSERT_TRUE(Coverage_Attach_AFL());
+    Coverage_Start_Input();
+    Coverage_Edge(0x0300);
+
+    // then:
+    TEST_ASSERT_TRUE(coverage.map == afl_map || memcmp(coverage.map, afl_map, COVERAGE_MAP_SIZE) == 0);
+    TEST_ASSERT_EQUAL_UINT8(1, afl_map[((0x0300 >> 4) ^ (0x0300 << 8)) & 0xFFFF]);
+
+    // not run by afl-fuzz, the loop runs once
+    TEST_ASSERT_TRUE(Coverage_AFL_Loop(100));
+    TEST_ASSERT_FALSE(Coverage_AFL_Loop(100));
+
+    unsetenv(COVERAGE_SHM_ENV);
+    coverage.map    = coverage_local_map;
+    coverage.shared = false;
+    shmdt(afl_map);
+    shmctl(id, IPC_RMID, NULL);
+#else
+    TEST_IGNORE_MESSAGE("AFL shared memory is POSIX only");
+#endif
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(Coverage_Records_An_Edge_For_Each_Change_Of_Control_Flow);
+    RUN_TEST(Coverage_Is_The_Same_For_The_Same_Path);
+    RUN_TEST(Coverage_Counters_Never_Wrap_To_Zero);
+    RUN_TEST(Coverage_Uses_AFL_Shared_Memory);
+
+    return UNITY_END();
+}
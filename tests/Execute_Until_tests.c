@@ -0,0 +1,195 @@
+#define H6502_WRITE_WATCH 1
+
+#include "Unity/unity.h"
+#include "h6502.h"
+
+#include <stdbool.h>
+
+// https://github.com/ThrowTheSwitch/Unity
+
+void setUp(void) /* Is run before every test, put unit init calls here. */
+{
+    Reset_CPU();
+}
+void tearDown(void) {} /* Is run after every test, put unit clean-up calls here. */
+
+// 0x0200 : LDX #$05
+// 0x0202 : STX $30
+// 0x0204 : DEX
+// 0x0205 : BNE $0202
+// 0x0207 : JSR $0300
+// 0x020A : NOP
+// 0x0300 : STA $4000
+// 0x0303 : RTS
+static void Load_Test_Program(void)
+{
+    const u8 program[] = {INS_LDX_IM, 0x05, INS_STX_ZP, 0x30, INS_DEX, INS_BNE, 0xFB, INS_JSR, 0x00, 0x03, INS_NOP};
+    memcpy(&mem.data[0x0200], program, sizeof(program));
+
+    const u8 subroutine[] = {INS_STA_ABS, 0x00, 0x40, INS_RTS};
+    memcpy(&mem.data[0x0300], subroutine, sizeof(subroutine));
+
+    cpu.program_counter = 0x0200;
+}
+
+void Execute_Until_Does_Nothing_Without_A_Condition(void)
+{
+    // given:
+    Load_Test_Program();
+    const Stop_Conditions stop = {0};
+
+    // when:
+    const Execute_Result result = Execute_Until(&stop);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT(STOP_NONE, result.reason);
+    TEST_ASSERT_EQUAL_INT32(0, result.cycles_used);
+    TEST_ASSERT_EQUAL_HEX16(0x0200, cpu.program_counter);
+}
+
+void Execute_Until_Can_Stop_At_A_Target_PC(void)
+{
+    // given:
+    Load_Test_Program();
+    Stop_Conditions stop = {0};
+    Stop_At_PC(&stop, 0x0300);
+
+    // when:
+    const Execute_Result result = Execute_Until(&stop);
+
+    // then: LDX(2) + 5 * (STX(3) + DEX(2)) + 4 taken BNE(3) + BNE(2) + JSR(6)
+    TEST_ASSERT_EQUAL_INT(STOP_PC, result.reason);
+    TEST_ASSERT_EQUAL_HEX16(0x0300, cpu.program_counter);
+    TEST_ASSERT_EQUAL_INT32(2 + 5 * 5 + 4 * 3 + 2 + 6, result.cycles_used);
+    TEST_ASSERT_EQUAL_UINT32(1 + 5 * 3 + 1, result.instructions);
+}
+
+void Execute_Until_Stops_Before_A_Watched_Opcode(void)
+{
+    // given:
+    Load_Test_Program();
+    Stop_Conditions stop = {0};
+    Stop_On_Opcode(&stop, INS_RTS);
+
+    // when:
+    const Execute_Result result = Execute_Until(&stop);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT(STOP_OPCODE, result.reason);
+    TEST_ASSERT_EQUAL_HEX16(0x0303, cpu.program_counter);
+}
+
+void Execute_Until_Stops_After_A_Write_To_The_Watched_Range(void)
+{
+    // given:
+    Load_Test_Program();
+    Stop_Conditions stop = {0};
+    Stop_On_Write(&stop, 0x4000, 0x40FF);
+
+    // when:
+    const Execute_Result result = Execute_Until(&stop);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT(STOP_WRITE, result.reason);
+    TEST_ASSERT_EQUAL_HEX16(0x4000, result.write_address);
+    TEST_ASSERT_EQUAL_HEX16(0x0303, cpu.program_counter);
+}
+
+void Execute_Until_Ignores_Writes_Outside_The_Watched_Range(void)
+{
+    // given:
+    Load_Test_Program();
+    Stop_Conditions stop = {0};
+    Stop_On_Write(&stop, 0x4001, 0x40FF);
+    Stop_At_PC(&stop, 0x020A);
+
+    // when:
+    const Execute_Result result = Execute_Until(&stop);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT(STOP_PC, result.reason);
+}
+
+void Execute_Until_Swaps_A_Watched_Range_Given_Backwards(void)
+{
+    // given:
+    Load_Test_Program();
+    Stop_Conditions stop = {0};
+    Stop_On_Write(&stop, 0x40FF, 0x4000);
+    Stop_At_PC(&stop, 0x020A);
+
+    // when:
+    const Execute_Result result = Execute_Until(&stop);
+
+    // then: not every write
+    TEST_ASSERT_EQUAL_INT(STOP_WRITE, result.reason);
+    TEST_ASSERT_EQUAL_HEX16(0x4000, result.write_address);
+    TEST_ASSERT_EQUAL_HEX16(0x40FF, stop.write_high);
+}
+
+void Execute_Until_Can_Stop_After_A_Number_Of_Instructions(void)
+{
+    // given:
+    Load_Test_Program();
+    Stop_Conditions stop  = {0};
+    stop.max_instructions = 3;
+
+    // when:
+    const Execute_Result result = Execute_Until(&stop);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT(STOP_MAX_INSTRUCTIONS, result.reason);
+    TEST_ASSERT_EQUAL_UINT32(3, result.instructions);
+    TEST_ASSERT_EQUAL_INT32(2 + 3 + 2, result.cycles_used);
+    TEST_ASSERT_EQUAL_UINT8(0x04, cpu.index_reg_X);
+}
+
+void Execute_Until_Can_Stop_After_A_Number_Of_Cycles(void)
+{
+    // given:
+    Load_Test_Program();
+    Stop_Conditions stop = {0};
+    stop.max_cycles      = 6;
+
+    // when:
+    const Execute_Result result = Execute_Until(&stop);
+
+    // then: the last instruction is allowed to finish
+    TEST_ASSERT_EQUAL_INT(STOP_MAX_CYCLES, result.reason);
+    TEST_ASSERT_EQUAL_INT32(7, result.cycles_used);
+}
+
+void Execute_Until_Stops_On_A_Bad_Instruction(void)
+{
+    // given:
+    cpu.program_counter = 0x0200;
+    mem.data[0x0200]    = INS_NOP;
+    mem.data[0x0201]    = 0x02; // invalid instruction
+
+    Stop_Conditions stop = {0};
+    stop.max_cycles      = 100;
+
+    // when:
+    const Execute_Result result = Execute_Until(&stop);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT(STOP_BAD_INSTRUCTION, result.reason);
+    TEST_ASSERT_EQUAL_UINT32(2, result.instructions);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(Execute_Until_Does_Nothing_Without_A_Condition);
+    RUN_TEST(Execute_Until_Can_Stop_At_A_Target_PC);
+    RUN_TEST(Execute_Until_Stops_Before_A_Watched_Opcode);
+    RUN_TEST(Execute_Until_Stops_After_A_Write_To_The_Watched_Range);
+    RUN_TEST(Execute_Until_Ignores_Writes_Outside_The_Watched_Range);
+    RUN_TEST(Execute_Until_Swaps_A_Watched_Range_Given_Backwards);
+    RUN_TEST(Execute_Until_Can_Stop_After_A_Number_Of_Instructions);
+    RUN_TEST(Execute_Until_Can_Stop_After_A_Number_Of_Cycles);
+    RUN_TEST(Execute_Until_Stops_On_A_Bad_Instruction);
+
+    return UNITY_END();
+}
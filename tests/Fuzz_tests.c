@@ -0,0 +1,119 @@
+#define H6502_SNAPSHOT 1
+
+#include "Unity/unity.h"
+#include "fuzz.h"
+
+#include <stdbool.h>
+
+// https://github.com/ThrowTheSwitch/Unity
+
+// 0x0200 : STA $10 ; STX $11 ; LDA $0400
+// 0x0207 : CMP #'!' ; BNE $020E ; JMP $0300 (crash)
+// 0x020E : CMP #'L' ; BEQ $0210 (hang)
+// 0x0212 : STA $0500 ; JMP $0215 (exit)
+static const u8 rom[] = {
+    0x00, 0x02, // load address : 0x0200
+    INS_STA_ZP, 0x10, INS_STX_ZP, 0x11, INS_LDA_ABS, 0x00, 0x04,
+    INS_CMP_IM, '!', INS_BNE, 0x03, INS_JMP_ABS, 0x00, 0x03,
+    INS_CMP_IM, 'L', INS_BEQ, 0xFE,
+    INS_STA_ABS, 0x00, 0x05, INS_JMP_ABS, 0x15, 0x02,
+};
+
+static const Fuzz_Config config = {
+    .input_address  = 0x0400,
+    .input_size     = 0x0300,
+    .entry_pc       = 0x0200,
+    .exit_pc        = 0x0215,
+    .crash_pc       = 0x0300,
+    .check_crash_pc = true,
+    .max_cycles     = 1000,
+};
+
+void setUp(void) /* Is run before every test, put unit init calls here. */
+{
+    Fuzz_Setup(&config, rom, sizeof(rom));
+}
+void tearDown(void) /* Is run after every test, put unit clean-up calls here. */
+{
+}
+
+void Fuzz_Runs_Each_Input_From_The_Baseline(void)
+{
+    // when:
+    Execute_Result result = Fuzz_Run((const uint8_t *)"BC", 2);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT(FUZZ_OK, Fuzz_Check(&result));
+    TEST_ASSERT_EQUAL_HEX16(0x0215, cpu.program_counter);
+    TEST_ASSERT_EQUAL_UINT8(2, mem.data[0x10]);
+    TEST_ASSERT_EQUAL_HEX8('B', mem.data[0x0500]);
+    TEST_ASSERT_EQUAL_HEX8('C', mem.data[0x0401]);
+
+    // when: nothing left over from the last input
+    result = Fuzz_Run(NULL, 0);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT(FUZZ_OK, Fuzz_Check(&result));
+    TEST_ASSERT_EQUAL_UINT8(0, mem.data[0x10]);
+    TEST_ASSERT_EQUAL_HEX8(0, mem.data[0x0500]);
+    TEST_ASSERT_EQUAL_HEX8(0, mem.data[0x0401]);
+    TEST_ASSERT_EQUAL_UINT64(2, fuzz.runs);
+}
+
+void Fuzz_Reports_Crashes_And_Hangs(void)
+{
+    // when:
+    Execute_Result result = Fuzz_Run((const uint8_t *)"!", 1);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT(FUZZ_CRASH, Fuzz_Check(&result));
+    TEST_ASSERT_EQUAL_HEX16(0x0300, cpu.program_counter);
+
+    // when:
+    result = Fuzz_Run((const uint8_t *)"L", 1);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT(FUZZ_HANG, Fuzz_Check(&result));
+    TEST_ASSERT_TRUE(result.cycles_used >= 1000);
+
+    // when: the machine is back to normal after both
+    result = Fuzz_Run((const uint8_t *)"A", 1);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT(FUZZ_OK, Fuzz_Check(&result));
+    TEST_ASSERT_EQUAL_HEX8('A', mem.data[0x0500]);
+}
+
+void Fuzz_Passes_The_Length_And_Cuts_Long_Inputs(void)
+{
+    // given:
+    static uint8_t input[0x1000];
+    memset(input, 'x', sizeof(input));
+
+    // when: the length is in A and X
+    Fuzz_Run(input, 0x012C);
+
+    // then:
+    TEST_ASSERT_EQUAL_HEX8(0x2C, mem.data[0x10]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, mem.data[0x11]);
+
+    // when: longer than the input region
+    Fuzz_Run(input, sizeof(input));
+
+    // then:
+    TEST_ASSERT_EQUAL_HEX8(0x00, mem.data[0x10]);
+    TEST_ASSERT_EQUAL_HEX8(0x03, mem.data[0x11]);
+    TEST_ASSERT_EQUAL_HEX8('x', mem.data[0x06FF]);
+    TEST_ASSERT_EQUAL_HEX8(0, mem.data[0x0700]);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(Fuzz_Runs_Each_Input_From_The_Baseline);
+    RUN_TEST(Fuzz_Reports_Crashes_And_Hangs);
+    RUN_TEST(Fuzz_Passes_The_Length_And_Cuts_Long_Inputs);
+
+    return UNITY_END();
+}
@@ -0,0 +1,185 @@
+#include "Unity/unity.h"
+#include "golden.h"
+
+#include <stdbool.h>
+
+// https://github.com/ThrowTheSwitch/Unity
+
+static Golden_Opcode entries[256];
+static uint8_t      *records[256];
+static Golden_Table  table;
+
+// Execute() with a bug in INX : C flips when X comes out as 0x40
+static s32 Execute_Bad_Carry(s32 cycles)
+{
+    const bool inx = (mem.data[cpu.program_counter] == INS_INX);
+    cycles         = Execute(cycles);
+    if (inx && cpu.index_reg_X == 0x40)
+        cpu.PS ^= 0x01;
+    return cycles;
+}
+
+void setUp(void) /* Is run before every test, put unit init calls here. */
+{
+    Initialise_Memory();
+    Reset_CPU();
+    memset(entries, 0, sizeof(entries));
+}
+void tearDown(void) /* Is run after every test, put unit clean-up calls here. */
+{
+    for (u32 opcode = 0; opcode < 256; opcode++)
+    {
+        free(records[opcode]);
+        records[opcode] = NULL;
+    }
+    Golden_Free(&table);
+}
+
+void Golden_INX_Only_Depends_On_X(void)
+{
+    // when:
+    records[INS_INX] = Golden_Build_Opcode(Execute, INS_INX, &entries[INS_INX]);
+
+    // then: 256 records of X and P. Bit 0 of X always flips so it is
+    // stored XORed with the input, the rest as they come out
+    TEST_ASSERT_NOT_NULL(records[INS_INX]);
+    TEST_ASSERT_EQUAL_HEX32(0x0FF00, entries[INS_INX].cases);
+    TEST_ASSERT_EQUAL_HEX32((1u << GOLDEN_X) | (1u << GOLDEN_P), entries[INS_INX].fields);
+    TEST_ASSERT_EQUAL_UINT32(256, entries[INS_INX].records);
+    TEST_ASSERT_EQUAL_HEX8(0x01, entries[INS_INX].xor_mask[GOLDEN_X]);
+    TEST_ASSERT_EQUAL_HEX8(0x03, records[INS_INX][2 * 0x01]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, records[INS_INX][2 * 0xFF]);
+    TEST_ASSERT_EQUAL_HEX8(0x5A, entries[INS_INX].constant[GOLDEN_A]);
+}
+
+void Golden_ADC_Depends_On_The_Operand_A_C_And_D(void)
+{
+    // when:
+    records[INS_ADC_IM] = Golden_Build_Opcode(Execute, INS_ADC_IM, &entries[INS_ADC_IM]);
+
+    // then: V is an output of ADC but not an input
+#if H6502_IS_CMOS
+    const u32 EXPECTED_FIELDS = (1u << GOLDEN_A) | (1u << GOLDEN_P) | (1u << GOLDEN_CYCLES); // decimal mode takes a cycle more
+#else
+    const u32 EXPECTED_FIELDS = (1u << GOLDEN_A) | (1u << GOLDEN_P);
+#endif
+    TEST_ASSERT_NOT_NULL(records[INS_ADC_IM]);
+    TEST_ASSERT_EQUAL_HEX32(0x3FFFF, entries[INS_ADC_IM].cases);
+    TEST_ASSERT_EQUAL_HEX32(EXPECTED_FIELDS, entries[INS_ADC_IM].fields);
+    TEST_ASSERT_EQUAL_UINT32(1u << 18, entries[INS_ADC_IM].records);
+}
+
+void Golden_Engines_Agree(void)
+{
+    // given:
+    const u8 opcodes[] = {INS_ADC_IM, INS_LDA_IND_Y, INS_STA_ABS_X, INS_BNE, INS_JSR, INS_RTI, INS_PHP};
+    for (u32 i = 0; i < sizeof(opcodes); i++)
+        records[opcodes[i]] = Golden_Build_Opcode(Execute, opcodes[i], &entries[opcodes[i]]);
+
+    for (u32 i = 0; i < sizeof(opcodes); i++)
+    {
+        // when:
+        const Golden_Opcode *entry  = &entries[opcodes[i]];
+        const Golden_Result  stored = Golden_Verify_Opcode(Execute_Dispatch_Table, opcodes[i], entry, records[opcodes[i]], false);
+        const Golden_Result  all    = Golden_Verify_Opcode(Execute_Dispatch_Table, opcodes[i], entry, records[opcodes[i]], true);
+
+        // then:
+        TEST_ASSERT_EQUAL_UINT32(entry->records, stored.checked);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, stored.failed, stored.failure);
+        TEST_ASSERT_EQUAL_UINT32(GOLDEN_CASES, all.checked);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, all.failed, all.failure);
+    }
+}
+
+void Golden_Finds_The_Case_That_Differs(void)
+{
+    // given:
+    records[INS_INX] = Golden_Build_Opcode(Execute, INS_INX, &entries[INS_INX]);
+
+    // when:
+    const Golden_Result result = Golden_Verify_Opcode(Execute_Bad_Carry, INS_INX, &entries[INS_INX], records[INS_INX], false);
+
+    // then: X is 0x3F on the way in, whatever the C of the case
+    TEST_ASSERT_EQUAL_UINT32(1, result.failed);
+    TEST_ASSERT_EQUAL_STRING("E8 INX IMP : operand 0x00 X 0x3F C0 D0 V0 : P 0x25, expected 0x24", result.failure);
+
+    // when:
+    const Golden_Result all = Golden_Verify_Opcode(Execute_Bad_Carry, INS_INX, &entries[INS_INX], records[INS_INX], true);
+
+    // then:
+    TEST_ASSERT_EQUAL_UINT32(GOLDEN_CASES / 256, all.failed);
+}
+
+void Golden_Table_Is_Read_Back_As_Written(void)
+{
+    // given: LDA $40 and LDA $3450 only differ in their PC and cycles, which are stored as
+    // the difference from what the opcode usually does
+    const u8 opcodes[] = {INS_LDA_ZP, INS_INX, INS_LDA_ABS};
+    for (u32 i = 0; i < sizeof(opcodes); i++)
+        records[opcodes[i]] = Golden_Build_Opcode(Execute, opcodes[i], &entries[opcodes[i]]);
+    FILE *file = tmpfile();
+    TEST_ASSERT_NOT_NULL(file);
+
+    // when:
+    TEST_ASSERT_TRUE(Golden_Write(file, entries, records));
+    rewind(file);
+    const bool read = Golden_Read(file, &table);
+
+    // then: the LDA records are in the file once
+    TEST_ASSERT_TRUE(read);
+    TEST_ASSERT_EQUAL_UINT64(2 * 256 + 2 * 256, table.size);
+    TEST_ASSERT_EQUAL_UINT64(table.opcodes[INS_LDA_ZP].offset, table.opcodes[INS_LDA_ABS].offset);
+    for (u32 opcode = 0; opcode < 256; opcode++)
+    {
+        const Golden_Opcode *entry = &table.opcodes[opcode];
+        TEST_ASSERT_EQUAL(entries[opcode].present, entry->present);
+        if (!entry->present)
+            continue;
+        TEST_ASSERT_EQUAL_HEX32(entries[opcode].cases, entry->cases);
+        TEST_ASSERT_EQUAL_HEX32(entries[opcode].fields, entry->fields);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(entries[opcode].xor_mask, entry->xor_mask, GOLDEN_FIELDS);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(entries[opcode].constant, entry->constant, GOLDEN_FIELDS);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(records[opcode], &table.data[entry->offset], entry->records * entry->record_size);
+    }
+
+    fclose(file);
+}
+
+void Golden_Table_Cut_Short_Is_Not_Read(void)
+{
+    // given: a table with its last record missing
+    records[INS_INX] = Golden_Build_Opcode(Execute, INS_INX, &entries[INS_INX]);
+    FILE *file       = tmpfile();
+    FILE *cut        = tmpfile();
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_NOT_NULL(cut);
+    TEST_ASSERT_TRUE(Golden_Write(file, entries, records));
+    const long size = ftell(file);
+    rewind(file);
+    for (long i = 0; i < size - 2; i++)
+        fputc(fgetc(file), cut);
+    rewind(cut);
+
+    // when:
+    const bool read = Golden_Read(cut, &table);
+
+    // then:
+    TEST_ASSERT_FALSE(read);
+    TEST_ASSERT_NULL(table.data);
+    fclose(file);
+    fclose(cut);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(Golden_INX_Only_Depends_On_X);
+    RUN_TEST(Golden_ADC_Depends_On_The_Operand_A_C_And_D);
+    RUN_TEST(Golden_Engines_Agree);
+    RUN_TEST(Golden_Finds_The_Case_That_Differs);
+    RUN_TEST(Golden_Table_Is_Read_Back_As_Written);
+    RUN_TEST(Golden_Table_Cut_Short_Is_Not_Read);
+
+    return UNITY_END();
+}
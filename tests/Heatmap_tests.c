@@ -0,0 +1,151 @@
+#define H6502_HEATMAP 1
+
+#include "Unity/unity.h"
+#include "h6502.h"
+
+#include <stdbool.h>
+
+// https://github.com/ThrowTheSwitch/Unity
+
+#define HEATMAP_TEST_FILE "Heatmap_tests.hmp"
+
+void setUp(void) /* Is run before every test, put unit init calls here. */
+{
+    Reset_CPU();
+    Heatmap_Reset(&heatmap);
+}
+void tearDown(void) /* Is run after every test, put unit clean-up calls here. */
+{
+    remove(HEATMAP_TEST_FILE);
+}
+
+void Heatmap_Counts_Reads_Writes_And_Executes(void)
+{
+    // given: LDA $1234 ; STA $0300 ; JSR $0400 -> RTS
+    const u8 program[] = {INS_LDA_ABS, 0x34, 0x12, INS_STA_ABS, 0x00, 0x03, INS_JSR, 0x00, 0x04};
+    memcpy(&mem.data[0x0200], program, sizeof(program));
+    mem.data[0x0400]    = INS_RTS;
+    cpu.program_counter = 0x0200;
+
+    // when:
+    Execute(4 + 4 + 6 + 6);
+
+    // then:
+    TEST_ASSERT_EQUAL_UINT64(1, heatmap.counts[HEATMAP_READS][0x1234]);
+    TEST_ASSERT_EQUAL_UINT64(1, heatmap.counts[HEATMAP_WRITES][0x0300]);
+    TEST_ASSERT_EQUAL_UINT64(0, heatmap.counts[HEATMAP_READS][0x0300]);
+    for (u16 address = 0x0200; address < 0x0209; address++)
+    {
+        TEST_ASSERT_EQUAL_UINT64(1, heatmap.counts[HEATMAP_EXECUTES][address]);
+        TEST_ASSERT_EQUAL_UINT64(0, heatmap.counts[HEATMAP_READS][address]);
+    }
+    TEST_ASSERT_EQUAL_UINT64(1, heatmap.counts[HEATMAP_EXECUTES][0x0400]);
+
+    // the return address is pushed and pulled
+    TEST_ASSERT_EQUAL_UINT64(1, heatmap.counts[HEATMAP_WRITES][0x01FF]);
+    TEST_ASSERT_EQUAL_UINT64(1, heatmap.counts[HEATMAP_WRITES][0x01FE]);
+    TEST_ASSERT_EQUAL_UINT64(1, heatmap.counts[HEATMAP_READS][0x01FF]);
+    TEST_ASSERT_EQUAL_UINT64(1, heatmap.counts[HEATMAP_READS][0x01FE]);
+}
+
+void Heatmap_Does_Not_Count_Debug_Reads(void)
+{
+    // given:
+    const u8 program[] = {INS_LDA_ABS, 0x34, 0x12};
+    memcpy(&mem.data[0x0200], program, sizeof(program));
+
+    // when:
+    char text[32];
+    Disassemble(0x0200, text, sizeof(text));
+    Effective_Address(0x0200);
+    Peek_Byte(0x1234);
+
+    // then:
+    for (u32 address = 0; address < HEATMAP_ADDRESSES; address++)
+    {
+        TEST_ASSERT_EQUAL_UINT64(0, heatmap.counts[HEATMAP_READS][address]);
+        TEST_ASSERT_EQUAL_UINT64(0, heatmap.counts[HEATMAP_EXECUTES][address]);
+    }
+}
+
+void Heatmap_Adds_Together_In_Memory_And_Through_Files(void)
+{
+    // given: two runs of the same program
+    static Heatmap total;
+    Heatmap_Reset(&total);
+
+    mem.data[0x0200] = INS_INX;
+    for (int run = 0; run < 2; run++)
+    {
+        cpu.program_counter = 0x0200;
+        Execute(2);
+        Heatmap_Add(&total, &heatmap);
+        Heatmap_Reset(&heatmap);
+    }
+    total.counts[HEATMAP_WRITES][0xFFFF] = 0x0123456789ABCDEFull;
+
+    // when:
+    TEST_ASSERT_TRUE(Heatmap_Save(&total, HEATMAP_TEST_FILE));
+    TEST_ASSERT_TRUE(Heatmap_Load(&heatmap, HEATMAP_TEST_FILE));
+    TEST_ASSERT_TRUE(Heatmap_Load(&heatmap, HEATMAP_TEST_FILE));
+
+    // then:
+    TEST_ASSERT_EQUAL_UINT64(2, total.counts[HEATMAP_EXECUTES][0x0200]);
+    TEST_ASSERT_EQUAL_UINT64(4, heatmap.counts[HEATMAP_EXECUTES][0x0200]);
+    TEST_ASSERT_EQUAL_UINT64(0x0123456789ABCDEFull * 2, heatmap.counts[HEATMAP_WRITES][0xFFFF]);
+    TEST_ASSERT_EQUAL_UINT64(0, heatmap.counts[HEATMAP_READS][0x0200]);
+}
+
+void Heatmap_Images_Have_A_Pixel_Per_Address(void)
+{
+    // given:
+    heatmap.counts[HEATMAP_READS][0x0000]  = 1;
+    heatmap.counts[HEATMAP_READS][0x1234]  = 1000;
+    heatmap.counts[HEATMAP_WRITES][0x1234] = 5;
+
+    // when:
+    FILE *file = fopen(HEATMAP_TEST_FILE, "w+b");
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_TRUE(Heatmap_Write_PGM(&heatmap, HEATMAP_READS, file));
+
+    // then: a row per page, brightest at the busiest address
+    const char header[] = "P5\n256 256\n255\n";
+    uint8_t    image[sizeof(header) - 1 + 256 * 256];
+    rewind(file);
+    TEST_ASSERT_EQUAL_size_t(sizeof(image), fread(image, 1, sizeof(image), file));
+    TEST_ASSERT_EQUAL_INT(EOF, fgetc(file));
+    TEST_ASSERT_EQUAL_MEMORY(header, image, sizeof(header) - 1);
+
+    const uint8_t *pixels = &image[sizeof(header) - 1];
+    TEST_ASSERT_EQUAL_UINT8(255, pixels[0x12 * 256 + 0x34]);
+    TEST_ASSERT_TRUE(pixels[0x0000] > 0 && pixels[0x0000] < 255);
+    TEST_ASSERT_EQUAL_UINT8(0, pixels[0x0001]);
+
+    // when:
+    TEST_ASSERT_EQUAL_INT(0, fseek(file, 0, SEEK_SET));
+    TEST_ASSERT_TRUE(Heatmap_Write_PPM(&heatmap, file));
+    fflush(file);
+
+    // then: red is writes, green reads, blue executes
+    static uint8_t colour[15 + 256 * 256 * 3];
+    rewind(file);
+    TEST_ASSERT_EQUAL_size_t(sizeof(colour), fread(colour, 1, sizeof(colour), file));
+    TEST_ASSERT_EQUAL_MEMORY("P6\n256 256\n255\n", colour, 15);
+    const uint8_t *pixel = &colour[15 + 0x1234 * 3];
+    TEST_ASSERT_EQUAL_UINT8(255, pixel[0]);
+    TEST_ASSERT_EQUAL_UINT8(255, pixel[1]);
+    TEST_ASSERT_EQUAL_UINT8(0, pixel[2]);
+    fclose(file);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(Heatmap_Counts_Reads_Writes_And_Executes);
+    RUN_TEST(Heatmap_Does_Not_Count_Debug_Reads);
+    RUN_TEST(Heatmap_Adds_Together_In_Memory_And_Through_Files);
+    RUN_TEST(Heatmap_Images_Have_A_Pixel_Per_Address);
+
+    return UNITY_END();
+}
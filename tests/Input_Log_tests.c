@@ -0,0 +1,263 @@
+#define H6502_INPUT_LOG 1
+
+#include "Unity/unity.h"
+#include "h6502.h"
+
+#include <stdbool.h>
+
+// https://github.com/ThrowTheSwitch/Unity
+
+#define INPUT_LOG_TEST_FILE "Input_Log_tests.inl"
+
+static u32 device_reads = 0;
+
+// A device that gives a different value every read
+static u8 Noise_Read(void *context, u16 address)
+{
+    u32 *state = context;
+    *state     = *state * 1103515245u + 12345u;
+    device_reads++;
+    return (u8)((*state >> 16) ^ address);
+}
+
+static u8 Unused_Read(void *context, u16 address)
+{
+    (void)context;
+    (void)address;
+    TEST_FAIL_MESSAGE("the device is read while replaying");
+    return 0;
+}
+
+static uint32_t Host_Clock(void *context)
+{
+    u32 *clock = context;
+    return *clock += 1000;
+}
+
+void setUp(void) /* Is run before every test, put unit init calls here. */
+{
+    Initialise_Memory();
+    Reset_CPU();
+    device_reads = 0;
+}
+void tearDown(void) /* Is run after every test, put unit clean-up calls here. */
+{
+    Input_Set_Port(0, 0, NULL, NULL);
+    remove(INPUT_LOG_TEST_FILE);
+}
+
+// 0x0200 : LDX #0
+// 0x0202 : LDA $D000 ; STA $0300,X ; EOR $D001 ; STA $0400,X ; INX ; BNE $0202
+// 0x0211 : JMP $0211
+static void Load_Reader(void)
+{
+    const u8 program[] = {
+        INS_LDX_IM, 0x00,                                                        // 0x0200
+        INS_LDA_ABS, 0x00, 0xD0, INS_STA_ABS_X, 0x00, 0x03,                      // 0x0202
+        INS_EOR_ABS, 0x01, 0xD0, INS_STA_ABS_X, 0x00, 0x04, INS_INX, INS_BNE, 0xF1, // 0x0208
+        INS_JMP_ABS, 0x11, 0x02,                                                 // 0x0211
+    };
+    memcpy(&mem.data[0x0200], program, sizeof(program));
+    cpu.program_counter = 0x0200;
+}
+
+void Input_Log_Replays_Device_Reads_Without_The_Device(void)
+{
+    // given: a recorded run
+    u32 seed = 1;
+    Load_Reader();
+    Input_Set_Port(0xD000, 0xD00F, Noise_Read, &seed);
+    TEST_ASSERT_TRUE(Input_Record_Start(INPUT_LOG_TEST_FILE));
+    Execute(20000);
+    TEST_ASSERT_TRUE(Input_Record_Stop());
+
+    static Memory recorded;
+    memcpy(recorded.data, mem.data, MAX_MEM);
+    const CPU recorded_cpu = cpu;
+    TEST_ASSERT_EQUAL_UINT32(512, device_reads);
+
+    // when:
+    Initialise_Memory();
+    Reset_CPU();
+    Load_Reader();
+    Input_Set_Port(0xD000, 0xD00F, Unused_Read, NULL);
+    TEST_ASSERT_TRUE(Input_Replay_Start(INPUT_LOG_TEST_FILE));
+    Execute(20000);
+
+    // then:
+    TEST_ASSERT_TRUE(Input_Replay_Done());
+    TEST_ASSERT_EQUAL_UINT64(512, input_log.records);
+    TEST_ASSERT_EQUAL_MEMORY(recorded.data, mem.data, MAX_MEM);
+    TEST_ASSERT_EQUAL_HEX16(recorded_cpu.program_counter, cpu.program_counter);
+    Input_Replay_Stop();
+}
+
+void Input_Log_Replays_With_The_Dispatch_Table(void)
+{
+    // given: a run recorded with the table engine
+    u32 seed = 7;
+    Load_Reader();
+    Input_Set_Port(0xD000, 0xD00F, Noise_Read, &seed);
+    TEST_ASSERT_TRUE(Input_Record_Start(INPUT_LOG_TEST_FILE));
+    Execute_Dispatch_Table(20000);
+    TEST_ASSERT_TRUE(Input_Record_Stop());
+
+    static Memory recorded;
+    memcpy(recorded.data, mem.data, MAX_MEM);
+    const uint64_t instructions = input_log.instructions;
+
+    // when: replayed with the switch engine, the instruction stamps have to match
+    Initialise_Memory();
+    Reset_CPU();
+    Load_Reader();
+    Input_Set_Port(0xD000, 0xD00F, Unused_Read, NULL);
+    TEST_ASSERT_TRUE(Input_Replay_Start(INPUT_LOG_TEST_FILE));
+    Execute(20000);
+
+    // then:
+    TEST_ASSERT_TRUE(Input_Replay_Done());
+    TEST_ASSERT_EQUAL_UINT64(512, input_log.records);
+    TEST_ASSERT_EQUAL_UINT64(instructions, input_log.instructions);
+    TEST_ASSERT_EQUAL_MEMORY(recorded.data, mem.data, MAX_MEM);
+    Input_Replay_Stop();
+
+    // when: and replayed with the table engine
+    Initialise_Memory();
+    Reset_CPU();
+    Load_Reader();
+    TEST_ASSERT_TRUE(Input_Replay_Start(INPUT_LOG_TEST_FILE));
+    Execute_Dispatch_Table(20000);
+
+    // then:
+    TEST_ASSERT_TRUE(Input_Replay_Done());
+    TEST_ASSERT_EQUAL_MEMORY(recorded.data, mem.data, MAX_MEM);
+    Input_Replay_Stop();
+}
+
+void Input_Log_Records_Are_Small(void)
+{
+    // given:
+    u32 seed = 7;
+    Load_Reader();
+    Input_Set_Port(0xD000, 0xD00F, Noise_Read, &seed);
+
+    // when:
+    TEST_ASSERT_TRUE(Input_Record_Start(INPUT_LOG_TEST_FILE));
+    Execute(20000);
+    TEST_ASSERT_TRUE(Input_Record_Stop());
+
+    // then: kind, a 1 byte stamp, address and value
+    FILE *file = fopen(INPUT_LOG_TEST_FILE, "rb");
+    TEST_ASSERT_NOT_NULL(file);
+    fseek(file, 0, SEEK_END);
+    TEST_ASSERT_EQUAL_INT(INPUT_LOG_HEADER_SIZE + 512 * 5, ftell(file));
+    fclose(file);
+}
+
+void Input_Log_Replay_Stops_When_The_Run_Is_Different(void)
+{
+    // given:
+    u32 seed = 3;
+    Load_Reader();
+    Input_Set_Port(0xD000, 0xD00F, Noise_Read, &seed);
+    TEST_ASSERT_TRUE(Input_Record_Start(INPUT_LOG_TEST_FILE));
+    Execute(20000);
+    TEST_ASSERT_TRUE(Input_Record_Stop());
+
+    // when: the second read is from another port address
+    Initialise_Memory();
+    Reset_CPU();
+    Load_Reader();
+    mem.data[0x0209] = 0x02;
+    Input_Set_Port(0xD000, 0xD00F, Unused_Read, NULL);
+    TEST_ASSERT_TRUE(Input_Replay_Start(INPUT_LOG_TEST_FILE));
+    Execute(20000);
+
+    // then: LDX, LDA, STA then EOR
+    TEST_ASSERT_TRUE(input_log.diverged);
+    TEST_ASSERT_EQUAL_UINT64(4, input_log.diverged_at);
+    TEST_ASSERT_FALSE(Input_Replay_Done());
+    Input_Replay_Stop();
+}
+
+void Input_Log_Replays_Host_Values(void)
+{
+    // given:
+    u32  clock = 0;
+    FILE *file = tmpfile();
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_TRUE(Input_Record_Start_File(file, false));
+    const uint32_t first = Input_Host_Call(Host_Clock, &clock);
+    input_log.instructions += 300;
+    const uint32_t second = Input_Host_Call(Host_Clock, &clock);
+    TEST_ASSERT_TRUE(Input_Record_Stop());
+
+    static uint8_t log[64];
+    rewind(file);
+    const size_t size = fread(log, 1, sizeof(log), file);
+    fclose(file);
+
+    // when:
+    clock = 1000000;
+    TEST_ASSERT_TRUE(Input_Replay_Start_Buffer(log, size));
+    const uint32_t replayed_first = Input_Host_Call(Host_Clock, &clock);
+    input_log.instructions += 300;
+    const uint32_t replayed_second = Input_Host_Call(Host_Clock, &clock);
+
+    // then:
+    TEST_ASSERT_EQUAL_UINT32(first, replayed_first);
+    TEST_ASSERT_EQUAL_UINT32(second, replayed_second);
+    TEST_ASSERT_EQUAL_UINT32(1000000, clock);
+    TEST_ASSERT_TRUE(Input_Replay_Done());
+    Input_Replay_Stop_Buffer();
+}
+
+void Input_Log_Replay_Stops_At_A_Truncated_Record(void)
+{
+    // given: two port reads, the log cut off inside the second
+    u32   seed = 5;
+    FILE *file = tmpfile();
+    TEST_ASSERT_NOT_NULL(file);
+    Input_Set_Port(0xD000, 0xD00F, Noise_Read, &seed);
+    TEST_ASSERT_TRUE(Input_Record_Start_File(file, false));
+    const u8 first = Input_Read(0xD000);
+    input_log.instructions += 10;
+    Input_Read(0xD000);
+    TEST_ASSERT_TRUE(Input_Record_Stop());
+
+    static uint8_t log[64];
+    rewind(file);
+    const size_t size = fread(log, 1, sizeof(log), file);
+    fclose(file);
+
+    // when:
+    Input_Set_Port(0xD000, 0xD00F, Unused_Read, NULL);
+    TEST_ASSERT_TRUE(Input_Replay_Start_Buffer(log, size - 1));
+    const u8 replayed_first = Input_Read(0xD000);
+    input_log.instructions += 10;
+    const size_t position  = input_log.position;
+    const u8     truncated = Input_Read(0xD000);
+
+    // then: the second read diverges and leaves the record where it was
+    TEST_ASSERT_EQUAL_HEX8(first, replayed_first);
+    TEST_ASSERT_EQUAL_HEX8(0, truncated);
+    TEST_ASSERT_TRUE(input_log.diverged);
+    TEST_ASSERT_EQUAL_UINT64(10, input_log.diverged_at);
+    TEST_ASSERT_EQUAL_size_t(position, input_log.position);
+    TEST_ASSERT_FALSE(Input_Replay_Done());
+    Input_Replay_Stop_Buffer();
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(Input_Log_Replays_Device_Reads_Without_The_Device);
+    RUN_TEST(Input_Log_Replays_With_The_Dispatch_Table);
+    RUN_TEST(Input_Log_Records_Are_Small);
+    RUN_TEST(Input_Log_Replay_Stops_When_The_Run_Is_Different);
+    RUN_TEST(Input_Log_Replays_Host_Values);
+    RUN_TEST(Input_Log_Replay_Stops_At_A_Truncated_Record);
+
+    return UNITY_END();
+}
@@ -106,8 +106,12 @@ void Jump_Indirect_Can_Jump_To_A_New_Location_In_The_Program(void)
     mem.data[0x8000]    = 0x00;
     mem.data[0x8001]    = 0x90;
 
-    const CPU cpu_before      = cpu;
+    const CPU cpu_before = cpu;
+#if H6502_IS_CMOS
+    const s32 EXPECTED_CYCLES = 6;
+#else
     const s32 EXPECTED_CYCLES = 5;
+#endif
 
     // when:
     const s32 actual_cycles = Execute(EXPECTED_CYCLES);
@@ -119,6 +123,31 @@ void Jump_Indirect_Can_Jump_To_A_New_Location_In_The_Program(void)
     TEST_ASSERT_EQUAL_UINT16(0x9000, cpu.program_counter);
 }
 
+#if H6502_IS_NMOS
+// The NMOS 6502 fetches the high byte from the start of the same page when
+// the pointer is at the end of a page
+void Jump_Indirect_Does_Not_Cross_A_Page_For_The_High_Byte(void)
+{
+    // given:
+    cpu.program_counter = 0xFF00;
+    mem.data[0xFF00]    = INS_JMP_IND;
+    mem.data[0xFF01]    = 0xFF;
+    mem.data[0xFF02]    = 0x80;
+    mem.data[0x80FF]    = 0x34;
+    mem.data[0x8000]    = 0x12;
+    mem.data[0x8100]    = 0x56;
+
+    const s32 EXPECTED_CYCLES = 5;
+
+    // when:
+    const s32 actual_cycles = Execute(EXPECTED_CYCLES);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(EXPECTED_CYCLES, actual_cycles);
+    TEST_ASSERT_EQUAL_UINT16(0x1234, cpu.program_counter);
+}
+#endif
+
 int main(void)
 {
     UNITY_BEGIN();
@@ -128,6 +157,9 @@ int main(void)
     RUN_TEST(RTS_Does_Not_Affect_The_Processor_Status);
     RUN_TEST(Jump_Absolute_Can_Jump_To_A_New_Location_In_The_Program);
     RUN_TEST(Jump_Indirect_Can_Jump_To_A_New_Location_In_The_Program);
+#if H6502_IS_NMOS
+    RUN_TEST(Jump_Indirect_Does_Not_Cross_A_Page_For_The_High_Byte);
+#endif
 
     return UNITY_END();
 }
\ No newline at end of file
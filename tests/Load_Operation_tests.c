@@ -59,7 +59,7 @@ void CPU_Can_Execute_More_Cycles_Than_Requested_If_The_Instruction_Requires(void
 
 void Executing_A_Bad_Instruction_Does_Not_Start_Infinite_Loop(void)
 {
-    mem.data[0xFFFC] = 0x0; // invalud instruction
+    mem.data[0xFFFC] = 0x02; // invalid instruction
     mem.data[0xFFFD] = 0x0;
 
     const s32 cycles_used = Execute(1);
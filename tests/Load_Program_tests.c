@@ -34,7 +34,10 @@ void Test_Load_Program_Into_Correct_Area_Of_Memory(void)
     mem_expected.data[0x100B] = 0x10;
     mem_expected.data[0x100C] = 0x00; // end
 
-    TEST_ASSERT_EQUAL_UINT8_ARRAY(mem_expected.data, mem.data, MAX_MEM);
+    Memory_Diff diff;
+    char        text[256];
+    Memory_Diff_Compare(&diff, mem_expected.data, mem.data, NULL);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, diff.bytes, Memory_Diff_Format(&diff, text, sizeof(text)));
 }
 
 void Test_Load_Program_And_Execute(void)
@@ -42,12 +45,17 @@ void Test_Load_Program_And_Execute(void)
     const u8  program[]       = {0x00, 0x10, 0xA9, 0xFF, 0x85, 0x90, 0x8D, 0x00, 0x80, 0x49, 0xCC, 0x4C, 0x02, 0x10};
     const int number_of_bytes = 14;
 
-    Load_Program(program, number_of_bytes);
+    const u16 start_address = Load_Program(program, number_of_bytes);
+    cpu.program_counter     = start_address;
+
+    Stop_Conditions stop = {0};
+    stop.max_cycles      = 100;
+
+    const Execute_Result result = Execute_Until(&stop);
 
-    for (s32 clock = 100; clock > 0;)
-    {
-        clock -= Execute(1);
-    }
+    TEST_ASSERT_EQUAL_INT(STOP_MAX_CYCLES, result.reason);
+    TEST_ASSERT_GREATER_OR_EQUAL_INT32(100, result.cycles_used);
+    TEST_ASSERT_TRUE(cpu.program_counter >= 0x1000 && cpu.program_counter < 0x100C);
 }
 
 int main(void)
@@ -0,0 +1,178 @@
+#define H6502_SNAPSHOT 1
+
+#include "Unity/unity.h"
+#include "counter_program.h"
+#include "lockstep.h"
+#include "program_gen.h"
+
+#include <stdbool.h>
+
+// https://github.com/ThrowTheSwitch/Unity
+
+#define INC_INSTRUCTION (1 + 256 * 7) // number of the first INC $10
+
+static Lockstep lockstep;
+
+// Execute() with a bug in INC $10 : X changes too
+static s32 Execute_Bad_Register(s32 cycles)
+{
+    const bool inc = (cpu.program_counter == 0x020F);
+    cycles         = Execute(cycles);
+    if (inc)
+        cpu.index_reg_X ^= 0x01;
+    return cycles;
+}
+
+// Execute() with a bug in INC $10 : it writes $4000 too
+static s32 Execute_Bad_Write(s32 cycles)
+{
+    const bool inc = (cpu.program_counter == 0x020F);
+    cycles         = Execute(cycles);
+    if (inc)
+        Write_Byte(0xAA, 0x4000);
+    return cycles;
+}
+
+static const Execution_Engine bad_register = {"bad_register", Execute_Bad_Register};
+static const Execution_Engine bad_write    = {"bad_write", Execute_Bad_Write};
+
+void setUp(void) /* Is run before every test, put unit init calls here. */
+{
+    Initialise_Memory();
+    Reset_CPU();
+    Load_Counter();
+}
+void tearDown(void) /* Is run after every test, put unit clean-up calls here. */
+{
+    Lockstep_Stop(&lockstep);
+}
+
+void Lockstep_Engines_Agree(void)
+{
+    // given:
+    Lockstep_Start(&lockstep, Find_Execution_Engine("switch"), Find_Execution_Engine("table"), 64);
+
+    // when:
+    const Lockstep_Outcome outcome = Lockstep_Run(&lockstep, 20000);
+
+    // then: both machines counted the same
+    TEST_ASSERT_EQUAL_INT(LOCKSTEP_AGREE, outcome);
+    TEST_ASSERT_EQUAL_UINT64(20000, lockstep.instructions);
+    TEST_ASSERT_EQUAL_UINT32(0, Lockstep_Compare_Memory(&lockstep, lockstep.machine_a, lockstep.machine_b));
+    TEST_ASSERT_TRUE(Lockstep_CPU_Equal(&lockstep.machine_a->cpu, &lockstep.machine_b->cpu));
+    TEST_ASSERT_NOT_EQUAL(0, lockstep.machine_a->table->pages[0x00]->data[0x10]);
+}
+
+void Lockstep_Finds_The_Instruction_That_Changed_A_Register(void)
+{
+    // given:
+    Lockstep_Start(&lockstep, Find_Execution_Engine("switch"), &bad_register, 64);
+
+    // when:
+    const Lockstep_Outcome outcome = Lockstep_Run(&lockstep, 20000);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT(LOCKSTEP_DIVERGED, outcome);
+    TEST_ASSERT_EQUAL_UINT64(INC_INSTRUCTION, lockstep.diverged_at);
+    TEST_ASSERT_FALSE(lockstep.memory_differs);
+    TEST_ASSERT_EQUAL_HEX8(0x00, lockstep.history[INC_INSTRUCTION].cpu.index_reg_X);
+    TEST_ASSERT_EQUAL_HEX8(0x01, lockstep.cpu_b.index_reg_X);
+}
+
+void Lockstep_Finds_The_Instruction_That_Wrote_Memory_Inside_A_Block(void)
+{
+    // given: memory is only checked every 256 instructions
+    Lockstep_Start(&lockstep, Find_Execution_Engine("switch"), &bad_write, 256);
+
+    // when:
+    const Lockstep_Outcome outcome = Lockstep_Run(&lockstep, 20000);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT(LOCKSTEP_DIVERGED, outcome);
+    TEST_ASSERT_EQUAL_UINT64(INC_INSTRUCTION, lockstep.diverged_at);
+    TEST_ASSERT_TRUE(lockstep.memory_differs);
+    TEST_ASSERT_EQUAL_UINT32(1, lockstep.difference_count);
+    TEST_ASSERT_EQUAL_HEX16(0x4000, lockstep.differences[0].address);
+    TEST_ASSERT_EQUAL_HEX8(0x00, lockstep.differences[0].value_a);
+    TEST_ASSERT_EQUAL_HEX8(0xAA, lockstep.differences[0].value_b);
+    TEST_ASSERT_EQUAL_UINT32(1, lockstep.memory_diff.range_count);
+}
+
+void Lockstep_Prints_The_Instructions_Before_A_Divergence(void)
+{
+    // given:
+    Lockstep_Start(&lockstep, Find_Execution_Engine("switch"), &bad_register, 64);
+    TEST_ASSERT_EQUAL_INT(LOCKSTEP_DIVERGED, Lockstep_Run(&lockstep, 20000));
+    FILE *file = tmpfile();
+    TEST_ASSERT_NOT_NULL(file);
+
+    // when:
+    Lockstep_Print_Divergence(&lockstep, file);
+
+    // then: the context ends with the instruction that diverged
+    static char text[4096];
+    rewind(file);
+    text[fread(text, 1, sizeof(text) - 1, file)] = '\0';
+    fclose(file);
+    TEST_ASSERT_NOT_NULL(strstr(text, "diverge at instruction 1793 (registers)"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "BNE $0202"));
+    TEST_ASSERT_NOT_NULL(strstr(text, ">       1793  020F  INC $10"));
+}
+
+void Lockstep_Stops_Before_An_Opcode_The_Variant_Does_Not_Have(void)
+{
+    // given: INC $10 replaced with an opcode the variant does not have
+    u8 opcode = 0x00;
+    while (Opcode_Is_Valid(opcode) && opcode < 0xFF)
+        opcode++;
+    if (Opcode_Is_Valid(opcode))
+        TEST_IGNORE_MESSAGE("the variant has every opcode");
+    mem.data[0x020F] = opcode;
+    Lockstep_Start(&lockstep, Find_Execution_Engine("switch"), Find_Execution_Engine("table"), 64);
+
+    // when:
+    const Lockstep_Outcome outcome = Lockstep_Run(&lockstep, 20000);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT(LOCKSTEP_STOPPED, outcome);
+    TEST_ASSERT_EQUAL_UINT64(INC_INSTRUCTION, lockstep.instructions);
+    TEST_ASSERT_EQUAL_HEX16(0x020F, cpu.program_counter);
+}
+
+void Lockstep_Runs_A_Generated_Program_To_Its_Trap(void)
+{
+    // given:
+    static Program_Generator generator;
+    static Program           program;
+    Program_Config           config;
+    Program_Default_Config(&config);
+    TEST_ASSERT_TRUE(Program_Generator_Init(&generator, &config));
+    Initialise_Memory();
+    Program_Generate(&generator, 1, &program);
+    Program_Load(&program);
+    Lockstep_Start(&lockstep, Find_Execution_Engine("switch"), Find_Execution_Engine("table"), 4096);
+    Lockstep_Stop_At(&lockstep, program.trap);
+
+    // when:
+    const Lockstep_Outcome outcome = Lockstep_Run(&lockstep, 100000);
+
+    // then: it stops on the JMP * inside the first block, not after spinning on it
+    TEST_ASSERT_EQUAL_INT(LOCKSTEP_STOPPED, outcome);
+    TEST_ASSERT_EQUAL_HEX16(program.trap, cpu.program_counter);
+    TEST_ASSERT_GREATER_THAN_UINT64(config.instructions - 1, lockstep.instructions);
+    TEST_ASSERT_LESS_THAN_UINT64(4096, lockstep.instructions);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(Lockstep_Engines_Agree);
+    RUN_TEST(Lockstep_Finds_The_Instruction_That_Changed_A_Register);
+    RUN_TEST(Lockstep_Finds_The_Instruction_That_Wrote_Memory_Inside_A_Block);
+    RUN_TEST(Lockstep_Prints_The_Instructions_Before_A_Divergence);
+    RUN_TEST(Lockstep_Stops_Before_An_Opcode_The_Variant_Does_Not_Have);
+    RUN_TEST(Lockstep_Runs_A_Generated_Program_To_Its_Trap);
+
+    return UNITY_END();
+}
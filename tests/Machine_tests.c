@@ -0,0 +1,133 @@
+#define H6502_SNAPSHOT 1
+
+#include "Unity/unity.h"
+#include "counter_program.h"
+#include "machine.h"
+
+#include <stdbool.h>
+
+// https://github.com/ThrowTheSwitch/Unity
+
+static Machine *parent;
+
+void setUp(void) /* Is run before every test, put unit init calls here. */
+{
+    Initialise_Memory();
+    Reset_CPU();
+    Load_Counter();
+    parent = Machine_Create();
+}
+void tearDown(void) /* Is run after every test, put unit clean-up calls here. */
+{
+    Machine_Free(parent);
+}
+
+void Machine_Fork_Shares_Pages_Until_They_Are_Written(void)
+{
+    // given:
+    Execute(1000);
+    const uint64_t allocated = machines.pages_allocated;
+
+    // when:
+    Machine *child = Machine_Fork(parent);
+
+    // then: nothing is copied
+    TEST_ASSERT_EQUAL_UINT64(allocated, machines.pages_allocated);
+    TEST_ASSERT_EQUAL_UINT32(0, Machine_Private_Pages(child));
+    TEST_ASSERT_EQUAL_HEX16(cpu.program_counter, child->cpu.program_counter);
+
+    // when: the child writes the counters, the stack and zero page
+    Machine_Switch(child);
+    Execute(10000);
+    Machine_Sync();
+
+    // then:
+    TEST_ASSERT_EQUAL_UINT32(3, Machine_Private_Pages(child));
+    TEST_ASSERT_EQUAL_UINT64(allocated + 3, machines.pages_allocated);
+
+    // 'mem' holds the child's pages until another machine runs
+    Machine_Switch(parent);
+    Machine_Free(child);
+    TEST_ASSERT_EQUAL_UINT64(allocated, machines.pages_allocated);
+}
+
+void Machine_Children_Run_Independently(void)
+{
+    // given: what 3000 and 7000 more cycles give, run alone
+    Execute(1000);
+    Machine *fork_point = Machine_Fork(parent);
+
+    static Memory expected[2];
+    CPU           expected_cpu[2];
+    const s32     cycles[2] = {3000, 7000};
+    for (int i = 0; i < 2; i++)
+    {
+        Machine_Switch(fork_point);
+        Machine *run = Machine_Fork(fork_point);
+        Machine_Switch(run);
+        for (s32 done = 0; done < cycles[i]; done += 1000)
+            Execute(1000);
+        memcpy(expected[i].data, mem.data, MAX_MEM);
+        expected_cpu[i] = cpu;
+        Machine_Free(run);
+    }
+
+    // when: two children run in turns
+    Machine *children[2] = {Machine_Fork(fork_point), Machine_Fork(fork_point)};
+    for (int slice = 0; slice < 7; slice++)
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            if (slice * 1000 < cycles[i])
+            {
+                Machine_Switch(children[i]);
+                Execute(1000);
+            }
+        }
+    }
+
+    // then:
+    for (int i = 0; i < 2; i++)
+    {
+        Machine_Switch(children[i]);
+        TEST_ASSERT_EQUAL_MEMORY(expected[i].data, mem.data, MAX_MEM);
+        TEST_ASSERT_EQUAL_HEX16(expected_cpu[i].program_counter, cpu.program_counter);
+        TEST_ASSERT_EQUAL_HEX8(expected_cpu[i].accumulator, cpu.accumulator);
+    }
+
+    // and the parent is where it was
+    Machine_Switch(parent);
+    TEST_ASSERT_EQUAL_MEMORY(fork_point->table->pages[0x03]->data, &mem.data[0x0300], MACHINE_PAGE_SIZE);
+    TEST_ASSERT_EQUAL_UINT8(0, mem.data[0x10]);
+
+    Machine_Free(children[0]);
+    Machine_Free(children[1]);
+    Machine_Free(fork_point);
+}
+
+void Machine_Keeps_Changes_Made_With_No_Machine_Running(void)
+{
+    // given: the running machine is gone
+    Machine *child = Machine_Fork(parent);
+    Machine_Switch(child);
+    Machine_Free(child);
+
+    // when: written, then a machine is switched in
+    Execute(1000);
+    Machine_Switch(parent);
+
+    // then: the parent's memory, not what was run
+    TEST_ASSERT_EQUAL_HEX8(0, mem.data[0x0300]);
+    TEST_ASSERT_EQUAL_HEX16(0x0200, cpu.program_counter);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(Machine_Fork_Shares_Pages_Until_They_Are_Written);
+    RUN_TEST(Machine_Children_Run_Independently);
+    RUN_TEST(Machine_Keeps_Changes_Made_With_No_Machine_Running);
+
+    return UNITY_END();
+}
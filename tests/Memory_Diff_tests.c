@@ -0,0 +1,124 @@
+#include "Unity/unity.h"
+#include "h6502.h"
+
+#include <stdbool.h>
+
+// https://github.com/ThrowTheSwitch/Unity
+
+static Memory      other;
+static Memory_Diff diff;
+static char        text[256];
+
+void setUp(void) /* Is run before every test, put unit init calls here. */
+{
+    Initialise_Memory();
+    memset(other.data, 0, MAX_MEM);
+}
+void tearDown(void) /* Is run after every test, put unit clean-up calls here. */
+{
+}
+
+void Memory_Diff_Same_Memory_Has_No_Ranges(void)
+{
+    // given:
+    memset(mem.data, 0x5A, MAX_MEM);
+    memset(other.data, 0x5A, MAX_MEM);
+
+    // when:
+    const u32 bytes = Memory_Diff_Compare(&diff, mem.data, other.data, NULL);
+
+    // then:
+    TEST_ASSERT_EQUAL_UINT32(0, bytes);
+    TEST_ASSERT_EQUAL_UINT32(0, diff.range_count);
+    TEST_ASSERT_EQUAL_STRING("no bytes differ", Memory_Diff_Format(&diff, text, sizeof(text)));
+}
+
+void Memory_Diff_Joins_Bytes_Across_Chunks_And_Pages(void)
+{
+    // given: 0x10FE-0x1101 crosses a page, 0x201F-0x2020 a chunk
+    memset(&other.data[0x10FE], 0x11, 4);
+    other.data[0x2000] = 0x22;
+    memset(&other.data[0x201F], 0x33, 2);
+    other.data[0xFFFF] = 0x44;
+
+    // when:
+    const u32 bytes = Memory_Diff_Compare(&diff, mem.data, other.data, NULL);
+
+    // then:
+    TEST_ASSERT_EQUAL_UINT32(8, bytes);
+    TEST_ASSERT_EQUAL_UINT32(4, diff.range_count);
+    TEST_ASSERT_EQUAL_HEX16(0x10FE, diff.ranges[0].first);
+    TEST_ASSERT_EQUAL_HEX16(0x1101, diff.ranges[0].last);
+    TEST_ASSERT_EQUAL_STRING("8 bytes differ in 4 ranges : $10FE-$1101 $2000 $201F-$2020 $FFFF",
+                             Memory_Diff_Format(&diff, text, sizeof(text)));
+}
+
+void Memory_Diff_Only_Compares_The_Pages_Asked_For(void)
+{
+    // given:
+    uint8_t pages[MEMORY_DIFF_PAGES] = {0};
+    pages[0x20]                      = 1;
+    other.data[0x1000]               = 0x11;
+    other.data[0x2080]               = 0x22;
+
+    // when:
+    const u32 bytes = Memory_Diff_Compare(&diff, mem.data, other.data, pages);
+
+    // then:
+    TEST_ASSERT_EQUAL_UINT32(1, bytes);
+    TEST_ASSERT_EQUAL_STRING("1 byte differs in 1 range : $2080", Memory_Diff_Format(&diff, text, sizeof(text)));
+}
+
+void Memory_Diff_Counts_The_Ranges_It_Does_Not_Keep(void)
+{
+    // given: every other byte from 0x3000
+    for (u32 i = 0; i < 20; i++)
+        other.data[0x3000 + 2 * i] = 0xFF;
+
+    // when:
+    Memory_Diff_Compare(&diff, mem.data, other.data, NULL);
+
+    // then:
+    TEST_ASSERT_EQUAL_UINT32(20, diff.bytes);
+    TEST_ASSERT_EQUAL_UINT32(20, diff.range_count);
+    TEST_ASSERT_EQUAL_HEX16(0x300E, diff.ranges[MEMORY_DIFF_MAX_RANGES - 1].first);
+    TEST_ASSERT_EQUAL_STRING("20 bytes differ in 20 ranges : $3000 $3002 $3004 $3006 $3008 $300A $300C $300E ...",
+                             Memory_Diff_Format(&diff, text, sizeof(text)));
+
+    // when: the text does not fit
+    Memory_Diff_Format(&diff, text, 40);
+
+    // then:
+    TEST_ASSERT_EQUAL_STRING("20 bytes differ in 20 ranges : $3000 $3", text);
+}
+
+void Memory_Diff_Range_Takes_Any_Size(void)
+{
+    // given: not a whole number of chunks
+    const u8 a[40] = {0};
+    u8       b[40] = {0};
+    b[31]          = 1;
+    b[32]          = 2;
+    b[39]          = 3;
+    Memory_Diff_Clear(&diff);
+
+    // when:
+    const u32 bytes = Memory_Diff_Range(&diff, a, b, 0x4000, sizeof(a));
+
+    // then:
+    TEST_ASSERT_EQUAL_UINT32(3, bytes);
+    TEST_ASSERT_EQUAL_STRING("3 bytes differ in 2 ranges : $401F-$4020 $4027", Memory_Diff_Format(&diff, text, sizeof(text)));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(Memory_Diff_Same_Memory_Has_No_Ranges);
+    RUN_TEST(Memory_Diff_Joins_Bytes_Across_Chunks_And_Pages);
+    RUN_TEST(Memory_Diff_Only_Compares_The_Pages_Asked_For);
+    RUN_TEST(Memory_Diff_Counts_The_Ranges_It_Does_Not_Keep);
+    RUN_TEST(Memory_Diff_Range_Takes_Any_Size);
+
+    return UNITY_END();
+}
@@ -0,0 +1,171 @@
+#define H6502_OPCODE_STATS 1
+
+#include "Unity/unity.h"
+#include "h6502.h"
+
+#include <stdbool.h>
+
+// https://github.com/ThrowTheSwitch/Unity
+
+void setUp(void) /* Is run before every test, put unit init calls here. */
+{
+    Reset_CPU();
+    Opcode_Stats_Reset();
+}
+void tearDown(void) {} /* Is run after every test, put unit clean-up calls here. */
+
+// 0x02F0 : LDX #$03
+// 0x02F2 : LDA $02F0,X  <- crosses into page 3 when X >= 0x10, never here
+// 0x02F5 : LDA $02FF,X  <- crosses into page 3 every time
+// 0x02F8 : DEX
+// 0x02F9 : BNE $02F2
+static void Load_Test_Program(void)
+{
+    const u8 program[] = {INS_LDX_IM, 0x03, INS_LDA_ABS_X, 0xF0, 0x02, INS_LDA_ABS_X, 0xFF, 0x02, INS_DEX, INS_BNE, 0xF7};
+    memcpy(&mem.data[0x02F0], program, sizeof(program));
+    cpu.program_counter = 0x02F0;
+}
+
+void Opcode_Stats_Count_Executions_And_Cycles(void)
+{
+    // given:
+    Load_Test_Program();
+
+    // when: LDX(2) + 3 * (LDA(4) + LDA(5) + DEX(2)) + 2 taken BNE(3) + BNE(2)
+    const s32 cycles_used = Execute(2 + 3 * 11 + 2 * 3 + 2);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(43, cycles_used);
+    TEST_ASSERT_EQUAL_UINT64(1, opcode_stats.counters[INS_LDX_IM].executions);
+    TEST_ASSERT_EQUAL_UINT64(6, opcode_stats.counters[INS_LDA_ABS_X].executions);
+    TEST_ASSERT_EQUAL_UINT64(3 * 4 + 3 * 5, Opcode_Stats_Cycles(INS_LDA_ABS_X));
+    TEST_ASSERT_EQUAL_UINT64(3, opcode_stats.counters[INS_LDA_ABS_X].page_crossings);
+    TEST_ASSERT_EQUAL_UINT64(3, opcode_stats.counters[INS_DEX].executions);
+    TEST_ASSERT_EQUAL_UINT64(2 * 3 + 2, Opcode_Stats_Cycles(INS_BNE));
+}
+
+void Opcode_Stats_Count_Branches_Taken_And_Not_Taken(void)
+{
+    // given:
+    Load_Test_Program();
+
+    // when:
+    Execute(43);
+
+    // then:
+    TEST_ASSERT_EQUAL_UINT64(2, opcode_stats.counters[INS_BNE].branches_taken);
+    TEST_ASSERT_EQUAL_UINT64(1, Opcode_Stats_Branches_Not_Taken(INS_BNE));
+    TEST_ASSERT_EQUAL_UINT64(0, opcode_stats.counters[INS_DEX].branches_taken);
+}
+
+// 0x02F0 : LDX #$01
+// 0x02F2 : BNE $0314  <- lands in page 3
+// 0x0314 : BNE $0316  <- stays in page 3
+// 0x0316 : NOP
+void Opcode_Stats_Count_A_Branch_Into_Another_Page_As_A_Page_Crossing(void)
+{
+    // given:
+    const u8 program[] = {INS_LDX_IM, 0x01, INS_BNE, 0x20};
+    memcpy(&mem.data[0x02F0], program, sizeof(program));
+    mem.data[0x0314]    = INS_BNE;
+    mem.data[0x0315]    = 0x00;
+    mem.data[0x0316]    = INS_NOP;
+    cpu.program_counter = 0x02F0;
+
+    // when: LDX(2) + BNE(4) + BNE(3)
+    const s32 cycles_used = Execute(2 + 4 + 3);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(9, cycles_used);
+    TEST_ASSERT_EQUAL_HEX16(0x0316, cpu.program_counter);
+    TEST_ASSERT_EQUAL_UINT64(2, opcode_stats.counters[INS_BNE].branches_taken);
+    TEST_ASSERT_EQUAL_UINT64(1, opcode_stats.counters[INS_BNE].page_crossings);
+    TEST_ASSERT_EQUAL_UINT64(4 + 3, Opcode_Stats_Cycles(INS_BNE));
+}
+
+void Opcode_Stats_Count_The_Decimal_Mode_Cycle_With_The_Dispatch_Table(void)
+{
+    // given: ADC #$01 ; ADC #$01 in decimal mode
+    const u8 program[] = {INS_ADC_IM, 0x01, INS_ADC_IM, 0x01};
+    memcpy(&mem.data[0x0200], program, sizeof(program));
+    cpu.program_counter = 0x0200;
+    cpu.D               = 1;
+
+    // when:
+    const s32 cycles_used = Execute_Dispatch_Table(4);
+
+    // then: the 65C02 takes a cycle more in decimal mode, it is no branch
+#if H6502_IS_CMOS
+    const uint64_t EXPECTED_CYCLES = 2 * 3;
+#else
+    const uint64_t EXPECTED_CYCLES = 2 * 2;
+#endif
+    TEST_ASSERT_EQUAL_UINT64(2, opcode_stats.counters[INS_ADC_IM].executions);
+    TEST_ASSERT_EQUAL_UINT64(EXPECTED_CYCLES, Opcode_Stats_Cycles(INS_ADC_IM));
+    TEST_ASSERT_EQUAL_UINT64((u32)cycles_used, Opcode_Stats_Cycles(INS_ADC_IM));
+    TEST_ASSERT_EQUAL_UINT64(0, opcode_stats.counters[INS_ADC_IM].branches_taken);
+}
+
+void Opcode_Stats_Can_Be_Written_As_CSV(void)
+{
+    // given:
+    Load_Test_Program();
+    Execute(43);
+
+    // when:
+    FILE *file = tmpfile();
+    TEST_ASSERT_NOT_NULL(file);
+    Opcode_Stats_Write_CSV(file);
+    rewind(file);
+
+    // then:
+    char line[256];
+    TEST_ASSERT_NOT_NULL(fgets(line, sizeof(line), file));
+    TEST_ASSERT_EQUAL_STRING("opcode,mnemonic,mode,executions,cycles,page_crossings,branches_taken,branches_not_taken\n", line);
+
+    int lines_found = 0;
+    while (fgets(line, sizeof(line), file))
+    {
+        if (strcmp(line, "0xBD,LDA,ABS_X,6,27,3,0,0\n") == 0 || strcmp(line, "0xD0,BNE,REL,3,8,0,2,1\n") == 0)
+            lines_found++;
+    }
+    TEST_ASSERT_EQUAL_INT(2, lines_found);
+
+    fclose(file);
+}
+
+void Opcode_Stats_Can_Be_Written_As_JSON(void)
+{
+    // given:
+    Load_Test_Program();
+    Execute(43);
+
+    // when:
+    FILE *file = tmpfile();
+    TEST_ASSERT_NOT_NULL(file);
+    Opcode_Stats_Write_JSON(file);
+    rewind(file);
+
+    char   text[4096] = {0};
+    size_t length     = fread(text, 1, sizeof(text) - 1, file);
+    fclose(file);
+
+    // then:
+    TEST_ASSERT_GREATER_THAN(0, length);
+    TEST_ASSERT_NOT_NULL(strstr(text, "{\"opcode\": 189, \"mnemonic\": \"LDA\", \"mode\": \"ABS_X\", \"executions\": 6"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "{\"mode\": \"REL\", \"executions\": 3, \"cycles\": 8}"));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(Opcode_Stats_Count_Executions_And_Cycles);
+    RUN_TEST(Opcode_Stats_Count_Branches_Taken_And_Not_Taken);
+    RUN_TEST(Opcode_Stats_Count_A_Branch_Into_Another_Page_As_A_Page_Crossing);
+    RUN_TEST(Opcode_Stats_Count_The_Decimal_Mode_Cycle_With_The_Dispatch_Table);
+    RUN_TEST(Opcode_Stats_Can_Be_Written_As_CSV);
+    RUN_TEST(Opcode_Stats_Can_Be_Written_As_JSON);
+
+    return UNITY_END();
+}
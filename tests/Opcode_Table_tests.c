@@ -0,0 +1,169 @@
+#include "Unity/unity.h"
+#include "h6502.h"
+
+#include <stdbool.h>
+
+// https://github.com/ThrowTheSwitch/Unity
+
+// The opcode table in opcodes.h generates the enum, the instruction
+// handlers, the cycle/length tables and the disassembler
+
+void setUp(void) /* Is run before every test, put unit init calls here. */
+{
+    Reset_CPU();
+}
+void tearDown(void) {} /* Is run after every test, put unit clean-up calls here. */
+
+void Opcode_Tables_Have_The_Documented_Cycles_And_Lengths(void)
+{
+    TEST_ASSERT_EQUAL_UINT8(2, Opcode_Cycles(INS_LDA_IM));
+    TEST_ASSERT_EQUAL_UINT8(2, Opcode_Bytes(INS_LDA_IM));
+    TEST_ASSERT_EQUAL_UINT8(4, Opcode_Cycles(INS_LDA_ABS_X));
+    TEST_ASSERT_EQUAL_UINT8(3, Opcode_Bytes(INS_LDA_ABS_X));
+    TEST_ASSERT_TRUE(Opcode_Page_Penalty(INS_LDA_ABS_X));
+    TEST_ASSERT_FALSE(Opcode_Page_Penalty(INS_STA_ABS_X));
+    TEST_ASSERT_EQUAL_UINT8(6, Opcode_Cycles(INS_JSR));
+    TEST_ASSERT_EQUAL_UINT8(7, Opcode_Cycles(INS_BRK));
+    TEST_ASSERT_EQUAL_UINT8(1, Opcode_Bytes(INS_RTS));
+    TEST_ASSERT_EQUAL_STRING("ADC", Opcode_Mnemonic(INS_ADC_IND_Y));
+    TEST_ASSERT_EQUAL_INT(MODE_IND_Y, Opcode_Address_Mode(INS_ADC_IND_Y));
+}
+
+void Opcode_Tables_Report_Unknown_Opcodes(void)
+{
+    TEST_ASSERT_FALSE(Opcode_Is_Valid(0x02));
+    TEST_ASSERT_NULL(Opcode_Mnemonic(0x02));
+    TEST_ASSERT_EQUAL_UINT8(0, Opcode_Cycles(0x02));
+    TEST_ASSERT_EQUAL_UINT8(0, Opcode_Bytes(0x02));
+}
+
+void Every_Valid_Opcode_Has_A_Handler(void)
+{
+    for (int opcode = 0; opcode < 256; opcode++)
+    {
+        TEST_ASSERT_EQUAL(Opcode_Is_Valid((u8)opcode), Get_Instruction_Handler((u8)opcode) != NULL);
+        if (Opcode_Is_Valid((u8)opcode))
+        {
+            TEST_ASSERT_NOT_EQUAL(0, Opcode_Cycles((u8)opcode));
+            TEST_ASSERT_NOT_EQUAL(0, Opcode_Bytes((u8)opcode));
+        }
+    }
+}
+
+static void Test_Disassemble(const u8 *bytes, u8 number_of_bytes, const char *expected)
+{
+    // given:
+    for (u8 i = 0; i < number_of_bytes; i++)
+    {
+        mem.data[0x1000 + i] = bytes[i];
+    }
+
+    // when:
+    char      buffer[32];
+    const u8 length = Disassemble(0x1000, buffer, sizeof(buffer));
+
+    // then:
+    TEST_ASSERT_EQUAL_STRING(expected, buffer);
+    TEST_ASSERT_EQUAL_UINT8(number_of_bytes, length);
+}
+
+void Disassemble_Formats_Each_Addressing_Mode(void)
+{
+    Test_Disassemble((const u8[]){INS_NOP}, 1, "NOP");
+    Test_Disassemble((const u8[]){INS_ASL}, 1, "ASL A");
+    Test_Disassemble((const u8[]){INS_LDA_IM, 0x42}, 2, "LDA #$42");
+    Test_Disassemble((const u8[]){INS_LDA_ZP, 0x42}, 2, "LDA $42");
+    Test_Disassemble((const u8[]){INS_LDA_ZP_X, 0x42}, 2, "LDA $42,X");
+    Test_Disassemble((const u8[]){INS_LDX_ZP_Y, 0x42}, 2, "LDX $42,Y");
+    Test_Disassemble((const u8[]){INS_LDA_ABS, 0x34, 0x12}, 3, "LDA $1234");
+    Test_Disassemble((const u8[]){INS_LDA_ABS_X, 0x34, 0x12}, 3, "LDA $1234,X");
+    Test_Disassemble((const u8[]){INS_LDA_ABS_Y, 0x34, 0x12}, 3, "LDA $1234,Y");
+    Test_Disassemble((const u8[]){INS_JMP_IND, 0x34, 0x12}, 3, "JMP ($1234)");
+    Test_Disassemble((const u8[]){INS_LDA_IND_X, 0x42}, 2, "LDA ($42,X)");
+    Test_Disassemble((const u8[]){INS_LDA_IND_Y, 0x42}, 2, "LDA ($42),Y");
+    Test_Disassemble((const u8[]){INS_BNE, 0xFE}, 2, "BNE $1000");
+    Test_Disassemble((const u8[]){0x02}, 1, ".byte $02");
+}
+
+void Both_Execution_Engines_Give_The_Same_Result(void)
+{
+    // given: count X down from 10, adding 3 to A each time
+    const u8 program[] = {
+        INS_LDX_IM, 0x0A,
+        INS_LDA_IM, 0x00,
+        INS_CLC,
+        INS_ADC_IM, 0x03,
+        INS_DEX,
+        INS_BNE, 0xFA,
+        INS_STA_ABS, 0x00, 0x30,
+    };
+    memcpy(&mem.data[0x0200], program, sizeof(program));
+    cpu.program_counter = 0x0200;
+
+    // when:
+    const s32 switch_cycles = Execute(100);
+    const CPU switch_cpu    = cpu;
+
+    Reset_CPU();
+    memcpy(&mem.data[0x0200], program, sizeof(program));
+    cpu.program_counter = 0x0200;
+
+    const s32 table_cycles = Execute_Dispatch_Table(100);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(switch_cycles, table_cycles);
+    TEST_ASSERT_EQUAL_UINT8(30, cpu.accumulator);
+    TEST_ASSERT_EQUAL_UINT8(30, mem.data[0x3000]);
+    TEST_ASSERT_EQUAL_UINT8(switch_cpu.accumulator, cpu.accumulator);
+    TEST_ASSERT_EQUAL_UINT8(switch_cpu.index_reg_X, cpu.index_reg_X);
+    TEST_ASSERT_EQUAL_UINT8(switch_cpu.PS, cpu.PS);
+    TEST_ASSERT_EQUAL_HEX16(switch_cpu.program_counter, cpu.program_counter);
+}
+
+void BRK_And_RTI_Return_After_The_Padding_Byte(void)
+{
+    // given:
+    cpu.program_counter = 0xFF00;
+    cpu.C               = 1;
+
+    mem.data[0xFF00] = INS_BRK;
+    mem.data[0xFF01] = 0xEA; // padding byte
+    mem.data[0xFFFE] = 0x00;
+    mem.data[0xFFFF] = 0x80;
+    mem.data[0x8000] = INS_RTI;
+
+    // when:
+    const s32 brk_cycles = Execute(7);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(7, brk_cycles);
+    TEST_ASSERT_EQUAL_HEX16(0x8000, cpu.program_counter);
+    TEST_ASSERT_TRUE(cpu.I);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, mem.data[0x1FF]);
+    TEST_ASSERT_EQUAL_HEX8(0x02, mem.data[0x1FE]);
+    TEST_ASSERT_TRUE(mem.data[0x1FD] & BREAK_FLAG_BIT);
+
+    // when:
+    const s32 rti_cycles = Execute(6);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(6, rti_cycles);
+    TEST_ASSERT_EQUAL_HEX16(0xFF02, cpu.program_counter);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, cpu.stack_pointer);
+    TEST_ASSERT_TRUE(cpu.C);
+    TEST_ASSERT_FALSE(cpu.I);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(Opcode_Tables_Have_The_Documented_Cycles_And_Lengths);
+    RUN_TEST(Opcode_Tables_Report_Unknown_Opcodes);
+    RUN_TEST(Every_Valid_Opcode_Has_A_Handler);
+    RUN_TEST(Disassemble_Formats_Each_Addressing_Mode);
+    RUN_TEST(Both_Execution_Engines_Give_The_Same_Result);
+    RUN_TEST(BRK_And_RTI_Return_After_The_Padding_Byte);
+
+    return UNITY_END();
+}
@@ -0,0 +1,160 @@
+#include "Unity/unity.h"
+#include "program_gen.h"
+
+#include <stdbool.h>
+
+// https://github.com/ThrowTheSwitch/Unity
+
+#define PROGRAM_SEEDS     2000
+#define PROGRAM_MAX_STEPS 10000
+
+static Program_Config    config;
+static Program_Generator generator;
+static Program           program;
+static Program           other;
+
+// Runs the loaded program an instruction at a time, false when it leaves its
+// code or goes deeper on the stack than the config allows
+static bool Run_To_Trap(void)
+{
+    for (u32 step = 0; step < PROGRAM_MAX_STEPS; step++)
+    {
+        if (cpu.program_counter == program.trap)
+            return true;
+        if (cpu.program_counter < program.address || cpu.program_counter >= program.address + program.size)
+            return false;
+        if (step >= 2 && cpu.stack_pointer < 0xFF - config.max_stack_depth)
+            return false;
+        Execute(1);
+    }
+    return false;
+}
+
+void setUp(void) /* Is run before every test, put unit init calls here. */
+{
+    Initialise_Memory();
+    Reset_CPU();
+    Program_Default_Config(&config);
+}
+void tearDown(void) /* Is run after every test, put unit clean-up calls here. */
+{
+}
+
+void Program_Gen_Makes_The_Same_Program_From_The_Same_Seed(void)
+{
+    // given:
+    TEST_ASSERT_TRUE(Program_Generator_Init(&generator, &config));
+
+    // when:
+    Program_Generate(&generator, 7, &program);
+    Program_Generate(&generator, 7, &other);
+
+    // then:
+    TEST_ASSERT_EQUAL_UINT32(program.size, other.size);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(program.code, other.code, program.size);
+
+    // when:
+    Program_Generate(&generator, 8, &other);
+
+    // then:
+    TEST_ASSERT_FALSE(program.size == other.size && memcmp(program.code, other.code, program.size) == 0);
+}
+
+void Program_Gen_Programs_Get_To_Their_Trap(void)
+{
+    // given: lots of branches, calls and stores into the code
+    config.branch_per_256  = 64;
+    config.call_per_256    = 32;
+    config.smc_per_256     = 32;
+    config.max_stack_depth = 8;
+    TEST_ASSERT_TRUE(Program_Generator_Init(&generator, &config));
+
+    for (uint64_t seed = 0; seed < PROGRAM_SEEDS; seed++)
+    {
+        // when:
+        Initialise_Memory();
+        Program_Generate(&generator, seed, &program);
+        Program_Load(&program);
+
+        // then:
+        TEST_ASSERT_TRUE_MESSAGE(Run_To_Trap(), "a program did not get to its trap");
+        TEST_ASSERT_EQUAL_HEX8(INS_JMP_ABS, mem.data[program.trap]);
+    }
+}
+
+void Program_Gen_Programs_Only_Write_To_Their_Regions(void)
+{
+    // given: small regions, memory marked everywhere else
+    config.data_low       = 0x3000;
+    config.data_high      = 0x30FF;
+    config.zero_page_low  = 0x80;
+    config.zero_page_high = 0x9F;
+    TEST_ASSERT_TRUE(Program_Generator_Init(&generator, &config));
+
+    for (uint64_t seed = 0; seed < PROGRAM_SEEDS; seed++)
+    {
+        memset(mem.data, 0xA5, MAX_MEM);
+        Program_Generate(&generator, seed, &program);
+        Program_Load(&program);
+
+        // when:
+        TEST_ASSERT_TRUE(Run_To_Trap());
+
+        // then:
+        for (u32 address = 0; address < MAX_MEM; address++)
+        {
+            const bool zero_page = (address >= 0x80 && address <= 0x9F);
+            const bool stack     = (address >= 0x0100 && address <= 0x01FF);
+            const bool data      = (address >= 0x3000 && address <= 0x30FF);
+            const bool code      = (address >= program.address && address < program.address + program.size);
+            if (!zero_page && !stack && !data && !code && mem.data[address] != 0xA5)
+                TEST_FAIL_MESSAGE("a program wrote outside its regions");
+        }
+    }
+}
+
+void Program_Gen_Picks_Opcodes_By_Weight(void)
+{
+    // given: INX only, nothing else
+    memset(config.opcode_weights, 0, sizeof(config.opcode_weights));
+    config.opcode_weights[INS_INX] = 1;
+    config.branch_per_256          = 0;
+    config.call_per_256            = 0;
+    config.smc_per_256             = 0;
+    TEST_ASSERT_TRUE(Program_Generator_Init(&generator, &config));
+
+    // when:
+    Program_Generate(&generator, 1, &program);
+    Program_Load(&program);
+
+    // then: the prologue, 32 INX and the trap
+    const u32 prologue = 3 + 8 * PROGRAM_POINTERS;
+    TEST_ASSERT_EQUAL_UINT32(prologue + 32 + 3, program.size);
+    for (u32 i = 0; i < 32; i++)
+        TEST_ASSERT_EQUAL_HEX8(INS_INX, program.code[prologue + i]);
+    TEST_ASSERT_TRUE(Run_To_Trap());
+    TEST_ASSERT_EQUAL_HEX8(0x1F, cpu.index_reg_X); // 0xFF from the prologue
+}
+
+void Program_Gen_Rejects_Regions_That_Overlap(void)
+{
+    // given: code at 0x0400-0x13FF
+    config.data_low  = 0x1000;
+    config.data_high = 0x1FFF;
+
+    // then:
+    TEST_ASSERT_FALSE(Program_Generator_Init(&generator, &config));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(Program_Gen_Makes_The_Same_Program_From_The_Same_Seed);
+    RUN_TEST(Program_Gen_Programs_Get_To_Their_Trap);
+    RUN_TEST(Program_Gen_Programs_Only_Write_To_Their_Regions);
+    RUN_TEST(Program_Gen_Picks_Opcodes_By_Weight);
+    RUN_TEST(Program_Gen_Rejects_Regions_That_Overlap);
+
+    return UNITY_END();
+}
@@ -0,0 +1,170 @@
+#include "Unity/unity.h"
+#include "counter_program.h"
+#include "rewind.h"
+
+#include <stdbool.h>
+
+// https://github.com/ThrowTheSwitch/Unity
+
+static Rewind rewind_buffer;
+
+void setUp(void) /* Is run before every test, put unit init calls here. */
+{
+    Initialise_Memory();
+    Reset_CPU();
+    Load_Counter();
+}
+void tearDown(void) /* Is run after every test, put unit clean-up calls here. */
+{
+    Rewind_Free(&rewind_buffer);
+}
+
+// The machine at the first instruction boundary at or after 'cycle', run from the start
+static uint64_t Run_To(uint64_t cycle, Memory *memory, CPU *state)
+{
+    Initialise_Memory();
+    Reset_CPU();
+    Load_Counter();
+
+    uint64_t now = 0;
+    while (now < cycle)
+        now += (uint64_t)Execute(1);
+    memcpy(memory->data, mem.data, MAX_MEM);
+    *state = cpu;
+    return now;
+}
+
+void Rewind_Goes_Back_To_The_Exact_Cycle(void)
+{
+    // given:
+    static Memory expected;
+    static Memory later;
+    CPU           expected_cpu;
+    CPU           later_cpu;
+    Run_To(500003, &later, &later_cpu);
+    const uint64_t cycle = Run_To(123457, &expected, &expected_cpu);
+    setUp();
+    TEST_ASSERT_TRUE(Rewind_Init(&rewind_buffer, 4 << 20, 10000));
+
+    // when:
+    Rewind_Execute(&rewind_buffer, 1000000);
+    const bool rewound = Rewind_To_Cycle(&rewind_buffer, 123457);
+
+    // then:
+    TEST_ASSERT_TRUE(rewound);
+    TEST_ASSERT_EQUAL_UINT64(cycle, rewind_buffer.cycle);
+    TEST_ASSERT_EQUAL_MEMORY(expected.data, mem.data, MAX_MEM);
+    TEST_ASSERT_EQUAL_HEX16(expected_cpu.program_counter, cpu.program_counter);
+    TEST_ASSERT_EQUAL_HEX8(expected_cpu.accumulator, cpu.accumulator);
+    TEST_ASSERT_EQUAL_HEX8(expected_cpu.index_reg_X, cpu.index_reg_X);
+    TEST_ASSERT_EQUAL_HEX8(expected_cpu.stack_pointer, cpu.stack_pointer);
+    TEST_ASSERT_EQUAL_HEX8(expected_cpu.PS, cpu.PS);
+
+    // when: running on from there is the same as the first time
+    Rewind_Execute(&rewind_buffer, 400000);
+    TEST_ASSERT_TRUE(Rewind_To_Cycle(&rewind_buffer, 500003));
+
+    // then:
+    TEST_ASSERT_EQUAL_MEMORY(later.data, mem.data, MAX_MEM);
+    TEST_ASSERT_EQUAL_HEX16(later_cpu.program_counter, cpu.program_counter);
+}
+
+void Rewind_Keeps_Only_The_Changes(void)
+{
+    // given:
+    TEST_ASSERT_TRUE(Rewind_Init(&rewind_buffer, 4 << 20, 100000));
+
+    // when: nothing changed, then one byte
+    Rewind_Snapshot(&rewind_buffer);
+    mem.data[0x8000] = 0x42;
+    Rewind_Snapshot(&rewind_buffer);
+
+    // then: 2 varints (0x8000 and 1) and the byte
+    TEST_ASSERT_EQUAL_UINT32(2, rewind_buffer.count);
+    TEST_ASSERT_EQUAL_UINT32(0, rewind_buffer.frames[0].size);
+    TEST_ASSERT_EQUAL_UINT32(3 + 1 + 1, rewind_buffer.frames[1].size);
+
+    // when: a run of the counter program
+    Rewind_Execute(&rewind_buffer, 1000000);
+
+    // then: the counters and the stack change, not the other 64 KB
+    TEST_ASSERT_TRUE(Rewind_Delta_Bytes(&rewind_buffer) < rewind_buffer.count * 600);
+}
+
+void Rewind_Memory_Stays_Within_The_Budget(void)
+{
+    // given: an index of 128 states, about 128000 cycles
+    TEST_ASSERT_TRUE(Rewind_Init(&rewind_buffer, 128 << 10, 1000));
+    const size_t ring_size = rewind_buffer.ring_size;
+
+    // when:
+    Rewind_Execute(&rewind_buffer, 2000000);
+
+    // then: the oldest states are gone
+    TEST_ASSERT_TRUE(ring_size <= (128 << 10));
+    TEST_ASSERT_TRUE(Rewind_Delta_Bytes(&rewind_buffer) + rewind_buffer.count <= ring_size);
+    TEST_ASSERT_TRUE(Rewind_Oldest_Cycle(&rewind_buffer) > 1000000);
+    TEST_ASSERT_FALSE(Rewind_To_Cycle(&rewind_buffer, 1000));
+    TEST_ASSERT_FALSE(Rewind_To_Cycle(&rewind_buffer, rewind_buffer.cycle + 1));
+
+    // and what is left can still be reached
+    static Memory expected;
+    CPU           expected_cpu;
+    const uint64_t cycle = Rewind_Oldest_Cycle(&rewind_buffer) + 17;
+    const uint64_t landed = Run_To(cycle, &expected, &expected_cpu);
+    TEST_ASSERT_TRUE(Rewind_To_Cycle(&rewind_buffer, cycle));
+    TEST_ASSERT_EQUAL_UINT64(landed, rewind_buffer.cycle);
+    TEST_ASSERT_EQUAL_MEMORY(expected.data, mem.data, MAX_MEM);
+}
+
+void Rewind_Changes_Nothing_When_A_Delta_Is_Broken(void)
+{
+    // given: a machine that ran on past its newest state, and the delta
+    // before the newest one cut short by a byte
+    TEST_ASSERT_TRUE(Rewind_Init(&rewind_buffer, 4 << 20, 10000));
+    Rewind_Execute(&rewind_buffer, 100000);
+    Rewind_Execute(&rewind_buffer, 1234);
+    static Memory  before;
+    const CPU      before_cpu   = cpu;
+    const uint64_t before_cycle = rewind_buffer.cycle;
+    const u32      before_count = rewind_buffer.count;
+    memcpy(before.data, mem.data, MAX_MEM);
+    Rewind_Frame *broken = &rewind_buffer.frames[(rewind_buffer.first + rewind_buffer.count - 2) % rewind_buffer.frame_capacity];
+    broken->size--;
+
+    // when:
+    const bool rewound = Rewind_To_Cycle(&rewind_buffer, broken->cycle);
+
+    // then: the newest delta applied, the broken one did not, neither reached the machine
+    TEST_ASSERT_FALSE(rewound);
+    TEST_ASSERT_EQUAL_MEMORY(before.data, mem.data, MAX_MEM);
+    TEST_ASSERT_EQUAL_HEX16(before_cpu.program_counter, cpu.program_counter);
+    TEST_ASSERT_EQUAL_HEX8(before_cpu.accumulator, cpu.accumulator);
+    TEST_ASSERT_EQUAL_HEX8(before_cpu.index_reg_X, cpu.index_reg_X);
+    TEST_ASSERT_EQUAL_UINT64(before_cycle, rewind_buffer.cycle);
+    TEST_ASSERT_EQUAL_UINT32(before_count, rewind_buffer.count);
+
+    // when: the delta is whole again
+    broken->size++;
+    static Memory  expected;
+    CPU            expected_cpu;
+    const uint64_t landed = Run_To(broken->cycle, &expected, &expected_cpu);
+
+    // then:
+    TEST_ASSERT_TRUE(Rewind_To_Cycle(&rewind_buffer, broken->cycle));
+    TEST_ASSERT_EQUAL_UINT64(landed, rewind_buffer.cycle);
+    TEST_ASSERT_EQUAL_MEMORY(expected.data, mem.data, MAX_MEM);
+    TEST_ASSERT_EQUAL_HEX16(expected_cpu.program_counter, cpu.program_counter);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(Rewind_Goes_Back_To_The_Exact_Cycle);
+    RUN_TEST(Rewind_Keeps_Only_The_Changes);
+    RUN_TEST(Rewind_Memory_Stays_Within_The_Budget);
+    RUN_TEST(Rewind_Changes_Nothing_When_A_Delta_Is_Broken);
+
+    return UNITY_END();
+}
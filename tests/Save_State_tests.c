@@ -0,0 +1,161 @@
+#include "Unity/unity.h"
+#include "h6502.h"
+
+#include <stdbool.h>
+
+// https://github.com/ThrowTheSwitch/Unity
+
+#define SAVE_STATE_TEST_FILE "Save_State_tests.sav"
+
+static uint8_t state[SAVE_STATE_MAX_SIZE];
+
+void setUp(void) /* Is run before every test, put unit init calls here. */
+{
+    Initialise_Memory();
+    Reset_CPU();
+}
+void tearDown(void) /* Is run after every test, put unit clean-up calls here. */
+{
+    remove(SAVE_STATE_TEST_FILE);
+}
+
+static void Set_Up_Machine(void)
+{
+    cpu.program_counter = 0xC0DE;
+    cpu.stack_pointer   = 0xF3;
+    cpu.accumulator     = 0x11;
+    cpu.index_reg_X     = 0x22;
+    cpu.index_reg_Y     = 0x33;
+    cpu.PS              = 0xE5;
+
+    memset(&mem.data[0x8000], 0xFF, 0x2000); // filled pages
+    for (u32 address = 0x0200; address < 0x0400; address++)
+        mem.data[address] = (u8)(address * 7);
+    mem.data[0x00FF] = 0x01;
+    mem.data[0xFFFF] = 0x80;
+}
+
+void Save_State_Loads_What_Was_Saved(void)
+{
+    // given:
+    Set_Up_Machine();
+    static Memory saved;
+    memcpy(saved.data, mem.data, MAX_MEM);
+    const size_t size = Save_State_Write(state, sizeof(state));
+
+    // when:
+    Initialise_Memory();
+    Reset_CPU();
+    TEST_ASSERT_TRUE(Save_State_Read(state, size));
+
+    // then:
+    TEST_ASSERT_EQUAL_HEX16(0xC0DE, cpu.program_counter);
+    TEST_ASSERT_EQUAL_HEX8(0xF3, cpu.stack_pointer);
+    TEST_ASSERT_EQUAL_HEX8(0x11, cpu.accumulator);
+    TEST_ASSERT_EQUAL_HEX8(0x22, cpu.index_reg_X);
+    TEST_ASSERT_EQUAL_HEX8(0x33, cpu.index_reg_Y);
+    TEST_ASSERT_EQUAL_HEX8(0xE5, cpu.PS);
+    TEST_ASSERT_EQUAL_UINT8(1, cpu.N);
+    TEST_ASSERT_EQUAL_UINT8(1, cpu.C);
+    TEST_ASSERT_EQUAL_MEMORY(saved.data, mem.data, MAX_MEM);
+
+    // only pages that are not all one byte are stored in full
+    TEST_ASSERT_EQUAL_size_t(SAVE_STATE_MAX_SIZE - 252 * 256 + 0x20, size);
+}
+
+void Save_State_Layout_Is_Little_Endian_Bytes(void)
+{
+    // given:
+    Set_Up_Machine();
+
+    // when:
+    const size_t size = Save_State_Write(state, sizeof(state));
+
+    // then:
+    TEST_ASSERT_EQUAL_MEMORY("H6502SAV", state, 8);
+    TEST_ASSERT_EQUAL_UINT8(SAVE_STATE_VERSION, state[8]);
+    TEST_ASSERT_EQUAL_UINT8(H6502_VARIANT, state[9]);
+
+    const uint8_t cpu_chunk[] = {'C', 'P', 'U', ' ', 8, 0, 0, 0, 0xDE, 0xC0, 0xF3, 0x11, 0x22, 0x33, 0xE5, 0};
+    TEST_ASSERT_EQUAL_MEMORY(cpu_chunk, &state[16], sizeof(cpu_chunk));
+
+    const uint8_t *kinds = &state[16 + 16 + 8];
+    TEST_ASSERT_EQUAL_MEMORY("MEM ", kinds - 8, 4);
+    TEST_ASSERT_EQUAL_UINT8(SAVE_STATE_PAGE_RAW, kinds[0x00]);
+    TEST_ASSERT_EQUAL_UINT8(SAVE_STATE_PAGE_ZERO, kinds[0x01]);
+    TEST_ASSERT_EQUAL_UINT8(SAVE_STATE_PAGE_RAW, kinds[0x02]);
+    TEST_ASSERT_EQUAL_UINT8(SAVE_STATE_PAGE_FILL, kinds[0x80]);
+    TEST_ASSERT_EQUAL_UINT8(SAVE_STATE_PAGE_RAW, kinds[0xFF]);
+
+    TEST_ASSERT_EQUAL_MEMORY("END \0\0\0\0", &state[size - 8], 8);
+}
+
+void Save_State_Refuses_Broken_States_Without_Changing_The_Machine(void)
+{
+    // given:
+    Set_Up_Machine();
+    const size_t size = Save_State_Write(state, sizeof(state));
+    Reset_CPU();
+    mem.data[0x0200] = 0x99;
+
+    // then: cut short, bad magic, unknown page kind
+    TEST_ASSERT_FALSE(Save_State_Read(state, size - 1));
+    state[0] = 'X';
+    TEST_ASSERT_FALSE(Save_State_Read(state, size));
+    state[0] = 'H';
+    state[16 + 16 + 8 + 1] = 9;
+    TEST_ASSERT_FALSE(Save_State_Read(state, size));
+
+    TEST_ASSERT_EQUAL_HEX16(0xFFFC, cpu.program_counter);
+    TEST_ASSERT_EQUAL_HEX8(0x99, mem.data[0x0200]);
+}
+
+void Save_State_Skips_Unknown_Chunks(void)
+{
+    // given: a chunk from a later version before the end
+    Set_Up_Machine();
+    const size_t  size    = Save_State_Write(state, sizeof(state));
+    static uint8_t later[SAVE_STATE_MAX_SIZE + 16];
+    const uint8_t extra[] = {'I', 'R', 'Q', ' ', 4, 0, 0, 0, 1, 2, 3, 4};
+    memcpy(later, state, size - 8);
+    memcpy(&later[size - 8], extra, sizeof(extra));
+    memcpy(&later[size - 8 + sizeof(extra)], &state[size - 8], 8);
+
+    // when:
+    Reset_CPU();
+    const bool loaded = Save_State_Read(later, size + sizeof(extra));
+
+    // then:
+    TEST_ASSERT_TRUE(loaded);
+    TEST_ASSERT_EQUAL_HEX16(0xC0DE, cpu.program_counter);
+}
+
+void Save_State_Goes_Through_A_File(void)
+{
+    // given:
+    Set_Up_Machine();
+
+    // when:
+    TEST_ASSERT_TRUE(Save_State_Save(SAVE_STATE_TEST_FILE));
+    Initialise_Memory();
+    Reset_CPU();
+    TEST_ASSERT_TRUE(Save_State_Load(SAVE_STATE_TEST_FILE));
+
+    // then:
+    TEST_ASSERT_EQUAL_HEX16(0xC0DE, cpu.program_counter);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, mem.data[0x9FFF]);
+    TEST_ASSERT_EQUAL_HEX8(0x80, mem.data[0xFFFF]);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(Save_State_Loads_What_Was_Saved);
+    RUN_TEST(Save_State_Layout_Is_Little_Endian_Bytes);
+    RUN_TEST(Save_State_Refuses_Broken_States_Without_Changing_The_Machine);
+    RUN_TEST(Save_State_Skips_Unknown_Chunks);
+    RUN_TEST(Save_State_Goes_Through_A_File);
+
+    return UNITY_END();
+}
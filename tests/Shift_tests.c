@@ -240,7 +240,11 @@ void ASL_ABS_X_Can_Shift_The_Value_Of_One(void)
     mem.data[0xFF02]        = 0x80;
     mem.data[0x8000 + 0x10] = 1;
 
+#if H6502_IS_CMOS
+    const s32 EXPECTED_CYCLES = 6; // 65C02 only adds a cycle when crossing a page
+#else
     const s32 EXPECTED_CYCLES = 7;
+#endif
 
     // when:
     const s32 actual_cycles = Execute(EXPECTED_CYCLES);
@@ -269,7 +273,11 @@ void ASL_ABS_X_Can_Shift_A_Negative_Value(void)
     mem.data[0xFF02]        = 0x80;
     mem.data[0x8000 + 0x10] = 0b11000010;
 
+#if H6502_IS_CMOS
+    const s32 EXPECTED_CYCLES = 6; // 65C02 only adds a cycle when crossing a page
+#else
     const s32 EXPECTED_CYCLES = 7;
+#endif
 
     // when:
     const s32 actual_cycles = Execute(EXPECTED_CYCLES);
@@ -509,7 +517,11 @@ void LSR_ABS_X_Can_Shift_The_Value_Of_One(void)
     mem.data[0xFF02]        = 0x80;
     mem.data[0x8000 + 0x10] = 1;
 
+#if H6502_IS_CMOS
+    const s32 EXPECTED_CYCLES = 6; // 65C02 only adds a cycle when crossing a page
+#else
     const s32 EXPECTED_CYCLES = 7;
+#endif
 
     // when:
     const s32 actual_cycles = Execute(EXPECTED_CYCLES);
@@ -537,7 +549,11 @@ void LSR_ABS_X_Can_Shift_A_Zero_Into_The_Carry_Flag(void)
     mem.data[0xFF02]        = 0x80;
     mem.data[0x8000 + 0x10] = 8;
 
+#if H6502_IS_CMOS
+    const s32 EXPECTED_CYCLES = 6; // 65C02 only adds a cycle when crossing a page
+#else
     const s32 EXPECTED_CYCLES = 7;
+#endif
 
     // when:
     const s32 actual_cycles = Execute(EXPECTED_CYCLES);
@@ -879,7 +895,7 @@ void ROR_Can_Shift_The_Carry_Flag_Into_The_Operand(void)
 
     // then:
     TEST_ASSERT_EQUAL_INT32(EXPECTED_CYCLES, actual_cycles);
-    EXPECT_EQ(cpu.accumulator, 0b10000000);
+    TEST_ASSERT_EQUAL_UINT8(0b10000000, cpu.accumulator);
 
     TEST_ASSERT_FALSE(cpu.C);
     TEST_ASSERT_FALSE(cpu.Z);
@@ -904,7 +920,7 @@ void ROR_Can_Shift_A_Value_Into_The_Carry_Flag(void)
 
     // then:
     TEST_ASSERT_EQUAL_INT32(EXPECTED_CYCLES, actual_cycles);
-    EXPECT_EQ(cpu.accumulator, 0);
+    TEST_ASSERT_EQUAL_UINT8(0, cpu.accumulator);
 
     TEST_ASSERT_TRUE(cpu.C);
     TEST_ASSERT_TRUE(cpu.Z);
@@ -929,7 +945,7 @@ void ROR_Can_Rotate_A_Number(void)
 
     // then:
     TEST_ASSERT_EQUAL_INT32(EXPECTED_CYCLES, actual_cycles);
-    EXPECT_EQ(cpu.accumulator, 0b10110110);
+    TEST_ASSERT_EQUAL_UINT8(0b10110110, cpu.accumulator);
 
     TEST_ASSERT_TRUE(cpu.C);
     TEST_ASSERT_FALSE(cpu.Z);
@@ -955,7 +971,7 @@ void ROR_ZP_Can_Shift_The_Carry_Flag_Into_The_Operand(void)
 
     // then:
     TEST_ASSERT_EQUAL_INT32(EXPECTED_CYCLES, actual_cycles);
-    EXPECT_EQ(mem.data[0x0042], 0b10000000);
+    TEST_ASSERT_EQUAL_UINT8(0b10000000, mem.data[0x0042]);
 
     TEST_ASSERT_FALSE(cpu.C);
     TEST_ASSERT_FALSE(cpu.Z);
@@ -981,7 +997,7 @@ void ROR_ZP_Can_Shift_A_Value_Into_The_Carry_Flag(void)
 
     // then:
     TEST_ASSERT_EQUAL_INT32(EXPECTED_CYCLES, actual_cycles);
-    EXPECT_EQ(mem.data[0x0042], 0);
+    TEST_ASSERT_EQUAL_UINT8(0, mem.data[0x0042]);
 
     TEST_ASSERT_TRUE(cpu.C);
     TEST_ASSERT_TRUE(cpu.Z);
@@ -1007,7 +1023,7 @@ void ROR_ZP_Can_Rotate_A_Number(void)
 
     // then:
     TEST_ASSERT_EQUAL_INT32(EXPECTED_CYCLES, actual_cycles);
-    EXPECT_EQ(mem.data[0x0042], 0b10110110);
+    TEST_ASSERT_EQUAL_UINT8(0b10110110, mem.data[0x0042]);
 
     TEST_ASSERT_TRUE(cpu.C);
     TEST_ASSERT_FALSE(cpu.Z);
@@ -1034,7 +1050,7 @@ void ROR_ZP_X_Can_Shift_The_Carry_Flag_Into_The_Operand(void)
 
     // then:
     TEST_ASSERT_EQUAL_INT32(EXPECTED_CYCLES, actual_cycles);
-    EXPECT_EQ(mem.data[0x0042 + 0x10], 0b10000000);
+    TEST_ASSERT_EQUAL_UINT8(0b10000000, mem.data[0x0042 + 0x10]);
 
     TEST_ASSERT_FALSE(cpu.C);
     TEST_ASSERT_FALSE(cpu.Z);
@@ -1061,7 +1077,7 @@ void ROR_ZP_X_Can_Shift_A_Value_Into_The_Carry_Flag(void)
 
     // then:
     TEST_ASSERT_EQUAL_INT32(EXPECTED_CYCLES, actual_cycles);
-    EXPECT_EQ(mem.data[0x0042 + 0x10], 0);
+    TEST_ASSERT_EQUAL_UINT8(0, mem.data[0x0042 + 0x10]);
 
     TEST_ASSERT_TRUE(cpu.C);
     TEST_ASSERT_TRUE(cpu.Z);
@@ -1088,7 +1104,7 @@ void ROR_ZP_X_Can_Rotate_A_Number(void)
 
     // then:
     TEST_ASSERT_EQUAL_INT32(EXPECTED_CYCLES, actual_cycles);
-    EXPECT_EQ(mem.data[0x0042 + 0x10], 0b10110110);
+    TEST_ASSERT_EQUAL_UINT8(0b10110110, mem.data[0x0042 + 0x10]);
 
     TEST_ASSERT_TRUE(cpu.C);
     TEST_ASSERT_FALSE(cpu.Z);
@@ -1115,7 +1131,7 @@ void ROR_ABS_Can_Shift_The_Carry_Flag_Into_The_Operand(void)
 
     // then:
     TEST_ASSERT_EQUAL_INT32(EXPECTED_CYCLES, actual_cycles);
-    EXPECT_EQ(mem.data[0x8000], 0b10000000);
+    TEST_ASSERT_EQUAL_UINT8(0b10000000, mem.data[0x8000]);
 
     TEST_ASSERT_FALSE(cpu.C);
     TEST_ASSERT_FALSE(cpu.Z);
@@ -1142,7 +1158,7 @@ void ROR_ABS_Can_Shift_A_Value_Into_The_Carry_Flag(void)
 
     // then:
     TEST_ASSERT_EQUAL_INT32(EXPECTED_CYCLES, actual_cycles);
-    EXPECT_EQ(mem.data[0x8000], 0);
+    TEST_ASSERT_EQUAL_UINT8(0, mem.data[0x8000]);
 
     TEST_ASSERT_TRUE(cpu.C);
     TEST_ASSERT_TRUE(cpu.Z);
@@ -1169,7 +1185,7 @@ void ROR_ABS_Can_Rotate_A_Number(void)
 
     // then:
     TEST_ASSERT_EQUAL_INT32(EXPECTED_CYCLES, actual_cycles);
-    EXPECT_EQ(mem.data[0x8000], 0b10110110);
+    TEST_ASSERT_EQUAL_UINT8(0b10110110, mem.data[0x8000]);
 
     TEST_ASSERT_TRUE(cpu.C);
     TEST_ASSERT_FALSE(cpu.Z);
@@ -1190,14 +1206,18 @@ void ROR_ABS_X_Can_Shift_The_Carry_Flag_Into_The_Operand(void)
     mem.data[0xFF02]        = 0x80;
     mem.data[0x8000 + 0x10] = 0;
 
+#if H6502_IS_CMOS
+    const s32 EXPECTED_CYCLES = 6; // 65C02 only adds a cycle when crossing a page
+#else
     const s32 EXPECTED_CYCLES = 7;
+#endif
 
     // when:
     const s32 actual_cycles = Execute(EXPECTED_CYCLES);
 
     // then:
     TEST_ASSERT_EQUAL_INT32(EXPECTED_CYCLES, actual_cycles);
-    EXPECT_EQ(mem.data[0x8000 + 0x10], 0b10000000);
+    TEST_ASSERT_EQUAL_UINT8(0b10000000, mem.data[0x8000 + 0x10]);
 
     TEST_ASSERT_FALSE(cpu.C);
     TEST_ASSERT_FALSE(cpu.Z);
@@ -1218,14 +1238,18 @@ void ROR_ABS_X_Can_Shift_A_Value_Into_The_Carry_Flag(void)
     mem.data[0xFF02]        = 0x80;
     mem.data[0x8000 + 0x10] = 1;
 
+#if H6502_IS_CMOS
+    const s32 EXPECTED_CYCLES = 6; // 65C02 only adds a cycle when crossing a page
+#else
     const s32 EXPECTED_CYCLES = 7;
+#endif
 
     // when:
     const s32 actual_cycles = Execute(EXPECTED_CYCLES);
 
     // then:
     TEST_ASSERT_EQUAL_INT32(EXPECTED_CYCLES, actual_cycles);
-    EXPECT_EQ(mem.data[0x8000 + 0x10], 0);
+    TEST_ASSERT_EQUAL_UINT8(0, mem.data[0x8000 + 0x10]);
 
     TEST_ASSERT_TRUE(cpu.C);
     TEST_ASSERT_TRUE(cpu.Z);
@@ -1275,19 +1299,19 @@ int main(void)
     RUN_TEST(ROL_ZP_X_Can_Shift_A_Value_That_Result_In_A_Negative_Value);
 
     // ROR (ROtate Right)
-    RUN_TESTS(ROR_Can_Shift_The_Carry_Flag_Into_The_Operand);
-    RUN_TESTS(ROR_Can_Shift_A_Value_Into_The_Carry_Flag);
-    RUN_TESTS(ROR_Can_Rotate_A_Number);
-    RUN_TESTS(ROR_ZP_Can_Shift_The_Carry_Flag_Into_The_Operand);
-    RUN_TESTS(ROR_ZP_Can_Shift_A_Value_Into_The_Carry_Flag);
-    RUN_TESTS(ROR_ZP_Can_Rotate_A_Number);
-    RUN_TESTS(ROR_ZP_X_Can_Shift_The_Carry_Flag_Into_The_Operand);
-    RUN_TESTS(ROR_ZP_X_Can_Shift_A_Value_Into_The_Carry_Flag);
-    RUN_TESTS(ROR_ZP_X_Can_Rotate_A_Number);
-    RUN_TESTS(ROR_ABS_Can_Shift_The_Carry_Flag_Into_The_Operand);
-    RUN_TESTS(ROR_ABS_Can_Shift_A_Value_Into_The_Carry_Flag);
-    RUN_TESTS(ROR_ABS_Can_Rotate_A_Number);
-    RUN_TESTS(ROR_ABS_X_Can_Shift_The_Carry_Flag_Into_The_Operand);
-    RUN_TESTS(ROR_ABS_X_Can_Shift_A_Value_Into_The_Carry_Flag);
+    RUN_TEST(ROR_Can_Shift_The_Carry_Flag_Into_The_Operand);
+    RUN_TEST(ROR_Can_Shift_A_Value_Into_The_Carry_Flag);
+    RUN_TEST(ROR_Can_Rotate_A_Number);
+    RUN_TEST(ROR_ZP_Can_Shift_The_Carry_Flag_Into_The_Operand);
+    RUN_TEST(ROR_ZP_Can_Shift_A_Value_Into_The_Carry_Flag);
+    RUN_TEST(ROR_ZP_Can_Rotate_A_Number);
+    RUN_TEST(ROR_ZP_X_Can_Shift_The_Carry_Flag_Into_The_Operand);
+    RUN_TEST(ROR_ZP_X_Can_Shift_A_Value_Into_The_Carry_Flag);
+    RUN_TEST(ROR_ZP_X_Can_Rotate_A_Number);
+    RUN_TEST(ROR_ABS_Can_Shift_The_Carry_Flag_Into_The_Operand);
+    RUN_TEST(ROR_ABS_Can_Shift_A_Value_Into_The_Carry_Flag);
+    RUN_TEST(ROR_ABS_Can_Rotate_A_Number);
+    RUN_TEST(ROR_ABS_X_Can_Shift_The_Carry_Flag_Into_The_Operand);
+    RUN_TEST(ROR_ABS_X_Can_Shift_A_Value_Into_The_Carry_Flag);
     return UNITY_END();
 }
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "Unity/unity.h"
+#include "h6502.h"
+#include "single_step.h"
+
+#include <stdbool.h>
+
+// https://github.com/ThrowTheSwitch/Unity
+
+// LDA #$5C at 0x0200, and STA $10 with a stray key and a "final" that is wrong
+static const char single_step_json[] =
+    "[\n"
+    "  {\"name\": \"a9 5c 1e\", \"initial\": {\"pc\": 512, \"s\": 253, \"a\": 1, \"x\": 2, \"y\": 3, \"p\": 164,\n"
+    "   \"ram\": [[512, 169], [513, 92]]},\n"
+    "   \"final\": {\"pc\": 514, \"s\": 253, \"a\": 92, \"x\": 2, \"y\": 3, \"p\": 36, \"ram\": [[512, 169], [513, 92]]},\n"
+    "   \"cycles\": [[512, 169, \"read\"], [513, 92, \"read\"]]},\n"
+    "  {\"name\": \"85 10\", \"note\": {\"seen\": [1, \"]\", null]}, \"initial\": {\"pc\": 768, \"s\": 255, \"a\": 66, \"x\": 0, \"y\": 0,\n"
+    "   \"p\": 32, \"ram\": [[768, 133], [769, 16], [16, 0]]},\n"
+    "   \"final\": {\"pc\": 770, \"s\": 255, \"a\": 66, \"x\": 0, \"y\": 0, \"p\": 32, \"ram\": [[768, 133], [769, 16], [16, 67]]},\n"
+    "   \"cycles\": [[768, 133, \"read\"], [769, 16, \"read\"], [16, 66, \"write\"]]}\n"
+    "]\n";
+
+static FILE *Open_JSON(const char *text)
+{
+    FILE *file = tmpfile();
+    TEST_ASSERT_NOT_NULL(file);
+    fputs(text, file);
+    rewind(file);
+    return file;
+}
+
+void setUp(void) /* Is run before every test, put unit init calls here. */
+{
+    Initialise_Memory();
+    Reset_CPU();
+}
+void tearDown(void) /* Is run after every test, put unit clean-up calls here. */
+{
+}
+
+void Single_Step_Reads_Cases_One_At_A_Time(void)
+{
+    // given:
+    Single_Step_Reader *reader = Single_Step_Open_File(Open_JSON(single_step_json), true);
+    TEST_ASSERT_NOT_NULL(reader);
+    static Single_Step_Case test;
+
+    // when:
+    const bool first = Single_Step_Next(reader, &test);
+
+    // then:
+    TEST_ASSERT_TRUE(first);
+    TEST_ASSERT_EQUAL_STRING("a9 5c 1e", test.name);
+    TEST_ASSERT_EQUAL_HEX16(0x0200, test.initial.pc);
+    TEST_ASSERT_EQUAL_HEX8(0xFD, test.initial.s);
+    TEST_ASSERT_EQUAL_HEX8(0xA4, test.initial.p);
+    TEST_ASSERT_EQUAL_UINT32(2, test.initial.ram_count);
+    TEST_ASSERT_EQUAL_HEX16(0x0201, test.initial.address[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x5C, test.initial.value[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x5C, test.final.a);
+    TEST_ASSERT_EQUAL_UINT32(2, test.cycles);
+
+    // when: the next case has a key the reader does not know
+    const bool second = Single_Step_Next(reader, &test);
+
+    // then:
+    TEST_ASSERT_TRUE(second);
+    TEST_ASSERT_EQUAL_STRING("85 10", test.name);
+    TEST_ASSERT_EQUAL_UINT32(3, test.final.ram_count);
+    TEST_ASSERT_EQUAL_UINT32(3, test.cycles);
+    TEST_ASSERT_FALSE(Single_Step_Next(reader, &test));
+    TEST_ASSERT_FALSE(reader->error);
+    Single_Step_Close(reader);
+}
+
+void Single_Step_Runs_Cases_And_Reports_The_First_Difference(void)
+{
+    // given:
+    Single_Step_Reader *reader = Single_Step_Open_File(Open_JSON(single_step_json), true);
+    static Single_Step_Case test;
+    char                    failure[128] = "";
+
+    // when:
+    TEST_ASSERT_TRUE(Single_Step_Next(reader, &test));
+    const bool load_passed = Single_Step_Run(&test, failure, sizeof(failure));
+    TEST_ASSERT_TRUE(Single_Step_Next(reader, &test));
+    const bool store_passed = Single_Step_Run(&test, failure, sizeof(failure));
+    Single_Step_Close(reader);
+
+    // then: the store wrote 0x42, the case expects 0x43
+    TEST_ASSERT_TRUE(load_passed);
+    TEST_ASSERT_FALSE(store_passed);
+    TEST_ASSERT_EQUAL_STRING("85 10 : ram[0x0010] 0x42, expected 0x43", failure);
+    // the addresses the cases named are cleared for the next one
+    TEST_ASSERT_EQUAL_HEX8(0x00, mem.data[0x0010]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, mem.data[0x0200]);
+}
+
+void Single_Step_Checks_The_Cycle_Count(void)
+{
+    // given: LDA #$5C with three bus cycles instead of two
+    Single_Step_Reader *reader = Single_Step_Open_File(
+        Open_JSON("[{\"name\": \"a9 5c\", \"initial\": {\"pc\": 512, \"s\": 253, \"a\": 0, \"x\": 0, \"y\": 0, \"p\": 32,"
+                  " \"ram\": [[512, 169], [513, 92]]}, \"final\": {\"pc\": 514, \"s\": 253, \"a\": 92, \"x\": 0, \"y\": 0, \"p\": 32,"
+                  " \"ram\": []}, \"cycles\": [[512, 169, \"read\"], [513, 92, \"read\"], [514, 0, \"read\"]]}]"),
+        true);
+    static Single_Step_Case test;
+    char                    failure[128] = "";
+
+    // when:
+    TEST_ASSERT_TRUE(Single_Step_Next(reader, &test));
+    const bool passed = Single_Step_Run(&test, failure, sizeof(failure));
+    Single_Step_Close(reader);
+
+    // then:
+    TEST_ASSERT_FALSE(passed);
+    TEST_ASSERT_EQUAL_STRING("a9 5c : cycles 0x02, expected 0x03", failure);
+}
+
+void Single_Step_Stops_On_Bad_JSON(void)
+{
+    // given: the file ends in the middle of a case
+    Single_Step_Reader *reader = Single_Step_Open_File(Open_JSON("[{\"name\": \"a9 5c\", \"initial\": {\"pc\": 5"), true);
+    static Single_Step_Case test;
+
+    // when:
+    const bool read = Single_Step_Next(reader, &test);
+
+    // then:
+    TEST_ASSERT_FALSE(read);
+    TEST_ASSERT_TRUE(reader->error);
+    Single_Step_Close(reader);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(Single_Step_Reads_Cases_One_At_A_Time);
+    RUN_TEST(Single_Step_Runs_Cases_And_Reports_The_First_Difference);
+    RUN_TEST(Single_Step_Checks_The_Cycle_Count);
+    RUN_TEST(Single_Step_Stops_On_Bad_JSON);
+
+    return UNITY_END();
+}
@@ -0,0 +1,126 @@
+#define H6502_SNAPSHOT 1
+
+#include "Unity/unity.h"
+#include "h6502.h"
+
+#include <stdbool.h>
+
+// https://github.com/ThrowTheSwitch/Unity
+
+static Snapshot start;
+
+void setUp(void) /* Is run before every test, put unit init calls here. */
+{
+    Initialise_Memory();
+    Reset_CPU();
+}
+void tearDown(void) /* Is run after every test, put unit clean-up calls here. */
+{
+}
+
+// 0x0200 : LDA #$AA ; STA $0010 ; STA $1234 ; PHA ; INX ; JMP $0209
+static void Load_Writer(void)
+{
+    const u8 program[] = {INS_LDA_IM, 0xAA, INS_STA_ZP, 0x10, INS_STA_ABS, 0x34, 0x12, INS_PHA, INS_INX, INS_JMP_ABS, 0x09, 0x02};
+    memcpy(&mem.data[0x0200], program, sizeof(program));
+    cpu.program_counter = 0x0200;
+}
+
+void Snapshot_Marks_The_Pages_Instructions_Write(void)
+{
+    // given:
+    Load_Writer();
+    Snapshot_Take(&start);
+
+    // when:
+    Execute(2 + 3 + 4 + 3 + 2);
+
+    // then: zero page, stack and 0x12xx
+    for (u32 page = 0; page < SNAPSHOT_PAGE_COUNT; page++)
+        TEST_ASSERT_EQUAL_UINT8((page == 0x00 || page == 0x01 || page == 0x12), snapshot_dirty[page]);
+}
+
+void Snapshot_Restore_Dirty_Copies_Only_Written_Pages(void)
+{
+    // given:
+    Load_Writer();
+    mem.data[0x1234] = 0x55;
+    mem.data[0xFFFF] = 0x77;
+    Snapshot_Take(&start);
+    Execute(2 + 3 + 4 + 3 + 2);
+    TEST_ASSERT_EQUAL_HEX8(0xAA, mem.data[0x1234]);
+
+    // when:
+    const u32 pages = Snapshot_Restore_Dirty(&start);
+
+    // then:
+    TEST_ASSERT_EQUAL_UINT32(3, pages);
+    TEST_ASSERT_EQUAL_MEMORY(start.mem.data, mem.data, MAX_MEM);
+    TEST_ASSERT_EQUAL_HEX16(0x0200, cpu.program_counter);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, cpu.stack_pointer);
+    TEST_ASSERT_EQUAL_HEX8(0, cpu.index_reg_X);
+
+    // the same again, nothing is left dirty
+    Execute(2 + 3 + 4 + 3 + 2);
+    TEST_ASSERT_EQUAL_UINT32(3, Snapshot_Restore_Dirty(&start));
+    TEST_ASSERT_EQUAL_UINT32(0, Snapshot_Restore_Dirty(&start));
+    TEST_ASSERT_EQUAL_MEMORY(start.mem.data, mem.data, MAX_MEM);
+}
+
+void Snapshot_Changes_Outside_Instructions_Are_Marked_By_Hand(void)
+{
+    // given:
+    Snapshot_Take(&start);
+
+    // when: across a page boundary and at the end of memory
+    memset(&mem.data[0x03F0], 0x11, 0x20);
+    Snapshot_Mark_Dirty(0x03F0, 0x20);
+    mem.data[0xFFFF] = 0x22;
+    Snapshot_Mark_Dirty(0xFFFF, 1);
+
+    // then:
+    TEST_ASSERT_EQUAL_UINT32(3, Snapshot_Restore_Dirty(&start));
+    TEST_ASSERT_EQUAL_MEMORY(start.mem.data, mem.data, MAX_MEM);
+
+    // when: a full restore does not need them
+    mem.data[0x8000] = 0x33;
+    Snapshot_Restore(&start);
+
+    // then:
+    TEST_ASSERT_EQUAL_HEX8(0, mem.data[0x8000]);
+}
+
+void Snapshot_Diff_Finds_What_Instructions_Wrote(void)
+{
+    // given:
+    Load_Writer();
+    Snapshot_Take(&start);
+    Execute(2 + 3 + 4 + 3 + 2);
+
+    // when:
+    Memory_Diff diff;
+    const u32   bytes = Snapshot_Diff(&start, &diff);
+
+    // then: STA $10, PHA and STA $1234
+    char text[128];
+    TEST_ASSERT_EQUAL_UINT32(3, bytes);
+    TEST_ASSERT_EQUAL_STRING("3 bytes differ in 3 ranges : $0010 $01FF $1234", Memory_Diff_Format(&diff, text, sizeof(text)));
+
+    // when:
+    Snapshot_Restore_Dirty(&start);
+
+    // then:
+    TEST_ASSERT_EQUAL_UINT32(0, Snapshot_Diff(&start, &diff));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(Snapshot_Marks_The_Pages_Instructions_Write);
+    RUN_TEST(Snapshot_Restore_Dirty_Copies_Only_Written_Pages);
+    RUN_TEST(Snapshot_Changes_Outside_Instructions_Are_Marked_By_Hand);
+    RUN_TEST(Snapshot_Diff_Finds_What_Instructions_Wrote);
+
+    return UNITY_END();
+}
@@ -0,0 +1,234 @@
+#define H6502_TRACE_COLUMNS 1
+
+#include "Unity/unity.h"
+#include "h6502.h"
+
+#include <stdbool.h>
+
+// https://github.com/ThrowTheSwitch/Unity
+
+#define TRACE_TEST_FILE "Trace_Columns_tests.tcol"
+
+void setUp(void) /* Is run before every test, put unit init calls here. */
+{
+    Reset_CPU();
+}
+void tearDown(void) /* Is run after every test, put unit clean-up calls here. */
+{
+    remove(TRACE_TEST_FILE);
+}
+
+void Varints_And_Zigzag_Round_Trip(void)
+{
+    const int64_t values[] = {0, 1, -1, 63, -64, 64, 300, -300, 65535, -65536, INT64_MAX, INT64_MIN};
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+    {
+        uint8_t      buffer[10];
+        const size_t length = Trace_Columns_Put_Varint(buffer, Trace_Columns_Zigzag(values[i]));
+
+        uint64_t decoded = 0;
+        TEST_ASSERT_EQUAL_size_t(length, Trace_Columns_Get_Varint(buffer, buffer + length, &decoded));
+        TEST_ASSERT_EQUAL_INT64(values[i], Trace_Columns_Unzigzag(decoded));
+    }
+
+    uint8_t buffer[10];
+    TEST_ASSERT_EQUAL_size_t(1, Trace_Columns_Put_Varint(buffer, Trace_Columns_Zigzag(-1)));
+}
+
+// 0x0200 : LDX #$00
+// 0x0202 : STA $0300,X
+// 0x0205 : INX
+// 0x0206 : JMP $0202
+static void Trace_Test_Program(u32 instructions)
+{
+    const u8 program[] = {INS_LDX_IM, 0x00, INS_STA_ABS_X, 0x00, 0x03, INS_INX, INS_JMP_ABS, 0x02, 0x02};
+    memcpy(&mem.data[0x0200], program, sizeof(program));
+    cpu.program_counter = 0x0200;
+    cpu.accumulator     = 0x55;
+
+    TEST_ASSERT_TRUE(Trace_Columns_Start(TRACE_TEST_FILE));
+    Stop_Conditions stop  = {0};
+    stop.max_instructions = instructions;
+    Execute_Until(&stop);
+    TEST_ASSERT_TRUE(Trace_Columns_Stop());
+}
+
+void Columnar_Trace_Can_Be_Read_Back(void)
+{
+    // given:
+    Trace_Test_Program(1 + 3 * 100);
+
+    Trace_Columns_Reader reader;
+    TEST_ASSERT_TRUE(Trace_Columns_Reader_Open(&reader, TRACE_TEST_FILE));
+    TEST_ASSERT_EQUAL_UINT32(1, reader.chunk_count);
+
+    // when:
+    Trace_Columns_Chunk chunk;
+    TEST_ASSERT_TRUE(Trace_Columns_Chunk_Alloc(&chunk, &reader));
+    TEST_ASSERT_TRUE(Trace_Columns_Read_Chunk(&reader, 0, TRACE_COLUMNS_ALL, &chunk));
+
+    // then: LDX(2), then STA ABS,X(5) INX(2) JMP(3) repeating
+    TEST_ASSERT_EQUAL_UINT32(301, chunk.records);
+    TEST_ASSERT_EQUAL_HEX16(0x0200, chunk.pc[0]);
+    TEST_ASSERT_EQUAL_UINT64(0, chunk.cycle[0]);
+    for (u32 loop = 0; loop < 100; loop++)
+    {
+        const u32 record = 1 + loop * 3;
+        TEST_ASSERT_EQUAL_HEX16(0x0202, chunk.pc[record]);
+        TEST_ASSERT_EQUAL_HEX8(INS_STA_ABS_X, chunk.byte_column[TRACE_COLUMN_OPCODE][record]);
+        TEST_ASSERT_EQUAL_HEX16(0x0300 + loop, chunk.address[record]);
+        TEST_ASSERT_EQUAL_HEX8(loop, chunk.byte_column[TRACE_COLUMN_X][record]);
+        TEST_ASSERT_EQUAL_HEX8(0x55, chunk.byte_column[TRACE_COLUMN_A][record]);
+        TEST_ASSERT_EQUAL_UINT64(2 + loop * 10, chunk.cycle[record]);
+        TEST_ASSERT_EQUAL_HEX16(0x0206, chunk.pc[record + 2]);
+        TEST_ASSERT_EQUAL_HEX16(0x0202, chunk.address[record + 2]);
+    }
+
+    Trace_Columns_Chunk_Free(&chunk);
+    Trace_Columns_Reader_Close(&reader);
+}
+
+void Columnar_Trace_Is_Smaller_Than_The_Raw_Records(void)
+{
+    // given:
+    const u32 instructions = 100000;
+    Trace_Test_Program(instructions);
+
+    // when:
+    FILE *file = fopen(TRACE_TEST_FILE, "rb");
+    TEST_ASSERT_NOT_NULL(file);
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fclose(file);
+
+    // then: a 16 byte record per instruction uncompressed
+    TEST_ASSERT_LESS_THAN(instructions * 16 / 4, size);
+}
+
+void Columnar_Trace_Can_Seek_To_A_Cycle(void)
+{
+    // given: several chunks
+    const u32 instructions = TRACE_COLUMNS_CHUNK_RECORDS * 3 + 7;
+    Trace_Test_Program(instructions);
+
+    Trace_Columns_Reader reader;
+    TEST_ASSERT_TRUE(Trace_Columns_Reader_Open(&reader, TRACE_TEST_FILE));
+    TEST_ASSERT_EQUAL_UINT32(4, reader.chunk_count);
+
+    // when: the STA of loop 50000 is at cycle 2 + 50000 * 10
+    const uint64_t cycle = 2 + 50000ull * 10;
+    const u32      found = Trace_Columns_Find_Cycle(&reader, cycle);
+
+    // then:
+    TEST_ASSERT_EQUAL_UINT32((1 + 50000 * 3) / TRACE_COLUMNS_CHUNK_RECORDS, found);
+    TEST_ASSERT_TRUE(reader.index[found].first_cycle <= cycle && cycle <= reader.index[found].last_cycle);
+    TEST_ASSERT_EQUAL_UINT32(reader.chunk_count, Trace_Columns_Find_Cycle(&reader, UINT64_MAX));
+
+    // when: only the cycle and PC columns are decoded
+    Trace_Columns_Chunk chunk;
+    TEST_ASSERT_TRUE(Trace_Columns_Chunk_Alloc(&chunk, &reader));
+    TEST_ASSERT_TRUE(Trace_Columns_Read_Chunk(&reader, found, (1u << TRACE_COLUMN_CYCLE) | (1u << TRACE_COLUMN_PC), &chunk));
+
+    // then:
+    const u32 record = (1 + 50000 * 3) % TRACE_COLUMNS_CHUNK_RECORDS;
+    TEST_ASSERT_EQUAL_UINT64(cycle, chunk.cycle[record]);
+    TEST_ASSERT_EQUAL_HEX16(0x0202, chunk.pc[record]);
+
+    Trace_Columns_Chunk_Free(&chunk);
+    Trace_Columns_Reader_Close(&reader);
+}
+
+void Columnar_Trace_Index_Knows_Which_Chunks_Ran_A_PC(void)
+{
+    // given:
+    Trace_Test_Program(TRACE_COLUMNS_CHUNK_RECORDS + 10);
+
+    Trace_Columns_Reader reader;
+    TEST_ASSERT_TRUE(Trace_Columns_Reader_Open(&reader, TRACE_TEST_FILE));
+
+    // then:
+    TEST_ASSERT_TRUE(Trace_Columns_Chunk_May_Have_PC(&reader, 0, 0x0200));
+    TEST_ASSERT_TRUE(Trace_Columns_Chunk_May_Have_PC(&reader, 1, 0x0205));
+    TEST_ASSERT_FALSE(Trace_Columns_Chunk_May_Have_PC(&reader, 1, 0x0200));
+    TEST_ASSERT_FALSE(Trace_Columns_Chunk_May_Have_PC(&reader, 0, 0x8000));
+
+    Trace_Columns_Reader_Close(&reader);
+}
+
+void Columnar_Trace_Stops_Recording_When_The_Index_Cannot_Grow(void)
+{
+    // given: an index as big as the footer's chunk count allows
+    const u8 program[] = {INS_INX, INS_JMP_ABS, 0x00, 0x02};
+    memcpy(&mem.data[0x0200], program, sizeof(program));
+    cpu.program_counter = 0x0200;
+    TEST_ASSERT_TRUE(Trace_Columns_Start(TRACE_TEST_FILE));
+    trace_columns.chunk_count    = 0x80000000u;
+    trace_columns.index_capacity = 0x80000000u;
+
+    // when: a chunk fills up and more instructions run
+    Stop_Conditions stop  = {0};
+    stop.max_instructions = TRACE_COLUMNS_CHUNK_RECORDS + 100;
+    Execute_Until(&stop);
+
+    // then: the chunk is dropped and nothing more is added to it
+    TEST_ASSERT_TRUE(trace_columns.error);
+    TEST_ASSERT_EQUAL_UINT32(0, trace_columns.records);
+    TEST_ASSERT_NULL(trace_columns.index);
+
+    trace_columns.chunk_count    = 0;
+    trace_columns.index_capacity = 0;
+    TEST_ASSERT_FALSE(Trace_Columns_Stop());
+}
+
+void Columnar_Trace_Offsets_Can_Be_Past_4_GB(void)
+{
+#if !defined(_WIN32)
+    // given: a trace whose chunks start past 4 GB, the gap is a hole in the file
+    const int64_t gap       = 0x140000000ll;
+    const u8      program[] = {INS_INX, INS_JMP_ABS, 0x00, 0x02};
+    memcpy(&mem.data[0x0200], program, sizeof(program));
+    cpu.program_counter = 0x0200;
+    TEST_ASSERT_TRUE(Trace_Columns_Start(TRACE_TEST_FILE));
+    TEST_ASSERT_EQUAL_INT(0, Trace_Columns_Seek(trace_columns.file, gap, SEEK_SET));
+
+    // when:
+    Stop_Conditions stop  = {0};
+    stop.max_instructions = TRACE_COLUMNS_CHUNK_RECORDS + 10;
+    Execute_Until(&stop);
+    TEST_ASSERT_TRUE(Trace_Columns_Stop());
+
+    // then: the index and footer offsets are read back whole
+    Trace_Columns_Reader reader;
+    TEST_ASSERT_TRUE(Trace_Columns_Reader_Open(&reader, TRACE_TEST_FILE));
+    TEST_ASSERT_EQUAL_UINT32(2, reader.chunk_count);
+    TEST_ASSERT_EQUAL_UINT64(gap, reader.index[0].offset);
+    TEST_ASSERT_TRUE(reader.index[1].offset > (uint64_t)gap);
+
+    Trace_Columns_Chunk chunk;
+    TEST_ASSERT_TRUE(Trace_Columns_Chunk_Alloc(&chunk, &reader));
+    TEST_ASSERT_TRUE(Trace_Columns_Read_Chunk(&reader, 1, TRACE_COLUMNS_ALL, &chunk));
+    TEST_ASSERT_EQUAL_UINT32(10, chunk.records);
+    TEST_ASSERT_EQUAL_HEX16(0x0200, chunk.pc[0]);
+    TEST_ASSERT_EQUAL_HEX16(0x0201, chunk.pc[1]);
+
+    Trace_Columns_Chunk_Free(&chunk);
+    Trace_Columns_Reader_Close(&reader);
+#else
+    TEST_IGNORE_MESSAGE("no sparse files");
+#endif
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(Varints_And_Zigzag_Round_Trip);
+    RUN_TEST(Columnar_Trace_Can_Be_Read_Back);
+    RUN_TEST(Columnar_Trace_Is_Smaller_Than_The_Raw_Records);
+    RUN_TEST(Columnar_Trace_Can_Seek_To_A_Cycle);
+    RUN_TEST(Columnar_Trace_Index_Knows_Which_Chunks_Ran_A_PC);
+    RUN_TEST(Columnar_Trace_Stops_Recording_When_The_Index_Cannot_Grow);
+    RUN_TEST(Columnar_Trace_Offsets_Can_Be_Past_4_GB);
+
+    return UNITY_END();
+}
@@ -0,0 +1,186 @@
+#define H6502_TRACE_TEXT 1
+
+#include "Unity/unity.h"
+#include "h6502.h"
+
+#include <stdbool.h>
+
+// https://github.com/ThrowTheSwitch/Unity
+
+#define TRACE_TEST_FILE "Trace_Text_tests.log"
+
+void setUp(void) /* Is run before every test, put unit init calls here. */
+{
+    Reset_CPU();
+}
+void tearDown(void) /* Is run after every test, put unit clean-up calls here. */
+{
+    Trace_Text_Stop();
+    remove(TRACE_TEST_FILE);
+}
+
+void Text_Trace_Line_Matches_The_Nestest_Format(void)
+{
+    // given:
+    const Trace_Text_State state = {
+        .cycle  = 7,
+        .pc     = 0xC000,
+        .bytes  = {0x4C, 0xF5, 0xC5},
+        .length = 3,
+        .a      = 0x00,
+        .x      = 0x1F,
+        .y      = 0xA0,
+        .p      = 0x24,
+        .sp     = 0xFD,
+    };
+
+    // when:
+    char         line[TRACE_TEXT_MAX_LINE + 1];
+    const size_t length = Trace_Text_Format_Line(line, &state);
+    line[length]        = '\0';
+
+    // then:
+    TEST_ASSERT_EQUAL_STRING("C000  4C F5 C5  A:00 X:1F Y:A0 P:24 SP:FD CYC:7\n", line);
+}
+
+void Text_Trace_Leaves_Unused_Operand_Bytes_Blank(void)
+{
+    // given:
+    Trace_Text_State state = {.cycle = 18446744073709551615ull, .pc = 0x0001, .bytes = {0xE8, 0x12, 0x34}, .length = 1};
+
+    // when:
+    char   line[TRACE_TEXT_MAX_LINE + 1];
+    size_t length = Trace_Text_Format_Line(line, &state);
+    line[length]  = '\0';
+
+    // then:
+    TEST_ASSERT_EQUAL_STRING("0001  E8        A:00 X:00 Y:00 P:00 SP:00 CYC:18446744073709551615\n", line);
+    TEST_ASSERT_EQUAL_size_t(TRACE_TEXT_MAX_LINE, length);
+
+    // when:
+    state.cycle  = 0;
+    state.length = 2;
+    length       = Trace_Text_Format_Line(line, &state);
+    line[length] = '\0';
+
+    // then:
+    TEST_ASSERT_EQUAL_STRING("0001  E8 12     A:00 X:00 Y:00 P:00 SP:00 CYC:0\n", line);
+}
+
+void Text_Trace_Writes_A_Line_Per_Instruction(void)
+{
+    // given:
+    const u8 program[] = {INS_LDA_IM, 0x42, INS_STA_ABS, 0x34, 0x12, INS_TAX};
+    memcpy(&mem.data[0x0200], program, sizeof(program));
+    cpu.program_counter = 0x0200;
+
+    // when:
+    TEST_ASSERT_TRUE(Trace_Text_Start(TRACE_TEST_FILE));
+    trace_text.cycle = 7;
+    Execute(2 + 4 + 2);
+    Trace_Text_Stop();
+
+    // then:
+    FILE *file = fopen(TRACE_TEST_FILE, "rb");
+    TEST_ASSERT_NOT_NULL(file);
+    char         text[256] = {0};
+    const size_t size      = fread(text, 1, sizeof(text) - 1, file);
+    fclose(file);
+
+    char expected[256];
+    snprintf(expected, sizeof(expected),
+             "0200  A9 42     A:00 X:00 Y:00 P:%02X SP:FF CYC:7\n"
+             "0202  8D 34 12  A:42 X:00 Y:00 P:%02X SP:FF CYC:9\n"
+             "0205  AA        A:42 X:00 Y:00 P:%02X SP:FF CYC:13\n",
+             0x20, 0x20, 0x20);
+    TEST_ASSERT_EQUAL_size_t(strlen(expected), size);
+    TEST_ASSERT_EQUAL_STRING(expected, text);
+    TEST_ASSERT_EQUAL_UINT64(3, trace_text.lines);
+}
+
+void Text_Trace_Diff_Finds_The_First_Difference(void)
+{
+    // given:
+    const char *ours = "0200  A9 42     A:00 X:00 Y:00 P:20 SP:FF CYC:7\n"
+                       "0202  8D 34 12  A:42 X:00 Y:00 P:20 SP:FF CYC:9\n"
+                       "0205  AA        A:42 X:00 Y:00 P:20 SP:FF CYC:13\n";
+    const char *same = "0200  A9 42     A:00 X:00 Y:00 P:20 SP:FF CYC:7\r\n"
+                       "0202  8D 34 12  A:42 X:00 Y:00 P:20 SP:FF CYC:9\r\n"
+                       "0205  AA        A:42 X:00 Y:00 P:20 SP:FF CYC:13\r\n";
+    const char *diff = "0200  A9 42     A:00 X:00 Y:00 P:20 SP:FF CYC:7\n"
+                       "0202  8D 34 12  A:42 X:00 Y:00 P:20 SP:FF CYC:9\n"
+                       "0205  AA        A:42 X:42 Y:00 P:20 SP:FF CYC:13\n";
+
+    // when:
+    const Trace_Text_Diff_Result result_same = Trace_Text_Diff(ours, strlen(ours), same, strlen(same), NULL, 0);
+    const Trace_Text_Diff_Result result_diff = Trace_Text_Diff(ours, strlen(ours), diff, strlen(diff), NULL, 0);
+    const Trace_Text_Diff_Result result_short = Trace_Text_Diff(ours, strlen(ours), diff, 49, NULL, 0);
+
+    // then:
+    TEST_ASSERT_TRUE(result_same.match);
+    TEST_ASSERT_EQUAL_UINT64(3, result_same.line);
+
+    TEST_ASSERT_FALSE(result_diff.match);
+    TEST_ASSERT_EQUAL_UINT64(3, result_diff.line);
+    TEST_ASSERT_EQUAL_size_t(24, result_diff.column);
+
+    TEST_ASSERT_FALSE(result_short.match);
+    TEST_ASSERT_EQUAL_UINT64(2, result_short.line);
+}
+
+void Text_Trace_Diff_Reports_Context_Around_The_Difference(void)
+{
+    // given: many equal lines so the block compare is used, then one difference
+    const size_t lines = 5000;
+    char        *ours  = malloc(lines * TRACE_TEXT_MAX_LINE);
+    char        *ref   = malloc(lines * TRACE_TEXT_MAX_LINE);
+    TEST_ASSERT_NOT_NULL(ours);
+    TEST_ASSERT_NOT_NULL(ref);
+
+    size_t size = 0;
+    for (size_t line = 0; line < lines; line++)
+    {
+        const Trace_Text_State state = {.cycle = line * 3, .pc = (u16)line, .bytes = {0xEA}, .length = 1};
+        size += Trace_Text_Format_Line(&ours[size], &state);
+    }
+    memcpy(ref, ours, size);
+    char *difference = strstr(ref, "1069  EA");
+    TEST_ASSERT_NOT_NULL(difference);
+    difference[3] = 'A';
+
+    // when:
+    FILE *report = fopen(TRACE_TEST_FILE, "w+b");
+    TEST_ASSERT_NOT_NULL(report);
+    const Trace_Text_Diff_Result result = Trace_Text_Diff(ours, size, ref, size, report, 2);
+
+    // then: 0x1069 is line 4202
+    TEST_ASSERT_FALSE(result.match);
+    TEST_ASSERT_EQUAL_UINT64(0x1069 + 1, result.line);
+    TEST_ASSERT_EQUAL_size_t(4, result.column);
+
+    char text[1024] = {0};
+    rewind(report);
+    TEST_ASSERT_TRUE(fread(text, 1, sizeof(text) - 1, report) > 0);
+    fclose(report);
+    TEST_ASSERT_NOT_NULL(strstr(text, "line 4202, column 4"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "    4200 | 1067  EA"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "ours     4202 | 1069  EA"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "ref      4202 | 106A  EA"));
+    TEST_ASSERT_NULL(strstr(text, "4199 |"));
+
+    free(ours);
+    free(ref);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(Text_Trace_Line_Matches_The_Nestest_Format);
+    RUN_TEST(Text_Trace_Leaves_Unused_Operand_Bytes_Blank);
+    RUN_TEST(Text_Trace_Writes_A_Line_Per_Instruction);
+    RUN_TEST(Text_Trace_Diff_Finds_The_First_Difference);
+    RUN_TEST(Text_Trace_Diff_Reports_Context_Around_The_Difference);
+
+    return UNITY_END();
+}
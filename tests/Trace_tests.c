@@ -0,0 +1,134 @@
+#define H6502_TRACE 1
+
+#include "Unity/unity.h"
+#include "h6502.h"
+
+#include <stdbool.h>
+
+// https://github.com/ThrowTheSwitch/Unity
+
+#define TRACE_TEST_FILE "Trace_tests.trace"
+
+void setUp(void) /* Is run before every test, put unit init calls here. */
+{
+    Reset_CPU();
+}
+void tearDown(void) /* Is run after every test, put unit clean-up calls here. */
+{
+    Trace_Stop();
+    remove(TRACE_TEST_FILE);
+}
+
+void Trace_Records_The_State_Before_Each_Instruction(void)
+{
+    // given:
+    const u8 program[] = {INS_LDA_IM, 0x42, INS_LDX_ABS, 0x34, 0x12, INS_TAY};
+    memcpy(&mem.data[0x0200], program, sizeof(program));
+    mem.data[0x1234]    = 0x07;
+    cpu.program_counter = 0x0200;
+
+    // when:
+    TEST_ASSERT_TRUE(Trace_Start(TRACE_TEST_FILE));
+    Execute(2 + 4 + 2);
+    TEST_ASSERT_TRUE(Trace_Stop());
+
+    // then:
+    FILE *file = fopen(TRACE_TEST_FILE, "rb");
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_TRUE(Trace_Read_Header(file));
+
+    Trace_Record record;
+    TEST_ASSERT_TRUE(Trace_Read_Record(file, &record));
+    TEST_ASSERT_EQUAL_HEX16(0x0200, Trace_Record_PC(&record));
+    TEST_ASSERT_EQUAL_HEX8(INS_LDA_IM, record.opcode);
+    TEST_ASSERT_EQUAL_HEX8(0x42, record.operand[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, record.a);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, record.sp);
+    TEST_ASSERT_EQUAL_UINT64(0, Trace_Record_Cycle(&record));
+
+    TEST_ASSERT_TRUE(Trace_Read_Record(file, &record));
+    TEST_ASSERT_EQUAL_HEX16(0x0202, Trace_Record_PC(&record));
+    TEST_ASSERT_EQUAL_HEX8(INS_LDX_ABS, record.opcode);
+    TEST_ASSERT_EQUAL_HEX8(0x34, record.operand[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x12, record.operand[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x42, record.a);
+    TEST_ASSERT_EQUAL_UINT64(2, Trace_Record_Cycle(&record));
+
+    TEST_ASSERT_TRUE(Trace_Read_Record(file, &record));
+    TEST_ASSERT_EQUAL_HEX16(0x0205, Trace_Record_PC(&record));
+    TEST_ASSERT_EQUAL_HEX8(0x07, record.x);
+    TEST_ASSERT_EQUAL_UINT64(6, Trace_Record_Cycle(&record));
+
+    TEST_ASSERT_FALSE(Trace_Read_Record(file, &record));
+    fclose(file);
+}
+
+void Trace_Keeps_Every_Record_When_The_Ring_Wraps(void)
+{
+    // given: an endless loop, INX ; JMP $0200
+    mem.data[0x0200]    = INS_INX;
+    mem.data[0x0201]    = INS_JMP_ABS;
+    mem.data[0x0202]    = 0x00;
+    mem.data[0x0203]    = 0x02;
+    cpu.program_counter = 0x0200;
+
+    const u32 instructions = TRACE_RING_RECORDS * 3 + 10;
+
+    // when:
+    TEST_ASSERT_TRUE(Trace_Start(TRACE_TEST_FILE));
+    Stop_Conditions stop  = {0};
+    stop.max_instructions = instructions;
+    Execute_Until(&stop);
+    TEST_ASSERT_TRUE(Trace_Stop());
+
+    // then:
+    FILE *file = fopen(TRACE_TEST_FILE, "rb");
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_TRUE(Trace_Read_Header(file));
+
+    Trace_Record record;
+    u32          count = 0;
+    while (Trace_Read_Record(file, &record))
+    {
+        const bool is_inx = (count % 2) == 0;
+        TEST_ASSERT_EQUAL_HEX8(is_inx ? INS_INX : INS_JMP_ABS, record.opcode);
+        TEST_ASSERT_EQUAL_UINT64((count / 2) * 5 + (is_inx ? 0 : 2), Trace_Record_Cycle(&record));
+        count++;
+    }
+    fclose(file);
+
+    TEST_ASSERT_EQUAL_UINT32(instructions, count);
+}
+
+void Trace_Stop_Fails_When_The_Records_Cannot_Be_Written(void)
+{
+#if !defined(_WIN32)
+    // given: a device that is always full
+    const u8 program[] = {INS_INX, INS_JMP_ABS, 0x00, 0x02};
+    memcpy(&mem.data[0x0200], program, sizeof(program));
+    cpu.program_counter = 0x0200;
+    if (!Trace_Start("/dev/full"))
+        TEST_IGNORE_MESSAGE("no /dev/full");
+
+    // when:
+    Stop_Conditions stop  = {0};
+    stop.max_instructions = TRACE_RING_RECORDS * 2;
+    Execute_Until(&stop);
+
+    // then:
+    TEST_ASSERT_FALSE(Trace_Stop());
+#else
+    TEST_IGNORE_MESSAGE("no /dev/full");
+#endif
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(Trace_Records_The_State_Before_Each_Instruction);
+    RUN_TEST(Trace_Keeps_Every_Record_When_The_Ring_Wraps);
+    RUN_TEST(Trace_Stop_Fails_When_The_Records_Cannot_Be_Written);
+
+    return UNITY_END();
+}
@@ -0,0 +1,251 @@
+#include "Unity/unity.h"
+#include "h6502.h"
+
+#include <stdbool.h>
+
+// https://github.com/ThrowTheSwitch/Unity
+
+// Stable undocumented NMOS instructions, built for the "NMOS_UNDOC" variant
+// > https://www.masswerk.at/nowgobang/2021/6502-illegal-opcodes
+
+void setUp(void) /* Is run before every test, put unit init calls here. */
+{
+    Reset_CPU();
+}
+void tearDown(void) {} /* Is run after every test, put unit clean-up calls here. */
+
+// LAX (LDA + LDX)
+void LAX_ZP_Can_Load_A_Value_Into_A_And_X(void)
+{
+    // given:
+    cpu.program_counter = 0xFF00;
+
+    mem.data[0xFF00] = INS_LAX_ZP;
+    mem.data[0xFF01] = 0x42;
+    mem.data[0x0042] = 0x84;
+
+    // when:
+    const s32 NUM_OF_CYCLES = 3;
+
+    const s32 cycles_used = Execute(NUM_OF_CYCLES);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(NUM_OF_CYCLES, cycles_used);
+    TEST_ASSERT_EQUAL_UINT8(0x84, cpu.accumulator);
+    TEST_ASSERT_EQUAL_UINT8(0x84, cpu.index_reg_X);
+    TEST_ASSERT_TRUE(cpu.N);
+    TEST_ASSERT_FALSE(cpu.Z);
+}
+
+void LAX_ABS_Y_Takes_An_Extra_Cycle_When_Crossing_A_Page(void)
+{
+    // given:
+    cpu.program_counter = 0xFF00;
+    cpu.index_reg_Y     = 0xFF;
+
+    mem.data[0xFF00] = INS_LAX_ABS_Y;
+    mem.data[0xFF01] = 0x02;
+    mem.data[0xFF02] = 0x44;
+    mem.data[0x4501] = 0x37;
+
+    // when:
+    const s32 NUM_OF_CYCLES = 5;
+
+    const s32 cycles_used = Execute(NUM_OF_CYCLES);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(NUM_OF_CYCLES, cycles_used);
+    TEST_ASSERT_EQUAL_UINT8(0x37, cpu.accumulator);
+    TEST_ASSERT_EQUAL_UINT8(0x37, cpu.index_reg_X);
+}
+
+// SAX (store A & X)
+void SAX_ZP_Can_Store_A_And_X_Into_Memory(void)
+{
+    // given:
+    cpu.program_counter = 0xFF00;
+    cpu.accumulator     = 0xF0;
+    cpu.index_reg_X     = 0x3C;
+
+    mem.data[0xFF00] = INS_SAX_ZP;
+    mem.data[0xFF01] = 0x42;
+
+    // when:
+    const CPU before        = cpu;
+    const s32 NUM_OF_CYCLES = 3;
+
+    const s32 cycles_used = Execute(NUM_OF_CYCLES);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(NUM_OF_CYCLES, cycles_used);
+    TEST_ASSERT_EQUAL_UINT8(0x30, mem.data[0x0042]);
+    TEST_ASSERT_EQUAL_UINT8(before.PS, cpu.PS);
+}
+
+// DCP (DEC + CMP)
+void DCP_ZP_Can_Decrement_Memory_And_Compare(void)
+{
+    // given:
+    cpu.program_counter = 0xFF00;
+    cpu.accumulator     = 0x41;
+
+    mem.data[0xFF00] = INS_DCP_ZP;
+    mem.data[0xFF01] = 0x42;
+    mem.data[0x0042] = 0x42;
+
+    // when:
+    const s32 NUM_OF_CYCLES = 5;
+
+    const s32 cycles_used = Execute(NUM_OF_CYCLES);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(NUM_OF_CYCLES, cycles_used);
+    TEST_ASSERT_EQUAL_UINT8(0x41, mem.data[0x0042]);
+    TEST_ASSERT_TRUE(cpu.Z);
+    TEST_ASSERT_TRUE(cpu.C);
+}
+
+// ISC (INC + SBC)
+void ISC_ABS_X_Can_Increment_Memory_And_Subtract(void)
+{
+    // given:
+    cpu.program_counter = 0xFF00;
+    cpu.accumulator     = 0x10;
+    cpu.index_reg_X     = 0x01;
+    cpu.C               = 1;
+
+    mem.data[0xFF00] = INS_ISC_ABS_X;
+    mem.data[0xFF01] = 0x00;
+    mem.data[0xFF02] = 0x80;
+    mem.data[0x8001] = 0x04;
+
+    // when:
+    const s32 NUM_OF_CYCLES = 7;
+
+    const s32 cycles_used = Execute(NUM_OF_CYCLES);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(NUM_OF_CYCLES, cycles_used);
+    TEST_ASSERT_EQUAL_UINT8(0x05, mem.data[0x8001]);
+    TEST_ASSERT_EQUAL_UINT8(0x0B, cpu.accumulator);
+    TEST_ASSERT_TRUE(cpu.C);
+}
+
+// SLO (ASL + ORA)
+void SLO_IND_X_Can_Shift_Memory_And_OR_With_A(void)
+{
+    // given:
+    cpu.program_counter = 0xFF00;
+    cpu.accumulator     = 0x01;
+    cpu.index_reg_X     = 0x04;
+
+    mem.data[0xFF00] = INS_SLO_IND_X;
+    mem.data[0xFF01] = 0x02;
+    mem.data[0x0006] = 0x00;
+    mem.data[0x0007] = 0x80;
+    mem.data[0x8000] = 0xC0;
+
+    // when:
+    const s32 NUM_OF_CYCLES = 8;
+
+    const s32 cycles_used = Execute(NUM_OF_CYCLES);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(NUM_OF_CYCLES, cycles_used);
+    TEST_ASSERT_EQUAL_UINT8(0x80, mem.data[0x8000]);
+    TEST_ASSERT_EQUAL_UINT8(0x81, cpu.accumulator);
+    TEST_ASSERT_TRUE(cpu.C);
+    TEST_ASSERT_TRUE(cpu.N);
+}
+
+// RLA (ROL + AND)
+void RLA_ZP_Can_Rotate_Memory_And_AND_With_A(void)
+{
+    // given:
+    cpu.program_counter = 0xFF00;
+    cpu.accumulator     = 0x0F;
+    cpu.C               = 1;
+
+    mem.data[0xFF00] = INS_RLA_ZP;
+    mem.data[0xFF01] = 0x42;
+    mem.data[0x0042] = 0x03;
+
+    // when:
+    const s32 NUM_OF_CYCLES = 5;
+
+    const s32 cycles_used = Execute(NUM_OF_CYCLES);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(NUM_OF_CYCLES, cycles_used);
+    TEST_ASSERT_EQUAL_UINT8(0x07, mem.data[0x0042]);
+    TEST_ASSERT_EQUAL_UINT8(0x07, cpu.accumulator);
+    TEST_ASSERT_FALSE(cpu.C);
+}
+
+// SRE (LSR + EOR)
+void SRE_IND_Y_Can_Shift_Memory_And_EOR_With_A(void)
+{
+    // given:
+    cpu.program_counter = 0xFF00;
+    cpu.accumulator     = 0xFF;
+    cpu.index_reg_Y     = 0x01;
+
+    mem.data[0xFF00] = INS_SRE_IND_Y;
+    mem.data[0xFF01] = 0x02;
+    mem.data[0x0002] = 0x00;
+    mem.data[0x0003] = 0x80;
+    mem.data[0x8001] = 0x03;
+
+    // when:
+    const s32 NUM_OF_CYCLES = 8;
+
+    const s32 cycles_used = Execute(NUM_OF_CYCLES);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(NUM_OF_CYCLES, cycles_used);
+    TEST_ASSERT_EQUAL_UINT8(0x01, mem.data[0x8001]);
+    TEST_ASSERT_EQUAL_UINT8(0xFE, cpu.accumulator);
+    TEST_ASSERT_TRUE(cpu.C);
+}
+
+// RRA (ROR + ADC)
+void RRA_ABS_Can_Rotate_Memory_And_Add_To_A(void)
+{
+    // given:
+    cpu.program_counter = 0xFF00;
+    cpu.accumulator     = 0x10;
+    cpu.C               = 0;
+
+    mem.data[0xFF00] = INS_RRA_ABS;
+    mem.data[0xFF01] = 0x00;
+    mem.data[0xFF02] = 0x80;
+    mem.data[0x8000] = 0x05;
+
+    // when:
+    const s32 NUM_OF_CYCLES = 6;
+
+    const s32 cycles_used = Execute(NUM_OF_CYCLES);
+
+    // then:
+    TEST_ASSERT_EQUAL_INT32(NUM_OF_CYCLES, cycles_used);
+    TEST_ASSERT_EQUAL_UINT8(0x02, mem.data[0x8000]);
+    TEST_ASSERT_EQUAL_UINT8(0x13, cpu.accumulator); // 0x10 + 0x02 + carry out of the ROR
+    TEST_ASSERT_FALSE(cpu.C);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(LAX_ZP_Can_Load_A_Value_Into_A_And_X);
+    RUN_TEST(LAX_ABS_Y_Takes_An_Extra_Cycle_When_Crossing_A_Page);
+    RUN_TEST(SAX_ZP_Can_Store_A_And_X_Into_Memory);
+    RUN_TEST(DCP_ZP_Can_Decrement_Memory_And_Compare);
+    RUN_TEST(ISC_ABS_X_Can_Increment_Memory_And_Subtract);
+    RUN_TEST(SLO_IND_X_Can_Shift_Memory_And_OR_With_A);
+    RUN_TEST(RLA_ZP_Can_Rotate_Memory_And_AND_With_A);
+    RUN_TEST(SRE_IND_Y_Can_Shift_Memory_And_EOR_With_A);
+    RUN_TEST(RRA_ABS_Can_Rotate_Memory_And_Add_To_A);
+
+    return UNITY_END();
+}
@@ -0,0 +1,26 @@
+#ifndef __COUNTER_PROGRAM_H__
+#define __COUNTER_PROGRAM_H__
+
+// A short loop for the tests that need a machine doing something : it counts
+// the bytes of page 3 up, pushes and pulls on the way and counts the passes
+// in $10
+//
+// 0x0200 : LDX #0
+// 0x0202 : LDA $0300,X ; ADC #1 ; STA $0300,X ; PHA ; PLA ; INX ; BNE $0202
+// 0x020F : INC $10 ; JMP $0200
+
+#include "h6502.h"
+
+static inline void Load_Counter(void)
+{
+    const u8 program[] = {
+        INS_LDX_IM, 0x00,                                                       // 0x0200
+        INS_LDA_ABS_X, 0x00, 0x03, INS_ADC_IM, 0x01, INS_STA_ABS_X, 0x00, 0x03, // 0x0202
+        INS_PHA, INS_PLA, INS_INX, INS_BNE, 0xF3,                               // 0x020A
+        INS_INC_ZP, 0x10, INS_JMP_ABS, 0x00, 0x02,                              // 0x020F
+    };
+    memcpy(&mem.data[0x0200], program, sizeof(program));
+    cpu.program_counter = 0x0200;
+}
+
+#endif // __COUNTER_PROGRAM_H__
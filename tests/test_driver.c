@@ -0,0 +1,226 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Unity/unity.h"
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+// One program with every test suite of a variant
+//
+//  6502_tests [-j workers] [-s suite] [-f test]
+//
+//  -j workers  suites run at the same time (one a core)
+//  -s suite    only the suites with this in their name
+//  -f test     only the tests with this in their name
+//
+// The suite list, test_suites.h, is written by CMake. Each suite runs in its
+// own process, forked from the driver, so it has its own 'cpu', 'mem' and
+// Unity state and a crash only takes down that suite. Its output goes to a
+// temporary file and is printed in suite order when it is done, then the
+// totals in Unity's format. Windows runs the suites one after the other.
+//
+// Exit code 0 when every test passes
+
+#define TEST_SUITE_ENTRY(suite) int suite##_main(void);
+#include "test_suites.h"
+#undef TEST_SUITE_ENTRY
+
+typedef struct Test_Suite
+{
+    const char *name;
+    int (*main)(void);
+} Test_Suite;
+
+static const Test_Suite test_suites[] = {
+#define TEST_SUITE_ENTRY(suite) {#suite, suite##_main},
+#include "test_suites.h"
+#undef TEST_SUITE_ENTRY
+};
+
+#define TEST_SUITE_COUNT (int)(sizeof(test_suites) / sizeof(test_suites[0]))
+
+typedef struct Suite_Result
+{
+    bool  selected;
+    bool  finished; // got to UnityEnd()
+    int   tests;
+    int   failures;
+    int   ignored;
+    FILE *output;
+} Suite_Result;
+
+static const char *test_filter = NULL;
+static void (*suite_set_up)(void);
+static void (*suite_tear_down)(void);
+
+// Unity's runner calls these, they go to the running suite's own
+void setUp(void)
+{
+    suite_set_up();
+}
+void tearDown(void)
+{
+    suite_tear_down();
+}
+
+void Test_Driver_Run(void (*test)(void), const char *name, int line, void (*set_up)(void), void (*tear_down)(void))
+{
+    if (test_filter != NULL && strstr(name, test_filter) == NULL)
+        return;
+
+    suite_set_up    = set_up;
+    suite_tear_down = tear_down;
+    UnityDefaultTestRun(test, name, line);
+}
+
+static int Usage(const char *name)
+{
+    fprintf(stderr, "usage : %s [-j workers] [-s suite] [-f test]\n", name);
+    return 2;
+}
+
+// Totals from the last "N Tests N Failures N Ignored" line of the output
+static void Read_Totals(Suite_Result *result)
+{
+    char line[1024];
+    rewind(result->output);
+    while (fgets(line, sizeof(line), result->output) != NULL)
+    {
+        int tests, failures, ignored;
+        if (sscanf(line, "%d Tests %d Failures %d Ignored", &tests, &failures, &ignored) == 3)
+        {
+            result->tests    = tests;
+            result->failures = failures;
+            result->ignored  = ignored;
+            result->finished = true;
+        }
+    }
+}
+
+static void Print_Output(FILE *output)
+{
+    char   buffer[4096];
+    size_t size;
+    rewind(output);
+    while ((size = fread(buffer, 1, sizeof(buffer), output)) > 0)
+        fwrite(buffer, 1, size, stdout);
+}
+
+#if !defined(_WIN32)
+// Forks a process for each suite, 'workers' at a time
+static void Run_Suites(Suite_Result *results, int workers)
+{
+    int running = 0;
+    for (int suite = 0; suite < TEST_SUITE_COUNT; suite++)
+    {
+        if (!results[suite].selected || results[suite].output == NULL)
+            continue;
+        if (running == workers && wait(NULL) > 0)
+            running--;
+
+        fflush(stdout);
+        const pid_t child = fork();
+        if (child == 0)
+        {
+            dup2(fileno(results[suite].output), STDOUT_FILENO);
+            test_suites[suite].main();
+            fflush(stdout);
+            _exit(0);
+        }
+        running += (child > 0); // a suite that does not start does not finish
+    }
+    while (running > 0 && wait(NULL) > 0)
+        running--;
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    int workers = 1;
+#if !defined(_WIN32)
+    workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    const char *suite_filter = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (i + 1 >= argc)
+            return Usage(argv[0]);
+        if (strcmp(argv[i], "-j") == 0)
+            workers = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-s") == 0)
+            suite_filter = argv[++i];
+        else if (strcmp(argv[i], "-f") == 0)
+            test_filter = argv[++i];
+        else
+            return Usage(argv[0]);
+    }
+    if (workers < 1)
+        workers = 1;
+
+    static Suite_Result results[TEST_SUITE_COUNT];
+    for (int suite = 0; suite < TEST_SUITE_COUNT; suite++)
+    {
+        results[suite].selected = (suite_filter == NULL) || (strstr(test_suites[suite].name, suite_filter) != NULL);
+        results[suite].output   = results[suite].selected ? tmpfile() : NULL;
+    }
+
+#if !defined(_WIN32)
+    Run_Suites(results, workers);
+#else
+    for (int suite = 0; suite < TEST_SUITE_COUNT; suite++)
+    {
+        if (results[suite].selected && results[suite].output != NULL)
+        {
+            fflush(stdout);
+            const int saved = _dup(_fileno(stdout));
+            _dup2(_fileno(results[suite].output), _fileno(stdout));
+            test_suites[suite].main();
+            fflush(stdout);
+            _dup2(saved, _fileno(stdout));
+            _close(saved);
+        }
+    }
+#endif
+
+    int suites = 0, tests = 0, failures = 0, ignored = 0;
+    for (int suite = 0; suite < TEST_SUITE_COUNT; suite++)
+    {
+        Suite_Result *result = &results[suite];
+        if (!result->selected)
+            continue;
+
+        suites++;
+        if (result->output == NULL)
+        {
+            printf("%s:0:-:FAIL: no temporary file for the output\n", test_suites[suite].name);
+            failures++;
+            continue;
+        }
+
+        Read_Totals(result);
+        if (result->tests > 0 || !result->finished)
+            Print_Output(result->output);
+        if (!result->finished)
+        {
+            printf("%s:0:-:FAIL: the suite did not finish\n", test_suites[suite].name);
+            failures++;
+        }
+        tests += result->tests;
+        failures += result->failures;
+        ignored += result->ignored;
+        fclose(result->output);
+    }
+
+    printf("\n=======================\n");
+    printf("%d Suites\n", suites);
+    printf("%d Tests %d Failures %d Ignored \n", tests, failures, ignored);
+    printf("%s\n", (failures == 0 && suites > 0) ? "OK" : "FAIL");
+    return (failures == 0 && suites > 0) ? 0 : 1;
+}
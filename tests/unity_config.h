@@ -0,0 +1,21 @@
+#ifndef UNITY_CONFIG_H
+#define UNITY_CONFIG_H
+
+// Only for the suites built into the test driver (test_driver.c), which are
+// compiled with UNITY_INCLUDE_CONFIG_H and TEST_SUITE set to the suite name.
+// Each suite's main, setUp and tearDown get the suite name in front so all of
+// them link into one program, and RUN_TEST goes through the driver, which
+// filters by name and calls the suite's own setUp and tearDown.
+
+#define TEST_SUITE_SYMBOL(suite, name)  TEST_SUITE_SYMBOL_(suite, name)
+#define TEST_SUITE_SYMBOL_(suite, name) suite##_##name
+
+#define main     TEST_SUITE_SYMBOL(TEST_SUITE, main)
+#define setUp    TEST_SUITE_SYMBOL(TEST_SUITE, setUp)
+#define tearDown TEST_SUITE_SYMBOL(TEST_SUITE, tearDown)
+
+void Test_Driver_Run(void (*test)(void), const char *name, int line, void (*set_up)(void), void (*tear_down)(void));
+
+#define RUN_TEST(func) Test_Driver_Run(func, #func, __LINE__, setUp, tearDown)
+
+#endif // UNITY_CONFIG_H
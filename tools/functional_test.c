@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "h6502.h"
+#include "host.h"
+
+// Run a self-checking test image, such as Klaus Dormann's 6502_functional_test.bin
+//
+//  6502_functional_test image.bin [options]
+//
+//  --load address    where the raw image is loaded (0x0000)
+//  --start pc        PC the test starts at (0x0400)
+//  --success pc      PC of the loop the test ends in when it passes (0x3469)
+//  --test address    where the test keeps the number of the test it is on (0x0200)
+//  --max-cycles n    cycles before giving up (2000000000)
+//
+// Numbers can be hex (0x...). A test that fails ends in a trap, an instruction
+// that jumps or branches to itself, and one that passes in the same kind of
+// loop at the success PC. The image runs with Execute_Until() in slices of
+// FUNCTIONAL_SLICE cycles that also stop at the success PC or an opcode the
+// variant does not have. After each slice the next instruction is run on its
+// own, when the PC does not move the test is in a trap. So a trap is found in
+// less than a slice instead of when the cycle budget runs out.
+//
+// Exit code 0 when the test passes, 1 when it fails, 2 on a bad argument
+
+#define FUNCTIONAL_SLICE      100000
+#define FUNCTIONAL_MAX_CYCLES 2000000000ull
+
+static int Usage(const char *name)
+{
+    fprintf(stderr, "usage : %s image.bin [--load address] [--start pc] [--success pc] [--test address] [--max-cycles n]\n", name);
+    return 2;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || argv[1][0] == '-')
+        return Usage(argv[0]);
+
+    u16      load_address = 0x0000;
+    u16      start_pc     = 0x0400;
+    u16      success_pc   = 0x3469;
+    u16      test_address = 0x0200;
+    uint64_t max_cycles   = FUNCTIONAL_MAX_CYCLES;
+    for (int i = 2; i < argc; i++)
+    {
+        if (i + 1 >= argc)
+            return Usage(argv[0]);
+
+        const unsigned long long value = strtoull(argv[i + 1], NULL, 0);
+        if (strcmp(argv[i], "--load") == 0)
+            load_address = (u16)value & 0xFFFF;
+        else if (strcmp(argv[i], "--start") == 0)
+            start_pc = (u16)value & 0xFFFF;
+        else if (strcmp(argv[i], "--success") == 0)
+            success_pc = (u16)value & 0xFFFF;
+        else if (strcmp(argv[i], "--test") == 0)
+            test_address = (u16)value & 0xFFFF;
+        else if (strcmp(argv[i], "--max-cycles") == 0)
+            max_cycles = value;
+        else
+            return Usage(argv[0]);
+        i++;
+    }
+
+    Reset_CPU();
+    const size_t size = Load_Image(argv[1], load_address);
+    if (size == 0)
+        return 2;
+    printf("image : %s, %zu bytes at 0x%04X\n", argv[1], size, (unsigned)load_address);
+    cpu.program_counter = start_pc;
+
+    printf("6502 functional test - variant : %s, start 0x%04X, success 0x%04X\n", H6502_VARIANT_NAME, (unsigned)start_pc,
+           (unsigned)success_pc);
+
+    static Stop_Conditions slice, probe;
+    Stop_At_PC(&slice, success_pc);
+    probe.max_instructions = 1;
+
+    uint64_t     cycles  = 0;
+    bool         trapped = false;
+    bool         invalid = false;
+    const double start   = Seconds_Now();
+    while (cycles < max_cycles && !trapped && !invalid)
+    {
+        slice.max_cycles = (max_cycles - cycles < FUNCTIONAL_SLICE) ? (s32)(max_cycles - cycles) : FUNCTIONAL_SLICE;
+        Execute_Result result = Execute_Until(&slice);
+        cycles += (uint64_t)result.cycles_used;
+        if (result.reason == STOP_BAD_INSTRUCTION)
+        {
+            invalid = true;
+            break;
+        }
+
+        // at the success PC or the end of the slice, a trap when the next instruction does not move the PC
+        const u16 pc = cpu.program_counter;
+        result       = Execute_Until(&probe);
+        cycles += (uint64_t)result.cycles_used;
+        invalid = (result.reason == STOP_BAD_INSTRUCTION);
+        trapped = !invalid && cpu.program_counter == pc;
+    }
+    const double elapsed = Seconds_Now() - start;
+    const u16    pc      = cpu.program_counter;
+
+    printf("%" PRIu64 " cycles in %.3f s (%.1f MHz)\n", cycles, elapsed, (double)cycles / elapsed / 1e6);
+    if (trapped && pc == success_pc)
+    {
+        printf("pass : success loop at 0x%04X\n", (unsigned)pc);
+        return 0;
+    }
+
+    if (invalid)
+        printf("fail : opcode 0x%02X not handled at 0x%04X", (unsigned)Peek_Byte((pc - 1) & 0xFFFF), (unsigned)((pc - 1) & 0xFFFF));
+    else if (trapped)
+        printf("fail : trap at 0x%04X", (unsigned)pc);
+    else
+        printf("fail : no trap after %" PRIu64 " cycles, PC 0x%04X", cycles, (unsigned)pc);
+    printf(", test 0x%02X (at 0x%04X)\n", (unsigned)Peek_Byte(test_address), (unsigned)test_address);
+    printf("A 0x%02X X 0x%02X Y 0x%02X SP 0x%02X P 0x%02X\n", (unsigned)cpu.accumulator, (unsigned)cpu.index_reg_X,
+           (unsigned)cpu.index_reg_Y, (unsigned)cpu.stack_pointer, (unsigned)cpu.PS);
+    return 1;
+}
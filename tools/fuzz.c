@@ -0,0 +1,242 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fuzz.h"
+#include "host.h"
+
+// Fuzz a 6502 program in-process (see fuzz.h)
+//
+//  6502_fuzz                          one input on stdin, persistent mode under afl-fuzz
+//  6502_fuzz input...                 run each file, exit code 1 on a crash
+//  6502_fuzz -r runs input...         run each file 'runs' times and print execs/s
+//
+// Built with H6502_LIBFUZZER=1 and -fsanitize=fuzzer, main() is left to
+// libFuzzer and the edge map is given to it as extra counters.
+//
+// The program comes from the environment, numbers can be hex (0x...):
+//  FUZZ_ROM         program file, Load_Program() format (built in example if unset)
+//  FUZZ_INPUT       input region address
+//  FUZZ_INPUT_SIZE  input region size
+//  FUZZ_ENTRY       PC each run starts at
+//  FUZZ_EXIT        PC that ends a run
+//  FUZZ_CRASH       PC that is a crash (optional)
+//  FUZZ_CYCLES      cycle limit of a run
+
+#ifndef H6502_LIBFUZZER
+#define H6502_LIBFUZZER 0
+#endif
+
+#define FUZZ_MAX_INPUT (MAX_MEM + 1) // one more byte to see it was cut
+#define FUZZ_AFL_RUNS  10000         // inputs before afl-fuzz forks again
+
+// Copies the input at 0x0400 to 0x0500, crashes when it starts with "6502"
+// 0x0200 : STA $00 ; LDY #0
+// 0x0204 : CPY $00 ; BEQ $0211 ; LDA $0400,Y ; STA $0500,Y ; INY ; BNE $0204
+// 0x0211 : LDA $00 ; CMP #4 ; BCC $0236
+// 0x0217 : LDA $0500 ; CMP #'6' ; BNE $0236 ... "502" the same way
+// 0x0233 : JMP $0300 (crash)
+// 0x0236 : JMP $0236 (exit)
+static const u8 example_rom[] = {
+    0x00, 0x02,                               // load address : 0x0200
+    0x85, 0x00, 0xA0, 0x00,                   // 0x0200
+    0xC4, 0x00, 0xF0, 0x09, 0xB9, 0x00, 0x04, // 0x0204
+    0x99, 0x00, 0x05, 0xC8, 0xD0, 0xF3,       // 0x020B
+    0xA5, 0x00, 0xC9, 0x04, 0x90, 0x1F,       // 0x0211
+    0xAD, 0x00, 0x05, 0xC9, '6', 0xD0, 0x18,  // 0x0217
+    0xAD, 0x01, 0x05, 0xC9, '5', 0xD0, 0x11,  // 0x021E
+    0xAD, 0x02, 0x05, 0xC9, '0', 0xD0, 0x0A,  // 0x0225
+    0xAD, 0x03, 0x05, 0xC9, '2', 0xD0, 0x03,  // 0x022C
+    0x4C, 0x00, 0x03,                         // 0x0233
+    0x4C, 0x36, 0x02,                         // 0x0236
+};
+
+static const Fuzz_Config example_config = {
+    .input_address  = 0x0400,
+    .input_size     = 0x00FF, // the length has to fit in A
+    .entry_pc       = 0x0200,
+    .exit_pc        = 0x0236,
+    .crash_pc       = 0x0300,
+    .check_crash_pc = true,
+};
+
+static u32 Env_Number(const char *name, u32 fallback)
+{
+    const char *text = getenv(name);
+    return (text != NULL && *text) ? (u32)strtoul(text, NULL, 0) : fallback;
+}
+
+// Reads all of 'file', returns its size or -1
+static long Read_All(FILE *file, u8 *buffer, long size)
+{
+    long used = 0;
+    while (used < size)
+    {
+        const size_t read = fread(&buffer[used], 1, (size_t)(size - used), file);
+        if (read == 0)
+            break;
+        used += (long)read;
+    }
+    return ferror(file) ? -1 : used;
+}
+
+static bool Fuzz_Setup_From_Environment(void)
+{
+    const char *rom_path = getenv("FUZZ_ROM");
+    if (rom_path == NULL || !*rom_path)
+    {
+        Fuzz_Setup(&example_config, example_rom, sizeof(example_rom));
+        return true;
+    }
+
+    static u8 rom[MAX_MEM + 2];
+    FILE     *file = fopen(rom_path, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "Error opening ROM file : %s\n", rom_path);
+        return false;
+    }
+    const long rom_size = Read_All(file, rom, sizeof(rom));
+    fclose(file);
+    if (rom_size < 2)
+    {
+        fprintf(stderr, "Error reading ROM file : %s\n", rom_path);
+        return false;
+    }
+
+    const u16         load_address = (u16)(rom[0] | (rom[1] << 8));
+    const Fuzz_Config config       = {
+        .input_address  = (u16)Env_Number("FUZZ_INPUT", 0x0400) & 0xFFFF,
+        .input_size     = Env_Number("FUZZ_INPUT_SIZE", 0x0100),
+        .entry_pc       = (u16)Env_Number("FUZZ_ENTRY", load_address) & 0xFFFF,
+        .exit_pc        = (u16)Env_Number("FUZZ_EXIT", 0xFFFF) & 0xFFFF,
+        .crash_pc       = (u16)Env_Number("FUZZ_CRASH", 0) & 0xFFFF,
+        .check_crash_pc = getenv("FUZZ_CRASH") != NULL,
+        .max_cycles     = (s32)Env_Number("FUZZ_CYCLES", FUZZ_DEFAULT_MAX_CYCLES),
+    };
+    Fuzz_Setup(&config, rom, (int)rom_size);
+    return true;
+}
+
+#if H6502_LIBFUZZER && defined(__linux__)
+// libFuzzer reads any counters placed in this section as extra coverage
+__attribute__((section("__libfuzzer_extra_counters"))) static uint8_t libfuzzer_counters[COVERAGE_MAP_SIZE];
+#endif
+
+int LLVMFuzzerInitialize(int *argc, char ***argv)
+{
+    (void)argc;
+    (void)argv;
+#if H6502_LIBFUZZER && defined(__linux__)
+    coverage.map = libfuzzer_counters;
+#endif
+    if (!Fuzz_Setup_From_Environment())
+        exit(2);
+    return 0;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    const Execute_Result result = Fuzz_Run(data, size);
+    if (Fuzz_Check(&result) == FUZZ_CRASH)
+    {
+        fprintf(stderr, "6502 crash at PC 0x%04X\n", (unsigned)cpu.program_counter);
+        abort();
+    }
+    return 0;
+}
+
+#if !H6502_LIBFUZZER
+static u8 input[FUZZ_MAX_INPUT];
+
+// afl-fuzz rewinds stdin to the next input after each run
+static long Read_Stdin(void)
+{
+#if !defined(_WIN32)
+    long used = 0;
+    while (used < FUZZ_MAX_INPUT)
+    {
+        const ssize_t count = read(STDIN_FILENO, &input[used], (size_t)(FUZZ_MAX_INPUT - used));
+        if (count <= 0)
+            return (count < 0) ? -1 : used;
+        used += count;
+    }
+    return used;
+#else
+    return Read_All(stdin, input, FUZZ_MAX_INPUT);
+#endif
+}
+
+static int Run_Files(int count, char **paths, long repeat)
+{
+    uint64_t runs    = 0;
+    double   elapsed = 0.0;
+    for (int i = 0; i < count; i++)
+    {
+        FILE *file = fopen(paths[i], "rb");
+        if (file == NULL)
+        {
+            fprintf(stderr, "Error opening input file : %s\n", paths[i]);
+            return 2;
+        }
+        const long size = Read_All(file, input, FUZZ_MAX_INPUT);
+        fclose(file);
+        if (size < 0)
+        {
+            fprintf(stderr, "Error reading input file : %s\n", paths[i]);
+            return 2;
+        }
+
+        const double start = Seconds_Now();
+        for (long run = 1; run < repeat; run++)
+            Fuzz_Run(input, (size_t)size);
+        const Execute_Result result = Fuzz_Run(input, (size_t)size);
+        elapsed += Seconds_Now() - start;
+        runs += (uint64_t)repeat;
+
+        const Fuzz_Outcome outcome = Fuzz_Check(&result);
+        if (outcome == FUZZ_CRASH)
+        {
+            printf("%s : crash at PC 0x%04X\n", paths[i], (unsigned)cpu.program_counter);
+            return 1;
+        }
+        if (outcome == FUZZ_HANG)
+            printf("%s : hang, no exit after %" PRIdFAST32 " cycles\n", paths[i], result.cycles_used);
+    }
+
+    if (repeat > 1)
+        printf("%" PRIu64 " runs in %.3f s (%.0f execs/s)\n", runs, elapsed, (double)runs / elapsed);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    long repeat = 1;
+    int  first  = 1;
+    if (argc > 2 && strcmp(argv[1], "-r") == 0)
+    {
+        repeat = strtol(argv[2], NULL, 10);
+        first  = 3;
+        if (repeat < 1)
+        {
+            fprintf(stderr, "usage : %s [-r runs] [input...]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    LLVMFuzzerInitialize(&argc, &argv);
+
+    if (first < argc)
+        return Run_Files(argc - first, &argv[first], repeat);
+
+    // AFL persistent mode, or a single run outside afl-fuzz
+    Coverage_Attach_AFL();
+    while (Coverage_AFL_Loop(FUZZ_AFL_RUNS))
+    {
+        const long size = Read_Stdin();
+        if (size < 0)
+            return 2;
+        LLVMFuzzerTestOneInput(input, (size_t)size);
+    }
+    return 0;
+}
+#endif
@@ -0,0 +1,284 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "golden.h"
+#include "host.h"
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Makes an exhaustive golden table of instruction results, or checks an
+// engine against one
+//
+//  6502_golden generate table.bin [-e engine] [-j workers]
+//  6502_golden verify table.bin [-e engine] [-j workers] [--full]
+//
+//  -e engine   engine that runs the cases (switch, table, until), switch
+//  -j workers  processes the opcodes are shared out between (one a core)
+//  --full      runs all 524288 cases of each opcode, not only the stored ones
+//
+// Each worker process has its own 'cpu' and 'mem' and writes what it makes
+// to its own temporary file, which is read back once it has finished.
+// Windows runs them all in one. See golden.h for what a case is.
+//
+// Exit code 0 when the table is written or every case agrees, 1 when one does
+// not or the table cannot be read or written, 2 on a bad argument
+
+typedef struct Opcode_Result
+{
+    int           opcode;
+    Golden_Result result;
+} Opcode_Result;
+
+typedef struct Golden_Job
+{
+    bool                    generate;
+    bool                    every_case;
+    const Execution_Engine *engine;
+    const Golden_Table     *table; // verify
+} Golden_Job;
+
+static Golden_Table table;
+static uint8_t     *records[256];
+
+static int Usage(const char *name)
+{
+    fprintf(stderr, "usage : %s generate table.bin [-e engine] [-j workers]\n", name);
+    fprintf(stderr, "        %s verify table.bin [-e engine] [-j workers] [--full]\n", name);
+    return 2;
+}
+
+// The opcodes 'worker' of 'workers' runs, to 'out' : an entry and its records
+// for each opcode when generating, an Opcode_Result when verifying
+static bool Run_Worker(const Golden_Job *job, int worker, int workers, FILE *out)
+{
+    bool written = true;
+    Reset_CPU();
+    for (int opcode = worker; opcode < 256; opcode += workers)
+    {
+        if (!Opcode_Is_Valid((u8)opcode))
+            continue;
+        if (job->generate)
+        {
+            Golden_Opcode entry;
+            uint8_t      *data = Golden_Build_Opcode(job->engine->run, (u8)opcode, &entry);
+            if (data == NULL)
+                return false;
+            uint8_t bytes[GOLDEN_ENTRY_SIZE];
+            Golden_Put_Entry(bytes, &entry);
+            const size_t size = (size_t)entry.records * entry.record_size;
+            written &= fputc(opcode, out) != EOF && fwrite(bytes, 1, sizeof(bytes), out) == sizeof(bytes) &&
+                       fwrite(data, 1, size, out) == size;
+            free(data);
+        }
+        else if (job->table->opcodes[opcode].present)
+        {
+            const Golden_Opcode *entry  = &job->table->opcodes[opcode];
+            const Opcode_Result  result = {
+                 opcode, Golden_Verify_Opcode(job->engine->run, (u8)opcode, entry, &job->table->data[entry->offset], job->every_case)};
+            written &= fwrite(&result, 1, sizeof(result), out) == sizeof(result);
+        }
+    }
+    return written;
+}
+
+// Reads back what a worker wrote, false when it does not make sense
+static bool Read_Worker(const Golden_Job *job, FILE *file, Golden_Opcode *opcodes, Opcode_Result *results)
+{
+    rewind(file);
+    if (!job->generate)
+    {
+        Opcode_Result result;
+        while (fread(&result, 1, sizeof(result), file) == sizeof(result))
+        {
+            if (result.opcode < 0 || result.opcode > 255)
+                return false;
+            results[result.opcode] = result;
+        }
+        return feof(file);
+    }
+
+    int opcode;
+    while ((opcode = fgetc(file)) != EOF)
+    {
+        uint8_t bytes[GOLDEN_ENTRY_SIZE];
+        if (fread(bytes, 1, sizeof(bytes), file) != sizeof(bytes) || !Golden_Get_Entry(bytes, &opcodes[opcode]))
+            return false;
+        const size_t size = (size_t)opcodes[opcode].records * opcodes[opcode].record_size;
+        records[opcode]   = (uint8_t *)malloc(size + 1);
+        if (records[opcode] == NULL || fread(records[opcode], 1, size, file) != size)
+            return false;
+    }
+    return true;
+}
+
+static bool Run_Workers(const Golden_Job *job, int workers, Golden_Opcode *opcodes, Opcode_Result *results)
+{
+    FILE *outputs[256] = {NULL};
+    if (workers > 256)
+        workers = 256;
+    for (int worker = 0; worker < workers; worker++)
+    {
+        outputs[worker] = tmpfile();
+        if (outputs[worker] == NULL)
+            return false;
+    }
+
+    bool ok = true;
+#if !defined(_WIN32)
+    if (workers > 1)
+    {
+        fflush(stdout);
+        int started = 0;
+        for (; started < workers; started++)
+        {
+            const pid_t child = fork();
+            if (child < 0)
+                break;
+            if (child == 0)
+            {
+                const bool written = Run_Worker(job, started, workers, outputs[started]);
+                _exit((fflush(outputs[started]) == 0 && written) ? 0 : 1);
+            }
+        }
+        ok = (started == workers);
+        for (int worker = 0; worker < started; worker++)
+        {
+            int status = 0;
+            if (wait(&status) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                ok = false;
+        }
+    }
+    else
+#endif
+    {
+        workers = 1;
+        ok      = Run_Worker(job, 0, 1, outputs[0]);
+    }
+
+    for (int worker = 0; worker < workers; worker++)
+    {
+        ok &= Read_Worker(job, outputs[worker], opcodes, results);
+        fclose(outputs[worker]);
+    }
+    return ok;
+}
+
+static int Generate(const Golden_Job *job, const char *path, int workers)
+{
+    static Golden_Opcode opcodes[256];
+    const double         start = Seconds_Now();
+    if (!Run_Workers(job, workers, opcodes, NULL))
+    {
+        fprintf(stderr, "Error : a worker did not finish\n");
+        return 1;
+    }
+    const double elapsed = Seconds_Now() - start;
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL || !Golden_Write(file, opcodes, records) || fclose(file) != 0)
+    {
+        fprintf(stderr, "Error : could not write %s\n", path);
+        return 1;
+    }
+
+    int      count = 0;
+    uint64_t cases = 0, stored = 0, size = 0;
+    for (int opcode = 0; opcode < 256; opcode++)
+    {
+        if (!opcodes[opcode].present)
+            continue;
+        count++;
+        cases += GOLDEN_CASES;
+        stored += opcodes[opcode].records;
+        if (opcodes[opcode].offset + (uint64_t)opcodes[opcode].records * opcodes[opcode].record_size > size)
+            size = opcodes[opcode].offset + (uint64_t)opcodes[opcode].records * opcodes[opcode].record_size;
+        free(records[opcode]);
+    }
+    printf("%d opcodes, %" PRIu64 " cases, %" PRIu64 " records, %" PRIu64 " bytes of records\n", count, cases, stored, size);
+    printf("%.3f s, %.0f cases/s\n", elapsed, (double)cases / elapsed);
+    return 0;
+}
+
+static int Verify(Golden_Job *job, const char *path, int workers)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL || !Golden_Read(file, &table))
+    {
+        fprintf(stderr, "Error : %s is not a golden table for %s\n", path, H6502_VARIANT_NAME);
+        if (file != NULL)
+            fclose(file);
+        return 1;
+    }
+    fclose(file);
+    job->table = &table;
+
+    static Opcode_Result results[256];
+    const double         start = Seconds_Now();
+    const bool           ok    = Run_Workers(job, workers, NULL, results);
+    const double         elapsed = Seconds_Now() - start;
+
+    uint64_t checked = 0, failed = 0;
+    int      count = 0, failed_opcodes = 0, missing = 0;
+    for (int opcode = 0; opcode < 256; opcode++)
+    {
+        if (Opcode_Is_Valid((u8)opcode) != table.opcodes[opcode].present)
+            missing++;
+        if (!table.opcodes[opcode].present)
+            continue;
+        const Golden_Result *result = &results[opcode].result;
+        count++;
+        checked += result->checked;
+        failed += result->failed;
+        if (result->failed > 0)
+        {
+            failed_opcodes++;
+            printf("FAIL %" PRIuFAST32 " of %" PRIuFAST32 " : %s\n", result->failed, result->checked, result->failure);
+        }
+    }
+    Golden_Free(&table);
+
+    if (!ok)
+        fprintf(stderr, "Error : a worker did not finish\n");
+    if (missing > 0)
+        printf("%d opcode%s in the table and the variant do not match\n", missing, (missing == 1) ? "" : "s");
+    printf("%d opcodes, %" PRIu64 " of %" PRIu64 " cases agree, %d opcode%s failing\n", count, checked - failed, checked,
+           failed_opcodes, (failed_opcodes == 1) ? "" : "s");
+    printf("%.3f s, %.0f cases/s\n", elapsed, (double)checked / elapsed);
+    return (ok && missing == 0 && failed_opcodes == 0) ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3 || (strcmp(argv[1], "generate") != 0 && strcmp(argv[1], "verify") != 0))
+        return Usage(argv[0]);
+
+    Golden_Job job = {.generate = (strcmp(argv[1], "generate") == 0), .engine = Find_Execution_Engine("switch")};
+    int        workers = 1;
+#if !defined(_WIN32)
+    workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    for (int i = 3; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-e") == 0 && i + 1 < argc)
+        {
+            job.engine = Find_Execution_Engine(argv[++i]);
+            if (job.engine == NULL)
+                return Usage(argv[0]);
+        }
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+            workers = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--full") == 0 && !job.generate)
+            job.every_case = true;
+        else
+            return Usage(argv[0]);
+    }
+    if (workers < 1)
+        workers = 1;
+
+    printf("6502 golden table - variant : %s, %s %s with %s, %d worker%s\n", H6502_VARIANT_NAME, argv[1], argv[2], job.engine->name,
+           workers, (workers > 1) ? "s" : "");
+    return job.generate ? Generate(&job, argv[2], workers) : Verify(&job, argv[2], workers);
+}
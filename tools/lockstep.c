@@ -0,0 +1,364 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host.h"
+#include "lockstep.h"
+#include "program_gen.h"
+
+#if !defined(_WIN32)
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Runs two execution engines in lockstep and stops at the first place they
+// do not agree, with the instructions before it disassembled
+//
+//  6502_lockstep [options]                    random programs
+//  6502_lockstep image.bin [options]          one image
+//
+//  -a engine, -b engine   engines to compare (switch, table, until), switch and table
+//  --block n              instructions between memory checks (64)
+//  --instructions n       instructions a program runs (100000)
+//  --seeds n              random programs, 0 runs until they diverge (1000)
+//  --seed n               first seed (1)
+//  --generated            random programs from program_gen.h
+//  -j workers             processes for random programs (one a core)
+//  --load address         where the raw image is loaded (0x0000)
+//  --start pc             PC the image starts at (0x0400)
+//
+// A random program is memory and registers filled from its seed. An opcode
+// the variant does not have is replaced with one it has when a program gets
+// to it, in both machines, so every program runs its instructions. Seeds are
+// shared out between worker processes, each with its own machines.
+//
+// With --generated, a program from the generator is loaded over the random
+// memory and runs until it gets to its trap.
+//
+// Exit code 0 when the engines agree, 1 when they diverge, 2 on a bad argument
+
+#define LOCKSTEP_DEFAULT_BLOCK        64
+#define LOCKSTEP_DEFAULT_INSTRUCTIONS 100000
+#define LOCKSTEP_DEFAULT_SEEDS        1000
+#define LOCKSTEP_REPORT_EVERY         16   // seeds between a worker's reports
+#define LOCKSTEP_PROGRESS_SECONDS     10.0
+
+typedef struct Lockstep_Options
+{
+    const Execution_Engine *engine_a;
+    const Execution_Engine *engine_b;
+    u32                     block;
+    uint64_t                instructions;
+    uint64_t                seeds;
+    uint64_t                first_seed;
+    bool                    generated;
+} Lockstep_Options;
+
+// What a worker did since its last report
+typedef struct Worker_Report
+{
+    int      worker;
+    bool     diverged;
+    bool     done;
+    uint64_t seed; // of the program that diverged
+    uint64_t seeds;
+    uint64_t instructions;
+} Worker_Report;
+
+typedef void (*Report_Function)(const Worker_Report *report, void *context);
+
+static Lockstep          lockstep;
+static Program_Generator generator;
+static Program           program;
+
+static int Usage(const char *name)
+{
+    fprintf(stderr,
+            "usage : %s [image.bin] [-a engine] [-b engine] [--block n] [--instructions n] [--seeds n] [--seed n] [-j workers] "
+            "[--generated] [--load address] [--start pc]\n",
+            name);
+    return 2;
+}
+
+// Memory and registers from 'seed'
+static void Random_Program(uint64_t seed)
+{
+    uint64_t state = seed;
+    for (u32 address = 0; address < MAX_MEM; address += 8)
+    {
+        const uint64_t bytes = Random_Next(&state);
+        for (u32 i = 0; i < 8; i++)
+            mem.data[address + i] = (u8)(bytes >> (8 * i));
+    }
+
+    const uint64_t registers = Random_Next(&state);
+    cpu.program_counter      = (u16)registers & 0xFFFF;
+    cpu.accumulator          = (u8)(registers >> 16);
+    cpu.index_reg_X          = (u8)(registers >> 24);
+    cpu.index_reg_Y          = (u8)(registers >> 32);
+    cpu.stack_pointer        = (u8)(registers >> 40);
+    cpu.PS                   = (u8)(registers >> 48);
+}
+
+// Runs a program to the end, false when the engines diverge
+static bool Run_Program(const Lockstep_Options *options, uint64_t seed, uint64_t *instructions)
+{
+    Lockstep_Start(&lockstep, options->engine_a, options->engine_b, options->block);
+
+    if (options->generated)
+        Lockstep_Stop_At(&lockstep, program.trap);
+
+    uint64_t         state   = seed ^ 0x5EED5EED5EED5EEDull;
+    Lockstep_Outcome outcome = LOCKSTEP_AGREE;
+    while (lockstep.instructions < options->instructions)
+    {
+        outcome = Lockstep_Run(&lockstep, options->instructions - lockstep.instructions);
+        if (outcome != LOCKSTEP_STOPPED)
+            break;
+        if (options->generated && cpu.program_counter == program.trap)
+            break;
+
+        // an opcode the variant does not have, make it one it has
+        u8 opcode;
+        do
+            opcode = (u8)Random_Next(&state);
+        while (!Opcode_Is_Valid(opcode));
+        Lockstep_Poke(&lockstep, cpu.program_counter, opcode);
+    }
+
+    *instructions += lockstep.instructions;
+    if (outcome == LOCKSTEP_DIVERGED)
+    {
+        printf("program %" PRIu64 " : ", seed);
+        Lockstep_Print_Divergence(&lockstep, stdout);
+        fflush(stdout);
+    }
+    Lockstep_Stop(&lockstep);
+    return outcome != LOCKSTEP_DIVERGED;
+}
+
+// Seeds 'worker' of 'workers' runs, reports go to 'out'
+static void Run_Worker(const Lockstep_Options *options, int worker, int workers, Report_Function out, void *context)
+{
+    Worker_Report report = {.worker = worker};
+    for (uint64_t n = (uint64_t)worker; options->seeds == 0 || n < options->seeds; n += (uint64_t)workers)
+    {
+        report.seed = options->first_seed + n;
+        Random_Program(report.seed);
+        if (options->generated)
+        {
+            Program_Generate(&generator, report.seed, &program);
+            Program_Load(&program);
+        }
+        report.diverged = !Run_Program(options, report.seed, &report.instructions);
+        report.seeds++;
+        if (report.diverged)
+            break;
+
+        if (report.seeds == LOCKSTEP_REPORT_EVERY)
+        {
+            out(&report, context);
+            report.seeds        = 0;
+            report.instructions = 0;
+        }
+    }
+    report.done = true;
+    out(&report, context);
+}
+
+typedef struct Totals
+{
+    uint64_t seeds;
+    uint64_t instructions;
+    int      diverged;
+    int      done;
+    double   start;
+    double   progress;
+} Totals;
+
+static void Add_Report(const Worker_Report *report, void *context)
+{
+    Totals *totals = context;
+    totals->seeds += report->seeds;
+    totals->instructions += report->instructions;
+    totals->diverged += report->diverged;
+    totals->done += report->done;
+
+    const double now = Seconds_Now();
+    if (now - totals->progress >= LOCKSTEP_PROGRESS_SECONDS)
+    {
+        totals->progress = now;
+        printf("%" PRIu64 " programs, %" PRIu64 " instructions, %.0f s\n", totals->seeds, totals->instructions, now - totals->start);
+        fflush(stdout);
+    }
+}
+
+#if !defined(_WIN32)
+// Reports are smaller than PIPE_BUF so the workers' writes do not mix
+static void Write_Report(const Worker_Report *report, void *context)
+{
+    const int pipe_out = *(int *)context;
+    if (write(pipe_out, report, sizeof(*report)) != (ssize_t)sizeof(*report))
+        _exit(1);
+}
+
+// Stops the other workers at the first divergence
+static void Run_Workers(const Lockstep_Options *options, int workers, Totals *totals)
+{
+    int pipe_ends[2];
+    if (pipe(pipe_ends) != 0)
+    {
+        fprintf(stderr, "Error creating a pipe\n");
+        return;
+    }
+
+    fflush(stdout);
+    pid_t *children = calloc((size_t)workers, sizeof(pid_t));
+    int    started  = 0;
+    for (; children != NULL && started < workers; started++)
+    {
+        const pid_t child = fork();
+        if (child < 0)
+            break;
+        if (child == 0)
+        {
+            close(pipe_ends[0]);
+            Run_Worker(options, started, workers, Write_Report, &pipe_ends[1]);
+            _exit(0);
+        }
+        children[started] = child;
+    }
+    close(pipe_ends[1]);
+
+    Worker_Report report;
+    while (totals->done < started && read(pipe_ends[0], &report, sizeof(report)) == (ssize_t)sizeof(report))
+    {
+        Add_Report(&report, totals);
+        if (report.diverged)
+            break;
+    }
+    for (int worker = 0; worker < started; worker++)
+        kill(children[worker], SIGTERM);
+    for (int worker = 0; worker < started; worker++)
+        waitpid(children[worker], NULL, 0);
+    close(pipe_ends[0]);
+    free(children);
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    Lockstep_Options options = {
+        .engine_a     = Find_Execution_Engine("switch"),
+        .engine_b     = Find_Execution_Engine("table"),
+        .block        = LOCKSTEP_DEFAULT_BLOCK,
+        .instructions = LOCKSTEP_DEFAULT_INSTRUCTIONS,
+        .seeds        = LOCKSTEP_DEFAULT_SEEDS,
+        .first_seed   = 1,
+    };
+    const char *image        = NULL;
+    u16         load_address = 0x0000;
+    u16         start_pc     = 0x0400;
+    int         workers      = 1;
+#if !defined(_WIN32)
+    workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (argv[i][0] != '-')
+        {
+            if (image != NULL)
+                return Usage(argv[0]);
+            image = argv[i];
+            continue;
+        }
+        if (strcmp(argv[i], "--generated") == 0)
+        {
+            options.generated = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+            return Usage(argv[0]);
+
+        const char              *value  = argv[++i];
+        const unsigned long long number = strtoull(value, NULL, 0);
+        if (strcmp(argv[i - 1], "-a") == 0)
+            options.engine_a = Find_Execution_Engine(value);
+        else if (strcmp(argv[i - 1], "-b") == 0)
+            options.engine_b = Find_Execution_Engine(value);
+        else if (strcmp(argv[i - 1], "--block") == 0)
+            options.block = (u32)number;
+        else if (strcmp(argv[i - 1], "--instructions") == 0)
+            options.instructions = number;
+        else if (strcmp(argv[i - 1], "--seeds") == 0)
+            options.seeds = number;
+        else if (strcmp(argv[i - 1], "--seed") == 0)
+            options.first_seed = number;
+        else if (strcmp(argv[i - 1], "-j") == 0)
+            workers = (int)number;
+        else if (strcmp(argv[i - 1], "--load") == 0)
+            load_address = (u16)number & 0xFFFF;
+        else if (strcmp(argv[i - 1], "--start") == 0)
+            start_pc = (u16)number & 0xFFFF;
+        else
+            return Usage(argv[0]);
+    }
+    if (options.engine_a == NULL || options.engine_b == NULL)
+    {
+        fprintf(stderr, "Error : engines are");
+        for (int engine = 0; engine < EXECUTION_ENGINE_COUNT; engine++)
+            fprintf(stderr, " %s", execution_engines[engine].name);
+        fprintf(stderr, "\n");
+        return 2;
+    }
+    if (workers < 1)
+        workers = 1;
+    if (options.generated)
+    {
+        Program_Config config;
+        Program_Default_Config(&config);
+        Program_Generator_Init(&generator, &config);
+    }
+
+    printf("6502 lockstep - variant : %s, %s against %s, memory checked every %" PRIuFAST32 " instructions\n", H6502_VARIANT_NAME,
+           options.engine_a->name, options.engine_b->name, options.block);
+
+    Totals totals = {.start = Seconds_Now()};
+    totals.progress = totals.start;
+    if (image != NULL)
+    {
+        Reset_CPU();
+        if (!Load_Image(image, load_address))
+            return 2;
+        cpu.program_counter = start_pc;
+
+        Lockstep_Start(&lockstep, options.engine_a, options.engine_b, options.block);
+        const Lockstep_Outcome outcome = Lockstep_Run(&lockstep, options.instructions);
+        totals.seeds                   = 1;
+        totals.instructions            = lockstep.instructions;
+        totals.diverged                = (outcome == LOCKSTEP_DIVERGED);
+        if (outcome == LOCKSTEP_DIVERGED)
+            Lockstep_Print_Divergence(&lockstep, stdout);
+        else if (outcome == LOCKSTEP_STOPPED)
+            printf("stopped at opcode 0x%02X at 0x%04X, not in the variant\n", (unsigned)Peek_Byte(cpu.program_counter),
+                   (unsigned)cpu.program_counter);
+        Lockstep_Stop(&lockstep);
+    }
+    else
+    {
+        printf("%" PRIu64 " %sprograms from seed %" PRIu64 ", %" PRIu64 " instructions each, %d worker%s\n", options.seeds,
+               options.generated ? "generated " : "", options.first_seed, options.instructions, workers, (workers > 1) ? "s" : "");
+#if !defined(_WIN32)
+        if (workers > 1)
+            Run_Workers(&options, workers, &totals);
+        else
+#endif
+            Run_Worker(&options, 0, 1, Add_Report, &totals);
+    }
+
+    const double elapsed = Seconds_Now() - totals.start;
+    printf("%s : %" PRIu64 " program%s, %" PRIu64 " instructions in %.3f s (%.0f a second)\n", totals.diverged ? "DIVERGED" : "agree",
+           totals.seeds, (totals.seeds == 1) ? "" : "s", totals.instructions, elapsed, (double)totals.instructions / elapsed);
+    return totals.diverged ? 1 : 0;
+}
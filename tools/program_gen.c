@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "h6502.h"
+#include "host.h"
+#include "program_gen.h"
+
+// Generates random programs and runs them to their trap
+//
+//  6502_program_gen [options]
+//
+//  --programs n       programs to generate and run (100000)
+//  --seed n           first seed (1)
+//  --instructions n   random instructions in a program (32)
+//  --branches n       branches and JMPs in 256 instructions (32)
+//  --calls n          JSRs in 256 instructions (4)
+//  --smc n            stores into a later instruction in 256 instructions (4)
+//  --stack n          bytes on the stack at most (32)
+//  --print seed       disassembles the program of a seed and stops
+//
+// Generation is timed on its own first, then each program runs under
+// Execute() an instruction at a time, so a sanitizer build of this tool
+// checks Execute() on all of them. A program that leaves its code, goes
+// deeper on the stack than it should or does not get to its trap is
+// reported with its seed.
+//
+// Exit code 0 when every program gets to its trap, 1 when one does not, 2 on a bad argument
+
+#define PROGRAM_GEN_DEFAULT_PROGRAMS 100000
+#define PROGRAM_GEN_MAX_INSTRUCTIONS 100000 // a program that runs longer does not terminate
+
+static Program_Generator generator;
+static Program           program;
+
+static int Usage(const char *name)
+{
+    fprintf(stderr,
+            "usage : %s [--programs n] [--seed n] [--instructions n] [--branches n] [--calls n] [--smc n] [--stack n] "
+            "[--print seed]\n",
+            name);
+    return 2;
+}
+
+static void Print_Program(void)
+{
+    Initialise_Memory();
+    Program_Load(&program);
+    printf("; seed %" PRIu64 ", %" PRIuFAST32 " bytes, trap at $%04X\n", program.seed, program.size, (unsigned)program.trap);
+    for (u32 address = program.address; address < program.address + program.size;)
+    {
+        char text[32];
+        const u8 bytes = Disassemble((u16)address, text, sizeof(text));
+        printf("%04X  %s\n", (unsigned)address, text);
+        address += (bytes > 0) ? bytes : 1;
+    }
+}
+
+// Runs the loaded program to its trap, false with the reason when it does not get there
+static bool Run_Program(uint64_t *instructions, const char **reason)
+{
+    const u32 lowest_stack = 0xFF - generator.config.max_stack_depth;
+    for (u32 count = 0; count < PROGRAM_GEN_MAX_INSTRUCTIONS; count++)
+    {
+        const u16 pc = cpu.program_counter;
+        if (pc == program.trap)
+        {
+            *instructions += count;
+            return true;
+        }
+        if (pc < program.address || pc >= program.address + program.size)
+        {
+            *reason = "left its code";
+            return false;
+        }
+        // the prologue sets the stack with its first two instructions
+        if (count >= 2 && cpu.stack_pointer < lowest_stack)
+        {
+            *reason = "went too deep on the stack";
+            return false;
+        }
+        Execute(1);
+    }
+    *reason = "did not get to its trap";
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    Program_Config config;
+    Program_Default_Config(&config);
+    uint64_t programs   = PROGRAM_GEN_DEFAULT_PROGRAMS;
+    uint64_t first_seed = 1;
+    bool     print      = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (i + 1 >= argc)
+            return Usage(argv[0]);
+
+        const unsigned long long number = strtoull(argv[++i], NULL, 0);
+        if (strcmp(argv[i - 1], "--programs") == 0)
+            programs = number;
+        else if (strcmp(argv[i - 1], "--seed") == 0)
+            first_seed = number;
+        else if (strcmp(argv[i - 1], "--instructions") == 0)
+            config.instructions = (u32)number;
+        else if (strcmp(argv[i - 1], "--branches") == 0)
+            config.branch_per_256 = (u8)(number > 255 ? 255 : number);
+        else if (strcmp(argv[i - 1], "--calls") == 0)
+            config.call_per_256 = (u8)(number > 255 ? 255 : number);
+        else if (strcmp(argv[i - 1], "--smc") == 0)
+            config.smc_per_256 = (u8)(number > 255 ? 255 : number);
+        else if (strcmp(argv[i - 1], "--stack") == 0)
+            config.max_stack_depth = (u8)(number > 255 ? 255 : number);
+        else if (strcmp(argv[i - 1], "--print") == 0)
+        {
+            first_seed = number;
+            print      = true;
+        }
+        else
+            return Usage(argv[0]);
+    }
+    if (!Program_Generator_Init(&generator, &config))
+    {
+        fprintf(stderr, "Error : the program does not fit between $%04X and the data\n", (unsigned)config.code_address);
+        return 2;
+    }
+
+    if (print)
+    {
+        Program_Generate(&generator, first_seed, &program);
+        Print_Program();
+        return 0;
+    }
+
+    printf("6502 program generator - variant : %s, %" PRIuFAST32 " instructions, %u branches, %u calls, %u stores into code "
+           "in 256, stack %u\n",
+           H6502_VARIANT_NAME, config.instructions, (unsigned)config.branch_per_256, (unsigned)config.call_per_256,
+           (unsigned)config.smc_per_256, (unsigned)config.max_stack_depth);
+
+    uint64_t bytes = 0;
+    double   start = Seconds_Now();
+    for (uint64_t n = 0; n < programs; n++)
+    {
+        Program_Generate(&generator, first_seed + n, &program);
+        bytes += program.size;
+    }
+    double elapsed = Seconds_Now() - start;
+    printf("generated : %" PRIu64 " programs, %.1f bytes each, in %.3f s (%.0f a second)\n", programs,
+           programs ? (double)bytes / (double)programs : 0.0, elapsed, (double)programs / elapsed);
+
+    uint64_t instructions = 0;
+    uint64_t failed       = 0;
+    start                 = Seconds_Now();
+    for (uint64_t n = 0; n < programs; n++)
+    {
+        Initialise_Memory();
+        Reset_CPU();
+        Program_Generate(&generator, first_seed + n, &program);
+        Program_Load(&program);
+
+        const char *reason = NULL;
+        if (!Run_Program(&instructions, &reason))
+        {
+            if (failed++ < 10)
+                printf("program %" PRIu64 " %s, PC $%04X SP $%02X\n", program.seed, reason, (unsigned)cpu.program_counter,
+                       (unsigned)cpu.stack_pointer);
+        }
+    }
+    elapsed = Seconds_Now() - start;
+    printf("%s : %" PRIu64 " programs, %" PRIu64 " did not get to their trap, %" PRIu64 " instructions in %.3f s (%.0f a second)\n",
+           failed ? "FAIL" : "OK", programs, failed, instructions, elapsed, (double)instructions / elapsed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "h6502.h"
+#include "host.h"
+#include "single_step.h"
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Run single step conformance tests, one JSON file of cases an opcode
+//
+//  6502_single_step directory [-j workers] [opcode...]
+//
+// Reads "directory/a9.json" and so on for each opcode the variant has, or only
+// for the opcodes given in hex. Opcodes are shared out between worker
+// processes (one a core by default), each with its own 'cpu' and 'mem', and
+// their results come back through a pipe. Windows runs them all in one.
+//
+// Prints the pass rate of each opcode and the first case that failed.
+// Exit code 0 when every case passes, 1 when one fails, 2 on a bad argument
+
+#define SINGLE_STEP_MAX_PATH 4096
+
+typedef struct Opcode_Result
+{
+    int      opcode;
+    bool     found; // there is a file
+    bool     error; // the file is not valid JSON
+    uint64_t cases;
+    uint64_t passed;
+    char     failure[160];
+} Opcode_Result;
+
+static int Usage(const char *name)
+{
+    fprintf(stderr, "usage : %s directory [-j workers] [opcode...]\n", name);
+    return 2;
+}
+
+static Opcode_Result Run_Opcode(const char *directory, int opcode)
+{
+    Opcode_Result result = {.opcode = opcode};
+    char          path[SINGLE_STEP_MAX_PATH];
+    snprintf(path, sizeof(path), "%s/%02x.json", directory, opcode);
+
+    Single_Step_Reader *reader = Single_Step_Open(path);
+    if (reader == NULL)
+        return result;
+    result.found = true;
+
+    static Single_Step_Case test;
+    char                    failure[sizeof(result.failure)];
+    while (Single_Step_Next(reader, &test))
+    {
+        result.cases++;
+        if (Single_Step_Run(&test, failure, sizeof(failure)))
+            result.passed++;
+        else if (result.failure[0] == '\0')
+            memcpy(result.failure, failure, sizeof(failure));
+    }
+    result.error = reader->error;
+    Single_Step_Close(reader);
+    return result;
+}
+
+// The opcodes 'worker' of 'workers' runs, to 'out'
+static void Run_Worker(const char *directory, const bool *selected, int worker, int workers, void (*out)(const Opcode_Result *, void *),
+                       void *context)
+{
+    Reset_CPU();
+    for (int opcode = worker; opcode < 256; opcode += workers)
+    {
+        if (selected[opcode])
+        {
+            const Opcode_Result result = Run_Opcode(directory, opcode);
+            out(&result, context);
+        }
+    }
+}
+
+static void Store_Result(const Opcode_Result *result, void *context)
+{
+    Opcode_Result *results  = context;
+    results[result->opcode] = *result;
+}
+
+#if !defined(_WIN32)
+// Results are smaller than PIPE_BUF so the workers' writes do not mix
+static void Write_Result(const Opcode_Result *result, void *context)
+{
+    const int pipe_out = *(int *)context;
+    if (write(pipe_out, result, sizeof(*result)) != (ssize_t)sizeof(*result))
+        _exit(1);
+}
+
+static bool Run_Workers(const char *directory, const bool *selected, int workers, Opcode_Result *results)
+{
+    int pipe_ends[2];
+    if (pipe(pipe_ends) != 0)
+        return false;
+
+    fflush(stdout);
+    int started = 0;
+    for (; started < workers; started++)
+    {
+        const pid_t child = fork();
+        if (child < 0)
+            break;
+        if (child == 0)
+        {
+            close(pipe_ends[0]);
+            Run_Worker(directory, selected, started, workers, Write_Result, &pipe_ends[1]);
+            _exit(0);
+        }
+    }
+    close(pipe_ends[1]);
+
+    Opcode_Result result;
+    while (read(pipe_ends[0], &result, sizeof(result)) == (ssize_t)sizeof(result))
+    {
+        if (result.opcode >= 0 && result.opcode < 256)
+            results[result.opcode] = result;
+    }
+    close(pipe_ends[0]);
+
+    bool ok = (started == workers);
+    for (int worker = 0; worker < started; worker++)
+    {
+        int status = 0;
+        if (wait(&status) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            ok = false;
+    }
+    return ok;
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || argv[1][0] == '-')
+        return Usage(argv[0]);
+    const char *directory = argv[1];
+
+    int workers = 1;
+#if !defined(_WIN32)
+    workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    bool selected[256] = {0};
+    bool any_selected  = false;
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+        {
+            workers = atoi(argv[++i]);
+            continue;
+        }
+
+        char               *end;
+        const unsigned long opcode = strtoul(argv[i], &end, 16);
+        if (*end != '\0' || end == argv[i] || opcode > 0xFF)
+            return Usage(argv[0]);
+        selected[opcode] = true;
+        any_selected     = true;
+    }
+    if (workers < 1)
+        workers = 1;
+
+    // only the opcodes this variant has
+    for (int opcode = 0; opcode < 256; opcode++)
+        selected[opcode] = (selected[opcode] || !any_selected) && Opcode_Is_Valid((u8)opcode);
+
+    printf("6502 single step tests - variant : %s, %s, %d worker%s\n", H6502_VARIANT_NAME, directory, workers, (workers > 1) ? "s" : "");
+
+    static Opcode_Result results[256];
+    for (int opcode = 0; opcode < 256; opcode++)
+        results[opcode] = (Opcode_Result){.opcode = opcode};
+
+    const double start = Seconds_Now();
+    bool         ok    = true;
+#if !defined(_WIN32)
+    if (workers > 1)
+        ok = Run_Workers(directory, selected, workers, results);
+    else
+#endif
+        Run_Worker(directory, selected, 0, 1, Store_Result, results);
+    const double elapsed = Seconds_Now() - start;
+
+    uint64_t cases = 0, passed = 0;
+    int      files = 0, failed_opcodes = 0;
+    printf("%-6s %-4s %-8s %9s %9s %8s  %s\n", "opcode", "ins", "mode", "cases", "passed", "rate", "first failure");
+    for (int opcode = 0; opcode < 256; opcode++)
+    {
+        const Opcode_Result *result = &results[opcode];
+        if (!selected[opcode] || !result->found)
+            continue;
+
+        files++;
+        cases += result->cases;
+        passed += result->passed;
+        const bool failed = (result->passed < result->cases) || result->error;
+        failed_opcodes += failed;
+        printf("0x%02X   %-4s %-8s %9" PRIu64 " %9" PRIu64 " %7.2f%%  %s%s\n", opcode, Opcode_Mnemonic((u8)opcode),
+               Address_Mode_Name(Opcode_Address_Mode((u8)opcode)), result->cases, result->passed,
+               result->cases ? 100.0 * (double)result->passed / (double)result->cases : 0.0, result->error ? "(bad JSON) " : "",
+               result->failure);
+    }
+
+    if (files == 0)
+    {
+        fprintf(stderr, "Error : no test files in %s\n", directory);
+        return 2;
+    }
+    if (!ok)
+        fprintf(stderr, "Error : a worker did not finish\n");
+
+    printf("%d files, %" PRIu64 " of %" PRIu64 " cases passed (%.2f%%), %d opcode%s failing\n", files, passed, cases,
+           cases ? 100.0 * (double)passed / (double)cases : 0.0, failed_opcodes, (failed_opcodes == 1) ? "" : "s");
+    printf("%.3f s, %.0f cases/s\n", elapsed, (double)cases / elapsed);
+    return (ok && failed_opcodes == 0) ? 0 : 1;
+}
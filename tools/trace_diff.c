@@ -0,0 +1,33 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "h6502.h"
+#include "host.h"
+
+// Compare a text trace with a reference log (see trace_text.h)
+//
+//  6502_trace_diff ours.log nestest.log [context lines]
+//
+// Exit code 0 when the logs match, 1 when they differ, 2 on a bad argument
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage : %s ours.log reference.log [context lines]\n", argv[0]);
+        return 2;
+    }
+
+    const size_t context = (argc > 3) ? (size_t)strtoul(argv[3], NULL, 10) : 5;
+
+    const double                 start   = Seconds_Now();
+    const Trace_Text_Diff_Result result  = Trace_Text_Diff_Files(argv[1], argv[2], stdout, context);
+    const double                 elapsed = Seconds_Now() - start;
+
+    if (result.line == 0 && !result.match)
+        return 2;
+
+    if (result.match)
+        printf("Logs match, %" PRIu64 " lines in %.3f s (%.1f M lines/s)\n", result.line, elapsed, (double)result.line / elapsed / 1e6);
+    return result.match ? 0 : 1;
+}